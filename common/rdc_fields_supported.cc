@@ -21,6 +21,7 @@ THE SOFTWARE.
 */
 #include <assert.h>
 
+#include <ctype.h>
 #include <algorithm>
 
 #include "common/rdc_fields_supported.h"
@@ -59,6 +60,18 @@ bool get_field_id_from_name(const std::string name, rdc_field_t *value) {
     return true;
 }
 
+std::string get_field_metric_name(rdc_field_t field_id) {
+  auto desc = field_id_to_descript.find(static_cast<uint32_t>(field_id));
+  if (desc == field_id_to_descript.end()) {
+    return "field_" + std::to_string(field_id);
+  }
+  std::string name = desc->second.label;
+  for (auto& c : name) {
+    c = isalnum(c) ? tolower(c) : '_';
+  }
+  return name;
+}
+
 bool is_field_valid(rdc_field_t field_id) {
   if (field_id == RDC_FI_INVALID) {
     return false;
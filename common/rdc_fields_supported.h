@@ -46,6 +46,9 @@ bool get_field_id_from_name(const std::string name, rdc_field_t *value);
 fld_id2name_map_t & get_field_id_description_from_id(void);  // NOLINT
 bool is_field_valid(rdc_field_t field_id);
 
+//!< The name of a field for metrics systems, its label in lower case
+std::string get_field_metric_name(rdc_field_t field_id);
+
 }  // namespace rdc
 }  // namespace amd
 
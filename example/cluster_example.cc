@@ -0,0 +1,118 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+// Queries the GPUs of a whole cluster through an rdcd aggregator.
+//
+// Usage: clusterexample [aggregator host:port]
+// Start some rdcd, and an aggregator of them, all with -u:
+//   rdcd -u -p 50052 & rdcd -u -p 50053 &
+//   rdcd -u -p 50051 --aggregate localhost:50052,localhost:50053
+
+#include <unistd.h>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "rdc/rdc.h"
+
+static rdc_field_t kFields[] = {RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE};
+static const uint32_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+
+int main(int argc, char **argv) {
+    const char* aggregator = argc > 1 ? argv[1] : "localhost:50051";
+    rdc_handle_t rdc_handle;
+
+    rdc_status_t result = rdc_init(0);
+    if (result != RDC_ST_OK) {
+        std::cout << "Error initializing RDC. Return: " <<
+                rdc_status_string(result) << std::endl;
+        return 1;
+    }
+    result = rdc_connect(aggregator, &rdc_handle, nullptr, nullptr, nullptr);
+    if (result != RDC_ST_OK) {
+        std::cout << "Error connecting to " << aggregator << ". Return: " <<
+                rdc_status_string(result) << std::endl;
+        rdc_shutdown();
+        return 1;
+    }
+
+    std::vector<rdc_cluster_host_t> hosts(64);
+    uint32_t count = hosts.size();
+    result = rdc_cluster_get_hosts(rdc_handle, hosts.data(), &count);
+    if (result != RDC_ST_OK) {
+        std::cout << "Error getting the hosts of " << aggregator <<
+                ". Return: " << rdc_status_string(result) << std::endl;
+        rdc_disconnect(rdc_handle);
+        rdc_shutdown();
+        return 1;
+    }
+    std::cout << "Hosts of " << aggregator << ":\n";
+    for (uint32_t i = 0; i < count; i++) {
+        std::cout << "  " << std::left << std::setw(24) << hosts[i].host <<
+            (hosts[i].connected ? "connected " : "down      ") <<
+            hosts[i].num_gpus << " GPUs, errors " << hosts[i].num_errors <<
+            std::endl;
+    }
+
+    // All the values of all the hosts in one call. Retry with a larger
+    // array if the cluster has more.
+    std::vector<rdc_cluster_field_value_t> values(256);
+    while (true) {
+        count = values.size();
+        result = rdc_cluster_get_latest_values(rdc_handle, nullptr, kFields,
+                kNumFields, values.data(), &count);
+        if (result != RDC_ST_INSUFF_RESOURCES) {
+            break;
+        }
+        values.resize(count);
+    }
+    if (result == RDC_ST_OK) {
+        std::cout << "\nLatest values:\n";
+        for (uint32_t i = 0; i < count; i++) {
+            const rdc_cluster_field_value_t& v = values[i];
+            std::cout << "  " << std::left << std::setw(24) << v.host <<
+                "GPU " << std::setw(3) << v.gpu_index << std::setw(14) <<
+                field_id_string(v.value.field_id) << std::right <<
+                std::setw(12) << v.value.value.l_int << "  " << v.age_ms <<
+                " ms old" << std::endl;
+        }
+    }
+
+    std::cout << "\nCluster aggregates:\n";
+    for (uint32_t i = 0; i < kNumFields; i++) {
+        rdc_cluster_aggregate_t aggregate;
+        result = rdc_cluster_get_aggregate(rdc_handle, kFields[i], 0,
+                                           &aggregate);
+        if (result != RDC_ST_OK) {
+            std::cout << "  " << field_id_string(kFields[i]) << ": " <<
+                rdc_status_string(result) << std::endl;
+            continue;
+        }
+        std::cout << "  " << field_id_string(kFields[i]) << ": " <<
+            aggregate.num_values << " GPUs on " << aggregate.num_hosts <<
+            " hosts, min " << aggregate.min_value << " max " <<
+            aggregate.max_value << " average " << aggregate.average <<
+            " (" << aggregate.num_skipped << " skipped)" << std::endl;
+    }
+
+    rdc_disconnect(rdc_handle);
+    rdc_shutdown();
+    return 0;
+}
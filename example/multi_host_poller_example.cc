@@ -0,0 +1,209 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Polls the latest GPU temperature and power of many rdcd hosts from a
+// single thread. All requests of a sweep are in flight at once on the
+// completion queue of the client library, each with its own deadline, so
+// a slow or unreachable host only delays its own values.
+//
+// Usage: multihostpoller host:port [host:port ...]
+// The rdcd instances must be started with -u (no authentication).
+
+#include <unistd.h>
+#include <condition_variable>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+
+static const uint32_t kTimeoutMs = 500;
+static const uint32_t kNumSweeps = 5;
+static rdc_field_t kFields[] = {RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE};
+static const uint32_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+
+struct Host {
+    std::string address;
+    rdc_handle_t handle;
+    std::vector<uint32_t> gpus;
+    rdc_gpu_group_t group_id;
+    rdc_field_grp_t field_group_id;
+    bool watching;
+};
+
+struct Sweep;
+
+// One value requested from one host
+struct Request {
+    const Host* host;
+    uint32_t gpu;
+    rdc_field_t field;
+    rdc_status_t status;
+    rdc_field_value value;
+    Sweep* sweep;
+};
+
+struct Sweep {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t remaining;
+};
+
+// Runs on a thread of the client library when a value or an error arrives
+static void on_value(rdc_status_t status, const rdc_field_value* value,
+                     void* user_data) {
+    Request* request = static_cast<Request*>(user_data);
+    request->status = status;
+    if (status == RDC_ST_OK) {
+        request->value = *value;
+    }
+
+    Sweep* sweep = request->sweep;
+    std::lock_guard<std::mutex> guard(sweep->mutex);
+    if (--sweep->remaining == 0) {
+        sweep->cv.notify_one();
+    }
+}
+
+static rdc_status_t watch_host(Host* host) {
+    rdc_status_t result = rdc_connect(host->address.c_str(), &host->handle,
+                                      nullptr, nullptr, nullptr);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    uint32_t gpus[RDC_MAX_NUM_DEVICES_EXT];
+    uint32_t count = RDC_MAX_NUM_DEVICES_EXT;
+    result = rdc_device_get_all_ext(host->handle, gpus, &count);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    host->gpus.assign(gpus, gpus + count);
+
+    result = rdc_group_gpu_create(host->handle, RDC_GROUP_DEFAULT,
+                                  "multihostpoller", &host->group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    result = rdc_group_field_create(host->handle, kNumFields, kFields,
+                                  "multihostpoller", &host->field_group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    // Update the fields once per second, keep 1 minute and 10 samples
+    result = rdc_field_watch(host->handle, host->group_id,
+                             host->field_group_id, 1000000, 60, 10);
+    host->watching = (result == RDC_ST_OK);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " host:port [host:port ...]\n";
+        return 1;
+    }
+
+    rdc_status_t result = rdc_init(0);
+    if (result != RDC_ST_OK) {
+        std::cout << "Error initializing RDC. Return: " <<
+                rdc_status_string(result) << std::endl;
+        return 1;
+    }
+
+    // Hosts which cannot be watched are left out of the sweeps
+    std::vector<Host> hosts(argc - 1);
+    std::vector<Request> requests;
+    for (int i = 1; i < argc; i++) {
+        Host& host = hosts[i - 1];
+        host.address = argv[i];
+        host.handle = nullptr;
+        host.watching = false;
+        result = watch_host(&host);
+        if (result != RDC_ST_OK) {
+            std::cout << "Error watching " << host.address << ". Return: "
+                << rdc_status_string(result) << std::endl;
+            continue;
+        }
+        std::cout << host.address << ": watching " << host.gpus.size()
+            << " GPUs\n";
+        for (uint32_t gpu : host.gpus) {
+            for (uint32_t f = 0; f < kNumFields; f++) {
+                Request request = {&host, gpu, kFields[f], RDC_ST_OK, {},
+                                   nullptr};
+                requests.push_back(request);
+            }
+        }
+    }
+
+    std::cout << "Sleep a few seconds before retreive the data ...\n";
+    usleep(2000000);
+
+    for (uint32_t s = 0; s < kNumSweeps && !requests.empty(); s++) {
+        Sweep sweep;
+        sweep.remaining = requests.size();
+        for (Request& request : requests) {
+            request.sweep = &sweep;
+            result = rdc_field_get_latest_value_async(request.host->handle,
+                request.gpu, request.field, kTimeoutMs, on_value, &request);
+            if (result != RDC_ST_OK) {
+                on_value(result, nullptr, &request);
+            }
+        }
+
+        // The thread is free for other work until the sweep completes
+        {
+            std::unique_lock<std::mutex> lock(sweep.mutex);
+            sweep.cv.wait(lock, [&sweep] { return sweep.remaining == 0; });
+        }
+
+        std::cout << "Sweep " << s << std::endl;
+        std::cout << std::left << std::setw(24) << "host" << "GPU_index\t"
+            << "field_name\t\t" << "field_value\n";
+        for (const Request& request : requests) {
+            std::cout << std::setw(24) << request.host->address
+                << request.gpu << "\t\t" << std::setw(16)
+                << field_id_string(request.field) << "\t";
+            if (request.status == RDC_ST_OK) {
+                std::cout << request.value.value.l_int << std::endl;
+            } else {
+                std::cout << rdc_status_string(request.status) << std::endl;
+            }
+        }
+        usleep(1000000);
+    }
+
+    for (Host& host : hosts) {
+        if (host.watching) {
+            rdc_field_unwatch(host.handle, host.group_id,
+                              host.field_group_id);
+            rdc_group_field_destroy(host.handle, host.field_group_id);
+            rdc_group_gpu_destroy(host.handle, host.group_id);
+        }
+        if (host.handle != nullptr) {
+            rdc_disconnect(host.handle);
+        }
+    }
+    rdc_shutdown();
+    return 0;
+}
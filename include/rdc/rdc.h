@@ -65,6 +65,8 @@ typedef enum {
                                       //!<   but none was found
      RDC_ST_PERM_ERROR,               //!< Insufficient permission to complete
                                       //!<   operation
+     RDC_ST_TIMEOUT,                  //!< The request did not complete
+                                      //!<   before its deadline
 
      RDC_ST_UNKNOWN_ERROR = 0xFFFFFFFF  //!< Unknown error
 } rdc_status_t;
@@ -126,6 +128,11 @@ typedef enum {
  */
 #define RDC_MAX_FIELD_IDS_PER_FIELD_GROUP 128
 
+/**
+ * @brief The max fields in the moments of a job on one GPU
+ */
+#define RDC_MAX_JOB_FIELDS      16
+
 /**
  * @brief The max number of groups
  */
@@ -136,6 +143,26 @@ typedef enum {
  */
 #define RDC_MAX_NUM_FIELD_GROUPS 64
 
+/**
+ * @brief Max number of GPUs supported by the _ext APIs
+ */
+#define RDC_MAX_NUM_DEVICES_EXT      1024
+
+/**
+ * @brief The max entities in a group for the _ext APIs
+ */
+#define RDC_GROUP_MAX_ENTITIES_EXT   1024
+
+/**
+ * @brief The max number of groups for the _ext APIs
+ */
+#define RDC_MAX_NUM_GROUPS_EXT       4096
+
+/**
+ * @brief The max number of the field groups for the _ext APIs
+ */
+#define RDC_MAX_NUM_FIELD_GROUPS_EXT 4096
+
 /**
  * These enums are used to specify a particular field to be retrieved.
  */
@@ -215,6 +242,20 @@ typedef enum {
                                      //!< neighbor 0 in byes/sec
   RDC_EVNT_XGMI_1_THRPUT,            //!< Transmit throughput to XGMI
                                      //!< neighbor 1 in byes/sec
+
+  /*
+   * @brief Pseudo-fields on the overhead of RDC itself, the same for
+   * every GPU index. See rdc_perf_metrics_get() for the details.
+   */
+  RDC_FI_RDC_SWEEP_DURATION = 2000,  //!< Duration of the last collection
+                                     //!< sweep in microseconds
+  RDC_FI_RDC_MISSED_DEADLINES,       //!< Fetches a whole update period
+                                     //!< late so far
+  RDC_FI_RDC_CACHE_BYTES,            //!< Memory of the cached samples
+  RDC_FI_RDC_CACHE_SAMPLES,          //!< Number of cached samples
+  RDC_FI_RDC_LOCK_WAIT,              //!< Time waited on the cache and
+                                     //!< watch table locks so far, in
+                                     //!< microseconds
 } rdc_field_t;
 
 /**
@@ -286,6 +327,36 @@ typedef struct {
      rdc_gpu_usage_info_t gpus[16];  //!< Job usage summary staticstics by GPU
 } rdc_job_info_t;
 
+/**
+ * @brief The running moments of a job field on one GPU
+ *
+ * @details The raw samples are never kept; the moments are what is needed
+ * to merge the statistics of the GPUs of several hosts exactly.
+ */
+typedef struct {
+    rdc_field_t field_id;   //!< The field, in the units of the field
+    uint64_t count;         //!< Number of samples
+    int64_t min_value;      //!< Minimum sample
+    int64_t max_value;      //!< Maximum sample
+    double mean;            //!< Mean of the samples
+    double m2;              //!< Sum of the squared differences from the mean
+} rdc_field_moments_t;
+
+/**
+ * @brief The mergeable state of a job on one GPU
+ */
+typedef struct {
+    uint32_t gpu_index;          //!< The GPU index on its host
+    uint64_t start_time;         //!< The time the job started
+    uint64_t end_time;           //!< The time the job stopped, or now
+    uint64_t energy_consumed;    //!< GPU Energy consumed
+    uint64_t ecc_correct;        //!< Correctable errors
+    uint64_t ecc_uncorrect;      //!< Uncorrtable errors
+    uint64_t memory_total;       //!< GPU memory, to scale the memory usage
+    uint32_t num_fields;         //!< Number of fields
+    rdc_field_moments_t fields[RDC_MAX_JOB_FIELDS];  //!< The job fields
+} rdc_job_gpu_moments_t;
+
 /**
  * @brief The structure to store the field value
  */
@@ -324,6 +395,95 @@ typedef struct {
     uint64_t stop_time;                          //!< job stop time
 } rdc_job_group_info_t;
 
+/**
+ * @brief The state of a downstream rdcd of an aggregator
+ */
+typedef struct {
+    char host[RDC_MAX_STR_LENGTH];  //!< host:port of the rdcd
+    uint32_t connected;             //!< 1 if the last sweep reached it
+    uint32_t num_gpus;              //!< GPUs of the host
+    uint32_t age_ms;                //!< Time since the last value, or
+                                    //!< UINT32_MAX if none yet
+    uint64_t num_errors;            //!< Failed requests so far
+} rdc_cluster_host_t;
+
+/**
+ * @brief A latest value kept by an aggregator
+ */
+typedef struct {
+    char host[RDC_MAX_STR_LENGTH];  //!< host:port of the rdcd
+    uint32_t gpu_index;             //!< The GPU index on that host
+    uint32_t age_ms;                //!< Time since the value was received
+    rdc_field_value value;          //!< The value as read from the host
+} rdc_cluster_field_value_t;
+
+/**
+ * @brief A field aggregated over all the GPUs of a cluster
+ */
+typedef struct {
+    rdc_field_t field_id;   //!< The field aggregated
+    uint32_t num_hosts;     //!< Hosts with at least one value aggregated
+    uint32_t num_values;    //!< Values aggregated
+    uint32_t num_skipped;   //!< Values too old, failed or not numbers
+    double min_value;       //!< Minimum value
+    double max_value;       //!< Maximum value
+    double sum;             //!< Sum of the values
+    double average;         //!< Average value
+} rdc_cluster_aggregate_t;
+
+/**
+ * @brief The update period of a watch, as requested and as governed
+ */
+typedef struct {
+    rdc_gpu_group_t group_id;        //!< The group of GPUs watched
+    rdc_field_grp_t field_group_id;  //!< The fields watched
+    uint32_t priority;               //!< The lowest priorities are
+                                     //!< stretched first
+    uint64_t requested_freq;         //!< The update_freq of
+                                     //!< rdc_field_watch() in usec
+    uint64_t max_update_freq;        //!< The longest period it may be
+                                     //!< stretched to in usec
+    uint64_t effective_freq;         //!< The period it is updated at in
+                                     //!< usec
+} rdc_watch_rate_t;
+
+/**
+ * @brief The number of buckets of the histograms of rdc_perf_metric_t
+ */
+#define RDC_PERF_HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief The max length of the name and label of rdc_perf_metric_t
+ */
+#define RDC_PERF_NAME_LENGTH 64
+
+/**
+ * @brief The kind of an internal performance metric
+ */
+typedef enum {
+  RDC_PERF_COUNTER = 0,   //!< Count since RDC started
+  RDC_PERF_GAUGE,         //!< Current value
+  RDC_PERF_HISTOGRAM      //!< Distribution of durations in microseconds
+} rdc_perf_metric_type_t;
+
+/**
+ * @brief An internal performance metric of RDC
+ *
+ * @details Bucket i of a histogram counts the durations shorter than 2^i
+ * microseconds which are not in bucket i-1. The last bucket counts all
+ * the longer durations.
+ */
+typedef struct {
+    char name[RDC_PERF_NAME_LENGTH];   //!< e.g. "sweep_duration_us"
+    char label[RDC_PERF_NAME_LENGTH];  //!< The field, cache key, lock or
+                                       //!< RPC method, or empty
+    rdc_perf_metric_type_t type;       //!< The kind of metric
+    uint64_t value;                    //!< The counter or gauge, or the
+                                       //!< number of durations recorded
+    uint64_t sum;                      //!< Sum of the durations recorded
+    uint64_t buckets[RDC_PERF_HISTOGRAM_BUCKETS];  //!< Histogram buckets
+} rdc_perf_metric_t;
+
 
 /**
  *  @brief Initialize ROCm RDC.
@@ -383,6 +543,13 @@ rdc_status_t rdc_stop_embedded(rdc_handle_t p_rdc_handle);
  *  @details This method is used to connect to a remote stand-alone
  *  rdcd daemon.
  *
+ *  When ipAndPort is localhost, 127.0.0.1 or [::1], the connection goes
+ *  through the Unix socket of that rdcd if it has one, without TLS. If that
+ *  rdcd was started with --shm, rdc_field_get_latest_value() reads the
+ *  values from its shared memory segment instead of calling it. Set the
+ *  RDC_UNIX_SOCKET and RDC_SHM_NAME environment variables to "none" to
+ *  turn this off.
+ *
  *  @param[in] ipAndPort The IP and port of the remote rdcd. The ipAndPort
  *  can be specified in this x.x.x.x:yyyy format, where x.x.x.x is the
  *  IP address and yyyy is the port.
@@ -456,6 +623,51 @@ rdc_status_t rdc_job_start_stats(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_job_get_stats(rdc_handle_t p_rdc_handle,
                            const char job_id[64], rdc_job_info_t* p_job_info);
 
+/**
+ *  @brief Get the mergeable state of the job on every GPU
+ *
+ *  @details Unlike rdc_job_get_stats(), returns the moments the stats are
+ *  computed from, for every GPU of the job. The moments of the GPUs of a
+ *  job running on several hosts can be merged with
+ *  rdc_job_merge_moments().
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] job_id The name of the job.
+ *
+ *  @param[out] gpus The caller provided array for the GPUs.
+ *
+ *  @param[inout] count The size of gpus on input, the number of GPUs of
+ *  the job on output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_INSUFF_RESOURCES if gpus is too small.
+ */
+rdc_status_t rdc_job_get_moments(rdc_handle_t p_rdc_handle,
+        const char job_id[64], rdc_job_gpu_moments_t* gpus, uint32_t* count);
+
+/**
+ *  @brief Merge the moments of GPUs into the stats of one job
+ *
+ *  @details Combines in one pass the moments returned by
+ *  rdc_job_get_moments() on any number of hosts, as in Chan et al.,
+ *  "Updating Formulae and a Pairwise Algorithm for Computing Sample
+ *  Variances". The summary holds the mean and the standard deviation of
+ *  all the samples of all the GPUs, rather than the average over GPUs
+ *  reported by rdc_job_get_stats(). The first 16 GPUs are also reported
+ *  one by one, in the order given.
+ *
+ *  @param[in] gpus The moments of the GPUs, from all the hosts.
+ *
+ *  @param[in] num_gpus The size of gpus.
+ *
+ *  @param[out] p_job_info The stats of the job.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ */
+rdc_status_t rdc_job_merge_moments(const rdc_job_gpu_moments_t* gpus,
+        uint32_t num_gpus, rdc_job_info_t* p_job_info);
+
 /**
  *  @brief Request RDC to stop watching the stats of the job
  *
@@ -535,6 +747,29 @@ rdc_status_t rdc_field_update_all(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_device_get_all(rdc_handle_t p_rdc_handle,
             uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count);
 
+/**
+ *  @brief Get indexes corresponding to all the devices on the system,
+ *  without the RDC_MAX_NUM_DEVICES limit.
+ *
+ *  @details Same as rdc_device_get_all(), but the caller provides the
+ *  capacity of gpu_index_list. Use it on nodes that expose more than
+ *  RDC_MAX_NUM_DEVICES devices, for example partitioned GPUs.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[out] gpu_index_list Array reference to fill GPU indexes present on
+ *  the system.
+ *
+ *  @param[inout] count On input, the number of entries gpu_index_list can
+ *  hold. On output, the number of GPUs on the system.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_INSUFF_RESOURCES is returned if gpu_index_list is too
+ *  small. count is set to the required size.
+ */
+rdc_status_t rdc_device_get_all_ext(rdc_handle_t p_rdc_handle,
+            uint32_t* gpu_index_list, uint32_t* count);
+
 /**
  *  @brief Gets device attributes corresponding to the gpu_index.
  *
@@ -608,10 +843,42 @@ rdc_status_t rdc_group_gpu_add(rdc_handle_t p_rdc_handle,
  *  group p_rdc_group_id.
  *
  *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_MAX_LIMIT The group has more than RDC_GROUP_MAX_ENTITIES
+ *  GPUs: the name and the first RDC_GROUP_MAX_ENTITIES GPUs are returned,
+ *  use rdc_group_gpu_get_info_ext() for all of them.
  */
 rdc_status_t rdc_group_gpu_get_info(rdc_handle_t p_rdc_handle,
             rdc_gpu_group_t p_rdc_group_id, rdc_group_info_t* p_rdc_group_info);
 
+/**
+ *  @brief Get information about a GPU group, without the
+ *  RDC_GROUP_MAX_ENTITIES limit.
+ *
+ *  @details Same as rdc_group_gpu_get_info(), but the GPU indexes are
+ *  written to a caller provided array.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] p_rdc_group_id The GPU group handler created by
+ *  rdc_group_gpu_create
+ *
+ *  @param[out] group_name The name of the group. Can be NULL.
+ *
+ *  @param[out] entity_ids Array reference to fill the GPU indexes in
+ *  the group.
+ *
+ *  @param[inout] count On input, the number of entries entity_ids can
+ *  hold. On output, the number of GPUs in the group.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_INSUFF_RESOURCES is returned if entity_ids is too
+ *  small. count is set to the required size.
+ */
+rdc_status_t rdc_group_gpu_get_info_ext(rdc_handle_t p_rdc_handle,
+            rdc_gpu_group_t p_rdc_group_id,
+            char group_name[RDC_MAX_STR_LENGTH],
+            uint32_t* entity_ids, uint32_t* count);
+
 /**
  *  @brief Used to get information about all GPU groups in the system.
  *
@@ -629,6 +896,25 @@ rdc_status_t rdc_group_gpu_get_info(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_group_get_all_ids(rdc_handle_t p_rdc_handle,
             rdc_gpu_group_t group_id_list[], uint32_t* count);
 
+/**
+ *  @brief Used to get all GPU group ids in the system, without the
+ *  RDC_MAX_NUM_GROUPS limit.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[out] group_id_list Array reference to fill GPU group
+ *  ids in the system.
+ *
+ *  @param[inout] count On input, the number of entries group_id_list can
+ *  hold. On output, the number of GPU groups in the system.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_INSUFF_RESOURCES is returned if group_id_list is too
+ *  small. count is set to the required size.
+ */
+rdc_status_t rdc_group_get_all_ids_ext(rdc_handle_t p_rdc_handle,
+            rdc_gpu_group_t* group_id_list, uint32_t* count);
+
 /**
  *  @brief Destroy GPU group represented by p_rdc_group_id
  *
@@ -704,6 +990,25 @@ rdc_status_t rdc_group_field_get_info(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_group_field_get_all_ids(rdc_handle_t p_rdc_handle,
             rdc_field_grp_t field_group_id_list[], uint32_t* count);
 
+/**
+ *  @brief Used to get all field group ids in the system, without the
+ *  RDC_MAX_NUM_FIELD_GROUPS limit.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[out] field_group_id_list Array reference to fill field group
+ *  ids in the system.
+ *
+ *  @param[inout] count On input, the number of entries field_group_id_list
+ *  can hold. On output, the number of field groups in the system.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_INSUFF_RESOURCES is returned if field_group_id_list is
+ *  too small. count is set to the required size.
+ */
+rdc_status_t rdc_group_field_get_all_ids_ext(rdc_handle_t p_rdc_handle,
+            rdc_field_grp_t* field_group_id_list, uint32_t* count);
+
 /**
  *  @brief Destroy field group represented by rdc_field_group_id
  *
@@ -762,6 +1067,36 @@ rdc_status_t rdc_field_watch(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_field_get_latest_value(rdc_handle_t p_rdc_handle,
         uint32_t gpu_index, rdc_field_t field, rdc_field_value* value);
 
+/**
+ *  @brief Request the latest cached fields of several GPUs at once
+ *
+ *  @details The bulk version of rdc_field_get_latest_value(). With a
+ *  remote rdcd, the values which are not in its shared memory are read
+ *  in a single request.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] gpu_indexes The GPU indexes.
+ *
+ *  @param[in] num_gpus The number of GPU indexes.
+ *
+ *  @param[in] field_ids  The field ids.
+ *
+ *  @param[in] num_fields The number of field ids.
+ *
+ *  @param[out] values  The num_gpus * num_fields values, the field
+ *  field_ids[j] of the GPU gpu_indexes[i] at values[i * num_fields + j].
+ *  The status of a value which could not be read is the error
+ *  rdc_field_get_latest_value() would return for it.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, even when some
+ *  of the values could not be read.
+ */
+rdc_status_t rdc_field_get_latest_values(rdc_handle_t p_rdc_handle,
+        const uint32_t* gpu_indexes, uint32_t num_gpus,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_field_value* values);
+
 /**
  *  @brief Request a history cached field of a GPU
  *
@@ -787,6 +1122,40 @@ rdc_status_t rdc_field_get_value_since(rdc_handle_t p_rdc_handle,
         uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
         uint64_t *next_since_time_stamp, rdc_field_value* value);
 
+/**
+ *  @brief Request the cached history of a field of a GPU at once
+ *
+ *  @details The bulk version of rdc_field_get_value_since(). It returns
+ *  the samples which rdc_field_get_value_since() would return one per
+ *  call, in a single call, or a single request to a remote rdcd.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] gpu_index The GPU index.
+ *
+ *  @param[in] field  The field id
+ *
+ *  @param[in] since_time_stamp  Timestamp to request values since in
+ *  usec since 1970.
+ *
+ *  @param[out] next_since_time_stamp Timestamp to use for sinceTimestamp
+ *  on next call to this function
+ *
+ *  @param[out] values  The field values got from cache, oldest first.
+ *
+ *  @param[inout] count  The number of values the array can hold, then
+ *  the number of values stored. A remote rdcd may return fewer values than
+ *  the array can hold while more are cached; next_since_time_stamp
+ *  continues from there.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call.
+ *  @retval ::RDC_ST_NOT_FOUND if no value was cached since the timestamp.
+ */
+rdc_status_t rdc_field_get_values_since(rdc_handle_t p_rdc_handle,
+        uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count);
+
 /**
  *  @brief Stop record updates for a given field collection.
  *
@@ -803,6 +1172,276 @@ rdc_status_t rdc_field_get_value_since(rdc_handle_t p_rdc_handle,
 rdc_status_t rdc_field_unwatch(rdc_handle_t p_rdc_handle,
         rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id);
 
+/**
+ *  @brief Set how far the CPU budget may slow down a watch
+ *
+ *  @details When RDC runs with RDC_CPU_BUDGET_PERCENT set and the
+ *  collection takes more CPU time than that share of one core, the
+ *  update period of the watches of the lowest priority is doubled, up to
+ *  their max_update_freq, until the collection fits in the budget again.
+ *  The periods are restored, highest priority first, when the load drops.
+ *  A watch has priority 0 and may be stretched to 10 times its
+ *  update_freq unless set otherwise.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] group_id The GPU group id of the watch.
+ *
+ *  @param[in] field_group_id  The field group id of the watch.
+ *
+ *  @param[in] priority The priority of the watch, the lowest priorities
+ *  are stretched first.
+ *
+ *  @param[in] max_update_freq The longest period, in usec, the watch may
+ *  be updated at. Its update_freq or less prevents stretching it.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_NOT_FOUND if the fields are not watched.
+ */
+rdc_status_t rdc_field_watch_set_limits(rdc_handle_t p_rdc_handle,
+        rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
+        uint32_t priority, uint64_t max_update_freq);
+
+/**
+ *  @brief Get the requested and effective update periods of the watches
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[out] rates The caller provided array for the watches.
+ *
+ *  @param[inout] count The size of rates on input, the number of watches
+ *  on output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_INSUFF_RESOURCES if rates is too small.
+ */
+rdc_status_t rdc_field_get_watch_rates(rdc_handle_t p_rdc_handle,
+        rdc_watch_rate_t* rates, uint32_t* count);
+
+/**
+ *  @brief Called when an asynchronous field request completes
+ *
+ *  @details Callbacks run on a thread of the client library, shared by all
+ *  connections of the process. They should return quickly, and must not
+ *  call rdc_disconnect() on the connection of the request.
+ *
+ *  @param[in] status ::RDC_ST_OK, the error of the request, or
+ *  ::RDC_ST_TIMEOUT if the deadline passed first.
+ *
+ *  @param[in] value The field value if status is ::RDC_ST_OK. It is only
+ *  valid during the callback.
+ *
+ *  @param[in] user_data The user_data of the request.
+ */
+typedef void (*rdc_field_value_callback_t)(rdc_status_t status,
+        const rdc_field_value* value, void* user_data);
+
+/**
+ *  @brief Called when an asynchronous job stats request completes
+ *
+ *  @details See rdc_field_value_callback_t.
+ */
+typedef void (*rdc_job_info_callback_t)(rdc_status_t status,
+        const rdc_job_info_t* job_info, void* user_data);
+
+/**
+ *  @brief Request a latest cached field of a GPU without waiting for it
+ *
+ *  @details The asynchronous version of rdc_field_get_latest_value(). The
+ *  request is sent on a completion queue shared by all the connections
+ *  of the process, so one thread can keep requests to many rdcd hosts in
+ *  flight at once. callback is called exactly once if this returns
+ *  ::RDC_ST_OK, and never otherwise. For a connection of
+ *  rdc_start_embedded() the callback is called before this returns.
+ *
+ *  rdc_disconnect() cancels the requests of the connection still in
+ *  flight, and returns after their callbacks have run.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] gpu_index The GPU index.
+ *
+ *  @param[in] field  The field id
+ *
+ *  @param[in] timeout_ms The deadline of the request in milliseconds, or 0
+ *  to wait as long as it takes.
+ *
+ *  @param[in] callback The function receiving the value.
+ *
+ *  @param[in] user_data Passed to callback as is.
+ *
+ *  @retval ::RDC_ST_OK is returned if the request was sent.
+ */
+rdc_status_t rdc_field_get_latest_value_async(rdc_handle_t p_rdc_handle,
+        uint32_t gpu_index, rdc_field_t field, uint32_t timeout_ms,
+        rdc_field_value_callback_t callback, void* user_data);
+
+/**
+ *  @brief Request the stats of a job without waiting for them
+ *
+ *  @details The asynchronous version of rdc_job_get_stats(), see
+ *  rdc_field_get_latest_value_async().
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] job_id The name of the job.
+ *
+ *  @param[in] timeout_ms The deadline of the request in milliseconds, or 0
+ *  to wait as long as it takes.
+ *
+ *  @param[in] callback The function receiving the job stats.
+ *
+ *  @param[in] user_data Passed to callback as is.
+ *
+ *  @retval ::RDC_ST_OK is returned if the request was sent.
+ */
+rdc_status_t rdc_job_get_stats_async(rdc_handle_t p_rdc_handle,
+        const char job_id[64], uint32_t timeout_ms,
+        rdc_job_info_callback_t callback, void* user_data);
+
+/**
+ *  @brief Get the downstream hosts of an aggregator
+ *
+ *  @details An rdcd started with --aggregate polls the latest values of
+ *  the GPUs of other rdcd, and answers the rdc_cluster_* calls from
+ *  memory. Other rdcd return ::RDC_ST_NOT_SUPPORTED.
+ *
+ *  @param[in] p_rdc_handle The RDC handler from rdc_connect().
+ *
+ *  @param[out] hosts The caller provided array for the hosts.
+ *
+ *  @param[inout] count The size of hosts on input, the number of hosts on
+ *  output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_INSUFF_RESOURCES if hosts is too small.
+ */
+rdc_status_t rdc_cluster_get_hosts(rdc_handle_t p_rdc_handle,
+        rdc_cluster_host_t* hosts, uint32_t* count);
+
+/**
+ *  @brief Get the latest values of many GPUs from an aggregator
+ *
+ *  @details Returns in one call the latest value of the fields on every
+ *  GPU of every host, or of one host. See rdc_cluster_get_hosts().
+ *
+ *  @param[in] p_rdc_handle The RDC handler from rdc_connect().
+ *
+ *  @param[in] host The host:port of one downstream rdcd, or nullptr for
+ *  all of them.
+ *
+ *  @param[in] field_ids The fields to return.
+ *
+ *  @param[in] num_fields The size of field_ids, or 0 for all the fields
+ *  the aggregator collects.
+ *
+ *  @param[out] values The caller provided array for the values.
+ *
+ *  @param[inout] count The size of values on input, the number of values
+ *  on output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_INSUFF_RESOURCES if values is too small.
+ */
+rdc_status_t rdc_cluster_get_latest_values(rdc_handle_t p_rdc_handle,
+        const char* host, const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_cluster_field_value_t* values, uint32_t* count);
+
+/**
+ *  @brief Get the latest value of a field of one GPU from an aggregator
+ *
+ *  @param[in] p_rdc_handle The RDC handler from rdc_connect().
+ *
+ *  @param[in] host The host:port of the downstream rdcd.
+ *
+ *  @param[in] gpu_index The GPU index on that host.
+ *
+ *  @param[in] field The field id.
+ *
+ *  @param[out] value The latest value.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_NOT_FOUND if the aggregator has no such value.
+ */
+rdc_status_t rdc_cluster_get_latest_value(rdc_handle_t p_rdc_handle,
+        const char* host, uint32_t gpu_index, rdc_field_t field,
+        rdc_cluster_field_value_t* value);
+
+/**
+ *  @brief Aggregate a field over all the GPUs known to an aggregator
+ *
+ *  @details Computes the minimum, maximum, sum and average of the latest
+ *  values of an integer or double field on all GPUs of all hosts.
+ *
+ *  @param[in] p_rdc_handle The RDC handler from rdc_connect().
+ *
+ *  @param[in] field The field id.
+ *
+ *  @param[in] max_age_ms Values received longer ago are skipped. 0 uses
+ *  three polling intervals of the aggregator.
+ *
+ *  @param[out] aggregate The aggregated values.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_NOT_FOUND if no value could be aggregated.
+ */
+rdc_status_t rdc_cluster_get_aggregate(rdc_handle_t p_rdc_handle,
+        rdc_field_t field, uint32_t max_age_ms,
+        rdc_cluster_aggregate_t* aggregate);
+
+/**
+ *  @brief Get the internal performance metrics of RDC
+ *
+ *  @details Reports the overhead of the collection itself, so it can be
+ *  alerted on:
+ *  - sweep_duration_us: histogram of the collection sweeps
+ *  - missed_deadlines: fields fetched a whole update period late
+ *  - fetch_latency_us: histogram of the fetches, labeled with the field
+ *  - cache_samples and cache_bytes: gauges, in total and labeled with
+ *    the cache key "gpu:field"
+ *  - lock_wait_us: histogram of the contended acquisitions, labeled
+ *    cache_mutex or watch_mutex
+ *  - rpc_latency_us and rpc_errors: per RPC method, when connected to rdcd
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[out] metrics The caller provided array for the metrics.
+ *
+ *  @param[inout] count The size of metrics on input, the number of metrics
+ *  on output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call, or
+ *  ::RDC_ST_INSUFF_RESOURCES if metrics is too small.
+ */
+rdc_status_t rdc_perf_metrics_get(rdc_handle_t p_rdc_handle,
+        rdc_perf_metric_t* metrics, uint32_t* count);
+
+/**
+ *  @brief Get a trace of the recent collection sweeps and RPCs
+ *
+ *  @details The scopes of the collection path (sweep, telemetry fetches,
+ *  cache and job stats updates, clean up) and of the RPCs served by rdcd
+ *  are recorded in a ring per thread when the process runs with
+ *  RDC_TRACE_EVENTS set to the size of the rings. The trace is returned in
+ *  the Chrome trace event JSON format, which chrome://tracing and
+ *  ui.perfetto.dev open.
+ *
+ *  @param[in] p_rdc_handle The RDC handler.
+ *
+ *  @param[in] last_seconds Only the scopes which ended that recently.
+ *
+ *  @param[out] buffer The caller provided buffer for the trace.
+ *
+ *  @param[inout] size The size of buffer on input, the size of the trace
+ *  including its terminating null on output.
+ *
+ *  @retval ::RDC_ST_OK is returned upon successful call,
+ *  ::RDC_ST_INSUFF_RESOURCES if buffer is too small, or
+ *  ::RDC_ST_NOT_SUPPORTED if tracing is disabled.
+ */
+rdc_status_t rdc_trace_get(rdc_handle_t p_rdc_handle, uint32_t last_seconds,
+        char* buffer, uint32_t* size);
+
 /**
  *  @brief Get a description of a provided RDC error status
  *
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <vector>
 #include <map>
 #include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcGroupSettings.h"
 #include "rdc/rdc.h"
 
 namespace amd {
@@ -40,18 +41,32 @@ class RdcCacheManager {
     virtual rdc_status_t rdc_field_get_value_since(uint32_t gpu_index,
         rdc_field_t field, uint64_t since_time_stamp,
                 uint64_t *next_since_time_stamp, rdc_field_value* value) = 0;
+    //!< Up to *count samples since the timestamp, under a single lock
+    virtual rdc_status_t rdc_field_get_values_since(uint32_t gpu_index,
+        rdc_field_t field, uint64_t since_time_stamp,
+                uint64_t *next_since_time_stamp, rdc_field_value* values,
+                uint32_t* count) = 0;
     virtual rdc_status_t rdc_update_cache(uint32_t gpu_index,
                 const rdc_field_value& value) = 0;
     virtual rdc_status_t evict_cache(uint32_t gpu_index, rdc_field_t field_id,
                 uint64_t max_keep_samples, double  max_keep_age) = 0;
+    //!< Make room for num_samples of the field, so that the updates up to
+    //!< the next eviction do not allocate
+    virtual rdc_status_t reserve_cache(uint32_t gpu_index,
+                rdc_field_t field_id, uint64_t num_samples) = 0;
     virtual std::string  get_cache_stats() = 0;
+    //!< Append the cache_samples and cache_bytes of every cache key
+    virtual void get_cache_usage(std::vector<rdc_perf_metric_t>* metrics) = 0;
 
     virtual rdc_status_t rdc_job_get_stats(const char job_id[64],
         const rdc_gpu_gauges_t& gpu_gauges,
         rdc_job_info_t* p_job_info) = 0;
+    virtual rdc_status_t rdc_job_get_moments(const char job_id[64],
+        const rdc_gpu_gauges_t& gpu_gauges,
+        std::vector<rdc_job_gpu_moments_t>* moments) = 0;
     virtual rdc_status_t rdc_job_start_stats(const char job_id[64],
-        const rdc_group_info_t& group,
-        const rdc_field_group_info_t& finfo,
+        const RdcGpuGroup& group,
+        const RdcFieldGroup& finfo,
         const rdc_gpu_gauges_t& gpu_gauges) = 0;
     virtual rdc_status_t rdc_job_stop_stats(const char job_id[64],
                 const rdc_gpu_gauges_t& gpu_gauge) = 0;
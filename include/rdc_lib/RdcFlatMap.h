@@ -0,0 +1,293 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_RDCFLATMAP_H_
+#define INCLUDE_RDC_LIB_RDCFLATMAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace amd {
+namespace rdc {
+
+//!< Pack a key of two 32 bit ids, such as <gpu_index, field_id>, into
+//!< 64 bits with the first id in the high half.
+template <typename K>
+inline uint64_t rdc_pack_key(const K& key) {
+    return (static_cast<uint64_t>(key.first) << 32) |
+            static_cast<uint32_t>(key.second);
+}
+
+//!< Hash of a packed key. This is the finalizer of MurmurHash3, which
+//!< spreads the small and dense ids over all bits.
+inline uint64_t rdc_hash_key(uint64_t packed) {
+    packed ^= packed >> 33;
+    packed *= 0xff51afd7ed558ccdULL;
+    packed ^= packed >> 33;
+    return packed;
+}
+
+//!< Open addressing hash map for keys of two 32 bit ids.
+//!<
+//!< The packed keys are probed linearly in their own array, so a lookup
+//!< usually touches one or two cache lines instead of walking a tree. The
+//!< interface follows the subset of std::map used in RDC, except that:
+//!<  - The iteration order is not sorted.
+//!<  - insert() and operator[] may invalidate all iterators.
+//!<  - erase() only invalidates the erased iterator, so erasing while
+//!<    iterating works like std::map.
+//!<  - The keys <0xFFFFFFFF, 0xFFFFFFFF> and <0xFFFFFFFF, 0xFFFFFFFE> mark
+//!<    the empty and the erased slots. insert() rejects them by returning
+//!<    end() and false, operator[] throws std::out_of_range and find()
+//!<    never finds them.
+template <typename K, typename V>
+class RdcFlatMap {
+ public:
+    typedef K key_type;
+    typedef V mapped_type;
+    typedef std::pair<K, V> value_type;
+
+    template <typename Map, typename Value>
+    class Iterator {
+     public:
+        Iterator() : map_(nullptr), index_(0) {}
+        Iterator(Map* map, size_t index) : map_(map), index_(index) {
+            skip_empty();
+        }
+        // Allow iterator to const_iterator conversion
+        template <typename OMap, typename OValue>
+        Iterator(const Iterator<OMap, OValue>& other)  // NOLINT
+            : map_(other.map_), index_(other.index_) {}
+
+        Value& operator*() const { return map_->slots_[index_]; }
+        Value* operator->() const { return &map_->slots_[index_]; }
+        Iterator& operator++() {
+            index_++;
+            skip_empty();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator ite = *this;
+            ++(*this);
+            return ite;
+        }
+        bool operator==(const Iterator& other) const {
+            return index_ == other.index_;
+        }
+        bool operator!=(const Iterator& other) const {
+            return index_ != other.index_;
+        }
+
+     private:
+        template <typename, typename> friend class Iterator;
+        friend class RdcFlatMap;
+
+        void skip_empty() {
+            while (index_ < map_->keys_.size() &&
+                    map_->keys_[index_] >= kTombstone) {
+                index_++;
+            }
+        }
+
+        Map* map_;
+        size_t index_;
+    };
+    typedef Iterator<RdcFlatMap, value_type> iterator;
+    typedef Iterator<const RdcFlatMap, const value_type> const_iterator;
+
+    RdcFlatMap() : size_(0), tombstones_(0) {}
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, keys_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, keys_.size()); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    iterator find(const K& key) {
+        return iterator(this, find_index(rdc_pack_key(key)));
+    }
+    const_iterator find(const K& key) const {
+        return const_iterator(this, find_index(rdc_pack_key(key)));
+    }
+
+    V& at(const K& key) {
+        size_t index = find_index(rdc_pack_key(key));
+        if (index == keys_.size()) {
+            throw std::out_of_range("RdcFlatMap::at");
+        }
+        return slots_[index].second;
+    }
+    const V& at(const K& key) const {
+        size_t index = find_index(rdc_pack_key(key));
+        if (index == keys_.size()) {
+            throw std::out_of_range("RdcFlatMap::at");
+        }
+        return slots_[index].second;
+    }
+
+    V& operator[](const K& key) {
+        if (is_reserved(rdc_pack_key(key))) {
+            throw std::out_of_range("RdcFlatMap::operator[] reserved key");
+        }
+        return insert(value_type(key, V())).first->second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return insert(value_type(value));
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        uint64_t packed = rdc_pack_key(value.first);
+        if (is_reserved(packed)) {
+            return std::make_pair(end(), false);
+        }
+        size_t index = find_index(packed);
+        if (index != keys_.size()) {
+            return std::make_pair(iterator(this, index), false);
+        }
+
+        if ((size_ + tombstones_ + 1) * 4 > keys_.size() * 3) {
+            // Grow only if the live entries need it, otherwise just
+            // drop the tombstones.
+            size_t capacity = keys_.size() < kMinCapacity ?
+                    kMinCapacity : keys_.size();
+            rehash((size_ + 1) * 2 > capacity ? capacity * 2 : capacity);
+        }
+
+        index = probe_start(packed);
+        while (keys_[index] != kEmpty && keys_[index] != kTombstone) {
+            index = (index + 1) & (keys_.size() - 1);
+        }
+        if (keys_[index] == kTombstone) {
+            tombstones_--;
+        }
+        keys_[index] = packed;
+        slots_[index] = std::move(value);
+        size_++;
+        return std::make_pair(iterator(this, index), true);
+    }
+
+    iterator erase(iterator pos) {
+        keys_[pos.index_] = kTombstone;
+        // Release the resources held by the value
+        slots_[pos.index_] = value_type();
+        size_--;
+        tombstones_++;
+        return iterator(this, pos.index_ + 1);
+    }
+
+    size_t erase(const K& key) {
+        iterator ite = find(key);
+        if (ite == end()) {
+            return 0;
+        }
+        erase(ite);
+        return 1;
+    }
+
+    void clear() {
+        keys_.clear();
+        slots_.clear();
+        size_ = 0;
+        tombstones_ = 0;
+    }
+
+    //!< Make room for count entries without rehashing
+    void reserve(size_t count) {
+        size_t capacity = kMinCapacity;
+        while (capacity * 3 < count * 4) {
+            capacity *= 2;
+        }
+        if (capacity > keys_.size()) {
+            rehash(capacity);
+        }
+    }
+
+ private:
+    static const uint64_t kEmpty = ~0ULL;
+    static const uint64_t kTombstone = ~0ULL - 1;
+    static const size_t kMinCapacity = 16;
+
+    static bool is_reserved(uint64_t packed) {
+        return packed >= kTombstone;
+    }
+
+    size_t probe_start(uint64_t packed) const {
+        return static_cast<size_t>(rdc_hash_key(packed)) &
+                (keys_.size() - 1);
+    }
+
+    //!< Return keys_.size() if not found
+    size_t find_index(uint64_t packed) const {
+        if (size_ == 0 || is_reserved(packed)) {
+            return keys_.size();
+        }
+        size_t index = probe_start(packed);
+        while (keys_[index] != kEmpty) {
+            if (keys_[index] == packed) {
+                return index;
+            }
+            index = (index + 1) & (keys_.size() - 1);
+        }
+        return keys_.size();
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<uint64_t> old_keys(capacity, kEmpty);
+        std::vector<value_type> old_slots(capacity);
+        old_keys.swap(keys_);
+        old_slots.swap(slots_);
+        tombstones_ = 0;
+        for (size_t i = 0; i < old_keys.size(); i++) {
+            if (old_keys[i] >= kTombstone) {
+                continue;
+            }
+            size_t index = probe_start(old_keys[i]);
+            while (keys_[index] != kEmpty) {
+                index = (index + 1) & (keys_.size() - 1);
+            }
+            keys_[index] = old_keys[i];
+            slots_[index] = std::move(old_slots[i]);
+        }
+    }
+
+    std::vector<uint64_t> keys_;   //!< packed keys, kEmpty or kTombstone
+    std::vector<value_type> slots_;
+    size_t size_;
+    size_t tombstones_;
+};
+
+template <typename K, typename V>
+const uint64_t RdcFlatMap<K, V>::kEmpty;
+template <typename K, typename V>
+const uint64_t RdcFlatMap<K, V>::kTombstone;
+template <typename K, typename V>
+const size_t RdcFlatMap<K, V>::kMinCapacity;
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_RDCFLATMAP_H_
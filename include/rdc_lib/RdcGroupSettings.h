@@ -23,12 +23,28 @@ THE SOFTWARE.
 #define INCLUDE_RDC_LIB_RDCGROUPSETTINGS_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "rdc_lib/rdc_common.h"
 #include "rdc/rdc.h"
 
 namespace amd {
 namespace rdc {
 
+//! An immutable GPU group. Readers share it instead of copying the group.
+struct RdcGpuGroup {
+    std::string group_name;
+    std::vector<uint32_t> entity_ids;
+};
+typedef std::shared_ptr<const RdcGpuGroup> RdcGpuGroupSnapshot;
+
+//! An immutable field group. Readers share it instead of copying the group.
+struct RdcFieldGroup {
+    std::string group_name;
+    std::vector<rdc_field_t> field_ids;
+};
+typedef std::shared_ptr<const RdcFieldGroup> RdcFieldGroupSnapshot;
+
 class RdcGroupSettings {
  public:
     virtual rdc_status_t rdc_group_gpu_create(const char* group_name,
@@ -42,6 +58,10 @@ class RdcGroupSettings {
         rdc_group_info_t* p_rdc_group_info)  = 0;
     virtual rdc_status_t rdc_group_get_all_ids(
         rdc_gpu_group_t group_id_list[], uint32_t* count) = 0;
+    virtual rdc_status_t rdc_group_gpu_get_snapshot(
+        rdc_gpu_group_t group_id, RdcGpuGroupSnapshot* snapshot) = 0;
+    virtual rdc_status_t rdc_group_get_all_ids(
+        std::vector<rdc_gpu_group_t>* group_ids) = 0;
 
 
     virtual rdc_status_t rdc_group_field_create(uint32_t num_field_ids,
@@ -54,6 +74,10 @@ class RdcGroupSettings {
         rdc_field_group_info_t* field_group_info) = 0;
     virtual rdc_status_t rdc_group_field_get_all_ids(
         rdc_field_grp_t field_group_id_list[], uint32_t* count) = 0;
+    virtual rdc_status_t rdc_group_field_get_snapshot(
+        rdc_field_grp_t field_group_id, RdcFieldGroupSnapshot* snapshot) = 0;
+    virtual rdc_status_t rdc_group_field_get_all_ids(
+        std::vector<rdc_field_grp_t>* field_group_ids) = 0;
 
     virtual ~RdcGroupSettings() {}
 };
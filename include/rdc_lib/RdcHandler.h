@@ -36,6 +36,8 @@ class RdcHandler {
                              const char job_id[64], uint64_t update_freq) = 0;
     virtual rdc_status_t rdc_job_get_stats(const char jobId[64],
                 rdc_job_info_t* p_job_info)= 0;
+    virtual rdc_status_t rdc_job_get_moments(const char job_id[64],
+                rdc_job_gpu_moments_t* gpus, uint32_t* count) = 0;
     virtual rdc_status_t rdc_job_stop_stats(const char job_id[64]) = 0;
     virtual rdc_status_t rdc_job_remove(const char job_id[64]) = 0;
     virtual rdc_status_t rdc_job_remove_all() = 0;
@@ -45,6 +47,8 @@ class RdcHandler {
         uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count) = 0;
     virtual rdc_status_t rdc_device_get_attributes(uint32_t gpu_index,
         rdc_device_attributes_t* p_rdc_attr) = 0;
+    virtual rdc_status_t rdc_device_get_all_ext(uint32_t* gpu_index_list,
+        uint32_t* count) = 0;
 
     // Group API
     virtual rdc_status_t rdc_group_gpu_create(rdc_group_type_t type,
@@ -63,6 +67,13 @@ class RdcHandler {
             rdc_gpu_group_t group_id_list[], uint32_t* count) = 0;
     virtual rdc_status_t rdc_group_field_get_all_ids(
             rdc_field_grp_t field_group_id_list[], uint32_t* count) = 0;
+    virtual rdc_status_t rdc_group_gpu_get_info_ext(
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) = 0;
+    virtual rdc_status_t rdc_group_get_all_ids_ext(
+            rdc_gpu_group_t* group_id_list, uint32_t* count) = 0;
+    virtual rdc_status_t rdc_group_field_get_all_ids_ext(
+            rdc_field_grp_t* field_group_id_list, uint32_t* count) = 0;
     virtual rdc_status_t rdc_group_gpu_destroy(
         rdc_gpu_group_t p_rdc_group_id) = 0;
     virtual rdc_status_t rdc_group_field_destroy(
@@ -80,9 +91,128 @@ class RdcHandler {
     virtual rdc_status_t rdc_field_unwatch(rdc_gpu_group_t group_id,
         rdc_field_grp_t field_group_id) = 0;
 
+    // CPU budget API, not served by an rdcd predating it
+    virtual rdc_status_t rdc_field_watch_set_limits(rdc_gpu_group_t group_id,
+        rdc_field_grp_t field_group_id, uint32_t priority,
+        uint64_t max_update_freq) {
+        (void)(group_id); (void)(field_group_id); (void)(priority);
+        (void)(max_update_freq);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    virtual rdc_status_t rdc_field_get_watch_rates(rdc_watch_rate_t* rates,
+        uint32_t* count) {
+        (void)(rates); (void)(count);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+
     // Control API
     virtual rdc_status_t rdc_field_update_all(uint32_t wait_for_update) = 0;
 
+    // Async API, completed before returning unless the handler overrides it
+    virtual rdc_status_t rdc_field_get_latest_value_async(uint32_t gpu_index,
+        rdc_field_t field, uint32_t timeout_ms,
+        rdc_field_value_callback_t callback, void* user_data) {
+        (void)(timeout_ms);
+        rdc_field_value value;
+        rdc_status_t status = rdc_field_get_latest_value(gpu_index, field,
+                &value);
+        callback(status, status == RDC_ST_OK ? &value : nullptr, user_data);
+        return RDC_ST_OK;
+    }
+    virtual rdc_status_t rdc_job_get_stats_async(const char job_id[64],
+        uint32_t timeout_ms, rdc_job_info_callback_t callback,
+        void* user_data) {
+        (void)(timeout_ms);
+        rdc_job_info_t job_info;
+        rdc_status_t status = rdc_job_get_stats(job_id, &job_info);
+        callback(status, status == RDC_ST_OK ? &job_info : nullptr,
+                user_data);
+        return RDC_ST_OK;
+    }
+
+    // Bulk API, read one value at a time unless the handler overrides it
+    virtual rdc_status_t rdc_field_get_latest_values(
+        const uint32_t* gpu_indexes, uint32_t num_gpus,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_field_value* values) {
+        if ((num_gpus > 0 && !gpu_indexes) || (num_fields > 0 && !field_ids)
+                || (num_gpus > 0 && num_fields > 0 && !values)) {
+            return RDC_ST_BAD_PARAMETER;
+        }
+        for (uint32_t i = 0; i < num_gpus; i++) {
+            for (uint32_t j = 0; j < num_fields; j++) {
+                rdc_field_value* value = &values[i * num_fields + j];
+                rdc_status_t status = rdc_field_get_latest_value(
+                        gpu_indexes[i], field_ids[j], value);
+                if (status != RDC_ST_OK) {
+                    value->field_id = field_ids[j];
+                    value->status = status;
+                }
+            }
+        }
+        return RDC_ST_OK;
+    }
+
+    virtual rdc_status_t rdc_field_get_values_since(uint32_t gpu_index,
+        rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) {
+        if (!next_since_time_stamp || !count || (*count > 0 && !values)) {
+            return RDC_ST_BAD_PARAMETER;
+        }
+        uint32_t capacity = *count;
+        *count = 0;
+        *next_since_time_stamp = since_time_stamp;
+        while (*count < capacity) {
+            uint64_t next = *next_since_time_stamp;
+            if (rdc_field_get_value_since(gpu_index, field,
+                    *next_since_time_stamp, &next, &values[*count])
+                    != RDC_ST_OK || next <= *next_since_time_stamp) {
+                break;
+            }
+            *next_since_time_stamp = next;
+            (*count)++;
+        }
+        return *count > 0 ? RDC_ST_OK : RDC_ST_NOT_FOUND;
+    }
+
+    // Cluster API, only served by an aggregator rdcd
+    virtual rdc_status_t rdc_cluster_get_hosts(rdc_cluster_host_t* hosts,
+        uint32_t* count) {
+        (void)(hosts); (void)(count);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    virtual rdc_status_t rdc_cluster_get_latest_values(const char* host,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_cluster_field_value_t* values, uint32_t* count) {
+        (void)(host); (void)(field_ids); (void)(num_fields);
+        (void)(values); (void)(count);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    virtual rdc_status_t rdc_cluster_get_latest_value(const char* host,
+        uint32_t gpu_index, rdc_field_t field,
+        rdc_cluster_field_value_t* value) {
+        (void)(host); (void)(gpu_index); (void)(field); (void)(value);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    virtual rdc_status_t rdc_cluster_get_aggregate(rdc_field_t field,
+        uint32_t max_age_ms, rdc_cluster_aggregate_t* aggregate) {
+        (void)(field); (void)(max_age_ms); (void)(aggregate);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+
+    // Self-telemetry of librdc, and of rdcd through the RdcAdmin service
+    virtual rdc_status_t rdc_perf_metrics_get(rdc_perf_metric_t* metrics,
+        uint32_t* count) {
+        (void)(metrics); (void)(count);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    virtual rdc_status_t rdc_trace_get(uint32_t last_seconds, char* buffer,
+        uint32_t* size) {
+        (void)(last_seconds); (void)(buffer); (void)(size);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+
     virtual ~RdcHandler(){}
 };
 
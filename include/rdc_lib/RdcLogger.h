@@ -21,35 +21,120 @@ THE SOFTWARE.
 */
 #ifndef INCLUDE_RDC_LIB_RDCLOGGER_H_
 #define INCLUDE_RDC_LIB_RDCLOGGER_H_
+#include <stdint.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
-#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 namespace amd {
 namespace rdc {
+
+//!< Where the log goes: stdout (default), stderr, journald or a file path
+#define RDC_LOG_SINK_ENV "RDC_LOG_SINK"
+//!< How many records a RDC_LOG statement may write per minute before the
+//!< rest are counted instead, 0 for no limit. Debug records are not limited.
+#define RDC_LOG_RATE_LIMIT_ENV "RDC_LOG_RATE_LIMIT"
+
+//!< One RDC_LOG statement, which keeps its own rate limit
+struct RdcLogSite {
+    RdcLogSite(const char* file, int line);
+
+    const char* file;  //!< Without the directories
+    int line;
+    std::atomic<uint64_t> window_start_ms;
+    std::atomic<uint32_t> count;       //!< Records in the current window
+    std::atomic<uint32_t> suppressed;  //!< Records since the last written
+};
+
+struct RdcLogEntry;
+class RdcLogRing;
+
+//!< Records go into a ring of the logging thread without any lock, and
+//!< a writer thread adds the time and location and writes them out.
 class RdcLogger {
  public:
-     explicit RdcLogger(std::ostream& os);
+    static RdcLogger& getLogger() {
+        // Never destroyed, threads may still log during the exit
+        static RdcLogger* logger = new RdcLogger();
+        return *logger;
+    }
+
+    bool should_log(uint32_t severity) {
+        return log_level_ >= severity;
+    }
 
-     static RdcLogger& getLogger() {
-         static RdcLogger logger(std::cout);
-         return logger;
-     }
+    //!< The stream to format the message into, nullptr if the record is
+    //!< rate limited or the ring of the thread is full. commit() must
+    //!< follow a non null stream.
+    std::ostream* begin(uint32_t severity, RdcLogSite* site);
+    void commit();
 
-     bool should_log(uint32_t severity) {
-         return log_level_ >= severity;
-     }
+    //!< Write out everything logged so far
+    void flush();
 
-     std::ostream& get_ostream() {
-         return os_;
-     }
+ private:
+    enum RdcLogSinkType {
+        RDC_LOG_SINK_STDOUT,
+        RDC_LOG_SINK_STDERR,
+        RDC_LOG_SINK_FILE,
+        RDC_LOG_SINK_JOURNALD
+    };
+
+    RdcLogger();
+    ~RdcLogger();
+    RdcLogRing* acquire_ring();
+    bool admit(RdcLogSite* site, uint64_t now_ms);
+    void writer_loop();
+    void append_message(const RdcLogEntry& entry);
+    void append_line(const RdcLogEntry& entry);
+    void write_out();
+    void send_journal(const RdcLogEntry& entry);
+
+    uint32_t log_level_;
+    uint32_t rate_limit_;
+    RdcLogSinkType sink_type_;
+    std::string sink_path_;
+    int sink_fd_;  //!< Opened by the writer, after rdcd daemonized
+    std::atomic<uint64_t> dropped_;
+
+    std::mutex rings_mutex_;
+    //!< Rings are reused by new threads once their thread exited
+    std::list<std::unique_ptr<RdcLogRing>> rings_;
+    std::thread writer_;
+    bool writer_started_;  //!< writer_ is detached, so not joinable
+
+    std::mutex write_mutex_;  //!< Held while the records are written out
+    std::vector<const RdcLogEntry*> batch_;
+    std::vector<std::pair<RdcLogRing*, uint64_t>> ring_heads_;
+    std::string out_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+};
+
+//!< Formats one RDC_LOG record into the ring of the calling thread
+class RdcLogRecord {
+ public:
+    RdcLogRecord(uint32_t severity, RdcLogSite* site):
+        stream_(RdcLogger::getLogger().begin(severity, site)) {}
+    ~RdcLogRecord() {
+        if (stream_) {
+            RdcLogger::getLogger().commit();
+        }
+    }
 
-     std::string get_log_header(uint32_t severity,
-            const char* file, int line);
+    std::ostream* stream() const { return stream_; }
 
  private:
-     std::ostream& os_;
-     uint32_t log_level_;
+    std::ostream* stream_;
 };
 
 }  // namespace rdc
@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_RDCPERFCOUNTERS_H_
+#define INCLUDE_RDC_LIB_RDCPERFCOUNTERS_H_
+
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+inline uint64_t rdc_perf_elapsed_us(
+        std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+//!< The CPU time the calling thread consumed so far
+inline uint64_t rdc_thread_cpu_ns() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+inline void rdc_perf_metric_init(rdc_perf_metric_t* metric,
+        const char* name, const std::string& label,
+        rdc_perf_metric_type_t type, uint64_t value) {
+    memset(metric, 0, sizeof(*metric));
+    strncpy(metric->name, name, RDC_PERF_NAME_LENGTH - 1);
+    strncpy(metric->label, label.c_str(), RDC_PERF_NAME_LENGTH - 1);
+    metric->type = type;
+    metric->value = value;
+}
+
+//!< Lock free histogram of durations in microseconds, with the power of
+//!< two buckets of rdc_perf_metric_t
+class RdcPerfHistogram {
+ public:
+    RdcPerfHistogram() : count_(0), sum_(0) {
+        for (uint32_t i = 0; i < RDC_PERF_HISTOGRAM_BUCKETS; i++) {
+            buckets_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(uint64_t us) {
+        // Bucket i holds the durations of i significant bits
+        uint32_t bucket = 0;
+        while (bucket < RDC_PERF_HISTOGRAM_BUCKETS - 1 && (us >> bucket)) {
+            bucket++;
+        }
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(us, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    //!< The lower bound of the bucket holding the median, which unlike the
+    //!< mean is not thrown off by a few calls to a hung device
+    uint64_t median() const {
+        uint64_t half = (count() + 1) / 2;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < RDC_PERF_HISTOGRAM_BUCKETS; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= half) {
+                return i == 0 ? 0 : 1ULL << (i - 1);
+            }
+        }
+        return 0;
+    }
+
+    //!< Append the histogram to metrics
+    void snapshot(const char* name, const std::string& label,
+            std::vector<rdc_perf_metric_t>* metrics) const {
+        rdc_perf_metric_t metric;
+        rdc_perf_metric_init(&metric, name, label, RDC_PERF_HISTOGRAM,
+                count());
+        metric.sum = sum();
+        for (uint32_t i = 0; i < RDC_PERF_HISTOGRAM_BUCKETS; i++) {
+            metric.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        metrics->push_back(metric);
+    }
+
+ private:
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> buckets_[RDC_PERF_HISTOGRAM_BUCKETS];
+};
+
+//!< Locks the mutex for its scope like std::lock_guard, and records how
+//!< long it waited when the mutex was contended. Uncontended acquisitions
+//!< are not timed.
+class RdcTimedLockGuard {
+ public:
+    RdcTimedLockGuard(std::mutex* mutex, RdcPerfHistogram* wait)
+        : mutex_(mutex) {
+        if (!mutex_->try_lock()) {
+            auto start = std::chrono::steady_clock::now();
+            mutex_->lock();
+            wait->record(rdc_perf_elapsed_us(start));
+        }
+    }
+    ~RdcTimedLockGuard() { mutex_->unlock(); }
+
+    RdcTimedLockGuard(const RdcTimedLockGuard&) = delete;
+    RdcTimedLockGuard& operator=(const RdcTimedLockGuard&) = delete;
+
+ private:
+    std::mutex* mutex_;
+};
+
+//!< The self-telemetry of the collection and the cache of librdc. It is
+//!< shared by all the handlers of the process, and served both by
+//!< rdc_perf_metrics_get() and as the RDC_FI_RDC_* pseudo-fields.
+class RdcPerfCounters {
+ public:
+    static RdcPerfCounters& get();
+
+    //!< A collection sweep of a lane is done, with how late it started
+    //!< after its first field was due, and how many fields were fetched a
+    //!< whole update period late
+    void record_sweep(uint32_t lane, uint64_t duration_us,
+            uint64_t lateness_us, uint32_t missed_deadlines);
+
+    //!< The time a telemetry module took to fetch one field
+    void record_fetch(uint32_t field_id, uint64_t duration_us);
+
+    //!< How many times the field was fetched, and its median fetch time
+    void fetch_latency(uint32_t field_id, uint64_t* count,
+            uint64_t* median_us) const;
+
+    //!< A GPU did not fetch the fields of a sweep within its timeout
+    void record_gpu_timeout() {
+        gpu_timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    void add_quarantined_gpus(int64_t gpus) {
+        quarantined_gpus_.fetch_add(gpus, std::memory_order_relaxed);
+    }
+
+    //!< Measuring the CPU time of the collection takes two system calls
+    //!< per sweep and GPU, so it is only done for the CPU budget
+    void enable_collection_cpu() {
+        collection_cpu_enabled_.store(true, std::memory_order_relaxed);
+    }
+    bool collection_cpu_enabled() const {
+        return collection_cpu_enabled_.load(std::memory_order_relaxed);
+    }
+    //!< CPU time a collection thread spent on a sweep or a fetch
+    void record_collection_cpu(uint64_t cpu_ns) {
+        collection_cpu_ns_.fetch_add(cpu_ns, std::memory_order_relaxed);
+    }
+    uint64_t collection_cpu_ns() const {
+        return collection_cpu_ns_.load(std::memory_order_relaxed);
+    }
+    //!< The watches the CPU budget updates less often than requested
+    void set_stretched_watches(uint64_t watches) {
+        stretched_watches_.store(watches, std::memory_order_relaxed);
+    }
+
+    //!< Samples and bytes added to, or removed from, the cache
+    void add_cache_usage(int64_t samples, int64_t bytes) {
+        cache_samples_.fetch_add(samples, std::memory_order_relaxed);
+        cache_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    RdcPerfHistogram* cache_lock_wait() { return &cache_lock_wait_; }
+    RdcPerfHistogram* watch_lock_wait() { return &watch_lock_wait_; }
+
+    //!< The value of a RDC_FI_RDC_* pseudo-field
+    rdc_status_t get_field_value(rdc_field_t field_id, int64_t* value) const;
+
+    //!< Append all the metrics but the usage of each cache key, which
+    //!< only the cache manager knows
+    void snapshot(std::vector<rdc_perf_metric_t>* metrics) const;
+
+ private:
+    RdcPerfCounters();
+
+    //!< The fields with a fetch latency histogram
+    static const uint32_t kMaxFieldId = 4096;
+
+    RdcPerfHistogram sweep_duration_;
+    RdcPerfHistogram lane_sweep_duration_[RDC_LANE_COUNT];
+    RdcPerfHistogram lane_lateness_[RDC_LANE_COUNT];
+    std::atomic<uint64_t> last_sweep_us_;
+    std::atomic<uint64_t> missed_deadlines_;
+    //!< Allocated on the first fetch of the field, and never freed as
+    //!< the collection threads may outlive the static destructors
+    std::atomic<RdcPerfHistogram*> fetch_latency_[kMaxFieldId];
+    std::atomic<uint64_t> gpu_timeouts_;
+    std::atomic<int64_t> quarantined_gpus_;
+    std::atomic<bool> collection_cpu_enabled_;
+    std::atomic<uint64_t> collection_cpu_ns_;
+    std::atomic<uint64_t> stretched_watches_;
+    std::atomic<int64_t> cache_samples_;
+    std::atomic<int64_t> cache_bytes_;
+    RdcPerfHistogram cache_lock_wait_;
+    RdcPerfHistogram watch_lock_wait_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_RDCPERFCOUNTERS_H_
@@ -0,0 +1,93 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_RDCSHMLAYOUT_H_
+#define INCLUDE_RDC_LIB_RDCSHMLAYOUT_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcFlatMap.h"
+
+//!< The POSIX shared memory object to publish the latest values in
+#define RDC_SHM_NAME_ENV "RDC_SHM_NAME"
+//!< The number of slots of the segment, rounded up to a power of 2
+#define RDC_SHM_SLOTS_ENV "RDC_SHM_SLOTS"
+
+namespace amd {
+namespace rdc {
+
+//!< Layout of the latest value segment published by rdcd.
+//!<
+//!< The segment is a header followed by a power of 2 number of slots. The
+//!< slots form an open addressing table: a key is probed linearly starting
+//!< at rdc_hash_key(key) & (capacity - 1), and the first empty slot ends
+//!< the search. There is a single writer, which only ever adds keys, so a
+//!< reader can probe without locks.
+//!<
+//!< Each slot is guarded by a seqlock: seq is odd while the writer updates
+//!< the value. A reader copies the value and retries if seq was odd or
+//!< changed meanwhile.
+
+static const uint64_t kRdcShmMagic = 0x3130534d48534452ULL;  // "RDSHMS01"
+static const uint32_t kRdcShmVersion = 1;
+static const uint64_t kRdcShmEmptyKey = ~0ULL;
+static const uint32_t kRdcShmDefaultSlots = 16384;
+
+struct RdcShmHeader {
+    std::atomic<uint64_t> magic;  //!< Set last by the writer
+    uint32_t version;
+    uint32_t capacity;            //!< Number of slots
+    uint32_t slot_size;           //!< sizeof(RdcShmSlot)
+    int32_t writer_pid;
+    std::atomic<uint32_t> num_keys;
+    std::atomic<uint32_t> dropped_keys;  //!< Keys which did not fit
+};
+
+struct alignas(64) RdcShmSlot {
+    std::atomic<uint64_t> key;    //!< rdc_pack_key(), or kRdcShmEmptyKey
+    std::atomic<uint32_t> seq;
+    uint32_t gpu_index;
+    rdc_field_value value;        //!< status is RDC_ST_NOT_FOUND if unwatched
+};
+
+inline size_t rdc_shm_size(uint32_t capacity) {
+    return sizeof(RdcShmHeader) + 64 +
+            static_cast<size_t>(capacity) * sizeof(RdcShmSlot);
+}
+
+//!< The slots start at the first cache line after the header
+inline RdcShmSlot* rdc_shm_slots(void* base) {
+    uintptr_t p = reinterpret_cast<uintptr_t>(base) + sizeof(RdcShmHeader);
+    p = (p + 63) & ~static_cast<uintptr_t>(63);
+    return reinterpret_cast<RdcShmSlot*>(p);
+}
+
+//!< The segment of the rdcd listening on a TCP port
+inline std::string rdc_shm_default_name(const std::string& port) {
+    return "/rdcd-" + port;
+}
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_RDCSHMLAYOUT_H_
@@ -0,0 +1,111 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_RDCTHREADS_H_
+#define INCLUDE_RDC_LIB_RDCTHREADS_H_
+
+#include <sched.h>
+#include <stdint.h>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace amd {
+namespace rdc {
+
+//!< The CPUs of each class of threads, as class=cpus pairs separated by
+//!< semicolons, for example "collect=2-3;rpc=4-7,12;default=0-1". The
+//!< classes are collect, fetch, rpc, export and log; default is for the
+//!< classes not listed. Unset, the threads may run on any CPU.
+#define RDC_THREAD_CPUS_ENV "RDC_THREAD_CPUS"
+//!< The scheduling of each class, as class=nice pairs like
+//!< RDC_THREAD_CPUS, where nice is a nice level or idle for SCHED_IDLE
+#define RDC_THREAD_SCHED_ENV "RDC_THREAD_SCHED"
+//!< Set to 1 to run the threads fetching a GPU on the CPUs of its NUMA
+//!< node, among those of the collect class
+#define RDC_THREAD_NUMA_ENV "RDC_THREAD_NUMA"
+
+enum RdcThreadClass {
+    RDC_THREAD_COLLECT = 0,  //!< The collection lanes and GPU workers
+    RDC_THREAD_FETCH,        //!< The asynchronous fetch of the counters
+    RDC_THREAD_RPC,          //!< The gRPC threads of rdcd
+    RDC_THREAD_EXPORT,       //!< The Prometheus and export sink threads
+    RDC_THREAD_LOG,          //!< The log writer
+    RDC_THREAD_CLASS_COUNT
+};
+
+//!< Names the threads of RDC and places them on the CPUs and at the
+//!< scheduling priority configured for their class, so that they keep
+//!< out of the way of the jobs running on the GPUs.
+class RdcThreads {
+ public:
+    static RdcThreads& get();
+
+    //!< Name the calling thread, of which 15 characters are kept, and
+    //!< place it. A thread fetching a single GPU passes the NUMA node of
+    //!< the GPU, the others -1.
+    void setup(RdcThreadClass thread_class, const char* name,
+            int numa_node = -1);
+
+    //!< setup() the calling thread unless it already is, for the threads
+    //!< which libraries like gRPC create
+    void setup_once(RdcThreadClass thread_class, const char* name);
+
+    bool numa_enabled() const { return numa_; }
+
+    //!< Where the threads which are set up actually are: the CPU each last
+    //!< ran on, the NUMA node of that CPU and how many CPUs it may run on
+    void snapshot(std::vector<rdc_perf_metric_t>* metrics);
+
+    //!< Called when a thread which is set up exits
+    void forget(uint32_t tid);
+
+ private:
+    RdcThreads();
+    void parse(const char* env, bool cpus);
+    int numa_node_of(int cpu) const;
+
+    struct Policy {
+        bool has_cpus;
+        cpu_set_t cpus;
+        bool has_sched;
+        bool idle;   //!< SCHED_IDLE rather than a nice level
+        int nice;
+    };
+    struct Thread {
+        uint32_t tid;
+        RdcThreadClass thread_class;
+        std::string name;
+    };
+
+    Policy policy_[RDC_THREAD_CLASS_COUNT];
+    bool numa_;
+    std::vector<cpu_set_t> node_cpus_;  //!< Indexed by NUMA node
+
+    std::mutex mutex_;
+    std::vector<Thread> threads_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_RDCTHREADS_H_
@@ -0,0 +1,176 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_RDCTRACER_H_
+#define INCLUDE_RDC_LIB_RDCTRACER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include "rdc/rdc.h"
+
+namespace amd {
+namespace rdc {
+
+//!< The number of trace events kept per thread, 0 (default) to not trace
+#define RDC_TRACE_EVENTS_ENV "RDC_TRACE_EVENTS"
+
+//!< A completed scope. The name must outlive the tracer, string literals
+//!< are fine.
+struct RdcTraceEvent {
+    std::atomic<const char*> name;
+    std::atomic<uint32_t> tid;
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint64_t> duration_ns;
+};
+
+//!< The events of one thread. Only the owning thread writes, the oldest
+//!< event is overwritten when the ring is full.
+class RdcTraceRing {
+ public:
+    RdcTraceRing(uint32_t size, uint32_t tid);
+
+    void record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+        uint64_t next = next_.load(std::memory_order_relaxed);
+        RdcTraceEvent& event = events_[next % size_];
+        event.name.store(name, std::memory_order_relaxed);
+        event.tid.store(tid_, std::memory_order_relaxed);
+        event.start_ns.store(start_ns, std::memory_order_relaxed);
+        event.duration_ns.store(end_ns - start_ns,
+                std::memory_order_relaxed);
+        next_.store(next + 1, std::memory_order_release);
+    }
+
+    //!< Called when the thread exits, so that a new thread reuses it
+    void release() { in_use_.store(false, std::memory_order_release); }
+
+ private:
+    friend class RdcTracer;
+    std::unique_ptr<RdcTraceEvent[]> events_;
+    uint32_t size_;
+    std::atomic<uint64_t> next_;
+    uint32_t tid_;
+    std::atomic<bool> in_use_;
+};
+
+//!< Collects timed scopes into per-thread rings, to be dumped as a Chrome
+//!< trace, which chrome://tracing and ui.perfetto.dev both open. Tracing
+//!< costs one relaxed load per scope when it is disabled.
+class RdcTracer {
+ public:
+    static RdcTracer& get();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //!< Record a scope of the calling thread
+    void record(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+    /**
+     *  @brief Render the events of the last milliseconds
+     *
+     *  @param[in] last_ms Only the events which ended that recently
+     *
+     *  @param[in] max_bytes Stop adding events, the oldest first, past that
+     *  size, 0 for no limit
+     *
+     *  @param[out] trace The Chrome trace event JSON
+     */
+    void dump(uint64_t last_ms, size_t max_bytes, std::string* trace);
+
+ private:
+    RdcTracer();
+    RdcTraceRing* acquire_ring();
+
+    std::atomic<bool> enabled_;
+    uint32_t ring_size_;
+    std::mutex mutex_;
+    //!< Rings are reused by new threads once their thread exited
+    std::list<std::unique_ptr<RdcTraceRing>> rings_;
+};
+
+//!< Records its scope when tracing is enabled
+class RdcTraceScope {
+ public:
+    explicit RdcTraceScope(const char* name) : name_(name), start_ns_(0) {
+        if (RdcTracer::get().enabled()) {
+            start_ns_ = RdcTracer::now_ns();
+        }
+    }
+    ~RdcTraceScope() { end(); }
+
+    //!< Record the scope now rather than when it is left
+    void end() {
+        if (start_ns_ != 0) {
+            RdcTracer::get().record(name_, start_ns_, RdcTracer::now_ns());
+            start_ns_ = 0;
+        }
+    }
+
+    //!< Do not record the scope
+    void cancel() { start_ns_ = 0; }
+
+ private:
+    const char* name_;
+    uint64_t start_ns_;
+};
+
+#define RDC_TRACE_CONCAT_(a, b) a##b
+#define RDC_TRACE_CONCAT(a, b) RDC_TRACE_CONCAT_(a, b)
+//!< Trace the enclosing scope under a string literal name
+#define RDC_TRACE_SCOPE(name) amd::rdc::RdcTraceScope \
+    RDC_TRACE_CONCAT(rdc_trace_scope_, __LINE__)(name)
+
+/**
+ *  @brief Copy a trace to the caller provided buffer of rdc_trace_get()
+ *
+ *  @param[inout] size The capacity of buffer on input, the size of the
+ *  trace including its terminating null on output.
+ *
+ *  @retval ::RDC_ST_INSUFF_RESOURCES if buffer cannot hold the trace.
+ */
+inline rdc_status_t rdc_trace_copy(const std::string& trace,
+                char* buffer, uint32_t* size) {
+    if (!size || (*size > 0 && !buffer)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    uint32_t capacity = *size;
+    *size = trace.size() + 1;
+    if (*size > capacity) {
+        return RDC_ST_INSUFF_RESOURCES;
+    }
+    memcpy(buffer, trace.c_str(), trace.size() + 1);
+    return RDC_ST_OK;
+}
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_RDCTRACER_H_
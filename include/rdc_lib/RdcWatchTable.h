@@ -35,6 +35,18 @@ class RdcWatchTable {
  public:
     virtual rdc_status_t rdc_field_update_all() = 0;
 
+    //!< Update the fields of one RdcLane which are due, and tell in
+    //!< next_due when the lane is due again, in milliseconds since epoch.
+    virtual rdc_status_t rdc_field_update_lane(uint32_t lane,
+                uint64_t* next_due) = 0;
+    //!< Wait until next_due, or until the watches change or the lanes are
+    //!< woken up
+    virtual void rdc_field_wait_lane(uint32_t lane, uint64_t next_due) = 0;
+    virtual void rdc_field_wake_lanes() = 0;
+
+    //!< Whether the GPU stopped answering, and its values are stale
+    virtual bool rdc_gpu_quarantined(uint32_t gpu_index) const = 0;
+
     virtual rdc_status_t rdc_job_start_stats(rdc_gpu_group_t group_id,
                 const char job_id[64], uint64_t update_freq,
                 const rdc_gpu_gauges_t& gpu_gauge) = 0;
@@ -48,6 +60,11 @@ class RdcWatchTable {
                 double  max_keep_age, uint32_t max_keep_samples) = 0;
     virtual rdc_status_t rdc_field_unwatch(rdc_gpu_group_t group_id,
                 rdc_field_grp_t field_group_id) = 0;
+    virtual rdc_status_t rdc_field_watch_set_limits(rdc_gpu_group_t group_id,
+                rdc_field_grp_t field_group_id, uint32_t priority,
+                uint64_t max_update_freq) = 0;
+    virtual rdc_status_t rdc_field_get_watch_rates(
+                std::vector<rdc_watch_rate_t>* rates) = 0;
 
     virtual ~RdcWatchTable() {}
 };
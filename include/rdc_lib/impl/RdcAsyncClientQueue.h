@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCASYNCCLIENTQUEUE_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCASYNCCLIENTQUEUE_H_
+
+#include <grpcpp/grpcpp.h>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+//!< Threads completing the asynchronous requests of a process, 2 by default
+#define RDC_CLIENT_CQ_THREADS_ENV "RDC_CLIENT_CQ_THREADS"
+
+namespace amd {
+namespace rdc {
+
+//!< An asynchronous request in flight. Its address is the tag of the
+//!< request on the completion queue.
+class RdcAsyncClientCall {
+ public:
+    virtual ~RdcAsyncClientCall() {}
+
+    //!< Called on a queue thread when the reply, an error or the deadline
+    //!< arrives. The call is deleted afterwards.
+    virtual void complete() = 0;
+
+    ::grpc::ClientContext context;
+    ::grpc::Status status;
+};
+
+//!< The completion queue shared by the connections of a process, and the
+//!< threads completing its requests. It lives as long as a connection
+//!< holds it.
+class RdcAsyncClientQueue {
+ public:
+    static std::shared_ptr<RdcAsyncClientQueue> get();
+
+    ~RdcAsyncClientQueue();
+
+    ::grpc::CompletionQueue* cq() { return &cq_; }
+
+ private:
+    explicit RdcAsyncClientQueue(uint32_t num_threads);
+
+    void poll();
+
+    ::grpc::CompletionQueue cq_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCASYNCCLIENTQUEUE_H_
@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include <vector>
 #include <map>
 #include "rdc_lib/RdcCacheManager.h"
+#include "rdc_lib/RdcFlatMap.h"
+#include "rdc_lib/RdcPerfCounters.h"
 #include "rdc_lib/rdc_common.h"
 #include "rdc/rdc.h"
 
@@ -40,7 +42,7 @@ struct RdcCacheEntry {
     int64_t value;
 };
 
-typedef std::map<RdcFieldKey, std::vector<RdcCacheEntry>> RdcCacheSamples;
+typedef RdcFlatMap<RdcFieldKey, std::vector<RdcCacheEntry>> RdcCacheSamples;
 
 struct FieldSummaryStats {
     int64_t max_value;
@@ -79,23 +81,36 @@ typedef std::map<std::string, RdcJobStatsCacheEntry> RdcJobStatsCache;
 
 class RdcCacheManagerImpl: public RdcCacheManager {
  public:
+    RdcCacheManagerImpl();
+    ~RdcCacheManagerImpl();
+
     rdc_status_t rdc_field_get_latest_value(uint32_t gpu_index,
         rdc_field_t field, rdc_field_value* value) override;
     rdc_status_t rdc_field_get_value_since(uint32_t gpu_index,
         rdc_field_t field, uint64_t since_time_stamp,
           uint64_t *next_since_time_stamp, rdc_field_value* value) override;
+    rdc_status_t rdc_field_get_values_since(uint32_t gpu_index,
+        rdc_field_t field, uint64_t since_time_stamp,
+          uint64_t *next_since_time_stamp, rdc_field_value* values,
+          uint32_t* count) override;
     rdc_status_t rdc_update_cache(uint32_t gpu_index,
                 const rdc_field_value& value) override;
     rdc_status_t evict_cache(uint32_t gpu_index, rdc_field_t field_id,
                 uint64_t max_keep_samples, double  max_keep_age) override;
+    rdc_status_t reserve_cache(uint32_t gpu_index, rdc_field_t field_id,
+                uint64_t num_samples) override;
     std::string  get_cache_stats()  override;
+    void get_cache_usage(std::vector<rdc_perf_metric_t>* metrics) override;
 
     rdc_status_t rdc_job_get_stats(const char job_id[64],
         const rdc_gpu_gauges_t& gpu_gauges,
         rdc_job_info_t* p_job_info) override;
+    rdc_status_t rdc_job_get_moments(const char job_id[64],
+        const rdc_gpu_gauges_t& gpu_gauges,
+        std::vector<rdc_job_gpu_moments_t>* moments) override;
     rdc_status_t rdc_job_start_stats(const char job_id[64],
-        const rdc_group_info_t& group,
-        const rdc_field_group_info_t& finfo,
+        const RdcGpuGroup& group,
+        const RdcFieldGroup& finfo,
         const rdc_gpu_gauges_t& gpu_gauges) override;
     rdc_status_t rdc_job_stop_stats(const char job_id[64],
                     const rdc_gpu_gauges_t& gpu_gauge) override;
@@ -109,11 +124,15 @@ class RdcCacheManagerImpl: public RdcCacheManager {
     void set_summary(const FieldSummaryStats & stats,
         rdc_stats_summary_t& gpu, rdc_stats_summary_t& summary, // NOLINT
         unsigned int adjuster);
+    uint64_t get_ecc_count(uint32_t gpu_index, rdc_field_t field_id,
+        uint64_t ecc_init, bool is_job_stopped,
+        const rdc_gpu_gauges_t& gpu_gauges) const;
     void set_average_summary(
         rdc_stats_summary_t& summary, uint32_t num_gpus);  // NOLINT
     RdcCacheSamples cache_samples_;
     RdcJobStatsCache cache_jobs_;
     std::mutex cache_mutex_;
+    RdcPerfCounters& perf_;
 };
 
 }  // namespace rdc
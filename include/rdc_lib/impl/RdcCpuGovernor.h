@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCCPUGOVERNOR_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCCPUGOVERNOR_H_
+
+#include <stdint.h>
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <vector>
+
+//!< The share of one core, in percent, the collection may use, for example
+//!< 2.5. Unset or 0, the watches are always updated as requested.
+#define RDC_CPU_BUDGET_PERCENT_ENV "RDC_CPU_BUDGET_PERCENT"
+
+namespace amd {
+namespace rdc {
+
+//!< A watch as the governor sees it
+struct RdcGovernedWatch {
+    uint32_t priority;
+    uint64_t requested_freq;   //!< In usec, as passed to rdc_field_watch()
+    uint64_t max_update_freq;  //!< The longest period allowed, in usec
+};
+
+//!< Keeps the CPU time of the collection within a budget. When the sweeps
+//!< take more than the budget, the update periods of the watches of the
+//!< lowest priority are doubled, up to their max_update_freq. When they
+//!< take less than half of it, so that doubling a rate back still fits,
+//!< the highest priority stretched is restored one step. Not thread safe,
+//!< the watch table calls it under its lock.
+class RdcCpuGovernor {
+ public:
+    explicit RdcCpuGovernor(double budget_percent);
+
+    //!< Compare the CPU time of the collection so far with the budget,
+    //!< once a second at most. True when the effective periods changed.
+    bool update(uint64_t cpu_ns, const std::vector<RdcGovernedWatch>& watches);
+
+    //!< The period the watch is to be updated at, in usec
+    uint64_t effective_freq(const RdcGovernedWatch& watch) const;
+
+ private:
+    uint64_t budget_ppm_;  //!< Parts per million of one core
+    bool started_;
+    uint64_t last_cpu_ns_;
+    std::chrono::steady_clock::time_point last_time_;
+    //!< How many times the periods of each priority are doubled
+    std::map<uint32_t, uint32_t> stretch_;
+    //!< Over budget with nothing left to stretch, logged once
+    bool exhausted_;
+};
+
+typedef std::unique_ptr<RdcCpuGovernor> RdcCpuGovernorPtr;
+
+//!< The governor for RDC_CPU_BUDGET_PERCENT, or nullptr if not set
+RdcCpuGovernorPtr rdc_cpu_governor_from_env();
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCCPUGOVERNOR_H_
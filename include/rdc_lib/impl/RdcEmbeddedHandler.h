@@ -23,6 +23,7 @@ THE SOFTWARE.
 #define INCLUDE_RDC_LIB_IMPL_RDCEMBEDDEDHANDLER_H_
 
 #include <future>  // NOLINT(build/c++11)
+#include <vector>
 #include "rdc_lib/RdcHandler.h"
 #include "rdc_lib/RdcGroupSettings.h"
 #include "rdc_lib/RdcMetricFetcher.h"
@@ -41,6 +42,8 @@ class RdcEmbeddedHandler: public RdcHandler {
                         const char job_id[64], uint64_t update_freq) override;
     rdc_status_t rdc_job_get_stats(const char jobId[64],
                 rdc_job_info_t* p_job_info) override;
+    rdc_status_t rdc_job_get_moments(const char job_id[64],
+                rdc_job_gpu_moments_t* gpus, uint32_t* count) override;
     rdc_status_t rdc_job_stop_stats(const char job_id[64]) override;
     rdc_status_t rdc_job_remove(const char job_id[64]) override;
     rdc_status_t rdc_job_remove_all() override;
@@ -50,6 +53,8 @@ class RdcEmbeddedHandler: public RdcHandler {
         uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count) override;
     rdc_status_t rdc_device_get_attributes(uint32_t gpu_index,
         rdc_device_attributes_t* p_rdc_attr) override;
+    rdc_status_t rdc_device_get_all_ext(uint32_t* gpu_index_list,
+        uint32_t* count) override;
 
     // Group API
     rdc_status_t rdc_group_gpu_create(rdc_group_type_t type,
@@ -69,6 +74,13 @@ class RdcEmbeddedHandler: public RdcHandler {
             rdc_gpu_group_t group_id_list[], uint32_t* count) override;
     rdc_status_t rdc_group_field_get_all_ids(
             rdc_field_grp_t field_group_id_list[], uint32_t* count) override;
+    rdc_status_t rdc_group_gpu_get_info_ext(
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) override;
+    rdc_status_t rdc_group_get_all_ids_ext(
+            rdc_gpu_group_t* group_id_list, uint32_t* count) override;
+    rdc_status_t rdc_group_field_get_all_ids_ext(
+            rdc_field_grp_t* field_group_id_list, uint32_t* count) override;
     rdc_status_t rdc_group_gpu_destroy(
         rdc_gpu_group_t p_rdc_group_id) override;
     rdc_status_t rdc_group_field_destroy(
@@ -83,17 +95,33 @@ class RdcEmbeddedHandler: public RdcHandler {
     rdc_status_t rdc_field_get_value_since(uint32_t gpu_index,
         rdc_field_t field, uint64_t since_time_stamp,
         uint64_t *next_since_time_stamp, rdc_field_value* value) override;
+    rdc_status_t rdc_field_get_values_since(uint32_t gpu_index,
+        rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) override;
     rdc_status_t rdc_field_unwatch(rdc_gpu_group_t group_id,
         rdc_field_grp_t field_group_id) override;
+    rdc_status_t rdc_field_watch_set_limits(rdc_gpu_group_t group_id,
+        rdc_field_grp_t field_group_id, uint32_t priority,
+        uint64_t max_update_freq) override;
+    rdc_status_t rdc_field_get_watch_rates(rdc_watch_rate_t* rates,
+        uint32_t* count) override;
 
     // Control API
     rdc_status_t rdc_field_update_all(uint32_t wait_for_update) override;
 
+    // Self-telemetry API
+    rdc_status_t rdc_perf_metrics_get(rdc_perf_metric_t* metrics,
+        uint32_t* count) override;
+    rdc_status_t rdc_trace_get(uint32_t last_seconds, char* buffer,
+        uint32_t* size) override;
+
     explicit RdcEmbeddedHandler(rdc_operation_mode_t op_mode);
     ~RdcEmbeddedHandler();
 
  private:
     rdc_status_t get_gpu_gauges(rdc_gpu_gauges_t* gpu_gauges);
+    rdc_status_t get_all_devices(std::vector<uint32_t>* gpu_index_list);
     RdcGroupSettingsPtr group_settings_;
     RdcCacheManagerPtr cache_mgr_;
     RdcMetricFetcherPtr metric_fetcher_;
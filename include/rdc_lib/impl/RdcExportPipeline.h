@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCEXPORTPIPELINE_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCEXPORTPIPELINE_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc/rdc.h"
+
+//!< Comma separated sinks to push the fetched values to:
+//!<   influx-udp://host:port    InfluxDB line protocol over UDP
+//!<   influx-tcp://host:port    InfluxDB line protocol over TCP
+//!<   statsd://host:port        StatsD gauges over UDP
+//!<   textfile:///path/file     OpenMetrics text file, replaced atomically
+#define RDC_EXPORT_ENV "RDC_EXPORT"
+//!< Values the queue holds before dropping, rounded up to a power of 2
+#define RDC_EXPORT_QUEUE_ENV "RDC_EXPORT_QUEUE"
+//!< How often in milliseconds the queued values are written to the sinks
+#define RDC_EXPORT_INTERVAL_ENV "RDC_EXPORT_INTERVAL_MS"
+
+namespace amd {
+namespace rdc {
+
+//!< A numeric value fetched by a sweep
+struct RdcExportSample {
+    uint32_t gpu_index;
+    rdc_field_t field_id;
+    rdc_field_type_t type;   //!< INTEGER or DOUBLE
+    uint64_t ts;             //!< msec since 1970, as fetched
+    union {
+        int64_t l_int;
+        double dbl;
+    } value;
+};
+
+//!< A bounded queue with a single producer and a single consumer, and no
+//!< locks. The producer never waits: a full queue rejects the value.
+class RdcExportQueue {
+ public:
+    explicit RdcExportQueue(uint32_t capacity);
+
+    bool push(const RdcExportSample& sample);
+    bool pop(RdcExportSample* sample);
+
+ private:
+    std::vector<RdcExportSample> slots_;
+    uint64_t mask_;
+    //!< Apart on their own cache lines, the heap only guarantees 16 bytes
+    //!< alignment in C++11
+    char pad0_[64];
+    std::atomic<uint64_t> head_;   //!< Next to pop
+    char pad1_[64];
+    std::atomic<uint64_t> tail_;   //!< Next to push
+    char pad2_[64];
+};
+
+//!< Where the exporter writes the values to
+class RdcExportSink {
+ public:
+    //!< Write a batch, in the order the values were fetched
+    virtual rdc_status_t write(const std::vector<RdcExportSample>& batch) = 0;
+    virtual const std::string& name() const = 0;
+    virtual ~RdcExportSink() {}
+};
+
+typedef std::unique_ptr<RdcExportSink> RdcExportSinkPtr;
+
+//!< Create a sink from its URL, see RDC_EXPORT_ENV, or nullptr
+RdcExportSinkPtr rdc_export_sink_create(const std::string& url);
+
+//!< Pushes the fetched values to the sinks from its own thread, so that a
+//!< slow or unreachable sink never delays the sweeps. The sweep only adds
+//!< the values to a bounded queue and counts those it has no room for.
+//!<
+//!< There must be a single producer, the watch table calls it under its
+//!< watch mutex.
+class RdcExportPipeline {
+ public:
+    RdcExportPipeline(uint32_t queue_size, uint32_t interval_ms);
+    ~RdcExportPipeline();
+
+    void add_sink(RdcExportSinkPtr sink);
+    void start();
+
+    //!< Queue a fetched value; failed and string values are not exported
+    void push(uint32_t gpu_index, const rdc_field_value& value);
+
+    uint64_t num_queued() const { return num_queued_; }
+    uint64_t num_dropped() const { return num_dropped_; }
+    uint64_t num_exported() const { return num_exported_; }
+    uint64_t num_failed() const { return num_failed_; }
+
+ private:
+    void run();
+    void flush(std::vector<RdcExportSample>* batch);
+
+    RdcExportQueue queue_;
+    uint32_t interval_ms_;
+    std::vector<RdcExportSinkPtr> sinks_;
+
+    std::atomic<uint64_t> num_queued_;
+    std::atomic<uint64_t> num_dropped_;     //!< The queue was full
+    std::atomic<uint64_t> num_exported_;    //!< Values written, per sink
+    std::atomic<uint64_t> num_failed_;      //!< Values a sink failed on
+    uint64_t num_dropped_logged_;
+
+    std::atomic<bool> stop_;
+    std::thread thread_;
+};
+
+typedef std::unique_ptr<RdcExportPipeline> RdcExportPipelinePtr;
+
+//!< Create the pipeline configured by RDC_EXPORT, or nullptr
+RdcExportPipelinePtr rdc_export_pipeline_from_env();
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCEXPORTPIPELINE_H_
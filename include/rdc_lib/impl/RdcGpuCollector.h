@@ -0,0 +1,161 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCGPUCOLLECTOR_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCGPUCOLLECTOR_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcTelemetry.h"
+#include "rdc_lib/rdc_common.h"
+
+//!< How long in milliseconds a GPU may take to fetch the fields of a sweep
+//!< before it is quarantined. Unset or 0 fetches all the GPUs from the
+//!< lane threads, without a watchdog: the workers cost a thread per GPU
+//!< and lane, and a handoff per GPU and sweep.
+#define RDC_GPU_TIMEOUT_MS_ENV "RDC_GPU_TIMEOUT_MS"
+
+namespace amd {
+namespace rdc {
+
+//!< Fetches the fields of each GPU of a lane from a worker thread of its
+//!< own, so that a GPU whose calls hang only delays its own values.
+//!<
+//!< A GPU whose fetch takes longer than the timeout is quarantined: its
+//!< fields are no longer fetched but reported with RDC_ST_TIMEOUT, and it
+//!< is retried once its hung call has returned and a backoff, doubling
+//!< from 1 second up to 1 minute, has passed. The first retry answering
+//!< within the timeout lifts the quarantine.
+class RdcGpuCollector {
+ public:
+    //!< The fetched values are passed to the callback from the workers
+    RdcGpuCollector(uint32_t timeout_ms, rdc_field_value_f callback,
+            void* user_data);
+    //!< Joins the idle workers, and leaves those stuck in a call behind
+    ~RdcGpuCollector();
+
+    //!< Hand the fields of a lane to the workers of their GPU. The fields
+    //!< of the quarantined GPUs are added to stale instead, and those of
+    //!< a GPU still fetching the previous sweep are skipped.
+    void dispatch(uint32_t lane, const RdcTelemetryPtr& telemetry,
+            const std::vector<rdc_gpu_field_t>& fields,
+            std::vector<rdc_gpu_field_t>* stale);
+
+    //!< Wait until the fields dispatched to the lane are fetched, or at
+    //!< most until the time in milliseconds since epoch, then quarantine
+    //!< the GPUs whose fetch is overdue
+    void wait(uint32_t lane, uint64_t until);
+
+    //!< Whether the values of the GPU are stale
+    bool is_quarantined(uint32_t gpu_index) const {
+        return state_->num_quarantined.load(std::memory_order_relaxed) != 0
+            && gpu_index < RDC_MAX_NUM_DEVICES_EXT &&
+            state_->quarantined[gpu_index].load(std::memory_order_relaxed);
+    }
+
+    uint32_t timeout_ms() const { return state_->timeout_ms; }
+
+ private:
+    enum Verdict {
+        FETCH,   //!< Handed to the worker
+        STALE,   //!< The GPU is quarantined
+        SKIP     //!< The worker is still busy with a previous sweep
+    };
+
+    //!< Fetches the fields of one GPU for one lane
+    struct Worker {
+        uint32_t lane;
+        uint32_t gpu_index;
+        std::condition_variable cv;
+        std::vector<rdc_gpu_field_t> fields;
+        RdcTelemetryPtr telemetry;
+        bool busy;           //!< Handed fields it has not fetched yet
+        bool overdue;        //!< Its fetch exceeded the timeout
+        bool retry;          //!< Its fetch is the retry of a quarantine
+        uint64_t start;      //!< When it was handed the fields, steady ms
+        uint64_t sweep;      //!< The sweep of the lane it was handed
+        uint64_t visit;      //!< The last sweep of the lane it was part of
+        Verdict verdict;     //!< What that sweep does with its fields
+        std::thread thread;
+    };
+
+    struct GpuHealth {
+        bool quarantined;
+        uint64_t retry_time;  //!< Steady ms
+        uint64_t backoff_ms;
+    };
+
+    //!< Shared with the workers, which may outlive the collector while
+    //!< they are stuck in a call
+    struct State {
+        uint32_t timeout_ms;
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        bool stop;
+        std::vector<std::unique_ptr<Worker>> workers[RDC_LANE_COUNT];
+        std::vector<GpuHealth> health;
+        uint64_t sweep[RDC_LANE_COUNT];
+        uint32_t pending[RDC_LANE_COUNT];  //!< Workers busy with the sweep
+        //!< The workers handed the sweep of each lane, kept between sweeps
+        //!< so that dispatching does not allocate
+        std::vector<Worker*> handed[RDC_LANE_COUNT];
+        std::atomic<uint32_t> num_quarantined;
+        std::atomic<bool> quarantined[RDC_MAX_NUM_DEVICES_EXT];
+
+        //!< Held while the values are passed on, so that none are after
+        //!< the collector is gone
+        std::mutex deliver_mutex;
+        bool closed;
+        rdc_field_value_f callback;
+        void* user_data;
+    };
+
+    static void run(std::shared_ptr<State> state, Worker* worker);
+    static rdc_status_t deliver(rdc_gpu_field_value_t* values,
+            uint32_t num_values, void* user_data);
+
+    //!< Called with the state mutex held
+    static GpuHealth& get_health(State* state, uint32_t gpu_index);
+    static void quarantine(State* state, Worker* worker, uint64_t now);
+    static void lift_quarantine(State* state, uint32_t gpu_index);
+    Worker* get_worker(uint32_t lane, uint32_t gpu_index);
+    void check_overdue(uint32_t lane, uint64_t now);
+
+    std::shared_ptr<State> state_;
+};
+
+typedef std::unique_ptr<RdcGpuCollector> RdcGpuCollectorPtr;
+
+//!< Create the collector if RDC_GPU_TIMEOUT_MS is set, or nullptr to
+//!< fetch from the lane threads
+RdcGpuCollectorPtr rdc_gpu_collector_from_env(rdc_field_value_f callback,
+        void* user_data);
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCGPUCOLLECTOR_H_
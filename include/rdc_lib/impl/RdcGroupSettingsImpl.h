@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <map>
 #include <mutex> // NOLINT
 #include <string>
+#include <vector>
 #include "rdc_lib/RdcGroupSettings.h"
 
 namespace amd {
@@ -43,6 +44,10 @@ class RdcGroupSettingsImpl: public RdcGroupSettings {
         rdc_group_info_t* p_rdc_group_info)  override;
       rdc_status_t rdc_group_get_all_ids(
         rdc_gpu_group_t group_id_list[], uint32_t* count) override;
+      rdc_status_t rdc_group_gpu_get_snapshot(
+        rdc_gpu_group_t group_id, RdcGpuGroupSnapshot* snapshot) override;
+      rdc_status_t rdc_group_get_all_ids(
+        std::vector<rdc_gpu_group_t>* group_ids) override;
 
       rdc_status_t rdc_group_field_create(uint32_t num_field_ids,
           rdc_field_t* field_ids, const char* field_group_name,
@@ -54,12 +59,18 @@ class RdcGroupSettingsImpl: public RdcGroupSettings {
         rdc_field_group_info_t* field_group_info) override;
       rdc_status_t rdc_group_field_get_all_ids(
         rdc_field_grp_t field_group_id_list[], uint32_t* count) override;
+      rdc_status_t rdc_group_field_get_snapshot(
+        rdc_field_grp_t field_group_id,
+        RdcFieldGroupSnapshot* snapshot) override;
+      rdc_status_t rdc_group_field_get_all_ids(
+        std::vector<rdc_field_grp_t>* field_group_ids) override;
 
       RdcGroupSettingsImpl();
 
  private:
-    std::map<rdc_gpu_group_t, rdc_group_info_t> gpu_group_;
-    std::map<rdc_field_grp_t, rdc_field_group_info_t> field_group_;
+    //!< Groups are immutable once published; updates swap in a new copy
+    std::map<rdc_gpu_group_t, RdcGpuGroupSnapshot> gpu_group_;
+    std::map<rdc_field_grp_t, RdcFieldGroupSnapshot> field_group_;
     uint32_t cur_group_id_ = 1;
     uint32_t cur_field_group_id_ = 0;
     std::mutex group_mutex_;
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include <map>
 #include <queue>
 #include "rdc_lib/RdcMetricFetcher.h"
+#include "rdc_lib/RdcFlatMap.h"
 #include "rdc_lib/rdc_common.h"
 #include "rocm_smi/rocm_smi.h"
 
@@ -76,6 +77,7 @@ class RdcMetricFetcherImpl: public RdcMetricFetcher {
     rdc_status_t delete_rsmi_handle(RdcFieldKey fk) override;
 
  private:
+    //!< Called with the rsmi_mutex_ held
     std::shared_ptr<FieldRSMIData> get_rsmi_data(RdcFieldKey key);
 
     uint64_t now();
@@ -88,8 +90,9 @@ class RdcMetricFetcherImpl: public RdcMetricFetcher {
     void get_pcie_throughput(const RdcFieldKey& key);
 
     //!< Async metric retreive
-    std::map<RdcFieldKey, MetricValue> async_metrics_;
-    std::map<RdcFieldKey, std::shared_ptr<FieldRSMIData>> rsmi_data_;
+    RdcFlatMap<RdcFieldKey, MetricValue> async_metrics_;
+    RdcFlatMap<RdcFieldKey, std::shared_ptr<FieldRSMIData>> rsmi_data_;
+    std::mutex rsmi_mutex_;  //!< Guards the rsmi_data_ and its counters
     std::queue<MetricTask> updated_tasks_;
     std::mutex task_mutex_;
     std::future<void> updater_;  // keep the future of updater
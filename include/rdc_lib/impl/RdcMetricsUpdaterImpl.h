@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <memory>
 #include "rdc_lib/RdcMetricsUpdater.h"
 #include "rdc_lib/RdcWatchTable.h"
+#include "rdc_lib/rdc_common.h"
 
 namespace amd {
 namespace rdc {
@@ -39,8 +40,8 @@ class RdcMetricsUpdaterImpl: public RdcMetricsUpdater {
  private:
      RdcWatchTablePtr watch_table_;
      std::atomic<bool> started_;
-     std::future<void> updater_;  // keep the future of updater
-     const uint32_t _check_frequency;  // Check frequency in milliseconds
+     std::future<void> updater_[RDC_LANE_COUNT];  // one updater per lane
+     const uint32_t _check_frequency;  // Least sleep between lane sweeps
 };
 
 }  // namespace rdc
@@ -0,0 +1,84 @@
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCPROMETHEUSEXPORTER_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCPROMETHEUSEXPORTER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include "rdc/rdc.h"
+
+//!< [address:]port to serve the latest values in the Prometheus format on
+#define RDC_PROMETHEUS_LISTEN_ENV "RDC_PROMETHEUS_LISTEN"
+
+namespace amd {
+namespace rdc {
+
+//!< Serves the latest value of every watched field over HTTP, in the
+//!< Prometheus text exposition format, at /metrics.
+//!<
+//!< The text is rendered once per sweep into one of two buffers, and the
+//!< buffers are swapped when it is complete. A scrape only sends the
+//!< current buffer: it neither formats nor touches the cache. A buffer
+//!< still being sent is not rendered into; the sweep skips the rendering
+//!< and the next sweep renders instead.
+//!<
+//!< There must be a single writer, the watch table calls it under its
+//!< watch mutex.
+class RdcPrometheusExporter {
+ public:
+    RdcPrometheusExporter();
+    ~RdcPrometheusExporter();
+
+    //!< Listen on [address:]port and start serving
+    rdc_status_t listen(const std::string& address);
+
+    //!< Store a fetched value; failed values are not exported
+    void update(uint32_t gpu_index, const rdc_field_value& value);
+
+    //!< Stop exporting a field which is no longer watched
+    void invalidate(uint32_t gpu_index, rdc_field_t field_id);
+
+    //!< Render the values stored since the last sweep
+    void render();
+
+ private:
+    struct Metric {
+        std::string line_prefix;   //!< name{gpu_index="N"}
+        rdc_field_type_t type;
+        int64_t l_int;
+        double dbl;
+        bool valid;
+    };
+
+    struct Buffer {
+        std::string text;
+        std::atomic<uint32_t> readers;
+    };
+
+    void serve();
+    void send_metrics(int fd);
+
+    //!< <field_id, gpu_index>, to render each metric family at once
+    std::map<std::pair<uint32_t, uint32_t>, Metric> metrics_;
+    std::map<uint32_t, std::string> families_;  //!< HELP and TYPE lines
+    bool dirty_;
+
+    Buffer buffers_[2];
+    std::atomic<uint32_t> front_;
+
+    int listen_fd_;
+    std::atomic<bool> stop_;
+    std::thread server_thread_;
+};
+
+typedef std::unique_ptr<RdcPrometheusExporter> RdcPrometheusExporterPtr;
+
+//!< Create the exporter configured by RDC_PROMETHEUS_LISTEN, or nullptr
+RdcPrometheusExporterPtr rdc_prometheus_exporter_from_env();
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCPROMETHEUSEXPORTER_H_
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <list>
 #include <vector>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <algorithm>
 #include <string>
 #include "rdc_lib/RdcLibraryLoader.h"
@@ -58,6 +59,9 @@ class RdcRasLib: public RdcTelemetry {
     rdc_status_t (*fields_value_get_)(rdc_gpu_field_t*,
                 uint32_t, rdc_field_value_f, void*);
     rdc_status_t (*fields_query_)(uint32_t[MAX_NUM_FIELDS], uint32_t*);
+    //!< The RAS library is not known to be thread safe, and the lanes of
+    //!< the collection fetch concurrently
+    std::mutex fetch_mutex_;
 };
 typedef std::shared_ptr<RdcRasLib> RdcRasLibPtr;
 
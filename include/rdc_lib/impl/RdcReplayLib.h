@@ -0,0 +1,91 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef RDC_LIB_IMPL_RDCREPLAYLIB_H_
+#define RDC_LIB_IMPL_RDCREPLAYLIB_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>  // NOLINT
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcFlatMap.h"
+#include "rdc_lib/RdcTelemetry.h"
+#include "rdc_lib/impl/RdcTelemetryCapture.h"
+
+namespace amd {
+namespace rdc {
+
+//!< Telemetry module which plays back a capture file. The sweeps are
+//!< replayed at their original pace multiplied by the speed, and the file
+//!< is looped when the end is reached.
+class RdcReplayLib : public RdcTelemetry {
+ public:
+    // get support field ids
+    rdc_status_t rdc_telemetry_fields_query(
+        uint32_t field_ids[MAX_NUM_FIELDS], uint32_t* field_count) override;
+
+    // Fetch
+    rdc_status_t rdc_telemetry_fields_value_get(rdc_gpu_field_t* fields,
+            uint32_t fields_count, rdc_field_value_f callback,
+            void*  user_data) override;
+
+    rdc_status_t rdc_telemetry_fields_watch(rdc_gpu_field_t* fields,
+            uint32_t fields_count) override;
+    rdc_status_t rdc_telemetry_fields_unwatch(rdc_gpu_field_t* fields,
+            uint32_t fields_count) override;
+
+    RdcReplayLib(const std::string& file_name, double speed);
+
+    uint32_t get_num_sweeps() const;
+
+ private:
+    struct ReplaySweep {
+        uint64_t ts;
+        uint32_t count;
+        size_t offset;      //!< Offset of the first value in data_
+    };
+
+    bool load(const std::string& file_name);
+    void apply_sweep(const ReplaySweep& sweep);
+    void advance(uint64_t now);
+    static uint64_t now();
+
+    double speed_;
+    std::vector<char> data_;
+    std::vector<ReplaySweep> sweeps_;
+    std::set<uint32_t> field_ids_;
+
+    //!< The replay position and the latest value of each field
+    size_t cursor_;
+    uint64_t replay_start_;
+    RdcFlatMap<RdcFieldKey, rdc_field_value> latest_values_;
+    std::mutex replay_mutex_;
+};
+
+typedef std::shared_ptr<RdcReplayLib> RdcReplayLibPtr;
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // RDC_LIB_IMPL_RDCREPLAYLIB_H_
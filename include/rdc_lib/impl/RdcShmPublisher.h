@@ -0,0 +1,73 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCSHMPUBLISHER_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCSHMPUBLISHER_H_
+
+#include <memory>
+#include <string>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcShmLayout.h"
+
+namespace amd {
+namespace rdc {
+
+//!< Publishes the latest value of every watched field into a read only
+//!< POSIX shared memory segment, see RdcShmLayout.h. Local readers map it
+//!< to read the values without calling rdcd.
+//!<
+//!< There must be a single writer, the watch table calls it under its
+//!< watch mutex.
+class RdcShmPublisher {
+ public:
+    RdcShmPublisher();
+    ~RdcShmPublisher();
+
+    //!< Create the segment, replacing any segment left with the same name
+    rdc_status_t open(const std::string& name, uint32_t capacity);
+
+    //!< Store a fetched value, successful or not
+    void publish(uint32_t gpu_index, const rdc_field_value& value);
+
+    //!< Mark a field which is no longer watched
+    void invalidate(uint32_t gpu_index, rdc_field_t field_id);
+
+ private:
+    RdcShmSlot* find_slot(uint64_t key, bool claim);
+    void write_slot(RdcShmSlot* slot, const rdc_field_value& value);
+
+    std::string name_;
+    void* base_;
+    size_t size_;
+    RdcShmHeader* header_;
+    RdcShmSlot* slots_;
+    uint32_t max_keys_;
+};
+
+typedef std::unique_ptr<RdcShmPublisher> RdcShmPublisherPtr;
+
+//!< Create the publisher configured by RDC_SHM_NAME, or nullptr
+RdcShmPublisherPtr rdc_shm_publisher_from_env();
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCSHMPUBLISHER_H_
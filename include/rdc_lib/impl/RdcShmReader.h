@@ -0,0 +1,85 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef INCLUDE_RDC_LIB_IMPL_RDCSHMREADER_H_
+#define INCLUDE_RDC_LIB_IMPL_RDCSHMREADER_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcShmLayout.h"
+
+namespace amd {
+namespace rdc {
+
+//!< Maps the latest value segment of a local rdcd read only, and reads
+//!< from it without locks or calls to rdcd. See RdcShmLayout.h.
+//!<
+//!< Every kShmWriterCheckMs, a read also checks that the rdcd which
+//!< created the segment still runs. Once it is gone, the reads fail until
+//!< the segment of a restarted rdcd could be mapped instead.
+class RdcShmReader {
+ public:
+    RdcShmReader();
+    ~RdcShmReader();
+
+    //!< Map the segment. Fails if it does not exist, has another layout,
+    //!< or the rdcd which created it is gone.
+    rdc_status_t open(const std::string& name);
+
+    //!< Read the latest value of a field.
+    //!< @retval ::RDC_ST_NOT_FOUND if the field is not published, its
+    //!< latest fetch failed, or rdcd is gone; value->status has the error
+    //!< of the fetch.
+    rdc_status_t read(uint32_t gpu_index, rdc_field_t field_id,
+                      rdc_field_value* value);
+
+ private:
+    struct Segment {
+        void* base;
+        size_t size;
+        const RdcShmHeader* header;
+        const RdcShmSlot* slots;
+    };
+
+    static Segment* map_segment(const std::string& name);
+    static bool writer_alive(const RdcShmHeader* header);
+    static void unmap_segment(Segment* segment);
+
+    //!< The segment to read, after checking its writer if it is time to
+    const Segment* current_segment();
+
+    std::string name_;
+    std::atomic<Segment*> segment_;         //!< nullptr once rdcd is gone
+    std::atomic<int64_t> next_check_ms_;
+    std::mutex check_mutex_;                //!< One thread checks at a time
+    //!< Segments of a gone rdcd. Other threads may still be copying from
+    //!< them, so they are only unmapped with the reader.
+    std::vector<Segment*> retired_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // INCLUDE_RDC_LIB_IMPL_RDCSHMREADER_H_
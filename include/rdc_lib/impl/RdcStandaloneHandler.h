@@ -22,9 +22,18 @@ THE SOFTWARE.
 #ifndef INCLUDE_RDC_LIB_IMPL_RDCSTANDALONEHANDLER_H_
 #define INCLUDE_RDC_LIB_IMPL_RDCSTANDALONEHANDLER_H_
 #include <grpcpp/grpcpp.h>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <vector>
 #include "rdc.grpc.pb.h"  // NOLINT
 #include "rdc_lib/RdcHandler.h"
+#include "rdc_lib/impl/RdcAsyncClientQueue.h"
+#include "rdc_lib/impl/RdcShmReader.h"
 
 namespace amd {
 namespace rdc {
@@ -36,6 +45,8 @@ class RdcStandaloneHandler: public RdcHandler {
                         const char job_id[64], uint64_t update_freq) override;
     rdc_status_t rdc_job_get_stats(const char jobId[64],
                 rdc_job_info_t* p_job_info) override;
+    rdc_status_t rdc_job_get_moments(const char job_id[64],
+                rdc_job_gpu_moments_t* gpus, uint32_t* count) override;
     rdc_status_t rdc_job_stop_stats(const char job_id[64]) override;
     rdc_status_t rdc_job_remove(const char job_id[64]) override;
     rdc_status_t rdc_job_remove_all() override;
@@ -45,6 +56,8 @@ class RdcStandaloneHandler: public RdcHandler {
         uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count) override;
     rdc_status_t rdc_device_get_attributes(uint32_t gpu_index,
         rdc_device_attributes_t* p_rdc_attr) override;
+    rdc_status_t rdc_device_get_all_ext(uint32_t* gpu_index_list,
+        uint32_t* count) override;
 
     // Group RdcAPI
     rdc_status_t rdc_group_gpu_create(rdc_group_type_t type,
@@ -64,6 +77,13 @@ class RdcStandaloneHandler: public RdcHandler {
             rdc_gpu_group_t group_id_list[], uint32_t* count) override;
     rdc_status_t rdc_group_field_get_all_ids(
             rdc_field_grp_t field_group_id_list[], uint32_t* count) override;
+    rdc_status_t rdc_group_gpu_get_info_ext(
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) override;
+    rdc_status_t rdc_group_get_all_ids_ext(
+            rdc_gpu_group_t* group_id_list, uint32_t* count) override;
+    rdc_status_t rdc_group_field_get_all_ids_ext(
+            rdc_field_grp_t* field_group_id_list, uint32_t* count) override;
     rdc_status_t rdc_group_gpu_destroy(
         rdc_gpu_group_t p_rdc_group_id) override;
     rdc_status_t rdc_group_field_destroy(
@@ -78,24 +98,129 @@ class RdcStandaloneHandler: public RdcHandler {
     rdc_status_t rdc_field_get_value_since(uint32_t gpu_index,
         rdc_field_t field, uint64_t since_time_stamp,
         uint64_t *next_since_time_stamp, rdc_field_value* value) override;
+    rdc_status_t rdc_field_get_values_since(uint32_t gpu_index,
+        rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) override;
     rdc_status_t rdc_field_unwatch(rdc_gpu_group_t group_id,
         rdc_field_grp_t field_group_id) override;
+    rdc_status_t rdc_field_watch_set_limits(rdc_gpu_group_t group_id,
+        rdc_field_grp_t field_group_id, uint32_t priority,
+        uint64_t max_update_freq) override;
+    rdc_status_t rdc_field_get_watch_rates(rdc_watch_rate_t* rates,
+        uint32_t* count) override;
 
     // Control RdcAPI
     rdc_status_t rdc_field_update_all(uint32_t wait_for_update) override;
 
+    // Bulk RdcAPI
+    rdc_status_t rdc_field_get_latest_values(const uint32_t* gpu_indexes,
+        uint32_t num_gpus, const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_field_value* values) override;
+
+    // Async RdcAPI
+    rdc_status_t rdc_field_get_latest_value_async(uint32_t gpu_index,
+        rdc_field_t field, uint32_t timeout_ms,
+        rdc_field_value_callback_t callback, void* user_data) override;
+    rdc_status_t rdc_job_get_stats_async(const char job_id[64],
+        uint32_t timeout_ms, rdc_job_info_callback_t callback,
+        void* user_data) override;
+
+    // Cluster RdcAPI
+    rdc_status_t rdc_cluster_get_hosts(rdc_cluster_host_t* hosts,
+        uint32_t* count) override;
+    rdc_status_t rdc_cluster_get_latest_values(const char* host,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_cluster_field_value_t* values, uint32_t* count) override;
+    rdc_status_t rdc_cluster_get_latest_value(const char* host,
+        uint32_t gpu_index, rdc_field_t field,
+        rdc_cluster_field_value_t* value) override;
+    rdc_status_t rdc_cluster_get_aggregate(rdc_field_t field,
+        uint32_t max_age_ms, rdc_cluster_aggregate_t* aggregate) override;
+
+    // Self-telemetry of rdcd, from RdcAdmin
+    rdc_status_t rdc_perf_metrics_get(rdc_perf_metric_t* metrics,
+        uint32_t* count) override;
+    rdc_status_t rdc_trace_get(uint32_t last_seconds, char* buffer,
+        uint32_t* size) override;
+
     explicit RdcStandaloneHandler(const char* ip_and_port,
      const char* root_ca, const char* client_cert, const char* client_key);
+    ~RdcStandaloneHandler();
 
  private:
     // Helper function to handle the error
-    rdc_status_t error_handle(::grpc::Status status, uint32_t rdc_status);
+    rdc_status_t error_handle(const ::grpc::ClientContext& context,
+            ::grpc::Status status, uint32_t rdc_status);
+
+    //!< Name and members of a GPU group or field group
+    struct RdcGroupCacheEntry {
+        std::string name;
+        std::vector<uint32_t> ids;
+    };
+
+    // Metadata lookups, served from the cache when it is current
+    rdc_status_t get_all_devices(std::vector<uint32_t>* gpus);
+    rdc_status_t get_gpu_group(rdc_gpu_group_t group_id,
+            RdcGroupCacheEntry* group);
+    rdc_status_t get_field_group(rdc_field_grp_t field_group_id,
+            RdcGroupCacheEntry* group);
+
+    // Drops the cache when a response carries a new generation
+    void observe_generation(const ::grpc::ClientContext& context);
+    // Whether the cache may be used, called with cache_mutex_ held
+    bool cache_usable() const;
+    // Whether a response still describes the cached generation, called
+    // with cache_mutex_ held
+    bool cache_current(const ::grpc::ClientContext& context) const;
 
     bool copy_gpu_usage_info(
             const ::rdc::GpuUsageInfo& src,
             rdc_gpu_usage_info_t* target);
+    void copy_job_info(const ::rdc::GetJobStatsResponse& src,
+            rdc_job_info_t* target);
+    rdc_status_t get_cluster_values(
+            const ::rdc::GetClusterLatestValuesRequest& request,
+            std::vector<rdc_cluster_field_value_t>* values);
+
+    // A request on the shared completion queue, see start_call()
+    template <typename Reply> class AsyncCall;
+
+    // Arms the deadline of a request and tracks it until finish_call().
+    // Returns the queue to send it on.
+    ::grpc::CompletionQueue* start_call(RdcAsyncClientCall* call,
+            uint32_t timeout_ms);
+    void finish_call(RdcAsyncClientCall* call);
 
     std::unique_ptr<::rdc::RdcAPI::Stub> stub_;
+    //!< Only answered by an rdcd started with --aggregate
+    std::unique_ptr<::rdc::RdcAggregator::Stub> aggregator_stub_;
+    std::unique_ptr<::rdc::RdcAdmin::Stub> admin_stub_;
+
+    //!< The latest values published by a local rdcd, if any
+    std::unique_ptr<RdcShmReader> shm_reader_;
+
+    //!< Protects the metadata cache below
+    mutable std::mutex cache_mutex_;
+    //!< The configuration generation of rdcd, 0 until a response has one
+    uint64_t config_generation_;
+    //!< When a response last confirmed config_generation_
+    std::chrono::steady_clock::time_point generation_seen_;
+    //!< How long the cache is trusted without hearing from rdcd
+    std::chrono::milliseconds cache_ttl_;
+    bool devices_cached_;
+    std::vector<uint32_t> devices_;
+    std::map<uint32_t, std::string> device_names_;
+    std::map<rdc_gpu_group_t, RdcGroupCacheEntry> gpu_groups_;
+    std::map<rdc_field_grp_t, RdcGroupCacheEntry> field_groups_;
+
+    //!< Protects the asynchronous requests below
+    std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    //!< The requests in flight, cancelled when disconnecting
+    std::set<RdcAsyncClientCall*> pending_calls_;
+    //!< Taken on the first asynchronous request
+    std::shared_ptr<RdcAsyncClientQueue> async_queue_;
 };
 
 
@@ -0,0 +1,95 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef RDC_LIB_IMPL_RDCSYSFSLIB_H_
+#define RDC_LIB_IMPL_RDCSYSFSLIB_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "rdc_lib/RdcMetricFetcher.h"
+#include "rdc_lib/RdcTelemetry.h"
+
+namespace amd {
+namespace rdc {
+
+//!< Environment variable to enable the sysfs backend and set its root
+#define RDC_SYSFS_ROOT_ENV "RDC_SYSFS_ROOT"
+
+//!< Telemetry module which reads the hot fields directly from sysfs/hwmon.
+//!< The file paths are resolved once per device and the files are kept open,
+//!< so each fetch is a single pread() without any open()/close().
+class RdcSysfsLib : public RdcTelemetry {
+ public:
+    // get support field ids
+    rdc_status_t rdc_telemetry_fields_query(
+        uint32_t field_ids[MAX_NUM_FIELDS], uint32_t* field_count) override;
+
+    // Fetch
+    rdc_status_t rdc_telemetry_fields_value_get(rdc_gpu_field_t* fields,
+            uint32_t fields_count, rdc_field_value_f callback,
+            void*  user_data) override;
+
+    rdc_status_t rdc_telemetry_fields_watch(rdc_gpu_field_t* fields,
+            uint32_t fields_count) override;
+    rdc_status_t rdc_telemetry_fields_unwatch(rdc_gpu_field_t* fields,
+            uint32_t fields_count) override;
+
+    //!< The sysfs_root is the drm class directory, i.e. /sys/class/drm.
+    //!< Fields which cannot be resolved from sysfs are fetched from mf.
+    RdcSysfsLib(const std::string& sysfs_root, const RdcMetricFetcherPtr& mf);
+    ~RdcSysfsLib();
+
+    uint32_t get_num_devices() const;
+
+ private:
+    enum SysfsFile {
+        SYSFS_GPU_TEMP = 0,
+        SYSFS_MEMORY_TEMP,
+        SYSFS_POWER_USAGE,
+        SYSFS_GPU_UTIL,
+        SYSFS_GPU_MEMORY_USAGE,
+        SYSFS_FILE_COUNT
+    };
+
+    struct SysfsDevice {
+        std::string device_path;
+        int fds[SYSFS_FILE_COUNT];
+    };
+
+    static int field_to_file(uint32_t field_id);
+    void discover_devices();
+    void open_device_files(SysfsDevice* dev);
+    std::string find_hwmon_temp(const std::string& hwmon,
+            const char* label, uint32_t default_index) const;
+    int read_file(int fd, int64_t* val) const;
+
+    std::string sysfs_root_;
+    RdcMetricFetcherPtr metric_fetcher_;
+    std::vector<SysfsDevice> devices_;
+};
+
+typedef std::shared_ptr<RdcSysfsLib> RdcSysfsLibPtr;
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // RDC_LIB_IMPL_RDCSYSFSLIB_H_
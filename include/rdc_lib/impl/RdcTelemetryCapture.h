@@ -0,0 +1,109 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef RDC_LIB_IMPL_RDCTELEMETRYCAPTURE_H_
+#define RDC_LIB_IMPL_RDCTELEMETRYCAPTURE_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>  // NOLINT
+#include "rdc_lib/RdcTelemetry.h"
+
+namespace amd {
+namespace rdc {
+
+//!< Environment variables to capture and replay the telemetry
+#define RDC_CAPTURE_FILE_ENV "RDC_CAPTURE_FILE"
+#define RDC_REPLAY_FILE_ENV "RDC_REPLAY_FILE"
+#define RDC_REPLAY_SPEED_ENV "RDC_REPLAY_SPEED"
+
+// The capture file is in the host byte order:
+//   RdcCaptureFileHeader
+//   RdcCaptureSweepHeader, RdcCaptureValue * count, ...
+// STRING values are followed by str_len bytes of the string.
+#define RDC_CAPTURE_MAGIC "RDCCAPT"
+#define RDC_CAPTURE_VERSION 1
+
+#pragma pack(push, 1)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+} RdcCaptureFileHeader;
+
+typedef struct {
+    uint64_t ts;        //!< Sweep time in milliseconds since 1970
+    uint32_t count;     //!< Number of values in the sweep
+    uint32_t size;      //!< Bytes of values following the header
+} RdcCaptureSweepHeader;
+
+typedef struct {
+    uint32_t gpu_index;
+    uint32_t field_id;
+    int32_t status;
+    int32_t ts_offset;  //!< Value timestamp relative to the sweep
+    uint16_t type;
+    uint16_t str_len;
+    int64_t value;      //!< l_int, or the bits of dbl
+} RdcCaptureValue;
+#pragma pack(pop)
+
+//!< The values collected in one sweep, encoded in the capture format
+class RdcCaptureSweep {
+ public:
+    RdcCaptureSweep();
+
+    void add(const rdc_gpu_field_value_t* values, uint32_t num_values);
+
+    uint64_t ts() const { return ts_; }
+    uint32_t count() const { return count_; }
+    const std::vector<char>& buffer() const { return buffer_; }
+
+ private:
+    uint64_t ts_;
+    uint32_t count_;
+    std::vector<char> buffer_;
+};
+
+//!< Write the sweeps into a capture file
+class RdcTelemetryRecorder {
+ public:
+    explicit RdcTelemetryRecorder(const std::string& file_name);
+    ~RdcTelemetryRecorder();
+
+    bool is_open() const;
+
+    void write(const RdcCaptureSweep& sweep);
+
+ private:
+    std::string file_name_;
+    FILE* file_;
+    std::mutex recorder_mutex_;
+};
+
+typedef std::shared_ptr<RdcTelemetryRecorder> RdcTelemetryRecorderPtr;
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // RDC_LIB_IMPL_RDCTELEMETRYCAPTURE_H_
@@ -25,8 +25,10 @@ THE SOFTWARE.
 #include <map>
 #include <list>
 #include <memory>
+#include <vector>
 #include "rdc_lib/RdcTelemetry.h"
 #include "rdc_lib/impl/RdcRasLib.h"
+#include "rdc_lib/impl/RdcTelemetryCapture.h"
 #include "rdc_lib/RdcMetricFetcher.h"
 
 namespace amd {
@@ -49,9 +51,20 @@ class RdcTelemetryModule : public RdcTelemetry {
 
     RdcTelemetryModule(const RdcMetricFetcherPtr& fetcher,
             const RdcRasLibPtr& ras_module);
+
+    //!< Dispatch to the given modules only, the first module supporting a
+    //!< field fetches it. The benchmarks use it with stub modules.
+    explicit RdcTelemetryModule(const std::list<RdcTelemetryPtr>& modules);
+
  private:
-    std::list<RdcTelemetryPtr> telemetry_modules_;
-    std::map<uint32_t, RdcTelemetryPtr> fields_id_module_;
+    void map_fields();
+
+    std::vector<RdcTelemetryPtr> telemetry_modules_;
+    //!< The index in telemetry_modules_ of the module fetching each field
+    std::map<uint32_t, uint32_t> fields_id_module_;
+
+    //!< Record the fetched values when capturing is enabled
+    RdcTelemetryRecorderPtr recorder_;
 };
 
 typedef std::shared_ptr<RdcTelemetryModule> RdcTelemetryModulePtr;
@@ -29,23 +29,42 @@ THE SOFTWARE.
 #include <memory>
 #include <mutex>  // NOLINT
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include "rdc_lib/RdcWatchTable.h"
+#include "rdc_lib/RdcFlatMap.h"
 #include "rdc_lib/RdcGroupSettings.h"
 #include "rdc_lib/RdcCacheManager.h"
 #include "rdc_lib/RdcMetricFetcher.h"
 #include "rdc_lib/RdcModuleMgr.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/impl/RdcCpuGovernor.h"
+#include "rdc_lib/impl/RdcExportPipeline.h"
+#include "rdc_lib/impl/RdcGpuCollector.h"
+#include "rdc_lib/impl/RdcPrometheusExporter.h"
+#include "rdc_lib/impl/RdcShmPublisher.h"
 #include "rocm_smi/rocm_smi.h"
 
 namespace amd {
 namespace rdc {
 
+//!< The update period in microseconds at or below which a field cheap to
+//!< fetch goes to RDC_LANE_FAST, 1 second by default
+#define RDC_FAST_LANE_US_ENV "RDC_FAST_LANE_US"
+//!< The average fetch time in microseconds above which a field goes to
+//!< RDC_LANE_SLOW, 1 millisecond by default
+#define RDC_SLOW_FETCH_US_ENV "RDC_SLOW_FETCH_US"
+
 //!< The settings for a field or a group of field in the watch table.
 struct FieldSettings {
-    uint64_t  update_freq;
+    uint64_t  update_freq;  //!< As stretched by the CPU budget, if any
+    uint64_t  requested_freq;
+    uint64_t  max_update_freq;  //!< Of a watch, the most it is stretched to
+    uint32_t  priority;  //!< Of a watch, the lowest are stretched first
     uint32_t  max_keep_samples;
     double  max_keep_age;
     bool is_watching;
     uint64_t last_update_time;
+    uint32_t lane;  //!< The RdcLane which updates the field
 };
 
 struct JobWatchTableEntry {
@@ -74,6 +93,12 @@ class RdcWatchTableImpl : public RdcWatchTable {
     rdc_status_t rdc_field_unwatch(rdc_gpu_group_t group_id,
                 rdc_field_grp_t field_group_id) override;
 
+    rdc_status_t rdc_field_watch_set_limits(rdc_gpu_group_t group_id,
+                rdc_field_grp_t field_group_id, uint32_t priority,
+                uint64_t max_update_freq) override;
+    rdc_status_t rdc_field_get_watch_rates(
+                std::vector<rdc_watch_rate_t>* rates) override;
+
     //!< When the RDC is running as RDC_OPERATION_MODE_MANUAL, the user will
     //!< call this function periodically. Instead of providing other APIs to
     //!< cleanup the cache, this function will update and cleanup the cache.
@@ -83,6 +108,17 @@ class RdcWatchTableImpl : public RdcWatchTable {
     //!< once per second.
     rdc_status_t rdc_field_update_all() override;
 
+    //!< Each lane has its own deadline, the earliest time one of its
+    //!< fields is due, and is fetched without holding the watch table, so
+    //!< that the lanes do not wait for each other. The normal lane also
+    //!< cleans up the cache once per second.
+    rdc_status_t rdc_field_update_lane(uint32_t lane,
+                uint64_t* next_due) override;
+    void rdc_field_wait_lane(uint32_t lane, uint64_t next_due) override;
+    void rdc_field_wake_lanes() override;
+
+    bool rdc_gpu_quarantined(uint32_t gpu_index) const override;
+
     // TODO(bill_liu): Remove the RdcMetricFetcherPtr
     RdcWatchTableImpl(const RdcGroupSettingsPtr& group_settings,
         const RdcCacheManagerPtr& cache_mgr,
@@ -97,6 +133,13 @@ class RdcWatchTableImpl : public RdcWatchTable {
     //!< Helper function to clean up the watch table and cache
     void clean_up();
 
+    //!< Let the CPU budget stretch or restore the watches, and update the
+    //!< fields of those whose period changed
+    void govern();
+    //!< Set the period of each watch as the CPU budget allows, and of each
+    //!< field the shortest of its watches
+    void apply_update_freqs();
+
     //!< Helper function for debug information in watch table and cache
     void debug_status();
 
@@ -105,22 +148,37 @@ class RdcWatchTableImpl : public RdcWatchTable {
          rdc_field_grp_t field_group_id,
          std::vector<RdcFieldKey> & fields); // NOLINT
 
-    bool is_job_watch_field(uint32_t gpu_index, rdc_field_t field_id,
-                                        std::string& job_id) const;  // NOLINT
+    //!< The id of the job watching the field, nullptr if none does
+    const std::string* get_job_watching(uint32_t gpu_index,
+                                        rdc_field_t field_id) const;
+
+    //!< Have the cache hold the samples the field keeps, plus those added
+    //!< until the next clean up evicts
+    void reserve_samples(const RdcFieldKey& key,
+                         const FieldSettings& settings);
 
     rdc_status_t initialize_rsmi_handles(RdcFieldKey fk);
 
+    //!< The lane of a field from its update period and how long it took
+    //!< to fetch so far
+    uint32_t classify_field(rdc_field_t field_id, uint64_t update_freq,
+            uint32_t lane) const;
+
     //!< The function will be pass as the callback for bulk fetch
     static rdc_status_t handle_fields(rdc_gpu_field_value_t*  values,
             uint32_t num_values, void*  user_data);
 
+    //!< Report the fields of the quarantined GPUs with RDC_ST_TIMEOUT
+    void handle_stale_fields(uint32_t lane,
+            const std::vector<rdc_gpu_field_t>& fields, uint64_t now);
+
     RdcGroupSettingsPtr group_settings_;
     RdcCacheManagerPtr cache_mgr_;
     RdcMetricFetcherPtr metric_fetcher_;
     RdcModuleMgrPtr rdc_module_mgr_;
 
     //!< The watch table to store the watch settings.
-    std::map<RdcFieldGroupKey, FieldSettings> watch_table_;
+    RdcFlatMap<RdcFieldGroupKey, FieldSettings> watch_table_;
 
     //!< <job_id, gpu_group_id> pairs
     std::map<std::string, JobWatchTableEntry> job_watch_table_;
@@ -130,11 +188,46 @@ class RdcWatchTableImpl : public RdcWatchTable {
     //!< rdc_field_update_all() call needs to deduce them. To improve the
     //!< performance, the fields_to_watch_ is used to track the field settings.
     //!< Those settings will only be updated when watching or unwatching.
-    std::map<RdcFieldKey, FieldSettings> fields_to_watch_;
+    RdcFlatMap<RdcFieldKey, FieldSettings> fields_to_watch_;
+
+    //!< Publishes the fetched values to local readers, if configured
+    RdcShmPublisherPtr shm_publisher_;
+
+    //!< Serves the fetched values to Prometheus, if configured
+    RdcPrometheusExporterPtr prometheus_exporter_;
+
+    //!< Pushes the fetched values to the export sinks, if configured
+    RdcExportPipelinePtr export_pipeline_;
+
+    //!< Stretches the watches to keep within RDC_CPU_BUDGET_PERCENT, if set
+    RdcCpuGovernorPtr cpu_governor_;
+    //!< The watches passed to the governor, under the watch_mutex_
+    std::vector<RdcGovernedWatch> governed_watches_;
 
     //!< The last clean up time
     std::atomic<uint64_t> last_cleanup_time_;
     std::mutex watch_mutex_;
+    RdcPerfCounters& perf_;
+
+    uint64_t fast_lane_us_;
+    uint64_t slow_fetch_us_;
+    //!< Taken for the whole sweep of a lane, before the watch_mutex_
+    std::mutex lane_mutex_[RDC_LANE_COUNT];
+    //!< The fields being fetched by each lane, under its lane_mutex_
+    std::vector<rdc_gpu_field_t> lane_fields_[RDC_LANE_COUNT];
+
+    //!< Changes when the watches change, to wake the waiting lanes
+    std::mutex lane_wait_mutex_;
+    std::condition_variable lane_wait_cv_;
+    uint64_t watch_generation_;
+    uint64_t lane_generation_[RDC_LANE_COUNT];
+
+    //!< The fields of each lane its GPUs are too hung to fetch
+    std::vector<rdc_gpu_field_t> lane_stale_[RDC_LANE_COUNT];
+    std::vector<rdc_gpu_field_value_t> lane_stale_values_[RDC_LANE_COUNT];
+    //!< Fetches each GPU from its own thread, with a watchdog, if enabled.
+    //!< Last, so that it stops passing values on before the rest goes.
+    RdcGpuCollectorPtr gpu_collector_;
 };
 
 }  // namespace rdc
@@ -24,20 +24,24 @@ THE SOFTWARE.
 #define INCLUDE_RDC_LIB_RDC_COMMON_H_
 #include <iostream>
 #include <map>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "rdc/rdc.h"
+#include "rdc_lib/RdcFlatMap.h"
 
 #define RDC_ERROR  0
 #define RDC_INFO   1
 #define RDC_DEBUG  2
 
 #define RDC_LOG(debug_level, msg) do { \
-    auto& logger = amd::rdc::RdcLogger::getLogger(); \
-    if (logger.should_log((debug_level))) { \
-        logger.get_ostream() << \
-        logger.get_log_header((debug_level), __FILE__, __LINE__) << \
-        msg << std::endl; \
+    if (amd::rdc::RdcLogger::getLogger().should_log((debug_level))) { \
+        static amd::rdc::RdcLogSite rdc_log_site(__FILE__, __LINE__); \
+        amd::rdc::RdcLogRecord rdc_log_record((debug_level), &rdc_log_site); \
+        if (rdc_log_record.stream()) { \
+            *rdc_log_record.stream() << msg; \
+        } \
     } \
 } while (0)
 
@@ -48,7 +52,51 @@ typedef std::pair<uint32_t, rdc_field_t> RdcFieldKey;
 typedef std::pair<uint32_t, uint32_t> RdcFieldGroupKey;
 
 //!< The gauge metrics do not require aggregations
-typedef std::map<RdcFieldKey, uint64_t> rdc_gpu_gauges_t;
+typedef amd::rdc::RdcFlatMap<RdcFieldKey, uint64_t> rdc_gpu_gauges_t;
+
+//!< Path of the rdcd Unix socket, or "none" to not use one
+#define RDC_UNIX_SOCKET_ENV "RDC_UNIX_SOCKET"
+//!< The runtime directory of the rdcd service
+#define RDC_UNIX_SOCKET_RUN_DIR "/run/rdcd"
+//!< Where rdcd puts its socket when it cannot write the runtime directory
+#define RDC_UNIX_SOCKET_TMP_DIR "/tmp"
+
+//!< The priority lanes of the collection. Each lane is swept by its own
+//!< thread, so that the fields slow to fetch do not delay the others.
+enum RdcLane {
+    RDC_LANE_FAST = 0,  //!< Cheap fields updated at least every second
+    RDC_LANE_NORMAL,    //!< The other cheap fields
+    RDC_LANE_SLOW,      //!< Fields slow to fetch, whatever their frequency
+    RDC_LANE_COUNT
+};
+
+inline const char* rdc_lane_name(uint32_t lane) {
+    static const char* const names[RDC_LANE_COUNT] = {
+        "fast", "normal", "slow"};
+    return lane < RDC_LANE_COUNT ? names[lane] : "unknown";
+}
+
+//!< The response metadata carrying the configuration generation of rdcd
+#define RDC_CONFIG_GENERATION_KEY "rdc-config-generation"
+//!< How long in milliseconds a client trusts its cached metadata without
+//!< hearing the generation from rdcd, 0 to disable the cache
+#define RDC_METADATA_CACHE_MS_ENV "RDC_METADATA_CACHE_MS"
+
+/**
+ *  @brief The Unix domain socket of the rdcd listening on a TCP port
+ *
+ *  @details rdcd also listens on a Unix socket for node-local clients,
+ *  which are then served without TLS. The socket is named after the TCP
+ *  port so that clients connecting to localhost:port find the rdcd of
+ *  that port.
+ *
+ *  @param[in] dir RDC_UNIX_SOCKET_RUN_DIR or RDC_UNIX_SOCKET_TMP_DIR
+ *
+ *  @param[in] port The TCP port of rdcd
+ *
+ *  @retval The socket path dir/rdcd-port.sock
+ */
+std::string rdc_unix_socket_path(const char* dir, const std::string& port);
 
 /**
  *  @brief The strncpy but with null terminated
@@ -66,5 +114,34 @@ typedef std::map<RdcFieldKey, uint64_t> rdc_gpu_gauges_t;
  */
 char *strncpy_with_null(char *dest, const char *src, size_t n);
 
+/**
+ *  @brief Copy a list to the caller provided array of the _ext APIs
+ *
+ *  @param[in] src The list to be copied
+ *
+ *  @param[out] dest The destination array
+ *
+ *  @param[inout] count The capacity of dest on input, the size of src
+ *  on output.
+ *
+ *  @retval ::RDC_ST_INSUFF_RESOURCES if dest cannot hold src.
+ */
+template <typename T, typename D>
+rdc_status_t copy_to_ext_array(const std::vector<T>& src,
+                D* dest, uint32_t* count) {
+    if (!count || (*count > 0 && !dest)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    uint32_t capacity = *count;
+    *count = src.size();
+    if (src.size() > capacity) {
+        return RDC_ST_INSUFF_RESOURCES;
+    }
+    for (uint32_t i = 0; i < src.size(); i++) {
+        dest[i] = src[i];
+    }
+    return RDC_ST_OK;
+}
+
 
 #endif  // INCLUDE_RDC_LIB_RDC_COMMON_H_
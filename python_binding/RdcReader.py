@@ -2,6 +2,14 @@ import os,time
 from rdc_bootstrap import *
 from RdcUtil import RdcUtil
 
+# The compiled bulk reader, see rdc_bulk.cc. Without it the values are read
+# one ctypes call at a time.
+try:
+    import numpy
+    import rdc_bulk
+except ImportError:
+    rdc_bulk = None
+
 default_field_ids = [
         rdc_field_t.RDC_FI_GPU_MEMORY_USAGE,
         rdc_field_t.RDC_FI_GPU_MEMORY_TOTAL,
@@ -27,7 +35,8 @@ class RdcReader:
             field_group_name = "rdc_reader_field_group", gpu_group_name = "rdc_reader_gpu_group",
             gpu_indexes = None, root_ca = "/etc/rdc/client/certs/rdc_cacert.pem",
             client_cert = "/etc/rdc/client/certs/rdc_client_cert.pem",
-            client_key = "/etc/rdc/client/private/rdc_client_cert.key"):
+            client_key = "/etc/rdc/client/private/rdc_client_cert.key",
+            use_bulk = True):
         result = rdc.rdc_init(0)
         if rdc_status_t(result) != rdc_status_t.RDC_ST_OK:
             raise Exception("RdcReader init fail: " + str(result))
@@ -83,8 +92,84 @@ class RdcReader:
         if rdc_status_t(result) != rdc_status_t.RDC_ST_OK:
                raise Exception("RdcReader fail to watch group " + str(self.gpu_group_id) + ", field group " + str(self.field_group_id) + ":" + str(result))
 
+        self.use_bulk = use_bulk and rdc_bulk != None
+        self.latest_shape = None
+
+    # Read the latest values of all the GPUs and fields in a single call.
+    # Return the (GPU, field) arrays of timestamps, values as float64,
+    # rdc_status_t and rdc_field_type_t. The arrays are filled in place by
+    # the next call, and the values are not unit converted.
+    def read_latest(self):
+        if rdc_bulk == None:
+            raise Exception("RdcReader bulk reads need numpy and rdc_bulk")
+
+        shape = (len(self.gpu_indexes), len(self.field_ids))
+        if self.latest_shape != shape:
+            self.latest_ts = numpy.zeros(shape, dtype=numpy.uint64)
+            self.latest_values = numpy.zeros(shape, dtype=numpy.float64)
+            self.latest_status = numpy.zeros(shape, dtype=numpy.int32)
+            self.latest_types = numpy.zeros(shape, dtype=numpy.int8)
+            self.latest_shape = shape
+
+        rdc_bulk.latest_values(self.rdc_handle, self.gpu_indexes,
+                self.field_ids, self.latest_ts, self.latest_values,
+                self.latest_status, self.latest_types)
+        return self.latest_ts, self.latest_values, self.latest_status, self.latest_types
+
+    # Read the history of a field since a timestamp, at most max_samples.
+    # Return the arrays of timestamps and values, and the timestamp to
+    # continue from.
+    def read_since(self, gpu_index, field_id, since, max_samples = 1000):
+        if rdc_bulk == None:
+            raise Exception("RdcReader bulk reads need numpy and rdc_bulk")
+
+        ts = numpy.zeros(max_samples, dtype=numpy.uint64)
+        values = numpy.zeros(max_samples, dtype=numpy.float64)
+        count, next_since = rdc_bulk.values_since(self.rdc_handle, gpu_index,
+                field_id, since, ts, values)
+        return ts[:count], values[:count], next_since
+
     # Process the fields periodically
     def process(self):
+        if self.use_bulk:
+            has_succeed = self.process_bulk()
+        else:
+            has_succeed = self.process_each()
+
+        self.process_other_fields()
+
+        if len(self.gpu_indexes) != 0 and len(self.field_ids) != 0 and has_succeed == False:
+            self.try_reconnect()
+
+    # Hand the values of a single bulk read to handle_field
+    def process_bulk(self):
+        ts, values, status, types = self.read_latest()
+        if self.unit_converter != None:
+            scale = numpy.array([self.unit_converter.get(fid, 1.0) for fid in self.field_ids])
+            values = values * scale
+
+        has_succeed = False
+        num_fields = len(self.field_ids)
+        for index in numpy.flatnonzero(status == rdc_status_t.RDC_ST_OK.value):
+            g, f = divmod(int(index), num_fields)
+            value = rdc_field_value()
+            value.field_id = self.field_ids[f]
+            value.status = 0
+            value.ts = int(ts[g, f])
+            value.type = int(types[g, f])
+            if value.type.value == rdc_field_type_t.INTEGER:
+                value.value.l_int = int(values[g, f])
+            elif value.type.value == rdc_field_type_t.DOUBLE:
+                value.value.dbl = values[g, f]
+            else:
+                # Strings are not in the arrays
+                rdc.rdc_field_get_latest_value(self.rdc_handle,
+                        self.gpu_indexes[g], self.field_ids[f], value)
+            self.handle_field(self.gpu_indexes[g], value)
+            has_succeed = True
+        return has_succeed
+
+    def process_each(self):
         has_succeed = False
         for gindex in self.gpu_indexes:
             for fid in self.field_ids:
@@ -101,11 +186,7 @@ class RdcReader:
                             value.value.dbl  = value.value.l_int * self.unit_converter[fid]
                     self.handle_field(gindex, value)
                     has_succeed = True
-
-        self.process_other_fields()
-
-        if len(self.gpu_indexes) != 0 and len(self.field_ids) != 0 and has_succeed == False:
-            self.try_reconnect()
+        return has_succeed
 
     def process_other_fields(self):
         pass
@@ -5,10 +5,10 @@ class RdcUtil:
         pass
 
     def get_all_gpu_indexes(self, rdc_handle):
-        gpu_count = c_uint32()
-        gpu_index_list = (c_uint32 * RDC_MAX_NUM_DEVICES)()
+        gpu_count = c_uint32(RDC_MAX_NUM_DEVICES_EXT)
+        gpu_index_list = (c_uint32 * RDC_MAX_NUM_DEVICES_EXT)()
 
-        result = rdc.rdc_device_get_all(rdc_handle, gpu_index_list, gpu_count)
+        result = rdc.rdc_device_get_all_ext(rdc_handle, gpu_index_list, gpu_count)
         if rdc_status_t(result) != rdc_status_t.RDC_ST_OK:
             raise Exception("Fail to get all GPus")
         gpu_indexes = []
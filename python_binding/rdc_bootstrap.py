@@ -17,6 +17,10 @@ RDC_MAX_NUM_DEVICES = 16
 RDC_MAX_FIELD_IDS_PER_FIELD_GROUP = 128
 RDC_MAX_NUM_GROUPS = 64
 RDC_MAX_NUM_FIELD_GROUPS = 64
+RDC_MAX_NUM_DEVICES_EXT = 1024
+RDC_GROUP_MAX_ENTITIES_EXT = 1024
+RDC_MAX_NUM_GROUPS_EXT = 4096
+RDC_MAX_NUM_FIELD_GROUPS_EXT = 4096
 class rdc_status_t(Enum):
      def from_param(cls, obj):
           return int(obj)
@@ -31,6 +35,11 @@ class rdc_status_t(Enum):
      RDC_ST_CLIENT_ERROR = 8
      RDC_ST_ALREADY_EXIST = 9
      RDC_ST_MAX_LIMIT = 10
+     RDC_ST_INSUFF_RESOURCES = 11
+     RDC_ST_FILE_ERROR = 12
+     RDC_ST_NO_DATA = 13
+     RDC_ST_PERM_ERROR = 14
+     RDC_ST_TIMEOUT = 15
 
 class rdc_operation_mode_t(c_int):
      RDC_OPERATION_MODE_AUTO = 0
@@ -62,6 +71,16 @@ class rdc_field_t(c_int):
      RDC_FI_GPU_MEMORY_TOTAL = 502
      RDC_FI_ECC_CORRECT_TOTAL = 600
      RDC_FI_ECC_UNCORRECT_TOTAL = 601
+     RDC_FI_RDC_SWEEP_DURATION = 2000
+     RDC_FI_RDC_MISSED_DEADLINES = 2001
+     RDC_FI_RDC_CACHE_BYTES = 2002
+     RDC_FI_RDC_CACHE_SAMPLES = 2003
+     RDC_FI_RDC_LOCK_WAIT = 2004
+
+class rdc_perf_metric_type_t(c_int):
+     RDC_PERF_COUNTER = 0
+     RDC_PERF_GAUGE = 1
+     RDC_PERF_HISTOGRAM = 2
 
 rdc_handle_t = c_void_p
 rdc_gpu_group_t = c_uint32
@@ -143,6 +162,16 @@ class rdc_job_group_info_t(Structure):
             ,("stop_time", c_uint64)
             ]
 
+class rdc_perf_metric_t(Structure):
+    _fields_ = [
+            ("name", c_char*64)
+            ,("label", c_char*64)
+            ,("type", rdc_perf_metric_type_t)
+            ,("value", c_uint64)
+            ,("sum", c_uint64)
+            ,("buckets", c_uint64*24)
+            ]
+
 rdc.rdc_init.restype = rdc_status_t
 rdc.rdc_init.argtypes = [ c_uint64 ]
 rdc.rdc_shutdown.restype = rdc_status_t
@@ -169,6 +198,8 @@ rdc.rdc_field_update_all.restype = rdc_status_t
 rdc.rdc_field_update_all.argtypes = [ rdc_handle_t,c_uint32 ]
 rdc.rdc_device_get_all.restype = rdc_status_t
 rdc.rdc_device_get_all.argtypes = [ rdc_handle_t,POINTER(c_uint32),POINTER(c_uint32) ]
+rdc.rdc_device_get_all_ext.restype = rdc_status_t
+rdc.rdc_device_get_all_ext.argtypes = [ rdc_handle_t,POINTER(c_uint32),POINTER(c_uint32) ]
 rdc.rdc_device_get_attributes.restype = rdc_status_t
 rdc.rdc_device_get_attributes.argtypes = [ rdc_handle_t,c_uint32,POINTER(rdc_device_attributes_t) ]
 rdc.rdc_group_gpu_create.restype = rdc_status_t
@@ -179,6 +210,10 @@ rdc.rdc_group_gpu_get_info.restype = rdc_status_t
 rdc.rdc_group_gpu_get_info.argtypes = [ rdc_handle_t,rdc_gpu_group_t,POINTER(rdc_group_info_t) ]
 rdc.rdc_group_get_all_ids.restype = rdc_status_t
 rdc.rdc_group_get_all_ids.argtypes = [ rdc_handle_t,POINTER(rdc_gpu_group_t),POINTER(c_uint32) ]
+rdc.rdc_group_gpu_get_info_ext.restype = rdc_status_t
+rdc.rdc_group_gpu_get_info_ext.argtypes = [ rdc_handle_t,rdc_gpu_group_t,c_char_p,POINTER(c_uint32),POINTER(c_uint32) ]
+rdc.rdc_group_get_all_ids_ext.restype = rdc_status_t
+rdc.rdc_group_get_all_ids_ext.argtypes = [ rdc_handle_t,POINTER(rdc_gpu_group_t),POINTER(c_uint32) ]
 rdc.rdc_group_gpu_destroy.restype = rdc_status_t
 rdc.rdc_group_gpu_destroy.argtypes = [ rdc_handle_t,rdc_gpu_group_t ]
 rdc.rdc_group_field_create.restype = rdc_status_t
@@ -187,16 +222,26 @@ rdc.rdc_group_field_get_info.restype = rdc_status_t
 rdc.rdc_group_field_get_info.argtypes = [ rdc_handle_t,rdc_field_grp_t,POINTER(rdc_field_group_info_t) ]
 rdc.rdc_group_field_get_all_ids.restype = rdc_status_t
 rdc.rdc_group_field_get_all_ids.argtypes = [ rdc_handle_t,POINTER(rdc_field_grp_t),POINTER(c_uint32) ]
+rdc.rdc_group_field_get_all_ids_ext.restype = rdc_status_t
+rdc.rdc_group_field_get_all_ids_ext.argtypes = [ rdc_handle_t,POINTER(rdc_field_grp_t),POINTER(c_uint32) ]
 rdc.rdc_group_field_destroy.restype = rdc_status_t
 rdc.rdc_group_field_destroy.argtypes = [ rdc_handle_t,rdc_field_grp_t ]
 rdc.rdc_field_watch.restype = rdc_status_t
 rdc.rdc_field_watch.argtypes = [ rdc_handle_t,rdc_gpu_group_t,rdc_field_grp_t,c_uint64,c_double,c_uint32 ]
 rdc.rdc_field_get_latest_value.restype = rdc_status_t
 rdc.rdc_field_get_latest_value.argtypes = [ rdc_handle_t,c_uint32,rdc_field_t,POINTER(rdc_field_value) ]
+rdc.rdc_field_get_latest_values.restype = rdc_status_t
+rdc.rdc_field_get_latest_values.argtypes = [ rdc_handle_t,POINTER(c_uint32),c_uint32,POINTER(rdc_field_t),c_uint32,POINTER(rdc_field_value) ]
 rdc.rdc_field_get_value_since.restype = rdc_status_t
 rdc.rdc_field_get_value_since.argtypes = [ rdc_handle_t,c_uint32,rdc_field_t,c_uint64,POINTER(c_uint64),POINTER(rdc_field_value) ]
+rdc.rdc_field_get_values_since.restype = rdc_status_t
+rdc.rdc_field_get_values_since.argtypes = [ rdc_handle_t,c_uint32,rdc_field_t,c_uint64,POINTER(c_uint64),POINTER(rdc_field_value),POINTER(c_uint32) ]
 rdc.rdc_field_unwatch.restype = rdc_status_t
 rdc.rdc_field_unwatch.argtypes = [ rdc_handle_t,rdc_gpu_group_t,rdc_field_grp_t ]
+rdc.rdc_perf_metrics_get.restype = rdc_status_t
+rdc.rdc_perf_metrics_get.argtypes = [ rdc_handle_t,POINTER(rdc_perf_metric_t),POINTER(c_uint32) ]
+rdc.rdc_trace_get.restype = rdc_status_t
+rdc.rdc_trace_get.argtypes = [ rdc_handle_t,c_uint32,POINTER(c_char),POINTER(c_uint32) ]
 rdc.rdc_status_string.restype = c_char_p
 rdc.rdc_status_string.argtypes = [ rdc_status_t ]
 rdc.field_id_string.restype = c_char_p
@@ -0,0 +1,360 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// The rdc_bulk Python module reads many values of librdc_bootstrap in a
+// single call, into caller provided arrays such as those of NumPy. The
+// arrays are filled in place through the buffer protocol, so that a
+// reader allocates them once and no Python object is created per value.
+//
+//   ts = numpy.zeros((gpus, fields), numpy.uint64)
+//   values = numpy.zeros((gpus, fields), numpy.float64)
+//   status = numpy.zeros((gpus, fields), numpy.int32)
+//   rdc_bulk.latest_values(handle, gpu_indexes, field_ids,
+//                          ts, values, status)
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace {
+
+// The values read per call of the C API, whatever the size of the arrays
+const uint32_t kChunkValues = 1024;
+
+// The address of the ctypes c_void_p handle, or of a plain integer
+bool get_handle(PyObject* obj, rdc_handle_t* handle) {
+    PyObject* value = PyObject_HasAttrString(obj, "value") ?
+            PyObject_GetAttrString(obj, "value") : (Py_INCREF(obj), obj);
+    if (value == nullptr) {
+        return false;
+    }
+    void* address = value == Py_None ? nullptr : PyLong_AsVoidPtr(value);
+    Py_DECREF(value);
+    if (address == nullptr) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_ValueError, "The RDC handle is null");
+        }
+        return false;
+    }
+    *handle = address;
+    return true;
+}
+
+// An unsigned integer, or a ctypes integer such as rdc_field_t
+bool get_uint32(PyObject* obj, uint32_t* number) {
+    PyObject* value = PyObject_HasAttrString(obj, "value") ?
+            PyObject_GetAttrString(obj, "value") : (Py_INCREF(obj), obj);
+    if (value == nullptr) {
+        return false;
+    }
+    unsigned long n = PyLong_AsUnsignedLong(value);  // NOLINT
+    Py_DECREF(value);
+    if (PyErr_Occurred()) {
+        return false;
+    }
+    *number = static_cast<uint32_t>(n);
+    return true;
+}
+
+bool get_uint32_list(PyObject* obj, std::vector<uint32_t>* list) {
+    PyObject* seq = PySequence_Fast(obj, "Expect a sequence of integers");
+    if (seq == nullptr) {
+        return false;
+    }
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+    list->resize(size);
+    for (Py_ssize_t i = 0; i < size; i++) {
+        if (!get_uint32(PySequence_Fast_GET_ITEM(seq, i), &(*list)[i])) {
+            Py_DECREF(seq);
+            return false;
+        }
+    }
+    Py_DECREF(seq);
+    return true;
+}
+
+// A writable, C contiguous array of integers or doubles to fill
+class OutArray {
+ public:
+    OutArray() : held_(false) {}
+    ~OutArray() {
+        if (held_) {
+            PyBuffer_Release(&view_);
+        }
+    }
+
+    //!< None is accepted for an optional array, which is then not filled
+    bool get(PyObject* obj, const char* name, bool is_double,
+             Py_ssize_t min_items, bool optional) {
+        if (obj == nullptr || (optional && obj == Py_None)) {
+            return true;
+        }
+        if (PyObject_GetBuffer(obj, &view_,
+                PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+            return false;
+        }
+        held_ = true;
+
+        // Skip the byte order of the struct syntax, as "<d"
+        const char* format = view_.format ? view_.format : "B";
+        if (strchr("@=<>!", *format) != nullptr) {
+            format++;
+        }
+        bool valid = is_double ? (strcmp(format, "d") == 0) :
+            (strlen(format) == 1 && strchr("bBhHiIlLqQ", *format) != nullptr);
+        if (!valid) {
+            PyErr_Format(PyExc_TypeError, "%s must be an array of %s",
+                         name, is_double ? "float64" : "integers");
+            return false;
+        }
+        if (view_.len / view_.itemsize < min_items) {
+            PyErr_Format(PyExc_ValueError, "%s must hold at least %zd items",
+                         name, min_items);
+            return false;
+        }
+        return true;
+    }
+
+    Py_ssize_t size() const {
+        return held_ ? view_.len / view_.itemsize : 0;
+    }
+
+    void set(Py_ssize_t index, double value) {
+        if (held_) {
+            static_cast<double*>(view_.buf)[index] = value;
+        }
+    }
+
+    void set_int(Py_ssize_t index, int64_t value) {
+        if (!held_) {
+            return;
+        }
+        char* item = static_cast<char*>(view_.buf) + index * view_.itemsize;
+        switch (view_.itemsize) {
+            case 1: { int8_t v = value; memcpy(item, &v, 1); break; }
+            case 2: { int16_t v = value; memcpy(item, &v, 2); break; }
+            case 4: { int32_t v = value; memcpy(item, &v, 4); break; }
+            default: memcpy(item, &value, 8); break;
+        }
+    }
+
+ private:
+    Py_buffer view_;
+    bool held_;
+};
+
+double to_double(const rdc_field_value& value) {
+    if (value.type == INTEGER) {
+        return static_cast<double>(value.value.l_int);
+    }
+    if (value.type == DOUBLE) {
+        return value.value.dbl;
+    }
+    return NAN;
+}
+
+PyObject* latest_values(PyObject* self, PyObject* args, PyObject* kwargs) {
+    (void)(self);
+    static const char* keywords[] = {"handle", "gpu_indexes", "field_ids",
+            "ts", "values", "status", "types", nullptr};
+    PyObject *handle_obj, *gpus_obj, *fields_obj;
+    PyObject *ts_obj, *values_obj, *status_obj, *types_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOOOO|O:latest_values",
+            const_cast<char**>(keywords), &handle_obj, &gpus_obj, &fields_obj,
+            &ts_obj, &values_obj, &status_obj, &types_obj)) {
+        return nullptr;
+    }
+
+    rdc_handle_t handle;
+    std::vector<uint32_t> gpu_indexes;
+    std::vector<uint32_t> field_ids;
+    if (!get_handle(handle_obj, &handle) ||
+            !get_uint32_list(gpus_obj, &gpu_indexes) ||
+            !get_uint32_list(fields_obj, &field_ids)) {
+        return nullptr;
+    }
+    Py_ssize_t count = gpu_indexes.size() * field_ids.size();
+
+    OutArray ts, values, status, types;
+    if (!ts.get(ts_obj, "ts", false, count, false) ||
+            !values.get(values_obj, "values", true, count, false) ||
+            !status.get(status_obj, "status", false, count, false) ||
+            !types.get(types_obj, "types", false, count, true)) {
+        return nullptr;
+    }
+    if (count == 0) {
+        return PyLong_FromSsize_t(0);
+    }
+
+    // Whole rows of GPUs per call, and the fields in slices if a row
+    // alone exceeds the chunk
+    uint32_t num_fields = static_cast<uint32_t>(field_ids.size());
+    uint32_t fields_per_call = std::min(num_fields, kChunkValues);
+    std::vector<rdc_field_value> fetched(kChunkValues);
+    Py_ssize_t num_ok = 0;
+    for (size_t g = 0; g < gpu_indexes.size();) {
+        uint32_t num_gpus = static_cast<uint32_t>(std::min<size_t>(
+                std::max(kChunkValues / fields_per_call, 1u),
+                gpu_indexes.size() - g));
+        if (fields_per_call < num_fields) {
+            num_gpus = 1;
+        }
+        for (uint32_t f = 0; f < num_fields; f += fields_per_call) {
+            uint32_t num_f = std::min(fields_per_call, num_fields - f);
+            rdc_status_t result;
+            Py_BEGIN_ALLOW_THREADS
+            result = rdc_field_get_latest_values(handle, &gpu_indexes[g],
+                    num_gpus,
+                    reinterpret_cast<const rdc_field_t*>(&field_ids[f]),
+                    num_f, fetched.data());
+            Py_END_ALLOW_THREADS
+            if (result != RDC_ST_OK) {
+                PyErr_Format(PyExc_RuntimeError,
+                             "rdc_field_get_latest_values: %s",
+                             rdc_status_string(result));
+                return nullptr;
+            }
+
+            for (uint32_t i = 0; i < num_gpus * num_f; i++) {
+                const rdc_field_value& value = fetched[i];
+                Py_ssize_t index = (g + i / num_f) * num_fields + f +
+                        i % num_f;
+                status.set_int(index, value.status);
+                if (value.status != RDC_ST_OK) {
+                    ts.set_int(index, 0);
+                    values.set(index, NAN);
+                    types.set_int(index, -1);
+                    continue;
+                }
+                ts.set_int(index, value.ts);
+                values.set(index, to_double(value));
+                types.set_int(index, value.type);
+                num_ok++;
+            }
+        }
+        g += num_gpus;
+    }
+    return PyLong_FromSsize_t(num_ok);
+}
+
+PyObject* values_since(PyObject* self, PyObject* args, PyObject* kwargs) {
+    (void)(self);
+    static const char* keywords[] = {"handle", "gpu_index", "field_id",
+            "since", "ts", "values", nullptr};
+    PyObject *handle_obj, *gpu_obj, *field_obj, *ts_obj, *values_obj;
+    unsigned long long since;  // NOLINT
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOKOO:values_since",
+            const_cast<char**>(keywords), &handle_obj, &gpu_obj, &field_obj,
+            &since, &ts_obj, &values_obj)) {
+        return nullptr;
+    }
+
+    rdc_handle_t handle;
+    uint32_t gpu_index;
+    uint32_t field_id;
+    OutArray ts, values;
+    if (!get_handle(handle_obj, &handle) || !get_uint32(gpu_obj, &gpu_index)
+            || !get_uint32(field_obj, &field_id) ||
+            !ts.get(ts_obj, "ts", false, 0, false) ||
+            !values.get(values_obj, "values", true, 0, false)) {
+        return nullptr;
+    }
+
+    // Up to kChunkValues values per call of the C API, until the arrays or
+    // the history are exhausted. A remote rdcd returns a bounded number of
+    // values per request, and the next timestamp is 1us after the last
+    // value once the history is exhausted.
+    Py_ssize_t capacity = std::min(ts.size(), values.size());
+    std::vector<rdc_field_value> fetched(
+            std::min<Py_ssize_t>(capacity, kChunkValues));
+    uint64_t next_since = since;
+    Py_ssize_t count = 0;
+    while (count < capacity) {
+        uint64_t next = next_since;
+        uint32_t num_values = static_cast<uint32_t>(std::min<Py_ssize_t>(
+                capacity - count, kChunkValues));
+        rdc_status_t result;
+        Py_BEGIN_ALLOW_THREADS
+        result = rdc_field_get_values_since(handle, gpu_index,
+                static_cast<rdc_field_t>(field_id), next_since, &next,
+                fetched.data(), &num_values);
+        Py_END_ALLOW_THREADS
+        if (result != RDC_ST_OK || num_values == 0 || next <= next_since) {
+            break;
+        }
+
+        for (uint32_t i = 0; i < num_values; i++) {
+            ts.set_int(count + i, fetched[i].ts);
+            values.set(count + i, to_double(fetched[i]));
+        }
+        next_since = next;
+        count += num_values;
+        if (next == fetched[num_values - 1].ts + 1) {
+            break;
+        }
+    }
+    return Py_BuildValue("nK", count,
+                         static_cast<unsigned long long>(next_since));  // NOLINT
+}
+
+PyMethodDef rdc_bulk_methods[] = {
+    {"latest_values", reinterpret_cast<PyCFunction>(
+        reinterpret_cast<void(*)(void)>(latest_values)),
+     METH_VARARGS | METH_KEYWORDS,
+     "latest_values(handle, gpu_indexes, field_ids, ts, values, status, "
+     "types=None)\n\n"
+     "Read the latest value of every field of every GPU in a single call.\n"
+     "The value of gpu_indexes[i] and field_ids[j] is stored at the flat\n"
+     "index i * len(field_ids) + j of the arrays: its timestamp in ts, its\n"
+     "value as a float64 in values (NaN for strings), its rdc_status_t in\n"
+     "status, and its rdc_field_type_t in types (-1 if not read).\n"
+     "Return the number of values read."},
+    {"values_since", reinterpret_cast<PyCFunction>(
+        reinterpret_cast<void(*)(void)>(values_since)),
+     METH_VARARGS | METH_KEYWORDS,
+     "values_since(handle, gpu_index, field_id, since, ts, values)\n\n"
+     "Read the cached history of a field since a timestamp, as many\n"
+     "samples as the arrays hold, with rdc_field_get_values_since().\n"
+     "Return (count, next_since), where next_since is the timestamp to\n"
+     "continue from."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+struct PyModuleDef rdc_bulk_module = {
+    PyModuleDef_HEAD_INIT,
+    "rdc_bulk",
+    "Bulk reads of the RDC field values into NumPy arrays",
+    -1,
+    rdc_bulk_methods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_rdc_bulk(void) {
+    return PyModule_Create(&rdc_bulk_module);
+}
@@ -0,0 +1,64 @@
+import argparse, time
+from RdcReader import RdcReader
+from rdc_bootstrap import *
+
+# Ticks per second of RdcReader.process() with the bulk reads of rdc_bulk
+# against one ctypes call per (GPU, field), of the bare reads, and of the
+# history reads against one ctypes call per sample.
+# One "name ticks_per_sec" line per case.
+
+class NullReader(RdcReader):
+    def handle_field(self, gpu_index, value):
+        pass
+
+def ticks_per_sec(tick, duration):
+    ticks = 0
+    start = time.time()
+    end = start + duration
+    while time.time() < end:
+        tick()
+        ticks += 1
+    return ticks / (time.time() - start)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='RdcReader bulk read benchmark.')
+    parser.add_argument('--rdc_embedded', default=False, action='store_true', help='Run RDC in embedded mode (default: standalone mode)')
+    parser.add_argument('--rdc_ip_port' , default='localhost:50051', help='The rdcd IP and port in standalone mode (default: localhost:50051)')
+    parser.add_argument('--rdc_unauth', default=False, action='store_true', help='Set this option if the rdcd is running with unauth in standalone mode (default: false)')
+    parser.add_argument('--duration', default=5, type=float, help='Seconds to run each case (default: 5)')
+    args = parser.parse_args()
+
+    ip_port = None if args.rdc_embedded else args.rdc_ip_port
+    certs = {}
+    if args.rdc_unauth:
+        certs = dict(root_ca=None, client_cert=None, client_key=None)
+
+    # Every 10ms, so that a second of history is cached
+    reader = NullReader(ip_port=ip_port, update_freq=10000, **certs)
+    rdc.rdc_field_update_all(reader.rdc_handle, 1)
+    time.sleep(1)
+
+    print("values_per_tick %d" % (len(reader.gpu_indexes) * len(reader.field_ids)))
+    reader.use_bulk = False
+    print("process_ctypes %.1f" % ticks_per_sec(reader.process, args.duration))
+    reader.use_bulk = True
+    print("process_bulk %.1f" % ticks_per_sec(reader.process, args.duration))
+    print("read_latest %.1f" % ticks_per_sec(reader.read_latest, args.duration))
+
+    # The history of a field, one ctypes call per sample or in a single
+    # call
+    gpu_index = reader.gpu_indexes[0]
+    field_id = reader.field_ids[0]
+    def since_ctypes():
+        since = c_uint64(0)
+        next_since = c_uint64(0)
+        value = rdc_field_value()
+        while rdc_status_t(rdc.rdc_field_get_value_since(reader.rdc_handle,
+                gpu_index, field_id, since, next_since, value)) == \
+                rdc_status_t.RDC_ST_OK and next_since.value > since.value:
+            since.value = next_since.value
+    ts, values, next_since = reader.read_since(gpu_index, field_id, 0)
+    print("samples_per_read %d" % len(ts))
+    print("since_ctypes %.1f" % ticks_per_sec(since_ctypes, args.duration))
+    print("read_since %.1f" % ticks_per_sec(
+        lambda: reader.read_since(gpu_index, field_id, 0), args.duration))
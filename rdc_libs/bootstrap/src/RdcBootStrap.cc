@@ -123,6 +123,16 @@ rdc_status_t rdc_job_get_stats(rdc_handle_t p_rdc_handle,
                 rdc_job_get_stats(job_id, p_job_info);
 }
 
+rdc_status_t rdc_job_get_moments(rdc_handle_t p_rdc_handle,
+        const char job_id[64], rdc_job_gpu_moments_t* gpus, uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_job_get_moments(job_id, gpus, count);
+}
+
 rdc_status_t rdc_job_start_stats(rdc_handle_t p_rdc_handle,
                                rdc_gpu_group_t groupId, const char job_id[64],
                  uint64_t update_freq) {
@@ -194,6 +204,16 @@ rdc_status_t rdc_device_get_all(rdc_handle_t p_rdc_handle,
                 rdc_device_get_all(gpu_index_list, count);
 }
 
+rdc_status_t rdc_device_get_all_ext(rdc_handle_t p_rdc_handle,
+            uint32_t* gpu_index_list, uint32_t* count) {
+        if (!p_rdc_handle || !count) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_device_get_all_ext(gpu_index_list, count);
+}
+
 rdc_status_t rdc_device_get_attributes(rdc_handle_t p_rdc_handle,
             uint32_t gpu_index, rdc_device_attributes_t* p_rdc_attr) {
         if (!p_rdc_handle || !p_rdc_attr) {
@@ -258,6 +278,38 @@ rdc_status_t rdc_group_field_get_all_ids(rdc_handle_t p_rdc_handle,
               rdc_group_field_get_all_ids(field_group_id_list, count);
 }
 
+rdc_status_t rdc_group_gpu_get_info_ext(rdc_handle_t p_rdc_handle,
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) {
+        if (!p_rdc_handle || !count) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_group_gpu_get_info_ext(p_rdc_group_id, group_name,
+                        entity_ids, count);
+}
+
+rdc_status_t rdc_group_get_all_ids_ext(rdc_handle_t p_rdc_handle,
+            rdc_gpu_group_t* group_id_list, uint32_t* count) {
+        if (!p_rdc_handle || !count) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+              rdc_group_get_all_ids_ext(group_id_list, count);
+}
+
+rdc_status_t rdc_group_field_get_all_ids_ext(rdc_handle_t p_rdc_handle,
+        rdc_field_grp_t* field_group_id_list, uint32_t* count) {
+        if (!p_rdc_handle || !count) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+              rdc_group_field_get_all_ids_ext(field_group_id_list, count);
+}
+
 rdc_status_t rdc_field_watch(rdc_handle_t p_rdc_handle,
         rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
         uint64_t update_freq, double max_keep_age, uint32_t max_keep_samples) {
@@ -280,6 +332,19 @@ rdc_status_t rdc_field_get_latest_value(rdc_handle_t p_rdc_handle,
                 rdc_field_get_latest_value(gpu_index, field, value);
 }
 
+rdc_status_t rdc_field_get_latest_values(rdc_handle_t p_rdc_handle,
+        const uint32_t* gpu_indexes, uint32_t num_gpus,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_field_value* values) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_field_get_latest_values(gpu_indexes, num_gpus,
+                field_ids, num_fields, values);
+}
+
 rdc_status_t rdc_field_get_value_since(rdc_handle_t p_rdc_handle,
         uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
         uint64_t *next_since_time_stamp, rdc_field_value* value) {
@@ -292,6 +357,122 @@ rdc_status_t rdc_field_get_value_since(rdc_handle_t p_rdc_handle,
                 next_since_time_stamp, value);
 }
 
+rdc_status_t rdc_field_get_values_since(rdc_handle_t p_rdc_handle,
+        uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_field_get_values_since(gpu_index, field,
+                since_time_stamp, next_since_time_stamp, values, count);
+}
+
+rdc_status_t rdc_field_get_latest_value_async(rdc_handle_t p_rdc_handle,
+        uint32_t gpu_index, rdc_field_t field, uint32_t timeout_ms,
+        rdc_field_value_callback_t callback, void* user_data) {
+        if (!p_rdc_handle || !callback) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_field_get_latest_value_async(gpu_index, field,
+                timeout_ms, callback, user_data);
+}
+
+rdc_status_t rdc_job_get_stats_async(rdc_handle_t p_rdc_handle,
+        const char job_id[64], uint32_t timeout_ms,
+        rdc_job_info_callback_t callback, void* user_data) {
+        if (!p_rdc_handle || !job_id || !callback) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_job_get_stats_async(job_id, timeout_ms, callback,
+                user_data);
+}
+
+rdc_status_t rdc_cluster_get_hosts(rdc_handle_t p_rdc_handle,
+        rdc_cluster_host_t* hosts, uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_cluster_get_hosts(hosts, count);
+}
+
+rdc_status_t rdc_cluster_get_latest_values(rdc_handle_t p_rdc_handle,
+        const char* host, const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_cluster_field_value_t* values, uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (num_fields > 0 && !field_ids) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_cluster_get_latest_values(host, field_ids, num_fields,
+                values, count);
+}
+
+rdc_status_t rdc_cluster_get_latest_value(rdc_handle_t p_rdc_handle,
+        const char* host, uint32_t gpu_index, rdc_field_t field,
+        rdc_cluster_field_value_t* value) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (!host || !value) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_cluster_get_latest_value(host, gpu_index, field, value);
+}
+
+rdc_status_t rdc_cluster_get_aggregate(rdc_handle_t p_rdc_handle,
+        rdc_field_t field, uint32_t max_age_ms,
+        rdc_cluster_aggregate_t* aggregate) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (!aggregate) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_cluster_get_aggregate(field, max_age_ms, aggregate);
+}
+
+rdc_status_t rdc_perf_metrics_get(rdc_handle_t p_rdc_handle,
+        rdc_perf_metric_t* metrics, uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (!count || (*count > 0 && !metrics)) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_perf_metrics_get(metrics, count);
+}
+
+rdc_status_t rdc_trace_get(rdc_handle_t p_rdc_handle, uint32_t last_seconds,
+        char* buffer, uint32_t* size) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (!size || (*size > 0 && !buffer)) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+                rdc_trace_get(last_seconds, buffer, size);
+}
+
 rdc_status_t rdc_field_unwatch(rdc_handle_t p_rdc_handle,
         rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id) {
         if (!p_rdc_handle) {
@@ -302,6 +483,31 @@ rdc_status_t rdc_field_unwatch(rdc_handle_t p_rdc_handle,
               rdc_field_unwatch(group_id, field_group_id);
 }
 
+rdc_status_t rdc_field_watch_set_limits(rdc_handle_t p_rdc_handle,
+        rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
+        uint32_t priority, uint64_t max_update_freq) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+              rdc_field_watch_set_limits(group_id, field_group_id, priority,
+                      max_update_freq);
+}
+
+rdc_status_t rdc_field_get_watch_rates(rdc_handle_t p_rdc_handle,
+        rdc_watch_rate_t* rates, uint32_t* count) {
+        if (!p_rdc_handle) {
+                return RDC_ST_INVALID_HANDLER;
+        }
+        if (!count || (*count > 0 && !rates)) {
+                return RDC_ST_BAD_PARAMETER;
+        }
+
+        return static_cast<amd::rdc::RdcHandler*>(p_rdc_handle)->
+              rdc_field_get_watch_rates(rates, count);
+}
+
 rdc_status_t rdc_group_gpu_destroy(rdc_handle_t p_rdc_handle,
         rdc_gpu_group_t p_rdc_group_id) {
         if (!p_rdc_handle) {
@@ -354,6 +560,8 @@ const char* rdc_status_string(rdc_status_t result) {
                 return "Data was requested, but none was found";
         case RDC_ST_PERM_ERROR:
                 return "Insufficient permission to complete operation";
+        case RDC_ST_TIMEOUT:
+                return "The request timed out";
         case RDC_ST_UNKNOWN_ERROR:
                 return "Unknown error";
         default:
@@ -383,3 +591,7 @@ char *strncpy_with_null(char *dest, const char *src, size_t n) {
      dest[n - 1]= '\0';
      return dest;
 }
+
+std::string rdc_unix_socket_path(const char* dir, const std::string& port) {
+     return std::string(dir) + "/rdcd-" + port + ".sock";
+}
@@ -0,0 +1,165 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include "rdc/rdc.h"
+
+namespace {
+
+// The units of the job stats, as reported by rdc_job_get_stats()
+struct JobStatsField {
+    rdc_field_t field_id;
+    rdc_stats_summary_t rdc_gpu_usage_info_t::* stats;
+    double adjuster;   //!< 0 for a percentage of the GPU memory
+};
+
+const JobStatsField job_stats_fields[] = {
+    {RDC_FI_POWER_USAGE, &rdc_gpu_usage_info_t::power_usage, 1000000},
+    {RDC_FI_GPU_MEMORY_USAGE, &rdc_gpu_usage_info_t::memory_utilization, 0},
+    {RDC_FI_GPU_CLOCK, &rdc_gpu_usage_info_t::gpu_clock, 1000000},
+    {RDC_FI_GPU_UTIL, &rdc_gpu_usage_info_t::gpu_utilization, 1},
+    {RDC_FI_GPU_TEMP, &rdc_gpu_usage_info_t::gpu_temperature, 1000},
+    {RDC_FI_MEM_CLOCK, &rdc_gpu_usage_info_t::memory_clock, 1000000},
+    {RDC_FI_PCIE_TX, &rdc_gpu_usage_info_t::pcie_tx, 1024*1024},
+    {RDC_FI_PCIE_RX, &rdc_gpu_usage_info_t::pcie_rx, 1024*1024},
+};
+const uint32_t num_job_stats_fields =
+    sizeof(job_stats_fields) / sizeof(job_stats_fields[0]);
+
+struct Moments {
+    uint64_t count;
+    double min_value;
+    double max_value;
+    double mean;
+    double m2;
+};
+
+// Chan et al. combination of the moments of two sets of samples
+void merge_moments(Moments* a, const Moments& b) {
+    if (b.count == 0) {
+        return;
+    }
+    if (a->count == 0) {
+        *a = b;
+        return;
+    }
+    double count = static_cast<double>(a->count + b.count);
+    double delta = b.mean - a->mean;
+    a->mean += delta * b.count / count;
+    a->m2 += b.m2 + delta * delta * a->count * b.count / count;
+    a->min_value = std::min(a->min_value, b.min_value);
+    a->max_value = std::max(a->max_value, b.max_value);
+    a->count += b.count;
+}
+
+void set_stats(const Moments& m, rdc_stats_summary_t* stats) {
+    if (m.count == 0) {
+        stats->min_value = std::numeric_limits<uint64_t>::max();
+        stats->max_value = stats->average = 0;
+        stats->standard_deviation = 0;
+        return;
+    }
+    stats->max_value = static_cast<uint64_t>(m.max_value);
+    stats->min_value = static_cast<uint64_t>(m.min_value);
+    stats->average = static_cast<uint64_t>(m.mean);
+    //< the sample variance
+    stats->standard_deviation = sqrt(m.count > 1 ? m.m2 / (m.count - 1) : 0);
+}
+
+}  // namespace
+
+rdc_status_t rdc_job_merge_moments(const rdc_job_gpu_moments_t* gpus,
+        uint32_t num_gpus, rdc_job_info_t* p_job_info) {
+    if (p_job_info == nullptr || (num_gpus > 0 && gpus == nullptr)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    if (num_gpus == 0) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    rdc_gpu_usage_info_t& summary = p_job_info->summary;
+    summary = rdc_gpu_usage_info_t();
+    summary.gpu_id = GPU_ID_INVALID;
+    summary.start_time = std::numeric_limits<uint64_t>::max();
+    Moments summary_moments[num_job_stats_fields] = {};
+
+    const uint32_t max_job_gpus =
+        sizeof(p_job_info->gpus) / sizeof(p_job_info->gpus[0]);
+    p_job_info->num_gpus = num_gpus;
+    for (uint32_t i = 0; i < num_gpus; i++) {
+        const rdc_job_gpu_moments_t& gpu = gpus[i];
+        summary.start_time = std::min(summary.start_time, gpu.start_time);
+        summary.end_time = std::max(summary.end_time, gpu.end_time);
+        summary.energy_consumed += gpu.energy_consumed;
+        summary.ecc_correct += gpu.ecc_correct;
+        summary.ecc_uncorrect += gpu.ecc_uncorrect;
+
+        // The moments of the GPU in the units of the job stats
+        Moments gpu_moments[num_job_stats_fields] = {};
+        uint64_t max_gpu_memory_used = 0;
+        for (uint32_t f = 0; f < gpu.num_fields && f < RDC_MAX_JOB_FIELDS;
+                f++) {
+            const rdc_field_moments_t& field = gpu.fields[f];
+            if (field.count == 0) continue;
+            if (field.field_id == RDC_FI_GPU_MEMORY_USAGE) {
+                max_gpu_memory_used = field.max_value;
+            }
+            for (uint32_t s = 0; s < num_job_stats_fields; s++) {
+                if (job_stats_fields[s].field_id != field.field_id) continue;
+                double adjuster = job_stats_fields[s].adjuster;
+                if (adjuster == 0) {
+                    adjuster = gpu.memory_total / 100.0;
+                }
+                if (adjuster <= 0) break;
+                gpu_moments[s] = {field.count, field.min_value / adjuster,
+                    field.max_value / adjuster, field.mean / adjuster,
+                    field.m2 / (adjuster * adjuster)};
+                merge_moments(&summary_moments[s], gpu_moments[s]);
+                break;
+            }
+        }
+        summary.max_gpu_memory_used = std::max(summary.max_gpu_memory_used,
+            max_gpu_memory_used);
+
+        if (i >= max_job_gpus) continue;
+        rdc_gpu_usage_info_t& gpu_info = p_job_info->gpus[i];
+        gpu_info = rdc_gpu_usage_info_t();
+        gpu_info.gpu_id = gpu.gpu_index;
+        gpu_info.start_time = gpu.start_time;
+        gpu_info.end_time = gpu.end_time;
+        gpu_info.energy_consumed = gpu.energy_consumed;
+        gpu_info.ecc_correct = gpu.ecc_correct;
+        gpu_info.ecc_uncorrect = gpu.ecc_uncorrect;
+        gpu_info.max_gpu_memory_used = max_gpu_memory_used;
+        for (uint32_t s = 0; s < num_job_stats_fields; s++) {
+            set_stats(gpu_moments[s], &(gpu_info.*job_stats_fields[s].stats));
+        }
+    }
+
+    for (uint32_t s = 0; s < num_job_stats_fields; s++) {
+        set_stats(summary_moments[s], &(summary.*job_stats_fields[s].stats));
+    }
+
+    return RDC_ST_OK;
+}
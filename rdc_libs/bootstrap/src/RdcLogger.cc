@@ -20,19 +20,127 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "rdc_lib/RdcLogger.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sstream>
-#include <iomanip>
-#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
 #include <chrono>  // NOLINT
+#include <streambuf>
 #include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcThreads.h"
 
 namespace amd {
 namespace rdc {
 
-RdcLogger::RdcLogger(std::ostream& os):
-    os_(os) {
+namespace {
+const uint32_t kRingEntries = 1024;
+const size_t kMaxMessage = 232;  // Keep an entry at 256 bytes
+const uint64_t kRateWindowMs = 60000;
+const uint32_t kDefaultRateLimit = 20;
+const std::chrono::milliseconds kFlushInterval(20);
+const char kJournalSocket[] = "/run/systemd/journal/socket";
+
+// Formats into a fixed buffer and drops what does not fit
+class RdcLogStreamBuf : public std::streambuf {
+ public:
+    RdcLogStreamBuf() : truncated_(false) {}
+
+    void reset(char* buffer, size_t size) {
+        setp(buffer, buffer + size);
+        truncated_ = false;
+    }
+    size_t length() const { return pptr() - pbase(); }
+    bool truncated() const { return truncated_; }
+
+ protected:
+    int_type overflow(int_type c) override {
+        (void)(c);
+        truncated_ = true;
+        return traits_type::eof();
+    }
+
+ private:
+    bool truncated_;
+};
+
+uint64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* severity_name(uint32_t severity) {
+    if (severity == RDC_DEBUG) {
+        return "DEBUG";
+    } else if (severity == RDC_INFO) {
+        return "INFO";
+    }
+    return "ERROR";
+}
+}  // namespace
+
+struct RdcLogEntry {
+    uint64_t time_ms;
+    const RdcLogSite* site;
+    uint32_t severity;
+    uint32_t suppressed;
+    uint16_t length;
+    bool truncated;
+    char message[kMaxMessage];
+};
+
+// The records of one thread. Only the owning thread writes and only the
+// writer thread reads, the record is dropped when the ring is full.
+class RdcLogRing {
+ public:
+    RdcLogRing(): entries_(new RdcLogEntry[kRingEntries]), head_(0),
+        tail_(0), in_use_(true), busy_(false), stream_(&buf_) {
+    }
+
+    std::unique_ptr<RdcLogEntry[]> entries_;
+    std::atomic<uint64_t> head_;  //!< The next entry the thread writes
+    std::atomic<uint64_t> tail_;  //!< The next entry the writer reads
+    std::atomic<bool> in_use_;
+    bool busy_;  //!< A message is being formatted
+    RdcLogStreamBuf buf_;
+    std::ostream stream_;
+};
+
+namespace {
+// Gives the ring of a thread back when the thread exits
+struct RdcLogRingOwner {
+    RdcLogRingOwner() : ring(nullptr) {}
+    ~RdcLogRingOwner() {
+        if (ring) {
+            ring->in_use_.store(false, std::memory_order_release);
+        }
+    }
+    RdcLogRing* ring;
+};
+thread_local RdcLogRingOwner thread_ring;
+
+void flush_at_exit() {
+    RdcLogger::getLogger().flush();
+}
+}  // namespace
+
+RdcLogSite::RdcLogSite(const char* file, int line):
+    file(file), line(line), window_start_ms(0), count(0), suppressed(0) {
+    // extract out the file path as it may be very long.
+    const char* base = strrchr(file, '/');
+    if (base != nullptr) {
+        this->file = base + 1;
+    }
+}
+
+RdcLogger::RdcLogger():
+    rate_limit_(kDefaultRateLimit), sink_type_(RDC_LOG_SINK_STDOUT),
+    sink_fd_(-1), dropped_(0), writer_started_(false) {
     char* verbose = getenv("RDC_LOG");
     if (verbose == nullptr) {
         log_level_ = RDC_ERROR;
@@ -43,36 +151,279 @@ RdcLogger::RdcLogger(std::ostream& os):
     } else {
        log_level_ = RDC_ERROR;
     }
+
+    const char* rate_limit = getenv(RDC_LOG_RATE_LIMIT_ENV);
+    if (rate_limit != nullptr) {
+        rate_limit_ = strtoul(rate_limit, nullptr, 10);
+    }
+
+    const char* sink = getenv(RDC_LOG_SINK_ENV);
+    if (sink == nullptr || strcmp(sink, "stdout") == 0) {
+        sink_type_ = RDC_LOG_SINK_STDOUT;
+    } else if (strcmp(sink, "stderr") == 0) {
+        sink_type_ = RDC_LOG_SINK_STDERR;
+    } else if (strcmp(sink, "journald") == 0) {
+        sink_type_ = RDC_LOG_SINK_JOURNALD;
+    } else {
+        sink_type_ = RDC_LOG_SINK_FILE;
+        sink_path_ = sink;
+        // rdcd changes its working directory to / when daemonized
+        char cwd[PATH_MAX];
+        if (sink[0] != '/' && getcwd(cwd, sizeof(cwd)) != nullptr) {
+            sink_path_ = std::string(cwd) + "/" + sink;
+        }
+    }
+
+    batch_.reserve(kRingEntries);
+    out_.reserve(kRingEntries * 64);
+    atexit(flush_at_exit);
 }
 
-std::string RdcLogger::get_log_header(uint32_t severity,
-            const char* file, int line) {
-    std::stringstream strstream;
-    auto ms =  std::chrono::duration_cast<std::chrono::milliseconds>
-         (std::chrono::system_clock::now().time_since_epoch()).count();
-    strstream << std::fixed << std::setprecision(3) << (ms/1000.0) << " ";
-    if (severity == RDC_DEBUG) {
-       strstream << "DEBUG ";
-    } else if (severity == RDC_INFO) {
-       strstream << "INFO ";
+RdcLogger::~RdcLogger() {
+    if (sink_fd_ >= 0) {
+        close(sink_fd_);
+    }
+}
+
+RdcLogRing* RdcLogger::acquire_ring() {
+    std::lock_guard<std::mutex> guard(rings_mutex_);
+    if (!writer_started_) {
+        writer_started_ = true;
+        writer_ = std::thread(&RdcLogger::writer_loop, this);
+        writer_.detach();
+    }
+    for (auto& ring : rings_) {
+        if (!ring->in_use_.load(std::memory_order_acquire)) {
+            // The records of the exited thread are still written out
+            ring->in_use_.store(true, std::memory_order_relaxed);
+            return ring.get();
+        }
+    }
+    rings_.emplace_back(new RdcLogRing());
+    return rings_.back().get();
+}
+
+bool RdcLogger::admit(RdcLogSite* site, uint64_t now) {
+    uint64_t start = site->window_start_ms.load(std::memory_order_relaxed);
+    if (now - start >= kRateWindowMs &&
+            site->window_start_ms.compare_exchange_strong(start, now,
+            std::memory_order_relaxed)) {
+        site->count.store(0, std::memory_order_relaxed);
+    }
+    if (site->count.fetch_add(1, std::memory_order_relaxed) >= rate_limit_) {
+        site->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+std::ostream* RdcLogger::begin(uint32_t severity, RdcLogSite* site) {
+    if (thread_ring.ring == nullptr) {
+        thread_ring.ring = acquire_ring();
+    }
+    RdcLogRing* ring = thread_ring.ring;
+    // The message itself logged something
+    if (ring->busy_) {
+        return nullptr;
+    }
+
+    uint64_t now = now_ms();
+    if (severity != RDC_DEBUG && rate_limit_ > 0 && !admit(site, now)) {
+        return nullptr;
+    }
+
+    uint64_t head = ring->head_.load(std::memory_order_relaxed);
+    if (head - ring->tail_.load(std::memory_order_acquire) >= kRingEntries) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    RdcLogEntry& entry = ring->entries_[head % kRingEntries];
+    entry.time_ms = now;
+    entry.site = site;
+    entry.severity = severity;
+    entry.suppressed = site->suppressed.exchange(0,
+            std::memory_order_relaxed);
+    ring->buf_.reset(entry.message, kMaxMessage);
+    ring->stream_.clear();
+    ring->stream_.flags(std::ios_base::dec | std::ios_base::skipws);
+    ring->stream_.precision(6);
+    ring->stream_.fill(' ');
+    ring->busy_ = true;
+    return &ring->stream_;
+}
+
+void RdcLogger::commit() {
+    RdcLogRing* ring = thread_ring.ring;
+    uint64_t head = ring->head_.load(std::memory_order_relaxed);
+    RdcLogEntry& entry = ring->entries_[head % kRingEntries];
+    entry.length = ring->buf_.length();
+    entry.truncated = ring->buf_.truncated();
+    ring->head_.store(head + 1, std::memory_order_release);
+    ring->busy_ = false;
+
+    // Do not wait for the next flush to drain a filling ring
+    if (head + 1 - ring->tail_.load(std::memory_order_relaxed) ==
+            kRingEntries / 2) {
+        wake_.notify_one();
+    }
+}
+
+void RdcLogger::writer_loop() {
+    RdcThreads::get().setup(RDC_THREAD_LOG, "rdc-log");
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    while (true) {
+        wake_.wait_for(lock, kFlushInterval);
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void RdcLogger::append_message(const RdcLogEntry& entry) {
+    out_.append(entry.message, entry.length);
+    if (entry.truncated) {
+        out_.append("...");
+    }
+    if (entry.suppressed > 0) {
+        char suffix[64];
+        int len = snprintf(suffix, sizeof(suffix),
+                " (%u similar messages suppressed)", entry.suppressed);
+        out_.append(suffix, std::min<size_t>(len, sizeof(suffix) - 1));
+    }
+}
+
+void RdcLogger::append_line(const RdcLogEntry& entry) {
+    char header[128];
+    int len = snprintf(header, sizeof(header), "%llu.%03llu %s %s(%d): ",
+        static_cast<unsigned long long>(entry.time_ms / 1000),  // NOLINT
+        static_cast<unsigned long long>(entry.time_ms % 1000),  // NOLINT
+        severity_name(entry.severity), entry.site->file, entry.site->line);
+    out_.append(header, std::min<size_t>(len, sizeof(header) - 1));
+    append_message(entry);
+    out_.push_back('\n');
+}
+
+void RdcLogger::write_out() {
+    if (out_.empty()) {
+        return;
+    }
+    if (sink_type_ == RDC_LOG_SINK_STDOUT ||
+            sink_type_ == RDC_LOG_SINK_STDERR) {
+        FILE* stream = sink_type_ == RDC_LOG_SINK_STDOUT ? stdout : stderr;
+        fwrite(out_.data(), 1, out_.size(), stream);
+        fflush(stream);
     } else {
-       strstream << "ERROR ";
+        if (sink_fd_ < 0) {
+            sink_fd_ = open(sink_path_.c_str(),
+                    O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        }
+        if (sink_fd_ < 0 ||
+                write(sink_fd_, out_.data(), out_.size()) < 0) {
+            fwrite(out_.data(), 1, out_.size(), stderr);
+        }
     }
+    out_.clear();
+}
 
-    //  extract out the file path as it may be very long.
-    if (file != nullptr) {
-       std::string file_str(file);
-       auto found = file_str.find_last_of("/");
-       if (found != std::string::npos) {
-          file_str = file_str.substr(found+1);
-       }
-       strstream << file_str << "(" << line << "): ";
+// The native journald protocol, which keeps the severity and location as
+// fields without linking libsystemd.
+void RdcLogger::send_journal(const RdcLogEntry& entry) {
+    static const uint32_t kPriority[] = {3, 6, 7};  // err, info, debug
+    char fields[192];
+    int len = snprintf(fields, sizeof(fields),
+        "PRIORITY=%u\nSYSLOG_IDENTIFIER=%s\nCODE_FILE=%s\nCODE_LINE=%d\n",
+        kPriority[std::min<uint32_t>(entry.severity, RDC_DEBUG)],
+        program_invocation_short_name, entry.site->file, entry.site->line);
+    out_.assign(fields, std::min<size_t>(len, sizeof(fields) - 1));
+    // The message goes length prefixed as it may contain new lines, and
+    // without the time and location which journald records itself
+    out_.append("MESSAGE\n");
+    size_t size_pos = out_.size();
+    out_.append(sizeof(uint64_t), '\0');
+    append_message(entry);
+    uint64_t size = out_.size() - size_pos - sizeof(uint64_t);
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+        out_[size_pos + i] = static_cast<char>((size >> (8 * i)) & 0xff);
     }
+    out_.push_back('\n');
 
-    return strstream.str();
+    if (sink_fd_ < 0) {
+        sink_fd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, kJournalSocket, sizeof(addr.sun_path) - 1);
+    if (sink_fd_ < 0 || sendto(sink_fd_, out_.data(), out_.size(),
+            MSG_NOSIGNAL, reinterpret_cast<struct sockaddr*>(&addr),
+            sizeof(addr)) < 0) {
+        out_.clear();
+        append_line(entry);
+        fwrite(out_.data(), 1, out_.size(), stderr);
+    }
+    out_.clear();
 }
 
+void RdcLogger::flush() {
+    std::lock_guard<std::mutex> write_guard(write_mutex_);
+    batch_.clear();
+    ring_heads_.clear();
+    {
+        std::lock_guard<std::mutex> guard(rings_mutex_);
+        for (auto& ring : rings_) {
+            uint64_t head = ring->head_.load(std::memory_order_acquire);
+            uint64_t tail = ring->tail_.load(std::memory_order_relaxed);
+            if (head == tail) {
+                continue;
+            }
+            for (uint64_t i = tail; i < head; i++) {
+                batch_.push_back(&ring->entries_[i % kRingEntries]);
+            }
+            ring_heads_.emplace_back(ring.get(), head);
+        }
+    }
+
+    // Interleave the threads by time, each keeps its own order
+    std::stable_sort(batch_.begin(), batch_.end(),
+        [](const RdcLogEntry* a, const RdcLogEntry* b) {
+            return a->time_ms < b->time_ms;
+        });
+    for (const RdcLogEntry* entry : batch_) {
+        if (sink_type_ == RDC_LOG_SINK_JOURNALD) {
+            send_journal(*entry);
+        } else {
+            append_line(*entry);
+        }
+    }
+    write_out();
+
+    for (auto& ring_head : ring_heads_) {
+        ring_head.first->tail_.store(ring_head.second,
+                std::memory_order_release);
+    }
+
+    uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        static RdcLogSite site(__FILE__, __LINE__);
+        RdcLogEntry entry;
+        entry.time_ms = now_ms();
+        entry.site = &site;
+        entry.severity = RDC_ERROR;
+        entry.suppressed = 0;
+        entry.truncated = false;
+        entry.length = snprintf(entry.message, kMaxMessage,
+            "%llu log messages dropped as a thread logged faster than "
+            "they were written",
+            static_cast<unsigned long long>(dropped));  // NOLINT
+        if (sink_type_ == RDC_LOG_SINK_JOURNALD) {
+            send_journal(entry);
+        } else {
+            append_line(entry);
+            write_out();
+        }
+    }
+}
 
 }  // namespace rdc
 }  // namespace amd
-
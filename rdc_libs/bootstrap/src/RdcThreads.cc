@@ -0,0 +1,334 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/RdcThreads.h"
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcPerfCounters.h"
+
+namespace amd {
+namespace rdc {
+
+namespace {
+const char* const kClassNames[RDC_THREAD_CLASS_COUNT] = {
+    "collect", "fetch", "rpc", "export", "log"
+};
+
+// Forgets the calling thread when it exits
+struct RdcThreadRecord {
+    RdcThreadRecord() : tid(0) {}
+    ~RdcThreadRecord() {
+        if (tid != 0) {
+            RdcThreads::get().forget(tid);
+        }
+    }
+    uint32_t tid;
+};
+thread_local RdcThreadRecord thread_record;
+
+// Parse a list of CPUs like "0-3,8,10-11"
+bool parse_cpu_list(const std::string& list, cpu_set_t* cpus) {
+    CPU_ZERO(cpus);
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        char* end = nullptr;
+        unsigned long first = strtoul(range.c_str(), &end, 10);  // NOLINT
+        unsigned long last = first;  // NOLINT
+        if (*end == '-') {
+            last = strtoul(end + 1, &end, 10);
+        }
+        if (*end != '\0' || last < first || last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (unsigned long cpu = first; cpu <= last; cpu++) {  // NOLINT
+            CPU_SET(cpu, cpus);
+        }
+    }
+    return CPU_COUNT(cpus) > 0;
+}
+
+// The CPU the thread last ran on, field 39 of its stat
+int last_cpu(uint32_t tid) {
+    std::ifstream stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string line;
+    std::getline(stat, line);
+    // The name in parentheses may hold spaces
+    size_t pos = line.rfind(')');
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    std::stringstream ss(line.substr(pos + 1));
+    std::string field;
+    for (int i = 3; i <= 39 && ss >> field; i++) {
+        if (i == 39) {
+            return atoi(field.c_str());
+        }
+    }
+    return -1;
+}
+}  // namespace
+
+RdcThreads& RdcThreads::get() {
+    // Never destroyed, the threads may exit after the static destructors
+    static RdcThreads* threads = new RdcThreads();
+    return *threads;
+}
+
+RdcThreads::RdcThreads(): numa_(false) {
+    memset(policy_, 0, sizeof(policy_));
+    parse(RDC_THREAD_CPUS_ENV, true);
+    parse(RDC_THREAD_SCHED_ENV, false);
+
+    const char* numa = getenv(RDC_THREAD_NUMA_ENV);
+    numa_ = numa != nullptr && strcmp(numa, "1") == 0;
+
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == nullptr) {
+        return;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, "node", 4) != 0 ||
+                entry->d_name[4] < '0' || entry->d_name[4] > '9') {
+            continue;
+        }
+        uint32_t node = atoi(entry->d_name + 4);
+        std::ifstream list(std::string("/sys/devices/system/node/")
+                + entry->d_name + "/cpulist");
+        std::string cpus;
+        std::getline(list, cpus);
+        if (node >= node_cpus_.size()) {
+            cpu_set_t empty;
+            CPU_ZERO(&empty);
+            node_cpus_.resize(node + 1, empty);
+        }
+        parse_cpu_list(cpus, &node_cpus_[node]);
+    }
+    closedir(dir);
+}
+
+void RdcThreads::parse(const char* env, bool cpus) {
+    const char* value = getenv(env);
+    if (value == nullptr || *value == '\0') {
+        return;
+    }
+    std::stringstream ss(value);
+    std::string pair;
+    bool has_default = false;
+    Policy fallback;
+    memset(&fallback, 0, sizeof(fallback));
+    while (std::getline(ss, pair, ';')) {
+        size_t pos = pair.find('=');
+        if (pos == std::string::npos) {
+            RDC_LOG(RDC_ERROR, env << ": ignore " << pair
+                    << ", expect class=value");
+            continue;
+        }
+        std::string name = pair.substr(0, pos);
+        std::string setting = pair.substr(pos + 1);
+        Policy* policy = nullptr;
+        if (name == "default") {
+            policy = &fallback;
+            has_default = true;
+        }
+        for (int i = 0; i < RDC_THREAD_CLASS_COUNT && !policy; i++) {
+            if (name == kClassNames[i]) {
+                policy = &policy_[i];
+            }
+        }
+        if (policy == nullptr) {
+            RDC_LOG(RDC_ERROR, env << ": unknown thread class " << name);
+            continue;
+        }
+        if (cpus) {
+            policy->has_cpus = parse_cpu_list(setting, &policy->cpus);
+            if (!policy->has_cpus) {
+                RDC_LOG(RDC_ERROR, env << ": invalid CPU list " << setting
+                        << " for " << name);
+            }
+        } else if (setting == "idle") {
+            policy->has_sched = true;
+            policy->idle = true;
+        } else {
+            char* end = nullptr;
+            long nice = strtol(setting.c_str(), &end, 10);  // NOLINT
+            if (setting.empty() || *end != '\0' || nice < -20 || nice > 19) {
+                RDC_LOG(RDC_ERROR, env << ": invalid nice level " << setting
+                        << " for " << name);
+                continue;
+            }
+            policy->has_sched = true;
+            policy->idle = false;
+            policy->nice = static_cast<int>(nice);
+        }
+    }
+    if (!has_default) {
+        return;
+    }
+    for (int i = 0; i < RDC_THREAD_CLASS_COUNT; i++) {
+        if (cpus && !policy_[i].has_cpus && fallback.has_cpus) {
+            policy_[i].has_cpus = true;
+            policy_[i].cpus = fallback.cpus;
+        }
+        if (!cpus && !policy_[i].has_sched && fallback.has_sched) {
+            policy_[i].has_sched = true;
+            policy_[i].idle = fallback.idle;
+            policy_[i].nice = fallback.nice;
+        }
+    }
+}
+
+void RdcThreads::setup(RdcThreadClass thread_class, const char* name,
+        int numa_node) {
+    uint32_t tid = syscall(SYS_gettid);
+    char short_name[16];
+    strncpy(short_name, name, sizeof(short_name) - 1);
+    short_name[sizeof(short_name) - 1] = '\0';
+    pthread_setname_np(pthread_self(), short_name);
+
+    const Policy& policy = policy_[thread_class];
+    cpu_set_t cpus;
+    bool has_cpus = policy.has_cpus;
+    if (has_cpus) {
+        cpus = policy.cpus;
+    }
+    if (numa_ && numa_node >= 0 &&
+            static_cast<size_t>(numa_node) < node_cpus_.size()) {
+        cpu_set_t node_cpus = node_cpus_[numa_node];
+        if (has_cpus) {
+            CPU_AND(&node_cpus, &node_cpus, &cpus);
+        }
+        // Keep the CPUs of the class when none is on the node
+        if (CPU_COUNT(&node_cpus) > 0) {
+            cpus = node_cpus;
+            has_cpus = true;
+        } else {
+            RDC_LOG(RDC_DEBUG, name << ": no CPU of NUMA node "
+                    << numa_node << " in the "
+                    << kClassNames[thread_class] << " class");
+        }
+    }
+    if (has_cpus && sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        RDC_LOG(RDC_ERROR, name << ": fail to set the CPU affinity: "
+                << strerror(errno));
+    }
+    if (policy.has_sched && policy.idle) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        int err = pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+        if (err != 0) {
+            RDC_LOG(RDC_ERROR, name << ": fail to set SCHED_IDLE: "
+                    << strerror(err));
+        }
+    } else if (policy.has_sched &&
+            setpriority(PRIO_PROCESS, tid, policy.nice) != 0) {
+        // On Linux the nice level of a thread is set through its id
+        RDC_LOG(RDC_ERROR, name << ": fail to set the nice level "
+                << policy.nice << ": " << strerror(errno));
+    }
+    RDC_LOG(RDC_DEBUG, "Thread " << tid << " " << name << " in the "
+            << kClassNames[thread_class] << " class runs on "
+            << (has_cpus ? CPU_COUNT(&cpus) : 0) << " CPUs");
+
+    thread_record.tid = tid;
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& thread : threads_) {
+        if (thread.tid == tid) {
+            thread.thread_class = thread_class;
+            thread.name = name;
+            return;
+        }
+    }
+    threads_.push_back({tid, thread_class, name});
+}
+
+void RdcThreads::setup_once(RdcThreadClass thread_class, const char* name) {
+    if (thread_record.tid == 0) {
+        setup(thread_class, name);
+    }
+}
+
+void RdcThreads::forget(uint32_t tid) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) {
+        if (it->tid == tid) {
+            threads_.erase(it);
+            return;
+        }
+    }
+}
+
+int RdcThreads::numa_node_of(int cpu) const {
+    for (size_t node = 0; cpu >= 0 && node < node_cpus_.size(); node++) {
+        if (CPU_ISSET(cpu, &node_cpus_[node])) {
+            return static_cast<int>(node);
+        }
+    }
+    return -1;
+}
+
+void RdcThreads::snapshot(std::vector<rdc_perf_metric_t>* metrics) {
+    std::vector<Thread> threads;
+    do {
+        std::lock_guard<std::mutex> guard(mutex_);
+        threads = threads_;
+    } while (0);
+
+    rdc_perf_metric_t metric;
+    for (const auto& thread : threads) {
+        std::string label = thread.name + ":" + std::to_string(thread.tid);
+        int cpu = last_cpu(thread.tid);
+        if (cpu < 0) {
+            continue;  // Exited meanwhile
+        }
+        rdc_perf_metric_init(&metric, "thread_cpu", label, RDC_PERF_GAUGE,
+                cpu);
+        metrics->push_back(metric);
+        int node = numa_node_of(cpu);
+        if (node >= 0) {
+            rdc_perf_metric_init(&metric, "thread_numa_node", label,
+                    RDC_PERF_GAUGE, node);
+            metrics->push_back(metric);
+        }
+        cpu_set_t cpus;
+        if (sched_getaffinity(thread.tid, sizeof(cpus), &cpus) == 0) {
+            rdc_perf_metric_init(&metric, "thread_allowed_cpus", label,
+                    RDC_PERF_GAUGE, CPU_COUNT(&cpus));
+            metrics->push_back(metric);
+        }
+    }
+}
+
+}  // namespace rdc
+}  // namespace amd
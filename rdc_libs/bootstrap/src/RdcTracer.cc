@@ -0,0 +1,205 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/RdcTracer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace amd {
+namespace rdc {
+
+namespace {
+// Gives the ring of a thread back when the thread exits
+struct RdcTraceRingOwner {
+    RdcTraceRingOwner() : ring(nullptr) {}
+    ~RdcTraceRingOwner() {
+        if (ring) {
+            ring->release();
+        }
+    }
+    RdcTraceRing* ring;
+};
+thread_local RdcTraceRingOwner thread_ring;
+
+struct TraceEntry {
+    const char* name;
+    uint32_t tid;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+void append_json_string(std::ostream& os, const char* s) {
+    os << '"';
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            os << '\\';
+        }
+        if (static_cast<unsigned char>(*s) >= 0x20) {
+            os << *s;
+        }
+    }
+    os << '"';
+}
+
+std::string thread_name(uint32_t tid) {
+    std::ifstream comm("/proc/self/task/" + std::to_string(tid) + "/comm");
+    std::string name;
+    std::getline(comm, name);
+    return name;
+}
+}  // namespace
+
+RdcTraceRing::RdcTraceRing(uint32_t size, uint32_t tid):
+    events_(new RdcTraceEvent[size]), size_(size), next_(0), tid_(tid),
+    in_use_(true) {
+}
+
+RdcTracer& RdcTracer::get() {
+    // Never destroyed, threads may still record during the exit
+    static RdcTracer* tracer = new RdcTracer();
+    return *tracer;
+}
+
+RdcTracer::RdcTracer(): enabled_(false), ring_size_(0) {
+    const char* events = getenv(RDC_TRACE_EVENTS_ENV);
+    if (events != nullptr) {
+        ring_size_ = strtoul(events, nullptr, 10);
+    }
+    enabled_.store(ring_size_ > 0, std::memory_order_relaxed);
+}
+
+RdcTraceRing* RdcTracer::acquire_ring() {
+    uint32_t tid = syscall(SYS_gettid);
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& ring : rings_) {
+        if (!ring->in_use_.load(std::memory_order_acquire)) {
+            // The events of the exited thread are kept until overwritten
+            ring->tid_ = tid;
+            ring->in_use_.store(true, std::memory_order_relaxed);
+            return ring.get();
+        }
+    }
+    rings_.emplace_back(new RdcTraceRing(ring_size_, tid));
+    return rings_.back().get();
+}
+
+void RdcTracer::record(const char* name, uint64_t start_ns,
+        uint64_t end_ns) {
+    if (!thread_ring.ring) {
+        thread_ring.ring = acquire_ring();
+    }
+    thread_ring.ring->record(name, start_ns, end_ns);
+}
+
+void RdcTracer::dump(uint64_t last_ms, size_t max_bytes,
+        std::string* trace) {
+    uint64_t now = now_ns();
+    uint64_t since = now > last_ms * 1000000 ? now - last_ms * 1000000 : 0;
+
+    std::vector<TraceEntry> entries;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        for (auto& ring : rings_) {
+            uint64_t end = ring->next_.load(std::memory_order_acquire);
+            uint64_t begin = end > ring->size_ ? end - ring->size_ : 0;
+            size_t first = entries.size();
+            for (uint64_t i = begin; i < end; i++) {
+                const RdcTraceEvent& event = ring->events_[i % ring->size_];
+                TraceEntry entry;
+                entry.name = event.name.load(std::memory_order_relaxed);
+                entry.tid = event.tid.load(std::memory_order_relaxed);
+                entry.start_ns = event.start_ns.load(
+                        std::memory_order_relaxed);
+                entry.duration_ns = event.duration_ns.load(
+                        std::memory_order_relaxed);
+                entries.push_back(entry);
+            }
+            // Drop what the thread may have overwritten while copying
+            uint64_t now_next = ring->next_.load(std::memory_order_acquire);
+            if (now_next >= begin + ring->size_) {
+                uint64_t overwritten = now_next - ring->size_ + 1 - begin;
+                entries.erase(entries.begin() + first,
+                    entries.begin() + first +
+                    std::min<uint64_t>(overwritten, end - begin));
+            }
+        }
+    }
+
+    // The newest events first, so that the size limit drops the oldest
+    std::sort(entries.begin(), entries.end(),
+        [](const TraceEntry& a, const TraceEntry& b) {
+            return a.start_ns + a.duration_ns > b.start_ns + b.duration_ns;
+        });
+
+    std::stringstream os;
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    pid_t pid = getpid();
+    std::vector<uint32_t> tids;
+    bool first = true;
+    char times[64];
+    for (const auto& entry : entries) {
+        if (entry.start_ns + entry.duration_ns < since) {
+            break;
+        }
+        if (max_bytes > 0 && static_cast<size_t>(os.tellp()) > max_bytes) {
+            break;
+        }
+        if (!first) {
+            os << ',';
+        }
+        first = false;
+        os << "{\"name\":";
+        append_json_string(os, entry.name);
+        snprintf(times, sizeof(times), "%.3f,\"dur\":%.3f",
+            entry.start_ns / 1000.0, entry.duration_ns / 1000.0);
+        os << ",\"cat\":\"rdc\",\"ph\":\"X\",\"ts\":" << times
+           << ",\"pid\":" << pid << ",\"tid\":" << entry.tid << '}';
+        if (std::find(tids.begin(), tids.end(), entry.tid) == tids.end()) {
+            tids.push_back(entry.tid);
+        }
+    }
+    // Name the threads which are still running
+    for (uint32_t tid : tids) {
+        std::string name = thread_name(tid);
+        if (name.empty()) {
+            continue;
+        }
+        if (!first) {
+            os << ',';
+        }
+        first = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+        append_json_string(os, name.c_str());
+        os << "}}";
+    }
+    os << "]}";
+    *trace = os.str();
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -21,16 +21,32 @@ THE SOFTWARE.
 */
 #include "rdc_lib/impl/RdcCacheManagerImpl.h"
 #include <sys/time.h>
+#include <algorithm>
 #include <cmath>
 #include <ctime>
+#include <iterator>
 #include <sstream>
 #include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcTracer.h"
 #include "rdc_lib/rdc_common.h"
+#include "common/rdc_fields_supported.h"
 
 
 namespace amd {
 namespace rdc {
 
+RdcCacheManagerImpl::RdcCacheManagerImpl(): perf_(RdcPerfCounters::get()) {
+}
+
+RdcCacheManagerImpl::~RdcCacheManagerImpl() {
+    // Leave the process totals to the other cache managers
+    for (auto& samples : cache_samples_) {
+        perf_.add_cache_usage(-static_cast<int64_t>(samples.second.size()),
+                -static_cast<int64_t>(samples.second.capacity() *
+                                      sizeof(RdcCacheEntry)));
+    }
+}
+
 rdc_status_t RdcCacheManagerImpl::rdc_field_get_value_since(
     uint32_t gpu_index, rdc_field_t field_id, uint64_t since_time_stamp,
     uint64_t *next_since_time_stamp, rdc_field_value* value) {
@@ -38,7 +54,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_value_since(
         return RDC_ST_BAD_PARAMETER;
     }
 
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     RdcFieldKey field{gpu_index, field_id};
     auto cache_samples_ite = cache_samples_.find(field);
     if (cache_samples_ite == cache_samples_.end() ||
@@ -47,7 +63,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_value_since(
     }
 
     // TODO(bill_liu): Optimize it using the binary search
-    auto cache_values = cache_samples_ite->second;
+    const auto& cache_values = cache_samples_ite->second;
     for (auto cache_value=cache_values.begin();
                 cache_value != cache_values.end(); cache_value++) {
         if ( cache_value->last_time >= since_time_stamp ) {
@@ -59,6 +75,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_value_since(
                 *next_since_time_stamp = cache_value->last_time + 1;
             }
             value->ts = cache_value->last_time;
+            value->status = RDC_ST_OK;
             value->type = INTEGER;
             value->value.l_int = cache_value->value;
             value->field_id = field_id;
@@ -70,10 +87,55 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_value_since(
     return RDC_ST_NOT_FOUND;
 }
 
+rdc_status_t RdcCacheManagerImpl::rdc_field_get_values_since(
+    uint32_t gpu_index, rdc_field_t field_id, uint64_t since_time_stamp,
+    uint64_t *next_since_time_stamp, rdc_field_value* values,
+    uint32_t* count) {
+    if (!next_since_time_stamp || !count || (*count > 0 && !values)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    uint32_t capacity = *count;
+    *count = 0;
+    *next_since_time_stamp = since_time_stamp;
+
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
+    RdcFieldKey field{gpu_index, field_id};
+    auto cache_samples_ite = cache_samples_.find(field);
+    if (cache_samples_ite == cache_samples_.end() ||
+             cache_samples_ite->second.size() == 0) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    // The samples are appended in time order
+    const auto& cache_values = cache_samples_ite->second;
+    auto cache_value = std::lower_bound(cache_values.begin(),
+            cache_values.end(), since_time_stamp,
+            [](const RdcCacheEntry& entry, uint64_t ts) {
+                return entry.last_time < ts;
+            });
+    if (cache_value == cache_values.end()) {
+        return RDC_ST_NOT_FOUND;
+    }
+    for (; cache_value != cache_values.end() && *count < capacity;
+                cache_value++) {
+        rdc_field_value* value = &values[(*count)++];
+        value->ts = cache_value->last_time;
+        value->status = RDC_ST_OK;
+        value->type = INTEGER;
+        value->value.l_int = cache_value->value;
+        value->field_id = field_id;
+    }
+    // Continue from the next sample, or after the last one
+    *next_since_time_stamp = cache_value != cache_values.end() ?
+            cache_value->last_time : std::prev(cache_value)->last_time + 1;
+    return *count > 0 ? RDC_ST_OK : RDC_ST_NOT_FOUND;
+}
+
 
 rdc_status_t RdcCacheManagerImpl::evict_cache(uint32_t gpu_index,
     rdc_field_t field_id, uint64_t max_keep_samples, double  max_keep_age) {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RDC_TRACE_SCOPE("evict_cache");
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
 
     RdcFieldKey field{gpu_index, field_id};
     auto cache_samples_ite = cache_samples_.find(field);
@@ -82,12 +144,12 @@ rdc_status_t RdcCacheManagerImpl::evict_cache(uint32_t gpu_index,
         return RDC_ST_NOT_FOUND;
     }
 
-    // Check max_keep_samples
+    // Check max_keep_samples, 0 keeps any number of samples
     auto& cache_values = cache_samples_ite->second;
-    int item_remove = cache_values.size() - max_keep_samples;
-    if (item_remove > 0) {
+    size_t num_samples = cache_values.size();
+    if (max_keep_samples != 0 && num_samples > max_keep_samples) {
        cache_values.erase(cache_values.begin(),
-                cache_values.begin()+item_remove);
+                cache_values.end() - max_keep_samples);
     }
 
     // Check max_keep_age
@@ -103,6 +165,28 @@ rdc_status_t RdcCacheManagerImpl::evict_cache(uint32_t gpu_index,
             ite = cache_values.erase(ite);
         }
     }
+    perf_.add_cache_usage(
+            -static_cast<int64_t>(num_samples - cache_values.size()), 0);
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcCacheManagerImpl::reserve_cache(uint32_t gpu_index,
+    rdc_field_t field_id, uint64_t num_samples) {
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
+    RdcFieldKey field{gpu_index, field_id};
+    auto cache_samples_ite = cache_samples_.find(field);
+    if (cache_samples_ite == cache_samples_.end()) {
+        cache_samples_ite = cache_samples_.insert(
+                {field, std::vector<RdcCacheEntry>()}).first;
+    }
+    auto& cache_values = cache_samples_ite->second;
+    size_t capacity = cache_values.capacity();
+    if (num_samples > capacity) {
+        cache_values.reserve(num_samples);
+        perf_.add_cache_usage(0,
+                (cache_values.capacity() - capacity) * sizeof(RdcCacheEntry));
+    }
 
     return RDC_ST_OK;
 }
@@ -113,7 +197,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_latest_value(
         return RDC_ST_BAD_PARAMETER;
     }
 
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     RdcFieldKey field{gpu_index, field_id};
     auto cache_samples_ite = cache_samples_.find(field);
     if (cache_samples_ite == cache_samples_.end() ||
@@ -123,6 +207,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_latest_value(
 
     auto& cache_value = cache_samples_ite->second.back();
     value->ts = cache_value.last_time;
+    value->status = RDC_ST_OK;
     value->type = INTEGER;
     value->value.l_int = cache_value.value;
     value->field_id = field_id;
@@ -132,7 +217,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_field_get_latest_value(
 
 std::string RdcCacheManagerImpl::get_cache_stats() {
     std::stringstream strstream;
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
 
     strstream << "Cache samples:";
     auto cache_samples_ite = cache_samples_.begin();
@@ -154,6 +239,7 @@ std::string RdcCacheManagerImpl::get_cache_stats() {
 
 rdc_status_t RdcCacheManagerImpl::rdc_update_cache(uint32_t gpu_index,
         const rdc_field_value& value) {
+    RDC_TRACE_SCOPE("cache_update");
     RdcCacheEntry entry;
     entry.last_time = value.ts;
     if (value.type == INTEGER) {
@@ -162,35 +248,57 @@ rdc_status_t RdcCacheManagerImpl::rdc_update_cache(uint32_t gpu_index,
         return RDC_ST_NOT_SUPPORTED;
     }
 
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     RdcFieldKey field{gpu_index, value.field_id};
     auto cache_samples_ite = cache_samples_.find(field);
     if (cache_samples_ite == cache_samples_.end()) {
         std::vector<RdcCacheEntry> ve;
         ve.push_back(entry);
         cache_samples_.insert({field, ve});
+        perf_.add_cache_usage(1, sizeof(RdcCacheEntry));
     } else {
-        cache_samples_ite->second.push_back(entry);
+        auto& cache_values = cache_samples_ite->second;
+        size_t capacity = cache_values.capacity();
+        cache_values.push_back(entry);
+        perf_.add_cache_usage(1,
+                (cache_values.capacity() - capacity) * sizeof(RdcCacheEntry));
     }
 
     return RDC_ST_OK;
 }
 
+void RdcCacheManagerImpl::get_cache_usage(
+        std::vector<rdc_perf_metric_t>* metrics) {
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
+    rdc_perf_metric_t metric;
+    for (auto& samples : cache_samples_) {
+        std::string key = std::to_string(samples.first.first) + ":" +
+                get_field_metric_name(samples.first.second);
+        rdc_perf_metric_init(&metric, "cache_samples", key, RDC_PERF_GAUGE,
+                samples.second.size());
+        metrics->push_back(metric);
+        rdc_perf_metric_init(&metric, "cache_bytes", key, RDC_PERF_GAUGE,
+                samples.second.capacity() * sizeof(RdcCacheEntry));
+        metrics->push_back(metric);
+    }
+}
+
 rdc_status_t RdcCacheManagerImpl::rdc_job_remove(const char job_id[64]) {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     cache_jobs_.erase(job_id);
     return RDC_ST_OK;
 }
 
 rdc_status_t RdcCacheManagerImpl::rdc_job_remove_all() {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     cache_jobs_.clear();
     return RDC_ST_OK;
 }
 
 rdc_status_t RdcCacheManagerImpl::rdc_update_job_stats(uint32_t gpu_index,
     const std::string& job_id, const rdc_field_value& value) {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RDC_TRACE_SCOPE("job_stats_update");
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     auto job_iter = cache_jobs_.find(job_id);
     if (job_iter == cache_jobs_.end()) {
         return RDC_ST_NOT_FOUND;
@@ -272,7 +380,7 @@ void RdcCacheManagerImpl::set_summary(const FieldSummaryStats & stats,
 rdc_status_t RdcCacheManagerImpl::rdc_job_get_stats(const char jobId[64],
         const rdc_gpu_gauges_t& gpu_gauges,
         rdc_job_info_t* p_job_info) {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     auto job_stats = cache_jobs_.find(jobId);
 
     if (job_stats == cache_jobs_.end()) {
@@ -309,39 +417,29 @@ rdc_status_t RdcCacheManagerImpl::rdc_job_get_stats(const char jobId[64],
 
     //< Populate information for each GPUs
 
+    // rdc_job_info_t only has room for the first GPUs; the others still
+    // count towards the summary.
+    const uint32_t max_job_gpus =
+        sizeof(p_job_info->gpus) / sizeof(p_job_info->gpus[0]);
+    rdc_gpu_usage_info_t overflow_info;
     auto gpus = job_stats->second.gpu_stats.begin();
     for (; gpus != job_stats->second.gpu_stats.end(); gpus++) {
-        auto & gpu_info = p_job_info->gpus[gpus->first];
+        auto & gpu_info = gpus->first < max_job_gpus ?
+                p_job_info->gpus[gpus->first] : overflow_info;
         gpu_info.start_time = summary_info.start_time;
         gpu_info.end_time = summary_info.end_time;
         gpu_info.energy_consumed = gpus->second.energy_consumed;
         summary_info.energy_consumed += gpu_info.energy_consumed;
 
-        if (is_job_stopped) {
-            gpu_info.ecc_correct = gpus->second.ecc_correct_init;
-            summary_info.ecc_correct += gpu_info.ecc_correct;
-        } else if (gpu_gauges.find({gpus->first,
-            RDC_FI_ECC_CORRECT_TOTAL}) != gpu_gauges.end()) {
-                gpu_info.ecc_correct = gpu_gauges.at({
-                    gpus->first, RDC_FI_ECC_CORRECT_TOTAL}) -
-                    gpus->second.ecc_correct_init;
-                summary_info.ecc_correct += gpu_info.ecc_correct;
-        } else {
-            gpu_info.ecc_correct = 0;
-        }
+        gpu_info.ecc_correct = get_ecc_count(gpus->first,
+            RDC_FI_ECC_CORRECT_TOTAL, gpus->second.ecc_correct_init,
+            is_job_stopped, gpu_gauges);
+        summary_info.ecc_correct += gpu_info.ecc_correct;
 
-        if (is_job_stopped) {
-            gpu_info.ecc_uncorrect = gpus->second.ecc_uncorrect_init;
-            summary_info.ecc_uncorrect += gpu_info.ecc_uncorrect;
-        } else if (gpu_gauges.find({gpus->first,
-            RDC_FI_ECC_UNCORRECT_TOTAL}) != gpu_gauges.end()) {
-                gpu_info.ecc_uncorrect = gpu_gauges.at({
-                    gpus->first, RDC_FI_ECC_UNCORRECT_TOTAL}) -
-                    gpus->second.ecc_uncorrect_init;
-                summary_info.ecc_uncorrect += gpu_info.ecc_uncorrect;
-        } else {
-            gpu_info.ecc_uncorrect = 0;
-        }
+        gpu_info.ecc_uncorrect = get_ecc_count(gpus->first,
+            RDC_FI_ECC_UNCORRECT_TOTAL, gpus->second.ecc_uncorrect_init,
+            is_job_stopped, gpu_gauges);
+        summary_info.ecc_uncorrect += gpu_info.ecc_uncorrect;
 
         if (gpu_gauges.find({gpus->first,
             RDC_FI_GPU_MEMORY_TOTAL}) == gpu_gauges.end()) {
@@ -397,6 +495,77 @@ rdc_status_t RdcCacheManagerImpl::rdc_job_get_stats(const char jobId[64],
     return RDC_ST_OK;
 }
 
+uint64_t RdcCacheManagerImpl::get_ecc_count(uint32_t gpu_index,
+        rdc_field_t field_id, uint64_t ecc_init, bool is_job_stopped,
+        const rdc_gpu_gauges_t& gpu_gauges) const {
+    // Once the job is stopped, the init counter holds the errors of the job
+    if (is_job_stopped) {
+        return ecc_init;
+    }
+    auto gauge = gpu_gauges.find({gpu_index, field_id});
+    if (gauge == gpu_gauges.end()) {
+        return 0;
+    }
+    return gauge->second - ecc_init;
+}
+
+rdc_status_t RdcCacheManagerImpl::rdc_job_get_moments(const char job_id[64],
+        const rdc_gpu_gauges_t& gpu_gauges,
+        std::vector<rdc_job_gpu_moments_t>* moments) {
+    if (moments == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
+    auto job_stats = cache_jobs_.find(job_id);
+    if (job_stats == cache_jobs_.end()) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    bool is_job_stopped = (job_stats->second.end_time != 0);
+    moments->clear();
+    auto gpus = job_stats->second.gpu_stats.begin();
+    for (; gpus != job_stats->second.gpu_stats.end(); gpus++) {
+        auto tmemory = gpu_gauges.find({gpus->first,
+            RDC_FI_GPU_MEMORY_TOTAL});
+        if (tmemory == gpu_gauges.end()) {
+            RDC_LOG(RDC_ERROR, "Cannot find the total memory");
+            return RDC_ST_BAD_PARAMETER;
+        }
+
+        rdc_job_gpu_moments_t gpu;
+        gpu.gpu_index = gpus->first;
+        gpu.start_time = job_stats->second.start_time;
+        gpu.end_time = is_job_stopped ? job_stats->second.end_time
+            : time(nullptr);
+        gpu.energy_consumed = gpus->second.energy_consumed;
+        gpu.ecc_correct = get_ecc_count(gpus->first,
+            RDC_FI_ECC_CORRECT_TOTAL, gpus->second.ecc_correct_init,
+            is_job_stopped, gpu_gauges);
+        gpu.ecc_uncorrect = get_ecc_count(gpus->first,
+            RDC_FI_ECC_UNCORRECT_TOTAL, gpus->second.ecc_uncorrect_init,
+            is_job_stopped, gpu_gauges);
+        gpu.memory_total = tmemory->second;
+        gpu.num_fields = 0;
+
+        auto ite = gpus->second.field_summaries.begin();
+        for (; ite != gpus->second.field_summaries.end() &&
+                gpu.num_fields < RDC_MAX_JOB_FIELDS; ite++) {
+            rdc_field_moments_t& field = gpu.fields[gpu.num_fields++];
+            field.field_id = static_cast<rdc_field_t>(ite->first);
+            field.count = ite->second.count;
+            field.min_value = ite->second.min_value;
+            field.max_value = ite->second.max_value;
+            // Welford keeps the mean and the sum of squares in old_m/old_s
+            field.mean = ite->second.count > 0 ? ite->second.old_m : 0;
+            field.m2 = ite->second.count > 0 ? ite->second.old_s : 0;
+        }
+        moments->push_back(gpu);
+    }
+
+    return RDC_ST_OK;
+}
+
 void RdcCacheManagerImpl::set_average_summary(
         rdc_stats_summary_t& summary, uint32_t num_gpus) {
     summary.average = summary.average/num_gpus;
@@ -404,40 +573,40 @@ void RdcCacheManagerImpl::set_average_summary(
 }
 
 rdc_status_t RdcCacheManagerImpl::rdc_job_start_stats(const char job_id[64],
-        const rdc_group_info_t& ginfo, const rdc_field_group_info_t& finfo,
+        const RdcGpuGroup& ginfo, const RdcFieldGroup& finfo,
         const rdc_gpu_gauges_t& gpu_gauges) {
      RdcJobStatsCacheEntry cacheEntry;
      cacheEntry.start_time = std::time(nullptr);
      cacheEntry.end_time = 0;
-     for (unsigned int i=0 ; i < ginfo.count; i++) {  // GPUs
+     for (auto gpu_index : ginfo.entity_ids) {  // GPUs
        GpuSummaryStats gstats;
        gstats.energy_consumed = 0;
        gstats.energy_last_time = 0;
-       for (unsigned int j = 0; j < finfo.count; j++) {  // init fields
+       for (auto field_id : finfo.field_ids) {  // init fields
           FieldSummaryStats s;
           s.count = 0;
           s.max_value = s.min_value = s.total_value = 0;
-          gstats.field_summaries.insert({finfo.field_ids[j], s});
+          gstats.field_summaries.insert({field_id, s});
        }
 
        gstats.ecc_correct_init = 0;
-       if (gpu_gauges.find({ginfo.entity_ids[i], RDC_FI_ECC_CORRECT_TOTAL}) !=
+       if (gpu_gauges.find({gpu_index, RDC_FI_ECC_CORRECT_TOTAL}) !=
                gpu_gauges.end()) {
            gstats.ecc_correct_init = gpu_gauges.at(
-                   {ginfo.entity_ids[i], RDC_FI_ECC_CORRECT_TOTAL});
+                   {gpu_index, RDC_FI_ECC_CORRECT_TOTAL});
        }
 
        gstats.ecc_uncorrect_init = 0;
-       if (gpu_gauges.find({ginfo.entity_ids[i], RDC_FI_ECC_UNCORRECT_TOTAL}) !=
+       if (gpu_gauges.find({gpu_index, RDC_FI_ECC_UNCORRECT_TOTAL}) !=
                gpu_gauges.end()) {
            gstats.ecc_uncorrect_init = gpu_gauges.at(
-                   {ginfo.entity_ids[i], RDC_FI_ECC_UNCORRECT_TOTAL});
+                   {gpu_index, RDC_FI_ECC_UNCORRECT_TOTAL});
        }
 
-       cacheEntry.gpu_stats.insert({ginfo.entity_ids[i], gstats});
+       cacheEntry.gpu_stats.insert({gpu_index, gstats});
      }
 
-     std::lock_guard<std::mutex> guard(cache_mutex_);
+     RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
      // Remove the old stats if it exists
      cache_jobs_.erase(job_id);
      cache_jobs_.insert({job_id, cacheEntry});
@@ -447,7 +616,7 @@ rdc_status_t RdcCacheManagerImpl::rdc_job_start_stats(const char job_id[64],
 
 rdc_status_t RdcCacheManagerImpl::rdc_job_stop_stats(const char job_id[64],
             const rdc_gpu_gauges_t& gpu_gauges) {
-    std::lock_guard<std::mutex> guard(cache_mutex_);
+    RdcTimedLockGuard guard(&cache_mutex_, perf_.cache_lock_wait());
     auto job_stats = cache_jobs_.find(job_id);
 
     if (job_stats == cache_jobs_.end()) {
@@ -0,0 +1,141 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcCpuGovernor.h"
+#include <stdlib.h>
+#include <algorithm>
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+namespace {
+//!< The periods are never stretched more than 2^kMaxStretch times
+const uint32_t kMaxStretch = 20;
+//!< How long the CPU time is averaged over
+const int64_t kMinWindowMs = 1000;
+}  // namespace
+
+RdcCpuGovernor::RdcCpuGovernor(double budget_percent):
+    budget_ppm_(static_cast<uint64_t>(budget_percent * 10000))
+    , started_(false)
+    , last_cpu_ns_(0)
+    , exhausted_(false) {
+}
+
+uint64_t RdcCpuGovernor::effective_freq(
+        const RdcGovernedWatch& watch) const {
+    auto it = stretch_.find(watch.priority);
+    if (it == stretch_.end() || watch.max_update_freq <= watch.requested_freq) {
+        return watch.requested_freq;
+    }
+    uint64_t freq = watch.requested_freq;
+    for (uint32_t i = 0; i < it->second && freq < watch.max_update_freq; i++) {
+        freq *= 2;
+    }
+    return std::min(freq, watch.max_update_freq);
+}
+
+bool RdcCpuGovernor::update(uint64_t cpu_ns,
+        const std::vector<RdcGovernedWatch>& watches) {
+    auto now = std::chrono::steady_clock::now();
+    if (!started_) {
+        started_ = true;
+        last_cpu_ns_ = cpu_ns;
+        last_time_ = now;
+        return false;
+    }
+    int64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - last_time_).count();
+    if (elapsed_ns < kMinWindowMs * 1000000) {
+        return false;
+    }
+    uint64_t usage_ppm = (cpu_ns - last_cpu_ns_) * 1000000 / elapsed_ns;
+    last_cpu_ns_ = cpu_ns;
+    last_time_ = now;
+
+    if (usage_ppm > budget_ppm_) {
+        // Stretch the lowest priority which still can be
+        bool found = false;
+        uint32_t priority = 0;
+        for (const auto& watch : watches) {
+            auto it = stretch_.find(watch.priority);
+            uint32_t stretch = it == stretch_.end() ? 0 : it->second;
+            if (effective_freq(watch) < watch.max_update_freq &&
+                    stretch < kMaxStretch &&
+                    (!found || watch.priority < priority)) {
+                found = true;
+                priority = watch.priority;
+            }
+        }
+        if (!found) {
+            if (!exhausted_) {
+                RDC_LOG(RDC_INFO, "The collection takes "
+                    << usage_ppm / 10000.0 << "% of a core, over its budget "
+                    << "of " << budget_ppm_ / 10000.0 << "%, with all the "
+                    << "watches at their max_update_freq");
+                exhausted_ = true;
+            }
+            return false;
+        }
+        uint32_t stretch = ++stretch_[priority];
+        RDC_LOG(RDC_DEBUG, "The collection takes " << usage_ppm / 10000.0
+            << "% of a core, over its budget of " << budget_ppm_ / 10000.0
+            << "%, the watches of priority " << priority
+            << " are now updated up to " << (1U << stretch)
+            << " times less often");
+        return true;
+    }
+    exhausted_ = false;
+
+    if (usage_ppm * 2 < budget_ppm_ && !stretch_.empty()) {
+        // Restore the highest priority first
+        auto it = stretch_.rbegin();
+        uint32_t priority = it->first;
+        uint32_t stretch = --it->second;
+        RDC_LOG(RDC_DEBUG, "The collection takes " << usage_ppm / 10000.0
+            << "% of a core, under half its budget of "
+            << budget_ppm_ / 10000.0 << "%, the watches of priority "
+            << priority << " are now updated up to " << (1U << stretch)
+            << " times less often");
+        if (stretch == 0) {
+            stretch_.erase(priority);
+        }
+        return true;
+    }
+    return false;
+}
+
+RdcCpuGovernorPtr rdc_cpu_governor_from_env() {
+    const char* budget = getenv(RDC_CPU_BUDGET_PERCENT_ENV);
+    if (budget == nullptr || *budget == '\0') {
+        return nullptr;
+    }
+    double percent = strtod(budget, nullptr);
+    if (percent <= 0) {
+        return nullptr;
+    }
+    return RdcCpuGovernorPtr(new RdcCpuGovernor(percent));
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -21,6 +21,8 @@ THE SOFTWARE.
 */
 #include "rdc_lib/impl/RdcEmbeddedHandler.h"
 #include <string.h>
+#include <algorithm>
+#include <vector>
 #include "rdc_lib/impl/RdcMetricFetcherImpl.h"
 #include "rdc_lib/impl/RdcGroupSettingsImpl.h"
 #include "rdc_lib/impl/RdcMetricsUpdaterImpl.h"
@@ -30,6 +32,9 @@ THE SOFTWARE.
 #include "rdc_lib/rdc_common.h"
 #include "rdc_lib/RdcLogger.h"
 #include "rdc_lib/RdcException.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/RdcThreads.h"
+#include "rdc_lib/RdcTracer.h"
 #include "common/rdc_fields_supported.h"
 #include "rocm_smi/rocm_smi.h"
 
@@ -98,20 +103,18 @@ rdc_status_t RdcEmbeddedHandler::rdc_job_start_stats(rdc_gpu_group_t groupId,
 }
 
 rdc_status_t RdcEmbeddedHandler::get_gpu_gauges(rdc_gpu_gauges_t* gpu_gauges) {
-    uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES];
-    uint32_t count = 0;
+    std::vector<uint32_t> gpu_index_list;
 
     if (gpu_gauges == nullptr) {
         return RDC_ST_BAD_PARAMETER;
     }
-    rdc_status_t status = rdc_device_get_all(
-        gpu_index_list, &count);
+    rdc_status_t status = get_all_devices(&gpu_index_list);
     if (status != RDC_ST_OK) {
         return status;
     }
 
     // Fetch total memory and current ecc errors
-    for (uint32_t i = 0; i < count ; i++) {
+    for (uint32_t i = 0; i < gpu_index_list.size() ; i++) {
         rdc_field_value value;
         status = metric_fetcher_->fetch_smi_field(gpu_index_list[i],
                     RDC_FI_GPU_MEMORY_TOTAL, &value);
@@ -152,6 +155,19 @@ rdc_status_t RdcEmbeddedHandler::rdc_job_get_stats(const char job_id[64],
     return cache_mgr_->rdc_job_get_stats(job_id, gpu_gauges, p_job_info);
 }
 
+rdc_status_t RdcEmbeddedHandler::rdc_job_get_moments(const char job_id[64],
+           rdc_job_gpu_moments_t* gpus, uint32_t* count) {
+    rdc_gpu_gauges_t gpu_gauges;
+    rdc_status_t status = get_gpu_gauges(&gpu_gauges);
+    if (status != RDC_ST_OK) return status;
+
+    std::vector<rdc_job_gpu_moments_t> moments;
+    status = cache_mgr_->rdc_job_get_moments(job_id, gpu_gauges, &moments);
+    if (status != RDC_ST_OK) return status;
+
+    return copy_to_ext_array(moments, gpus, count);
+}
+
 rdc_status_t RdcEmbeddedHandler::rdc_job_stop_stats(const char job_id[64]) {
     rdc_gpu_gauges_t gpu_gauges;
     rdc_status_t status = get_gpu_gauges(&gpu_gauges);
@@ -170,27 +186,60 @@ rdc_status_t RdcEmbeddedHandler::rdc_job_remove_all() {
 }
 
 // Discovery API
+rdc_status_t RdcEmbeddedHandler::get_all_devices(
+        std::vector<uint32_t>* gpu_index_list) {
+    rdc_field_value device_count;
+    rdc_status_t status = metric_fetcher_->
+        fetch_smi_field(0, RDC_FI_GPU_COUNT, &device_count);
+    if (status != RDC_ST_OK) {
+        return status;
+    }
+
+    // Assign the index to the index list
+    gpu_index_list->clear();
+    for (int64_t i = 0; i < device_count.value.l_int; i++) {
+        gpu_index_list->push_back(i);
+    }
+
+    return RDC_ST_OK;
+}
+
 rdc_status_t RdcEmbeddedHandler::rdc_device_get_all(
         uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count)  {
     if (!count) {
         return RDC_ST_BAD_PARAMETER;
     }
-    rdc_field_value device_count;
-    rdc_status_t status = metric_fetcher_->
-        fetch_smi_field(0, RDC_FI_GPU_COUNT, &device_count);
+    std::vector<uint32_t> gpus;
+    rdc_status_t status = get_all_devices(&gpus);
     if (status != RDC_ST_OK) {
         return status;
     }
 
-    // Assign the index to the index list
-    *count = device_count.value.l_int;
-    for (uint32_t i=0; i < *count; i++) {
-        gpu_index_list[i] = i;
+    // Only the first RDC_MAX_NUM_DEVICES fit, rdc_device_get_all_ext
+    // returns the rest.
+    *count = std::min<size_t>(gpus.size(), RDC_MAX_NUM_DEVICES);
+    std::copy(gpus.begin(), gpus.begin() + *count, gpu_index_list);
+    if (gpus.size() > RDC_MAX_NUM_DEVICES) {
+        return RDC_ST_MAX_LIMIT;
     }
 
     return RDC_ST_OK;
 }
 
+rdc_status_t RdcEmbeddedHandler::rdc_device_get_all_ext(
+        uint32_t* gpu_index_list, uint32_t* count)  {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    std::vector<uint32_t> gpus;
+    rdc_status_t status = get_all_devices(&gpus);
+    if (status != RDC_ST_OK) {
+        return status;
+    }
+
+    return copy_to_ext_array(gpus, gpu_index_list, count);
+}
+
 rdc_status_t RdcEmbeddedHandler::rdc_device_get_attributes(uint32_t gpu_index,
         rdc_device_attributes_t* p_rdc_attr) {
     if (!p_rdc_attr) {
@@ -221,15 +270,14 @@ rdc_status_t RdcEmbeddedHandler::rdc_group_gpu_create(rdc_group_type_t type,
     }
 
     // Add All GPUs to the group
-    uint32_t count = 0;
-    uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES];
-    status = rdc_device_get_all(
-        gpu_index_list, &count);
+    std::vector<uint32_t> gpu_index_list;
+    status = get_all_devices(&gpu_index_list);
     if (status != RDC_ST_OK) {
         return status;
     }
-    for (uint32_t i=0; i < count; i++) {
-        status = rdc_group_gpu_add(*p_rdc_group_id, gpu_index_list[i]);
+    for (uint32_t i=0; i < gpu_index_list.size(); i++) {
+        status = group_settings_->rdc_group_gpu_add(*p_rdc_group_id,
+                    gpu_index_list[i]);
     }
 
     return status;
@@ -237,22 +285,15 @@ rdc_status_t RdcEmbeddedHandler::rdc_group_gpu_create(rdc_group_type_t type,
 
 rdc_status_t RdcEmbeddedHandler::rdc_group_gpu_add(rdc_gpu_group_t group_id,
                 uint32_t gpu_index) {
-    uint32_t count = 0;
-    uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES];
-    rdc_status_t status = rdc_device_get_all(
-        gpu_index_list, &count);
+    rdc_field_value device_count;
+    rdc_status_t status = metric_fetcher_->
+        fetch_smi_field(0, RDC_FI_GPU_COUNT, &device_count);
     if (status != RDC_ST_OK) {
         return status;
     }
-    bool is_gpu_exist = false;
-    for (uint32_t i=0; i < count; i++) {
-        if (gpu_index_list[i] == gpu_index) {
-            is_gpu_exist = true;
-            break;
-        }
-    }
 
-    if (!is_gpu_exist) {
+    // GPU indexes are 0 to count-1
+    if (gpu_index >= device_count.value.l_int) {
         RDC_LOG(RDC_INFO, "Fail to add GPU index " << gpu_index << " to group "
             << group_id <<" as the GPU index is invalid.");
         return RDC_ST_NOT_FOUND;
@@ -325,6 +366,55 @@ rdc_status_t RdcEmbeddedHandler::rdc_group_field_get_all_ids(
 }
 
 
+rdc_status_t RdcEmbeddedHandler::rdc_group_gpu_get_info_ext(
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    RdcGpuGroupSnapshot ginfo;
+    rdc_status_t status = group_settings_->
+        rdc_group_gpu_get_snapshot(p_rdc_group_id, &ginfo);
+    if (status != RDC_ST_OK) {
+        return status;
+    }
+
+    if (group_name) {
+        strncpy_with_null(group_name, ginfo->group_name.c_str(),
+                RDC_MAX_STR_LENGTH);
+    }
+    return copy_to_ext_array(ginfo->entity_ids, entity_ids, count);
+}
+
+rdc_status_t RdcEmbeddedHandler::rdc_group_get_all_ids_ext(
+        rdc_gpu_group_t* group_id_list, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    std::vector<rdc_gpu_group_t> group_ids;
+    rdc_status_t status = group_settings_->rdc_group_get_all_ids(&group_ids);
+    if (status != RDC_ST_OK) {
+        return status;
+    }
+
+    return copy_to_ext_array(group_ids, group_id_list, count);
+}
+
+rdc_status_t RdcEmbeddedHandler::rdc_group_field_get_all_ids_ext(
+        rdc_field_grp_t* field_group_id_list, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    std::vector<rdc_field_grp_t> field_group_ids;
+    rdc_status_t status = group_settings_->
+        rdc_group_field_get_all_ids(&field_group_ids);
+    if (status != RDC_ST_OK) {
+        return status;
+    }
+
+    return copy_to_ext_array(field_group_ids, field_group_id_list, count);
+}
+
 rdc_status_t RdcEmbeddedHandler::rdc_group_gpu_destroy(
         rdc_gpu_group_t p_rdc_group_id) {
     return group_settings_->rdc_group_gpu_destroy(p_rdc_group_id);
@@ -354,7 +444,13 @@ rdc_status_t RdcEmbeddedHandler::rdc_field_get_latest_value(
                     << field);
         return RDC_ST_NOT_SUPPORTED;
     }
-    return cache_mgr_->rdc_field_get_latest_value(gpu_index, field, value);
+    rdc_status_t status = cache_mgr_->rdc_field_get_latest_value(gpu_index,
+            field, value);
+    // The last value of a GPU which stopped answering is flagged stale
+    if (status == RDC_ST_OK && watch_table_->rdc_gpu_quarantined(gpu_index)) {
+        value->status = RDC_ST_TIMEOUT;
+    }
+    return status;
 }
 
 rdc_status_t RdcEmbeddedHandler::rdc_field_get_value_since(uint32_t gpu_index,
@@ -373,11 +469,45 @@ rdc_status_t RdcEmbeddedHandler::rdc_field_get_value_since(uint32_t gpu_index,
                 since_time_stamp, next_since_time_stamp, value);
 }
 
+rdc_status_t RdcEmbeddedHandler::rdc_field_get_values_since(
+        uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) {
+    if (!next_since_time_stamp || !count || (*count > 0 && !values)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    if (!is_field_valid(field)) {
+        RDC_LOG(RDC_INFO,
+                "Fail to get values since with unknown field id "
+                << field);
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    return cache_mgr_->rdc_field_get_values_since(gpu_index, field,
+                since_time_stamp, next_since_time_stamp, values, count);
+}
+
 rdc_status_t RdcEmbeddedHandler::rdc_field_unwatch(rdc_gpu_group_t group_id,
         rdc_field_grp_t field_group_id) {
     return watch_table_->rdc_field_unwatch(group_id, field_group_id);
 }
 
+rdc_status_t RdcEmbeddedHandler::rdc_field_watch_set_limits(
+        rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
+        uint32_t priority, uint64_t max_update_freq) {
+    return watch_table_->rdc_field_watch_set_limits(group_id,
+            field_group_id, priority, max_update_freq);
+}
+
+rdc_status_t RdcEmbeddedHandler::rdc_field_get_watch_rates(
+        rdc_watch_rate_t* rates, uint32_t* count) {
+    std::vector<rdc_watch_rate_t> all_rates;
+    rdc_status_t result = watch_table_->rdc_field_get_watch_rates(&all_rates);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    return copy_to_ext_array(all_rates, rates, count);
+}
+
 // Control API
 rdc_status_t RdcEmbeddedHandler::rdc_field_update_all(
     uint32_t wait_for_update) {
@@ -387,11 +517,33 @@ rdc_status_t RdcEmbeddedHandler::rdc_field_update_all(
 
     //  Async update the field and return immediately.
     updater_ = std::async(std::launch::async, [this](){
+        RdcThreads::get().setup(RDC_THREAD_COLLECT, "rdc-update");
         watch_table_->rdc_field_update_all();
     });
 
     return RDC_ST_OK;
 }
 
+// Self-telemetry API
+rdc_status_t RdcEmbeddedHandler::rdc_perf_metrics_get(
+    rdc_perf_metric_t* metrics, uint32_t* count) {
+    std::vector<rdc_perf_metric_t> all_metrics;
+    RdcPerfCounters::get().snapshot(&all_metrics);
+    cache_mgr_->get_cache_usage(&all_metrics);
+    RdcThreads::get().snapshot(&all_metrics);
+    return copy_to_ext_array(all_metrics, metrics, count);
+}
+
+rdc_status_t RdcEmbeddedHandler::rdc_trace_get(uint32_t last_seconds,
+    char* buffer, uint32_t* size) {
+    RdcTracer& tracer = RdcTracer::get();
+    if (!tracer.enabled()) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    std::string trace;
+    tracer.dump(last_seconds * 1000ULL, 0, &trace);
+    return rdc_trace_copy(trace, buffer, size);
+}
+
 }  // namespace rdc
 }  // namespace amd
@@ -0,0 +1,505 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcExportPipeline.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <map>
+#include <utility>
+#include "common/rdc_fields_supported.h"
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcThreads.h"
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+static const uint32_t kDefaultExportQueueSize = 65536;
+static const uint32_t kDefaultExportIntervalMs = 1000;
+// Keep the datagrams under the usual MTU
+static const size_t kMaxDatagramSize = 1400;
+// How long a blocked TCP sink may hold the exporter thread
+static const int kSinkSendTimeoutSec = 1;
+
+RdcExportQueue::RdcExportQueue(uint32_t capacity) : head_(0), tail_(0) {
+    uint64_t size = 16;
+    while (size < capacity && size < (1u << 30)) {
+        size <<= 1;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+}
+
+bool RdcExportQueue::push(const RdcExportSample& sample) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+        return false;
+    }
+    slots_[tail & mask_] = sample;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool RdcExportQueue::pop(RdcExportSample* sample) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    *sample = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+namespace {
+
+std::string host_name() {
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "localhost";
+    }
+    return name;
+}
+
+// Unlike std::to_string, does not allocate once out has grown
+void append_uint(uint64_t value, std::string* out) {
+    char number[32];
+    int len = snprintf(number, sizeof(number), "%" PRIu64, value);
+    out->append(number, len);
+}
+
+void append_value(const RdcExportSample& sample, std::string* out) {
+    char number[32];
+    int len;
+    if (sample.type == INTEGER) {
+        len = snprintf(number, sizeof(number), "%" PRId64,
+                       sample.value.l_int);
+    } else {
+        len = snprintf(number, sizeof(number), "%.17g", sample.value.dbl);
+    }
+    out->append(number, len);
+}
+
+// Sends text lines over UDP, packed in datagrams, or over TCP
+class RdcSocketSink : public RdcExportSink {
+ public:
+    RdcSocketSink(const std::string& url, const std::string& address,
+                  bool is_tcp) : url_(url), address_(address),
+                  is_tcp_(is_tcp), fd_(-1) {
+    }
+
+    ~RdcSocketSink() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    rdc_status_t write(const std::vector<RdcExportSample>& batch) override {
+        if (fd_ < 0 && !connect_socket()) {
+            return RDC_ST_FILE_ERROR;
+        }
+
+        buffer_.clear();
+        for (auto& sample : batch) {
+            line_.clear();
+            format(sample, &line_);
+            if (!is_tcp_ && !buffer_.empty() &&
+                    buffer_.size() + line_.size() > kMaxDatagramSize) {
+                if (!send_buffer()) return RDC_ST_FILE_ERROR;
+            }
+            buffer_ += line_;
+        }
+        if (!buffer_.empty() && !send_buffer()) {
+            return RDC_ST_FILE_ERROR;
+        }
+        return RDC_ST_OK;
+    }
+
+    const std::string& name() const override { return url_; }
+
+ protected:
+    //!< Append the line of a value, with its newline
+    virtual void format(const RdcExportSample& sample, std::string* out) = 0;
+
+    //!< The metric name of a field, computed once
+    const std::string& metric_name(rdc_field_t field_id) {
+        auto ite = names_.find(field_id);
+        if (ite == names_.end()) {
+            ite = names_.insert({field_id,
+                    get_field_metric_name(field_id)}).first;
+        }
+        return ite->second;
+    }
+
+ private:
+    bool connect_socket() {
+        std::string host = address_;
+        std::string port;
+        size_t colon = address_.rfind(':');
+        if (colon != std::string::npos) {
+            host = address_.substr(0, colon);
+            port = address_.substr(colon + 1);
+        }
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = is_tcp_ ? SOCK_STREAM : SOCK_DGRAM;
+        struct addrinfo* addrs = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs) != 0) {
+            return false;
+        }
+        for (struct addrinfo* a = addrs; a != nullptr; a = a->ai_next) {
+            int fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC,
+                            a->ai_protocol);
+            if (fd < 0) continue;
+            struct timeval tv = {kSinkSendTimeoutSec, 0};
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+                fd_ = fd;
+                break;
+            }
+            close(fd);
+        }
+        freeaddrinfo(addrs);
+        return fd_ >= 0;
+    }
+
+    bool send_buffer() {
+        size_t sent = 0;
+        while (sent < buffer_.size()) {
+            ssize_t n = send(fd_, buffer_.data() + sent,
+                             buffer_.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && !is_tcp_ && errno == ECONNREFUSED) {
+                // Nobody listens yet, the datagram is lost
+                break;
+            }
+            if (n <= 0) {
+                // Reconnect on the next batch
+                close(fd_);
+                fd_ = -1;
+                return false;
+            }
+            sent += n;
+        }
+        buffer_.clear();
+        return true;
+    }
+
+    std::string url_;
+    std::string address_;
+    bool is_tcp_;
+    int fd_;
+    std::string buffer_;
+    std::string line_;  //!< Kept between writes, like buffer_
+    std::map<rdc_field_t, std::string> names_;
+};
+
+// measurement,host=<host>,gpu_index=<gpu> value=<value> <nsec>
+class RdcInfluxSink : public RdcSocketSink {
+ public:
+    RdcInfluxSink(const std::string& url, const std::string& address,
+                  bool is_tcp) : RdcSocketSink(url, address, is_tcp),
+                  tags_(",host=" + host_name() + ",gpu_index=") {
+    }
+
+ protected:
+    void format(const RdcExportSample& sample, std::string* out) override {
+        *out += metric_name(sample.field_id);
+        *out += tags_;
+        append_uint(sample.gpu_index, out);
+        *out += " value=";
+        append_value(sample, out);
+        if (sample.type == INTEGER) {
+            *out += 'i';
+        }
+        *out += ' ';
+        append_uint(sample.ts * 1000000, out);
+        *out += '\n';
+    }
+
+ private:
+    std::string tags_;
+};
+
+// rdc.<host>.gpu<gpu>.<metric>:<value>|g
+class RdcStatsdSink : public RdcSocketSink {
+ public:
+    RdcStatsdSink(const std::string& url, const std::string& address) :
+        RdcSocketSink(url, address, false) {
+        std::string host = host_name();
+        std::replace(host.begin(), host.end(), '.', '_');
+        prefix_ = "rdc." + host + ".gpu";
+    }
+
+ protected:
+    void format(const RdcExportSample& sample, std::string* out) override {
+        *out += prefix_;
+        append_uint(sample.gpu_index, out);
+        *out += '.';
+        *out += metric_name(sample.field_id);
+        *out += ':';
+        append_value(sample, out);
+        *out += "|g\n";
+    }
+
+ private:
+    std::string prefix_;
+};
+
+// The latest values in the OpenMetrics text format, for the textfile
+// collector of node_exporter. The file is written aside and renamed, so
+// that a reader always sees a complete file.
+class RdcTextfileSink : public RdcExportSink {
+ public:
+    RdcTextfileSink(const std::string& url, const std::string& path) :
+        url_(url), path_(path), tmp_path_(path + ".tmp") {
+    }
+
+    rdc_status_t write(const std::vector<RdcExportSample>& batch) override {
+        for (auto& sample : batch) {
+            latest_[{sample.field_id, sample.gpu_index}] = sample;
+        }
+
+        text_.clear();
+        fld_id2name_map_t& descriptions = get_field_id_description_from_id();
+        uint32_t family = UINT32_MAX;
+        std::string name;
+        for (auto& l : latest_) {
+            if (l.first.first != family) {
+                family = l.first.first;
+                name = get_field_metric_name(
+                        static_cast<rdc_field_t>(family));
+                auto desc = descriptions.find(family);
+                text_ += "# HELP " + name + " " + (desc != descriptions.end()
+                        ? desc->second.description : "") + "\n";
+                text_ += "# TYPE " + name + " gauge\n";
+            }
+            text_ += name + "{gpu_index=\"" +
+                    std::to_string(l.first.second) + "\"} ";
+            append_value(l.second, &text_);
+            text_ += '\n';
+        }
+        text_ += "# EOF\n";
+
+        FILE* file = fopen(tmp_path_.c_str(), "w");
+        if (file == nullptr) {
+            return RDC_ST_FILE_ERROR;
+        }
+        bool written = fwrite(text_.data(), 1, text_.size(), file) ==
+                text_.size();
+        if (fclose(file) != 0 || !written ||
+                rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+            unlink(tmp_path_.c_str());
+            return RDC_ST_FILE_ERROR;
+        }
+        return RDC_ST_OK;
+    }
+
+    const std::string& name() const override { return url_; }
+
+ private:
+    std::string url_;
+    std::string path_;
+    std::string tmp_path_;
+    std::string text_;
+    //!< <field_id, gpu_index>, to write each metric family at once
+    std::map<std::pair<uint32_t, uint32_t>, RdcExportSample> latest_;
+};
+
+}  // namespace
+
+RdcExportSinkPtr rdc_export_sink_create(const std::string& url) {
+    size_t scheme_end = url.find("://");
+    if (scheme_end == std::string::npos) {
+        return nullptr;
+    }
+    std::string scheme = url.substr(0, scheme_end);
+    std::string address = url.substr(scheme_end + 3);
+    if (address.empty()) {
+        return nullptr;
+    }
+
+    if (scheme == "influx-udp" || scheme == "influx") {
+        return RdcExportSinkPtr(new RdcInfluxSink(url, address, false));
+    }
+    if (scheme == "influx-tcp") {
+        return RdcExportSinkPtr(new RdcInfluxSink(url, address, true));
+    }
+    if (scheme == "statsd") {
+        return RdcExportSinkPtr(new RdcStatsdSink(url, address));
+    }
+    if (scheme == "textfile") {
+        return RdcExportSinkPtr(new RdcTextfileSink(url, address));
+    }
+    return nullptr;
+}
+
+RdcExportPipeline::RdcExportPipeline(uint32_t queue_size,
+        uint32_t interval_ms) : queue_(queue_size),
+        interval_ms_(interval_ms), num_queued_(0), num_dropped_(0),
+        num_exported_(0), num_failed_(0), num_dropped_logged_(0),
+        stop_(false) {
+}
+
+RdcExportPipeline::~RdcExportPipeline() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    RDC_LOG(RDC_DEBUG, "Export pipeline: " << num_queued_ << " queued, "
+            << num_dropped_ << " dropped, " << num_exported_
+            << " exported, " << num_failed_ << " failed");
+}
+
+void RdcExportPipeline::add_sink(RdcExportSinkPtr sink) {
+    sinks_.push_back(std::move(sink));
+}
+
+void RdcExportPipeline::start() {
+    thread_ = std::thread(&RdcExportPipeline::run, this);
+}
+
+void RdcExportPipeline::push(uint32_t gpu_index,
+                             const rdc_field_value& value) {
+    if (value.status != RDC_ST_OK ||
+            (value.type != INTEGER && value.type != DOUBLE)) {
+        return;
+    }
+
+    RdcExportSample sample;
+    sample.gpu_index = gpu_index;
+    sample.field_id = value.field_id;
+    sample.type = value.type;
+    sample.ts = value.ts;
+    if (value.type == INTEGER) {
+        sample.value.l_int = value.value.l_int;
+    } else {
+        sample.value.dbl = value.value.dbl;
+    }
+
+    if (queue_.push(sample)) {
+        num_queued_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        num_dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RdcExportPipeline::run() {
+    RdcThreads::get().setup(RDC_THREAD_EXPORT, "rdc-export");
+    std::vector<RdcExportSample> batch;
+    const auto interval = std::chrono::milliseconds(interval_ms_);
+    const auto step = std::chrono::milliseconds(
+            std::min<uint32_t>(interval_ms_, 100));
+    while (!stop_) {
+        auto next = std::chrono::steady_clock::now() + interval;
+        while (!stop_ && std::chrono::steady_clock::now() < next) {
+            std::this_thread::sleep_for(step);
+        }
+        flush(&batch);
+    }
+}
+
+void RdcExportPipeline::flush(std::vector<RdcExportSample>* batch) {
+    batch->clear();
+    RdcExportSample sample;
+    while (queue_.pop(&sample)) {
+        batch->push_back(sample);
+    }
+
+    uint64_t dropped = num_dropped_;
+    if (dropped != num_dropped_logged_) {
+        RDC_LOG(RDC_INFO, "The export queue was full, "
+                << dropped - num_dropped_logged_ << " values dropped");
+        num_dropped_logged_ = dropped;
+    }
+
+    if (batch->empty()) {
+        return;
+    }
+    for (auto& sink : sinks_) {
+        if (sink->write(*batch) == RDC_ST_OK) {
+            num_exported_ += batch->size();
+        } else {
+            num_failed_ += batch->size();
+            RDC_LOG(RDC_DEBUG, "Fail to export " << batch->size()
+                    << " values to " << sink->name());
+        }
+    }
+}
+
+RdcExportPipelinePtr rdc_export_pipeline_from_env() {
+    const char* urls = getenv(RDC_EXPORT_ENV);
+    if (urls == nullptr || *urls == '\0') {
+        return nullptr;
+    }
+
+    uint32_t queue_size = kDefaultExportQueueSize;
+    const char* size = getenv(RDC_EXPORT_QUEUE_ENV);
+    if (size != nullptr && atoi(size) > 0) {
+        queue_size = static_cast<uint32_t>(atoi(size));
+    }
+    uint32_t interval_ms = kDefaultExportIntervalMs;
+    const char* interval = getenv(RDC_EXPORT_INTERVAL_ENV);
+    if (interval != nullptr && atoi(interval) > 0) {
+        interval_ms = static_cast<uint32_t>(atoi(interval));
+    }
+
+    RdcExportPipelinePtr pipeline(
+            new RdcExportPipeline(queue_size, interval_ms));
+    std::string list(urls);
+    size_t start = 0;
+    bool has_sink = false;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string url = list.substr(start, end - start);
+        start = end + 1;
+        if (url.empty()) continue;
+
+        RdcExportSinkPtr sink = rdc_export_sink_create(url);
+        if (!sink) {
+            RDC_LOG(RDC_ERROR, "Invalid export sink " << url);
+            continue;
+        }
+        RDC_LOG(RDC_INFO, "Exporting the fetched values to " << url);
+        pipeline->add_sink(std::move(sink));
+        has_sink = true;
+    }
+    if (!has_sink) {
+        return nullptr;
+    }
+
+    pipeline->start();
+    return pipeline;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,341 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcGpuCollector.h"
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/RdcThreads.h"
+#include "rdc_lib/rdc_common.h"
+#include "rocm_smi/rocm_smi.h"
+
+namespace amd {
+namespace rdc {
+
+static const uint64_t kMinBackoffMs = 1000;
+static const uint64_t kMaxBackoffMs = 60000;
+
+// The timeouts and backoffs do not follow the wall clock
+static uint64_t steady_now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t system_now() {
+    struct timeval  tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+RdcGpuCollector::RdcGpuCollector(uint32_t timeout_ms,
+        rdc_field_value_f callback, void* user_data)
+    : state_(std::make_shared<State>()) {
+    state_->timeout_ms = timeout_ms;
+    state_->stop = false;
+    for (uint32_t i = 0; i < RDC_LANE_COUNT; i++) {
+        state_->sweep[i] = 0;
+        state_->pending[i] = 0;
+    }
+    state_->num_quarantined = 0;
+    for (uint32_t i = 0; i < RDC_MAX_NUM_DEVICES_EXT; i++) {
+        state_->quarantined[i] = false;
+    }
+    state_->closed = false;
+    state_->callback = callback;
+    state_->user_data = user_data;
+}
+
+RdcGpuCollector::~RdcGpuCollector() {
+    do {
+        std::lock_guard<std::mutex> guard(state_->deliver_mutex);
+        state_->closed = true;
+    } while (0);
+
+    std::vector<std::thread*> idle;
+    do {
+        std::lock_guard<std::mutex> guard(state_->mutex);
+        state_->stop = true;
+        for (uint32_t lane = 0; lane < RDC_LANE_COUNT; lane++) {
+            for (auto& worker : state_->workers[lane]) {
+                if (!worker) {
+                    continue;
+                }
+                worker->cv.notify_one();
+                if (worker->busy) {
+                    // Joining would wait for the hung call to return
+                    RDC_LOG(RDC_INFO, "GPU " << worker->gpu_index
+                        << " is still fetching the "
+                        << rdc_lane_name(worker->lane)
+                        << " lane, leave its worker behind");
+                    worker->thread.detach();
+                } else {
+                    idle.push_back(&worker->thread);
+                }
+            }
+        }
+    } while (0);
+    for (auto thread : idle) {
+        thread->join();
+    }
+}
+
+RdcGpuCollector::Worker* RdcGpuCollector::get_worker(uint32_t lane,
+        uint32_t gpu_index) {
+    if (gpu_index >= RDC_MAX_NUM_DEVICES_EXT) {
+        return nullptr;
+    }
+    auto& workers = state_->workers[lane];
+    if (workers.size() <= gpu_index) {
+        workers.resize(gpu_index + 1);
+    }
+    if (!workers[gpu_index]) {
+        Worker* worker = new Worker();
+        worker->lane = lane;
+        worker->gpu_index = gpu_index;
+        worker->busy = false;
+        worker->overdue = false;
+        worker->retry = false;
+        worker->start = 0;
+        worker->sweep = 0;
+        worker->visit = 0;
+        worker->verdict = SKIP;
+        workers[gpu_index].reset(worker);
+        worker->thread = std::thread(run, state_, worker);
+    }
+    return workers[gpu_index].get();
+}
+
+RdcGpuCollector::GpuHealth& RdcGpuCollector::get_health(State* state,
+        uint32_t gpu_index) {
+    if (state->health.size() <= gpu_index) {
+        GpuHealth healthy = {false, 0, 0};
+        state->health.resize(gpu_index + 1, healthy);
+    }
+    return state->health[gpu_index];
+}
+
+void RdcGpuCollector::quarantine(State* state, Worker* worker,
+        uint64_t now) {
+    worker->overdue = true;
+    RdcPerfCounters::get().record_gpu_timeout();
+    GpuHealth& health = get_health(state, worker->gpu_index);
+    if (!health.quarantined) {
+        health.quarantined = true;
+        health.backoff_ms = kMinBackoffMs;
+        health.retry_time = now + health.backoff_ms;
+        state->quarantined[worker->gpu_index] = true;
+        state->num_quarantined++;
+        RdcPerfCounters::get().add_quarantined_gpus(1);
+        RDC_LOG(RDC_ERROR, "GPU " << worker->gpu_index
+            << " did not answer the " << rdc_lane_name(worker->lane)
+            << " lane within " << state->timeout_ms
+            << " ms, its values are stale until it does");
+    } else if (now >= health.retry_time) {  // The retry failed
+        health.backoff_ms = std::min(health.backoff_ms * 2, kMaxBackoffMs);
+        health.retry_time = now + health.backoff_ms;
+        RDC_LOG(RDC_ERROR, "GPU " << worker->gpu_index
+            << " is still not answering, retry in "
+            << health.backoff_ms << " ms");
+    }
+}
+
+void RdcGpuCollector::lift_quarantine(State* state, uint32_t gpu_index) {
+    // Not while another lane is stuck on the GPU
+    for (uint32_t lane = 0; lane < RDC_LANE_COUNT; lane++) {
+        auto& workers = state->workers[lane];
+        if (gpu_index < workers.size() && workers[gpu_index] &&
+                workers[gpu_index]->busy && workers[gpu_index]->overdue) {
+            return;
+        }
+    }
+    GpuHealth& health = get_health(state, gpu_index);
+    if (!health.quarantined) {
+        return;
+    }
+    health.quarantined = false;
+    health.backoff_ms = 0;
+    state->quarantined[gpu_index] = false;
+    state->num_quarantined--;
+    RdcPerfCounters::get().add_quarantined_gpus(-1);
+    RDC_LOG(RDC_INFO, "GPU " << gpu_index << " answers again");
+}
+
+void RdcGpuCollector::check_overdue(uint32_t lane, uint64_t now) {
+    for (auto& worker : state_->workers[lane]) {
+        if (worker && worker->busy && !worker->overdue &&
+                now - worker->start > state_->timeout_ms) {
+            quarantine(state_.get(), worker.get(), now);
+        }
+    }
+}
+
+void RdcGpuCollector::dispatch(uint32_t lane,
+        const RdcTelemetryPtr& telemetry,
+        const std::vector<rdc_gpu_field_t>& fields,
+        std::vector<rdc_gpu_field_t>* stale) {
+    if (lane >= RDC_LANE_COUNT || stale == nullptr) {
+        return;
+    }
+    uint64_t now = steady_now();
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    uint64_t sweep = ++state_->sweep[lane];
+    state_->pending[lane] = 0;
+    std::vector<Worker*>& handed = state_->handed[lane];
+    handed.clear();
+    for (auto& field : fields) {
+        Worker* worker = get_worker(lane, field.gpu_index);
+        if (worker == nullptr) {
+            continue;
+        }
+        if (worker->visit != sweep) {  // The first field of the GPU
+            worker->visit = sweep;
+            GpuHealth& health = get_health(state_.get(), field.gpu_index);
+            if (worker->busy) {
+                if (!worker->overdue &&
+                        now - worker->start > state_->timeout_ms) {
+                    quarantine(state_.get(), worker, now);
+                }
+                worker->verdict = worker->overdue ? STALE : SKIP;
+            } else if (health.quarantined && now < health.retry_time) {
+                worker->verdict = STALE;
+            } else {
+                worker->verdict = FETCH;
+                worker->fields.clear();
+                worker->telemetry = telemetry;
+                worker->retry = health.quarantined;
+                handed.push_back(worker);
+            }
+        }
+        if (worker->verdict == FETCH) {
+            worker->fields.push_back(field);
+        } else if (worker->verdict == STALE) {
+            stale->push_back(field);
+        }
+    }
+
+    for (auto worker : handed) {
+        worker->busy = true;
+        worker->start = now;
+        worker->sweep = sweep;
+        state_->pending[lane]++;
+        worker->cv.notify_one();
+    }
+}
+
+void RdcGpuCollector::wait(uint32_t lane, uint64_t until) {
+    if (lane >= RDC_LANE_COUNT) {
+        return;
+    }
+    uint64_t now = system_now();
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (until > now) {
+        State* state = state_.get();
+        state->done_cv.wait_for(lock, std::chrono::milliseconds(until - now),
+            [state, lane]() { return state->pending[lane] == 0; });
+    }
+    check_overdue(lane, steady_now());
+}
+
+void RdcGpuCollector::run(std::shared_ptr<State> state, Worker* worker) {
+    // Fetch the GPU from the CPUs next to it when asked to
+    RdcThreads& threads = RdcThreads::get();
+    uint32_t numa_node = 0;
+    bool numa = threads.numa_enabled() && rsmi_topo_get_numa_node_number(
+            worker->gpu_index, &numa_node) == RSMI_STATUS_SUCCESS;
+    threads.setup(RDC_THREAD_COLLECT, ("rdc-g" +
+            std::to_string(worker->gpu_index) + "-" +
+            rdc_lane_name(worker->lane)).c_str(),
+            numa ? static_cast<int>(numa_node) : -1);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (true) {
+        worker->cv.wait(lock, [&state, worker]() {
+            return state->stop || worker->busy;
+        });
+        if (state->stop) {
+            return;
+        }
+
+        // The fields are not touched by the lane while the worker is busy
+        RdcTelemetryPtr telemetry = worker->telemetry;
+        lock.unlock();
+        if (telemetry && worker->fields.size() != 0) {
+            RdcPerfCounters& perf = RdcPerfCounters::get();
+            bool measure_cpu = perf.collection_cpu_enabled();
+            uint64_t cpu_start = measure_cpu ? rdc_thread_cpu_ns() : 0;
+            telemetry->rdc_telemetry_fields_value_get(&worker->fields[0],
+                    worker->fields.size(), deliver, state.get());
+            if (measure_cpu) {
+                perf.record_collection_cpu(rdc_thread_cpu_ns() - cpu_start);
+            }
+        }
+        lock.lock();
+
+        uint64_t elapsed = steady_now() - worker->start;
+        worker->busy = false;
+        // Wake the lane once the last worker of its sweep is done
+        if (worker->sweep == state->sweep[worker->lane] &&
+                state->pending[worker->lane] > 0 &&
+                --state->pending[worker->lane] == 0) {
+            state->done_cv.notify_all();
+        }
+        if (worker->overdue) {
+            RDC_LOG(RDC_INFO, "GPU " << worker->gpu_index << " answered the "
+                << rdc_lane_name(worker->lane) << " lane after "
+                << elapsed << " ms");
+            worker->overdue = false;
+        } else if (worker->retry && elapsed <= state->timeout_ms) {
+            lift_quarantine(state.get(), worker->gpu_index);
+        }
+        worker->retry = false;
+    }
+}
+
+rdc_status_t RdcGpuCollector::deliver(rdc_gpu_field_value_t* values,
+        uint32_t num_values, void* user_data) {
+    State* state = static_cast<State*>(user_data);
+    std::lock_guard<std::mutex> guard(state->deliver_mutex);
+    if (state->closed) {
+        return RDC_ST_OK;
+    }
+    return state->callback(values, num_values, state->user_data);
+}
+
+RdcGpuCollectorPtr rdc_gpu_collector_from_env(rdc_field_value_f callback,
+        void* user_data) {
+    const char* timeout = getenv(RDC_GPU_TIMEOUT_MS_ENV);
+    if (timeout == nullptr || *timeout == '\0') {
+        return nullptr;
+    }
+    uint32_t timeout_ms = static_cast<uint32_t>(strtoul(timeout, nullptr, 10));
+    if (timeout_ms == 0) {
+        return nullptr;
+    }
+    return RdcGpuCollectorPtr(
+            new RdcGpuCollector(timeout_ms, callback, user_data));
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -20,6 +20,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "rdc_lib/impl/RdcGroupSettingsImpl.h"
+#include <algorithm>
 #include <ctime>
 #include "rdc_lib/rdc_common.h"
 #include "rdc_lib/RdcLogger.h"
@@ -43,12 +44,11 @@ RdcGroupSettingsImpl::RdcGroupSettingsImpl() {
 rdc_status_t RdcGroupSettingsImpl::rdc_group_gpu_create(
                   const char* group_name, rdc_gpu_group_t* p_rdc_group_id) {
     RDC_LOG(RDC_DEBUG, "Create group " << group_name);
-    rdc_group_info_t ginfo;
-    strncpy_with_null(ginfo.group_name, group_name, RDC_MAX_STR_LENGTH);
-    ginfo.count = 0;
+    std::shared_ptr<RdcGpuGroup> ginfo(new RdcGpuGroup);
+    ginfo->group_name = group_name;
 
     std::lock_guard<std::mutex> guard(group_mutex_);
-    if (gpu_group_.size() >= RDC_MAX_NUM_GROUPS) {
+    if (gpu_group_.size() >= RDC_MAX_NUM_GROUPS_EXT) {
         return RDC_ST_MAX_LIMIT;
     }
     gpu_group_.emplace(cur_group_id_, ginfo);
@@ -71,42 +71,80 @@ rdc_status_t RdcGroupSettingsImpl::rdc_group_gpu_add(
     rdc_gpu_group_t groupId, uint32_t gpu_index ) {
     std::lock_guard<std::mutex> guard(group_mutex_);
     auto ite = gpu_group_.find(groupId);
-    if (ite != gpu_group_.end()) {
-        // Check whether the index already exists
-        for (uint32_t i=0; i < ite->second.count; i++) {
-            if (ite->second.entity_ids[i] == gpu_index) {
-                RDC_LOG(RDC_INFO, "Fail to add " << gpu_index
-                <<" to GPU group " << groupId << " as it is already exists");
-                return RDC_ST_BAD_PARAMETER;
-            }
-        }
-        if (ite->second.count < RDC_GROUP_MAX_ENTITIES) {
-            ite->second.entity_ids[ite->second.count] = gpu_index;
-            ite->second.count++;
-        } else {
-            return RDC_ST_MAX_LIMIT;
-        }
-    } else {
+    if (ite == gpu_group_.end()) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    const std::vector<uint32_t>& ids = ite->second->entity_ids;
+    // Check whether the index already exists
+    if (std::find(ids.begin(), ids.end(), gpu_index) != ids.end()) {
+        RDC_LOG(RDC_INFO, "Fail to add " << gpu_index
+            <<" to GPU group " << groupId << " as it is already exists");
+        return RDC_ST_BAD_PARAMETER;
+    }
+    if (ids.size() >= RDC_GROUP_MAX_ENTITIES_EXT) {
+        return RDC_ST_MAX_LIMIT;
+    }
+
+    // Readers may still hold the old snapshot, so publish a new one.
+    std::shared_ptr<RdcGpuGroup> ginfo(new RdcGpuGroup(*ite->second));
+    ginfo->entity_ids.push_back(gpu_index);
+    ite->second = ginfo;
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcGroupSettingsImpl::rdc_group_gpu_get_snapshot(
+    rdc_gpu_group_t group_id, RdcGpuGroupSnapshot* snapshot) {
+    if (!snapshot) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    std::lock_guard<std::mutex> guard(group_mutex_);
+    auto ite = gpu_group_.find(group_id);
+    if (ite == gpu_group_.end()) {
         return RDC_ST_NOT_FOUND;
     }
+    *snapshot = ite->second;
 
     return RDC_ST_OK;
 }
 
 rdc_status_t RdcGroupSettingsImpl::rdc_group_gpu_get_info(
     rdc_gpu_group_t p_rdc_group_id, rdc_group_info_t* p_rdc_group_info) {
+    RdcGpuGroupSnapshot info;
+    rdc_status_t result = rdc_group_gpu_get_snapshot(p_rdc_group_id, &info);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    // Fill what fits, the callers of the legacy struct see the first GPUs
+    strncpy_with_null(p_rdc_group_info->group_name,
+            info->group_name.c_str(), RDC_MAX_STR_LENGTH);
+    size_t count = std::min<size_t>(info->entity_ids.size(),
+            RDC_GROUP_MAX_ENTITIES);
+    p_rdc_group_info->count = count;
+    std::copy(info->entity_ids.begin(), info->entity_ids.begin() + count,
+            p_rdc_group_info->entity_ids);
+
+    if (info->entity_ids.size() > RDC_GROUP_MAX_ENTITIES) {
+        return RDC_ST_MAX_LIMIT;
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcGroupSettingsImpl::rdc_group_get_all_ids(
+        std::vector<rdc_gpu_group_t>* group_ids) {
+    if (!group_ids) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    group_ids->clear();
     std::lock_guard<std::mutex> guard(group_mutex_);
-    auto ite = gpu_group_.find(p_rdc_group_id);
-    if (ite != gpu_group_.end()) {
-        auto info = ite->second;
-        strncpy_with_null(p_rdc_group_info->group_name,
-                info.group_name, RDC_MAX_STR_LENGTH);
-        p_rdc_group_info->count = info.count;
-        for (uint32_t i=0 ; i < info.count; i++) {
-            p_rdc_group_info->entity_ids[i]= info.entity_ids[i];
-        }
-    } else {
-        return RDC_ST_NOT_FOUND;
+    group_ids->reserve(gpu_group_.size());
+    auto ite = gpu_group_.begin();
+    for (; ite != gpu_group_.end(); ite++) {
+        group_ids->push_back(ite->first);
     }
 
     return RDC_ST_OK;
@@ -118,14 +156,14 @@ rdc_status_t RdcGroupSettingsImpl::rdc_group_get_all_ids(
         return RDC_ST_BAD_PARAMETER;
     }
 
+    std::vector<rdc_gpu_group_t> group_ids;
+    rdc_group_get_all_ids(&group_ids);
     *count = 0;
-    std::lock_guard<std::mutex> guard(group_mutex_);
-    auto ite = gpu_group_.begin();
-    for (; ite != gpu_group_.end(); ite++) {
+    for (auto ite = group_ids.begin(); ite != group_ids.end(); ite++) {
         if (*count >= RDC_MAX_NUM_GROUPS) {
             return RDC_ST_MAX_LIMIT;
         }
-        group_id_list[*count] = ite->first;
+        group_id_list[*count] = *ite;
         (*count)++;
     }
 
@@ -137,19 +175,15 @@ rdc_status_t RdcGroupSettingsImpl::rdc_group_field_create(
     const char* field_group_name, rdc_field_grp_t* rdc_field_group_id) {
 
     RDC_LOG(RDC_DEBUG, "Create field group " << field_group_name);
-    rdc_field_group_info_t finfo;
-    finfo.count = num_field_ids;
-    strncpy_with_null(finfo.group_name, field_group_name, RDC_MAX_STR_LENGTH);
-    if (num_field_ids <= RDC_MAX_FIELD_IDS_PER_FIELD_GROUP) {
-        for (uint32_t i = 0; i < num_field_ids; i++) {
-            finfo.field_ids[i] = field_ids[i];
-        }
-    } else {
+    if (num_field_ids > RDC_MAX_FIELD_IDS_PER_FIELD_GROUP) {
         return RDC_ST_MAX_LIMIT;
     }
+    std::shared_ptr<RdcFieldGroup> finfo(new RdcFieldGroup);
+    finfo->group_name = field_group_name;
+    finfo->field_ids.assign(field_ids, field_ids + num_field_ids);
 
     std::lock_guard<std::mutex> guard(field_group_mutex_);
-    if (field_group_.size() >= RDC_MAX_NUM_FIELD_GROUPS) {
+    if (field_group_.size() >= RDC_MAX_NUM_FIELD_GROUPS_EXT) {
         return RDC_ST_MAX_LIMIT;
     }
     field_group_.emplace(cur_field_group_id_, finfo);
@@ -171,23 +205,58 @@ rdc_status_t RdcGroupSettingsImpl::rdc_group_field_destroy(
     return RDC_ST_OK;
 }
 
+rdc_status_t RdcGroupSettingsImpl::rdc_group_field_get_snapshot(
+    rdc_field_grp_t field_group_id, RdcFieldGroupSnapshot* snapshot) {
+    if (!snapshot) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    std::lock_guard<std::mutex> guard(field_group_mutex_);
+    auto ite = field_group_.find(field_group_id);
+    if (ite == field_group_.end()) {
+        return RDC_ST_NOT_FOUND;
+    }
+    *snapshot = ite->second;
+
+    return RDC_ST_OK;
+}
+
 rdc_status_t RdcGroupSettingsImpl::rdc_group_field_get_info(
     rdc_field_grp_t rdc_field_group_id,
     rdc_field_group_info_t* field_group_info) {
+    RdcFieldGroupSnapshot info;
+    rdc_status_t result = rdc_group_field_get_snapshot(
+            rdc_field_group_id, &info);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    strncpy_with_null(field_group_info->group_name,
+            info->group_name.c_str(), RDC_MAX_STR_LENGTH);
+    field_group_info->count = info->field_ids.size();
+    std::copy(info->field_ids.begin(), info->field_ids.end(),
+            field_group_info->field_ids);
+
+    return RDC_ST_OK;
+}
 
+rdc_status_t RdcGroupSettingsImpl::rdc_group_field_get_all_ids(
+        std::vector<rdc_field_grp_t>* field_group_ids) {
+    if (!field_group_ids) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    field_group_ids->clear();
     std::lock_guard<std::mutex> guard(field_group_mutex_);
-    auto ite = field_group_.find(rdc_field_group_id);
-    if (ite != field_group_.end()) {
-       auto info = ite->second;
-       strncpy_with_null(field_group_info->group_name, info.group_name,
-            RDC_MAX_STR_LENGTH);
-       field_group_info->count = info.count;
-       for (uint32_t i=0 ; i < info.count; i++) {
-           field_group_info->field_ids[i]= info.field_ids[i];
-           }
-    } else {
-        return RDC_ST_NOT_FOUND;
+    field_group_ids->reserve(field_group_.size());
+    auto ite = field_group_.begin();
+    for (; ite != field_group_.end(); ite++) {
+        // Skip system defined JOB_FIELD_ID
+        if (ite->first == JOB_FIELD_ID) continue;
+
+        field_group_ids->push_back(ite->first);
     }
+
     return RDC_ST_OK;
 }
 
@@ -197,18 +266,15 @@ rdc_status_t RdcGroupSettingsImpl::rdc_group_field_get_all_ids(
         return RDC_ST_BAD_PARAMETER;
     }
 
+    std::vector<rdc_field_grp_t> field_group_ids;
+    rdc_group_field_get_all_ids(&field_group_ids);
     *count = 0;
-    std::lock_guard<std::mutex> guard(field_group_mutex_);
-    auto ite = field_group_.begin();
-    for (; ite != field_group_.end(); ite++) {
+    for (auto ite = field_group_ids.begin();
+            ite != field_group_ids.end(); ite++) {
         if (*count >= RDC_MAX_NUM_FIELD_GROUPS) {
             return RDC_ST_MAX_LIMIT;
         }
-
-        // Skip system defined JOB_FIELD_ID
-        if (ite->first == JOB_FIELD_ID) continue;
-
-        field_group_id_list[*count] = ite->first;
+        field_group_id_list[*count] = *ite;
         (*count)++;
     }
 
@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "rdc_lib/rdc_common.h"
 #include "common/rdc_fields_supported.h"
 #include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcThreads.h"
+#include "rdc_lib/RdcTracer.h"
 #include "rocm_smi/rocm_smi.h"
 
 namespace amd {
@@ -59,6 +61,7 @@ RdcMetricFetcherImpl::RdcMetricFetcherImpl() {
 
     // kick off another thread for async fetch
     updater_ = std::async(std::launch::async, [this]() {
+        RdcThreads::get().setup(RDC_THREAD_FETCH, "rdc-fetch");
         while (task_started_) {
             std::unique_lock<std::mutex> lk(task_mutex_);
             // Wait for tasks or stop signal
@@ -188,19 +191,14 @@ void RdcMetricFetcherImpl::get_pcie_throughput(const RdcFieldKey& key) {
     value.value.type = INTEGER;
     do {
         std::lock_guard<std::mutex> guard(task_mutex_);
-        // Create new cache entry it does not exist
+        // Create new cache entry it does not exist. Insert both before
+        // looking them up, as an insert may move the other entry.
+        value.value.field_id = RDC_FI_PCIE_TX;
+        async_metrics_.insert({{gpu_index, RDC_FI_PCIE_TX}, value});
+        value.value.field_id = RDC_FI_PCIE_RX;
+        async_metrics_.insert({{gpu_index, RDC_FI_PCIE_RX}, value});
         auto tx_metric = async_metrics_.find({gpu_index, RDC_FI_PCIE_TX});
-        if (tx_metric == async_metrics_.end()) {
-            tx_metric = async_metrics_.insert(
-                {{gpu_index, RDC_FI_PCIE_TX}, value}).first;
-            tx_metric->second.value.field_id = RDC_FI_PCIE_TX;
-        }
         auto rx_metric = async_metrics_.find({gpu_index, RDC_FI_PCIE_RX});
-        if (rx_metric == async_metrics_.end()) {
-            rx_metric = async_metrics_.insert(
-                {{gpu_index, RDC_FI_PCIE_RX}, value}).first;
-            rx_metric->second.value.field_id = RDC_FI_PCIE_RX;
-        }
 
         // Always update the status and last_time
         tx_metric->second.last_time = curTime;
@@ -233,12 +231,14 @@ rdc_status_t RdcMetricFetcherImpl::fetch_smi_field(uint32_t gpu_index,
     if (!value) {
          return RDC_ST_BAD_PARAMETER;
     }
+    RDC_TRACE_SCOPE("fetch_smi_field");
     uint64_t i64 = 0;
     rsmi_temperature_type_t sensor_type;
     rsmi_clk_type_t clk_type;
     bool async_fetching = false;
     RdcFieldKey f_key(gpu_index, field_id);
     std::shared_ptr<FieldRSMIData> rsmi_data;
+    rsmi_counter_value_t counter_val = {0, 0, 0};
     double coll_time_sec;
 
     if (!is_field_valid(field_id)) {
@@ -252,6 +252,9 @@ rdc_status_t RdcMetricFetcherImpl::fetch_smi_field(uint32_t gpu_index,
     value->status = RSMI_STATUS_NOT_SUPPORTED;
 
     auto read_rsmi_counter = [&](void) {
+      // The lanes fetch concurrently with the watches creating and
+      // destroying the counters
+      std::lock_guard<std::mutex> guard(rsmi_mutex_);
       rsmi_data = get_rsmi_data(f_key);
       if (rsmi_data == nullptr) {
         value->status = RSMI_STATUS_NOT_SUPPORTED;
@@ -262,6 +265,7 @@ rdc_status_t RdcMetricFetcherImpl::fetch_smi_field(uint32_t gpu_index,
                                                      &rsmi_data->counter_val);
       value->value.l_int = rsmi_data->counter_val.value;
       value->type = INTEGER;
+      counter_val = rsmi_data->counter_val;
     };
 
     switch (field_id) {
@@ -362,9 +366,9 @@ rdc_status_t RdcMetricFetcherImpl::fetch_smi_field(uint32_t gpu_index,
          case RDC_EVNT_XGMI_1_THRPUT:
            read_rsmi_counter();
            if (value->status == RDC_ST_OK) {
-             if (rsmi_data->counter_val.time_running > 0) {
+             if (counter_val.time_running > 0) {
                coll_time_sec =
-                 static_cast<float>(rsmi_data->counter_val.time_running)/kGig;
+                 static_cast<float>(counter_val.time_running)/kGig;
                value->value.l_int = (value->value.l_int * 32)/coll_time_sec;
              } else {
                value->value.l_int = 0;
@@ -404,8 +408,7 @@ rdc_status_t RdcMetricFetcherImpl::fetch_smi_field(uint32_t gpu_index,
 
 std::shared_ptr<FieldRSMIData>
 RdcMetricFetcherImpl::get_rsmi_data(RdcFieldKey key) {
-  std::map<RdcFieldKey, std::shared_ptr<FieldRSMIData>>::iterator r_info =
-                                                        rsmi_data_.find(key);
+  auto r_info = rsmi_data_.find(key);
 
   if (r_info != rsmi_data_.end()) {
     return r_info->second;
@@ -464,6 +467,7 @@ static rdc_status_t init_rsmi_counter(RdcFieldKey fk,
 
 rdc_status_t RdcMetricFetcherImpl::delete_rsmi_handle(RdcFieldKey fk) {
   rsmi_status_t ret;
+  std::lock_guard<std::mutex> guard(rsmi_mutex_);
 
   switch (fk.second) {
     case RDC_EVNT_XGMI_0_NOP_TX:
@@ -504,6 +508,7 @@ rdc_status_t RdcMetricFetcherImpl::delete_rsmi_handle(RdcFieldKey fk) {
 
 rdc_status_t RdcMetricFetcherImpl::acquire_rsmi_handle(RdcFieldKey fk) {
   rdc_status_t result;
+  std::lock_guard<std::mutex> guard(rsmi_mutex_);
 
   switch (fk.second) {
     case RDC_EVNT_XGMI_0_NOP_TX:
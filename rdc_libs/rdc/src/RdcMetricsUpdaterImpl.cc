@@ -23,7 +23,10 @@ THE SOFTWARE.
 #include <sys/time.h>
 #include <ctime>
 #include <chrono>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <string>
 #include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcThreads.h"
 
 namespace amd {
 namespace rdc {
@@ -41,17 +44,26 @@ void RdcMetricsUpdaterImpl::start() {
         return;
     }
     started_ = true;
-    updater_ = std::async(std::launch::async, [this](){
-        while (started_) {
-            watch_table_->rdc_field_update_all();
-            std::this_thread::sleep_for(
-                    std::chrono::microseconds(_check_frequency));
-        }
-    });
+    // Each lane sleeps until its next field is due, so a slow fetch in
+    // one lane does not delay the fields of the others.
+    for (uint32_t lane = 0; lane < RDC_LANE_COUNT; lane++) {
+        updater_[lane] = std::async(std::launch::async, [this, lane](){
+            RdcThreads::get().setup(RDC_THREAD_COLLECT,
+                    (std::string("rdc-lane-") + rdc_lane_name(lane)).c_str());
+            while (started_) {
+                uint64_t next_due = 0;
+                watch_table_->rdc_field_update_lane(lane, &next_due);
+                std::this_thread::sleep_for(
+                        std::chrono::microseconds(_check_frequency));
+                watch_table_->rdc_field_wait_lane(lane, next_due);
+            }
+        });
+    }
 }
 
 void RdcMetricsUpdaterImpl::stop() {
     started_ = false;
+    watch_table_->rdc_field_wake_lanes();
 }
 
 }  // namespace rdc
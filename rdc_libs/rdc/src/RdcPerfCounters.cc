@@ -0,0 +1,167 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/RdcPerfCounters.h"
+#include "common/rdc_fields_supported.h"
+
+namespace amd {
+namespace rdc {
+
+RdcPerfCounters& RdcPerfCounters::get() {
+    static RdcPerfCounters counters;
+    return counters;
+}
+
+RdcPerfCounters::RdcPerfCounters()
+    : last_sweep_us_(0)
+    , missed_deadlines_(0)
+    , gpu_timeouts_(0)
+    , quarantined_gpus_(0)
+    , collection_cpu_enabled_(false)
+    , collection_cpu_ns_(0)
+    , stretched_watches_(0)
+    , cache_samples_(0)
+    , cache_bytes_(0) {
+    for (uint32_t i = 0; i < kMaxFieldId; i++) {
+        fetch_latency_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void RdcPerfCounters::record_sweep(uint32_t lane, uint64_t duration_us,
+        uint64_t lateness_us, uint32_t missed_deadlines) {
+    sweep_duration_.record(duration_us);
+    if (lane < RDC_LANE_COUNT) {
+        lane_sweep_duration_[lane].record(duration_us);
+        lane_lateness_[lane].record(lateness_us);
+    }
+    last_sweep_us_.store(duration_us, std::memory_order_relaxed);
+    missed_deadlines_.fetch_add(missed_deadlines, std::memory_order_relaxed);
+}
+
+void RdcPerfCounters::record_fetch(uint32_t field_id, uint64_t duration_us) {
+    if (field_id >= kMaxFieldId) {
+        return;
+    }
+    RdcPerfHistogram* histogram =
+            fetch_latency_[field_id].load(std::memory_order_acquire);
+    if (histogram == nullptr) {
+        RdcPerfHistogram* created = new RdcPerfHistogram();
+        if (fetch_latency_[field_id].compare_exchange_strong(histogram,
+                created, std::memory_order_acq_rel)) {
+            histogram = created;
+        } else {  // Another thread created it first
+            delete created;
+        }
+    }
+    histogram->record(duration_us);
+}
+
+void RdcPerfCounters::fetch_latency(uint32_t field_id, uint64_t* count,
+        uint64_t* median_us) const {
+    *count = 0;
+    *median_us = 0;
+    if (field_id >= kMaxFieldId) {
+        return;
+    }
+    const RdcPerfHistogram* histogram =
+            fetch_latency_[field_id].load(std::memory_order_acquire);
+    if (histogram != nullptr) {
+        *count = histogram->count();
+        *median_us = histogram->median();
+    }
+}
+
+rdc_status_t RdcPerfCounters::get_field_value(rdc_field_t field_id,
+        int64_t* value) const {
+    switch (field_id) {
+        case RDC_FI_RDC_SWEEP_DURATION:
+            *value = last_sweep_us_.load(std::memory_order_relaxed);
+            return RDC_ST_OK;
+        case RDC_FI_RDC_MISSED_DEADLINES:
+            *value = missed_deadlines_.load(std::memory_order_relaxed);
+            return RDC_ST_OK;
+        case RDC_FI_RDC_CACHE_BYTES:
+            *value = cache_bytes_.load(std::memory_order_relaxed);
+            return RDC_ST_OK;
+        case RDC_FI_RDC_CACHE_SAMPLES:
+            *value = cache_samples_.load(std::memory_order_relaxed);
+            return RDC_ST_OK;
+        case RDC_FI_RDC_LOCK_WAIT:
+            *value = cache_lock_wait_.sum() + watch_lock_wait_.sum();
+            return RDC_ST_OK;
+        default:
+            return RDC_ST_NOT_SUPPORTED;
+    }
+}
+
+void RdcPerfCounters::snapshot(
+        std::vector<rdc_perf_metric_t>* metrics) const {
+    rdc_perf_metric_t metric;
+    sweep_duration_.snapshot("sweep_duration_us", "", metrics);
+    rdc_perf_metric_init(&metric, "missed_deadlines", "", RDC_PERF_COUNTER,
+            missed_deadlines_.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+    for (uint32_t i = 0; i < RDC_LANE_COUNT; i++) {
+        lane_sweep_duration_[i].snapshot("lane_sweep_duration_us",
+                rdc_lane_name(i), metrics);
+        lane_lateness_[i].snapshot("lane_lateness_us", rdc_lane_name(i),
+                metrics);
+    }
+
+    for (uint32_t i = 0; i < kMaxFieldId; i++) {
+        const RdcPerfHistogram* histogram =
+                fetch_latency_[i].load(std::memory_order_acquire);
+        if (histogram != nullptr) {
+            histogram->snapshot("fetch_latency_us",
+                    get_field_metric_name(static_cast<rdc_field_t>(i)),
+                    metrics);
+        }
+    }
+
+    rdc_perf_metric_init(&metric, "gpu_timeouts", "", RDC_PERF_COUNTER,
+            gpu_timeouts_.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+    rdc_perf_metric_init(&metric, "quarantined_gpus", "", RDC_PERF_GAUGE,
+            quarantined_gpus_.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+    if (collection_cpu_enabled()) {
+        rdc_perf_metric_init(&metric, "collection_cpu_us", "",
+                RDC_PERF_COUNTER,
+                collection_cpu_ns_.load(std::memory_order_relaxed) / 1000);
+        metrics->push_back(metric);
+        rdc_perf_metric_init(&metric, "stretched_watches", "", RDC_PERF_GAUGE,
+                stretched_watches_.load(std::memory_order_relaxed));
+        metrics->push_back(metric);
+    }
+
+    rdc_perf_metric_init(&metric, "cache_samples", "", RDC_PERF_GAUGE,
+            cache_samples_.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+    rdc_perf_metric_init(&metric, "cache_bytes", "", RDC_PERF_GAUGE,
+            cache_bytes_.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+
+    cache_lock_wait_.snapshot("lock_wait_us", "cache_mutex", metrics);
+    watch_lock_wait_.snapshot("lock_wait_us", "watch_mutex", metrics);
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,108 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <sys/time.h>
+#include <algorithm>
+#include <vector>
+#include "rdc_lib/impl/RdcPerfLib.h"
+
+namespace amd {
+namespace rdc {
+
+RdcPerfLib::RdcPerfLib(): perf_(RdcPerfCounters::get()) {
+}
+
+rdc_status_t RdcPerfLib::rdc_telemetry_fields_value_get(
+            rdc_gpu_field_t* fields, uint32_t fields_count,
+            rdc_field_value_f callback, void*  user_data) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    struct timeval  tv;
+    gettimeofday(&tv, NULL);
+    uint64_t now = static_cast<uint64_t>(tv.tv_sec)*1000+tv.tv_usec/1000;
+
+    const int BULK_FIELDS_MAX = 16;
+    rdc_gpu_field_value_t values[BULK_FIELDS_MAX];
+    uint32_t bulk_count = 0;
+    for (uint32_t i = 0; i < fields_count; i++) {
+        if (bulk_count >= BULK_FIELDS_MAX) {
+            rdc_status_t status = callback(values, bulk_count, user_data);
+            // When the callback returns errors, stop processing and return.
+            if (status != RDC_ST_OK) {
+                return status;
+            }
+            bulk_count = 0;
+        }
+        rdc_field_value* value = &(values[bulk_count].field_value);
+        values[bulk_count].gpu_index = fields[i].gpu_index;
+        value->field_id = fields[i].field_id;
+        value->type = INTEGER;
+        value->ts = now;
+        value->status = perf_.get_field_value(fields[i].field_id,
+                &value->value.l_int);
+        bulk_count++;
+    }
+    if (bulk_count != 0) {
+        rdc_status_t status = callback(values, bulk_count, user_data);
+        if (status != RDC_ST_OK) {
+            return status;
+        }
+    }
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcPerfLib::rdc_telemetry_fields_watch(rdc_gpu_field_t* fields,
+      uint32_t fields_count) {
+    // The counters are always kept
+    (void)fields;
+    (void)fields_count;
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcPerfLib::rdc_telemetry_fields_unwatch(rdc_gpu_field_t* fields,
+      uint32_t fields_count) {
+    (void)fields;
+    (void)fields_count;
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcPerfLib::rdc_telemetry_fields_query(
+    uint32_t field_ids[MAX_NUM_FIELDS], uint32_t* field_count) {
+    if (field_count == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    const std::vector<uint32_t> fields{
+            RDC_FI_RDC_SWEEP_DURATION, RDC_FI_RDC_MISSED_DEADLINES,
+            RDC_FI_RDC_CACHE_BYTES, RDC_FI_RDC_CACHE_SAMPLES,
+            RDC_FI_RDC_LOCK_WAIT
+    };
+    std::copy(fields.begin(), fields.end(), field_ids);
+    *field_count = fields.size();
+
+    return RDC_ST_OK;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,281 @@
+#include "rdc_lib/impl/RdcPrometheusExporter.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "common/rdc_fields_supported.h"
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcThreads.h"
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+// How long a scraper may take to send its request or read the metrics
+static const int kScrapeTimeoutSec = 5;
+// How often the server thread checks whether it should stop
+static const int kPollIntervalMs = 200;
+
+RdcPrometheusExporter::RdcPrometheusExporter() : dirty_(false), front_(0),
+    listen_fd_(-1), stop_(false) {
+    buffers_[0].readers = 0;
+    buffers_[1].readers = 0;
+}
+
+RdcPrometheusExporter::~RdcPrometheusExporter() {
+    stop_ = true;
+    if (server_thread_.joinable()) {
+        server_thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+    }
+}
+
+rdc_status_t RdcPrometheusExporter::listen(const std::string& address) {
+    if (listen_fd_ >= 0) {
+        return RDC_ST_ALREADY_EXIST;
+    }
+
+    // port, address:port or [address]:port
+    std::string host;
+    std::string port = address;
+    size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    struct addrinfo* addrs = nullptr;
+    int ret = getaddrinfo(host.empty() ? nullptr : host.c_str(),
+                          port.c_str(), &hints, &addrs);
+    if (ret != 0) {
+        RDC_LOG(RDC_ERROR, "Cannot resolve the Prometheus address "
+                << address << ": " << gai_strerror(ret));
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    for (struct addrinfo* a = addrs; a != nullptr; a = a->ai_next) {
+        int fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC,
+                        a->ai_protocol);
+        if (fd < 0) continue;
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, a->ai_addr, a->ai_addrlen) == 0 &&
+                ::listen(fd, SOMAXCONN) == 0) {
+            listen_fd_ = fd;
+            break;
+        }
+        close(fd);
+    }
+    freeaddrinfo(addrs);
+
+    if (listen_fd_ < 0) {
+        RDC_LOG(RDC_ERROR, "Cannot listen for Prometheus on " << address
+                << ": " << strerror(errno));
+        return RDC_ST_FAIL_LOAD_MODULE;
+    }
+
+    server_thread_ = std::thread(&RdcPrometheusExporter::serve, this);
+    RDC_LOG(RDC_INFO, "Serving Prometheus metrics on " << address);
+    return RDC_ST_OK;
+}
+
+void RdcPrometheusExporter::update(uint32_t gpu_index,
+                                   const rdc_field_value& value) {
+    auto key = std::make_pair(static_cast<uint32_t>(value.field_id),
+                              gpu_index);
+    auto ite = metrics_.find(key);
+    if (ite == metrics_.end()) {
+        if (value.status != RDC_ST_OK || (value.type != INTEGER &&
+                value.type != DOUBLE)) {
+            return;
+        }
+
+        // The metric names of the Python Prometheus plugin
+        std::string name = get_field_metric_name(value.field_id);
+        std::string help;
+        fld_id2name_map_t& descriptions =
+                get_field_id_description_from_id();
+        auto desc = descriptions.find(value.field_id);
+        if (desc != descriptions.end()) {
+            help = desc->second.description;
+        }
+        if (families_.find(key.first) == families_.end()) {
+            families_[key.first] = "# HELP " + name + " " + help +
+                    "\n# TYPE " + name + " gauge\n";
+        }
+
+        Metric metric;
+        metric.line_prefix = name + "{gpu_index=\"" +
+                std::to_string(gpu_index) + "\"} ";
+        ite = metrics_.insert({key, metric}).first;
+    }
+
+    Metric& metric = ite->second;
+    metric.valid = (value.status == RDC_ST_OK &&
+            (value.type == INTEGER || value.type == DOUBLE));
+    metric.type = value.type;
+    if (value.type == INTEGER) {
+        metric.l_int = value.value.l_int;
+    } else if (value.type == DOUBLE) {
+        metric.dbl = value.value.dbl;
+    }
+    dirty_ = true;
+}
+
+void RdcPrometheusExporter::invalidate(uint32_t gpu_index,
+                                       rdc_field_t field_id) {
+    if (metrics_.erase({static_cast<uint32_t>(field_id), gpu_index}) > 0) {
+        dirty_ = true;
+    }
+}
+
+void RdcPrometheusExporter::render() {
+    if (!dirty_) {
+        return;
+    }
+
+    uint32_t back = 1 - front_.load();
+    Buffer& buffer = buffers_[back];
+    if (buffer.readers.load() != 0) {
+        return;
+    }
+
+    // The buffer keeps its capacity, so it stops growing after the first
+    // sweeps.
+    buffer.text.clear();
+    uint32_t family = UINT32_MAX;
+    for (auto& m : metrics_) {
+        const Metric& metric = m.second;
+        if (!metric.valid) continue;
+        if (m.first.first != family) {
+            family = m.first.first;
+            buffer.text += families_[family];
+        }
+        buffer.text += metric.line_prefix;
+        char number[32];
+        int len;
+        if (metric.type == INTEGER) {
+            len = snprintf(number, sizeof(number), "%" PRId64 "\n",
+                           metric.l_int);
+        } else {
+            len = snprintf(number, sizeof(number), "%.17g\n", metric.dbl);
+        }
+        buffer.text.append(number, len);
+    }
+
+    front_.store(back);
+    dirty_ = false;
+}
+
+void RdcPrometheusExporter::serve() {
+    RdcThreads::get().setup(RDC_THREAD_EXPORT, "rdc-prometheus");
+    struct pollfd pfd;
+    pfd.fd = listen_fd_;
+    pfd.events = POLLIN;
+    while (!stop_) {
+        pfd.revents = 0;
+        if (poll(&pfd, 1, kPollIntervalMs) <= 0) {
+            continue;
+        }
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        struct timeval tv = {kScrapeTimeoutSec, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        send_metrics(fd);
+        close(fd);
+    }
+}
+
+void RdcPrometheusExporter::send_metrics(int fd) {
+    // Read the request headers; only the request line matters
+    char request[2048];
+    size_t size = 0;
+    while (size < sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + size, sizeof(request) - 1 - size, 0);
+        if (n <= 0) {
+            return;
+        }
+        size += n;
+        request[size] = '\0';
+        if (strstr(request, "\r\n\r\n") != nullptr) {
+            break;
+        }
+    }
+
+    bool is_get = strncmp(request, "GET ", 4) == 0;
+    bool is_head = strncmp(request, "HEAD ", 5) == 0;
+    const char* path = request + (is_head ? 5 : 4);
+    bool is_metrics = (is_get || is_head) &&
+        (strncmp(path, "/metrics ", 9) == 0 ||
+         strncmp(path, "/metrics?", 9) == 0);
+
+    char header[256];
+    int len;
+    if (!is_metrics) {
+        len = snprintf(header, sizeof(header), "HTTP/1.1 404 Not Found\r\n"
+                "Content-Length: 0\r\nConnection: close\r\n\r\n");
+        send(fd, header, len, MSG_NOSIGNAL);
+        return;
+    }
+
+    // Pin the current buffer so that the sweep does not render into it
+    uint32_t front;
+    while (true) {
+        front = front_.load();
+        buffers_[front].readers++;
+        if (front_.load() == front) break;
+        buffers_[front].readers--;
+    }
+    const std::string& text = buffers_[front].text;
+
+    len = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: %zu\r\nConnection: close\r\n\r\n", text.size());
+    if (send(fd, header, len, MSG_NOSIGNAL | (is_head ? 0 : MSG_MORE))
+            == len && !is_head) {
+        size_t sent = 0;
+        while (sent < text.size()) {
+            ssize_t n = send(fd, text.data() + sent, text.size() - sent,
+                             MSG_NOSIGNAL);
+            if (n <= 0) break;
+            sent += n;
+        }
+    }
+
+    buffers_[front].readers--;
+}
+
+RdcPrometheusExporterPtr rdc_prometheus_exporter_from_env() {
+    const char* address = getenv(RDC_PROMETHEUS_LISTEN_ENV);
+    if (address == nullptr || *address == '\0') {
+        return nullptr;
+    }
+
+    RdcPrometheusExporterPtr exporter(new RdcPrometheusExporter());
+    if (exporter->listen(address) != RDC_ST_OK) {
+        return nullptr;
+    }
+    return exporter;
+}
+
+}  // namespace rdc
+}  // namespace amd
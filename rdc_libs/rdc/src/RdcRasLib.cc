@@ -70,6 +70,7 @@ rdc_status_t RdcRasLib::rdc_telemetry_fields_value_get(
     if (!fields_value_get_) {
         return RDC_ST_FAIL_LOAD_MODULE;
     }
+    std::lock_guard<std::mutex> guard(fetch_mutex_);
     rdc_status_t status = fields_value_get_(fields,
                 fields_count, callback, user_data);
     RDC_LOG(RDC_DEBUG, "Bulk fetched " << fields_count << " fields from RAS: "
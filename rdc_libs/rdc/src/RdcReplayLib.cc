@@ -0,0 +1,243 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcReplayLib.h"
+#include <string.h>
+#include <sys/time.h>
+#include <fstream>
+#include <iterator>
+#include "rdc_lib/RdcLogger.h"
+
+namespace amd {
+namespace rdc {
+
+RdcReplayLib::RdcReplayLib(const std::string& file_name, double speed):
+    speed_(speed > 0 ? speed : 1.0)
+    , cursor_(0)
+    , replay_start_(now()) {
+    if (!load(file_name)) {
+        sweeps_.clear();
+        field_ids_.clear();
+    }
+}
+
+uint64_t RdcReplayLib::now() {
+    struct timeval  tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+uint32_t RdcReplayLib::get_num_sweeps() const {
+    return sweeps_.size();
+}
+
+// Read the whole file and index the sweeps. The values are decoded only
+// when the sweep is replayed.
+bool RdcReplayLib::load(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::binary);
+    if (!file.is_open()) {
+        RDC_LOG(RDC_ERROR, "Fail to open the replay file " << file_name);
+        return false;
+    }
+    data_.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+
+    RdcCaptureFileHeader header;
+    if (data_.size() < sizeof(header)) {
+        RDC_LOG(RDC_ERROR, "The replay file " << file_name << " is empty");
+        return false;
+    }
+    memcpy(&header, &data_[0], sizeof(header));
+    if (strncmp(header.magic, RDC_CAPTURE_MAGIC, sizeof(header.magic)) != 0
+            || header.version != RDC_CAPTURE_VERSION) {
+        RDC_LOG(RDC_ERROR, "The file " << file_name
+            << " is not a supported capture file");
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset + sizeof(RdcCaptureSweepHeader) <= data_.size()) {
+        RdcCaptureSweepHeader sweep_header;
+        memcpy(&sweep_header, &data_[offset], sizeof(sweep_header));
+        offset += sizeof(sweep_header);
+        if (offset + sweep_header.size > data_.size()) {
+            RDC_LOG(RDC_INFO, "Ignore the truncated sweep at the end of "
+                << file_name);
+            break;
+        }
+
+        ReplaySweep sweep = {sweep_header.ts, sweep_header.count, offset};
+        size_t value_offset = offset;
+        size_t sweep_end = offset + sweep_header.size;
+        for (uint32_t i = 0; i < sweep.count; i++) {
+            RdcCaptureValue v;
+            if (value_offset + sizeof(v) > sweep_end) {
+                RDC_LOG(RDC_ERROR, "The replay file " << file_name
+                    << " is corrupted");
+                return false;
+            }
+            memcpy(&v, &data_[value_offset], sizeof(v));
+            value_offset += sizeof(v) + v.str_len;
+            if (value_offset > sweep_end ||
+                    v.str_len >= RDC_MAX_STR_LENGTH) {
+                RDC_LOG(RDC_ERROR, "The replay file " << file_name
+                    << " is corrupted");
+                return false;
+            }
+            field_ids_.insert(v.field_id);
+        }
+        sweeps_.push_back(sweep);
+        offset += sweep_header.size;
+    }
+
+    RDC_LOG(RDC_INFO, "Loaded " << sweeps_.size() << " sweeps of "
+        << field_ids_.size() << " fields from " << file_name);
+    return sweeps_.size() > 0;
+}
+
+void RdcReplayLib::apply_sweep(const ReplaySweep& sweep) {
+    size_t offset = sweep.offset;
+    for (uint32_t i = 0; i < sweep.count; i++) {
+        RdcCaptureValue v;
+        memcpy(&v, &data_[offset], sizeof(v));
+        offset += sizeof(v);
+
+        rdc_field_value& value = latest_values_[
+            RdcFieldKey(v.gpu_index, static_cast<rdc_field_t>(v.field_id))];
+        value.field_id = static_cast<rdc_field_t>(v.field_id);
+        value.status = v.status;
+        value.type = static_cast<rdc_field_type_t>(v.type);
+        if (value.type == STRING) {
+            memcpy(value.value.str, &data_[offset], v.str_len);
+            value.value.str[v.str_len] = '\0';
+        } else {
+            memcpy(&value.value, &v.value, sizeof(v.value));
+        }
+        offset += v.str_len;
+    }
+}
+
+// Apply all sweeps captured before the current replay time
+void RdcReplayLib::advance(uint64_t now) {
+    if (sweeps_.size() == 0) {
+        return;
+    }
+    uint64_t first_ts = sweeps_[0].ts;
+    uint64_t replay_ts = first_ts +
+            static_cast<uint64_t>((now - replay_start_) * speed_);
+    while (cursor_ < sweeps_.size() && sweeps_[cursor_].ts <= replay_ts) {
+        apply_sweep(sweeps_[cursor_]);
+        cursor_++;
+    }
+    if (cursor_ == sweeps_.size()) {
+        RDC_LOG(RDC_DEBUG, "Reach the end of the replay file, restart");
+        cursor_ = 0;
+        replay_start_ = now;
+    }
+}
+
+rdc_status_t RdcReplayLib::rdc_telemetry_fields_value_get(
+            rdc_gpu_field_t* fields, uint32_t fields_count,
+            rdc_field_value_f callback, void*  user_data) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    const int BULK_FIELDS_MAX = 16;
+    rdc_gpu_field_value_t values[BULK_FIELDS_MAX];
+    uint32_t bulk_count = 0;
+    uint64_t cur_time = now();
+
+    std::lock_guard<std::mutex> guard(replay_mutex_);
+    advance(cur_time);
+    for (uint32_t i = 0; i < fields_count; i++) {
+        if (bulk_count >= BULK_FIELDS_MAX) {
+            rdc_status_t status = callback(values, bulk_count, user_data);
+            // When the callback returns errors, stop processing and return.
+            if (status != RDC_ST_OK) {
+                return status;
+            }
+            bulk_count = 0;
+        }
+        values[bulk_count].gpu_index = fields[i].gpu_index;
+        rdc_field_value* value = &(values[bulk_count].field_value);
+        auto ite = latest_values_.find(
+                RdcFieldKey(fields[i].gpu_index, fields[i].field_id));
+        if (ite != latest_values_.end()) {
+            *value = ite->second;
+        } else {
+            value->field_id = fields[i].field_id;
+            value->status = RDC_ST_NO_DATA;
+            value->type = INTEGER;
+        }
+        // The replayed values are fresh samples for the cache
+        value->ts = cur_time;
+        bulk_count++;
+    }
+    if (bulk_count != 0) {
+        rdc_status_t status = callback(values, bulk_count, user_data);
+        if (status != RDC_ST_OK) {
+            return status;
+        }
+    }
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcReplayLib::rdc_telemetry_fields_watch(rdc_gpu_field_t* fields,
+      uint32_t fields_count) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    (void)fields_count;
+    return RDC_ST_NOT_SUPPORTED;
+}
+
+rdc_status_t RdcReplayLib::rdc_telemetry_fields_unwatch(
+      rdc_gpu_field_t* fields, uint32_t fields_count) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    (void)fields_count;
+    return RDC_ST_NOT_SUPPORTED;
+}
+
+// Only the fields in the capture file are replayed
+rdc_status_t RdcReplayLib::rdc_telemetry_fields_query(
+     uint32_t field_ids[MAX_NUM_FIELDS],
+    uint32_t* field_count) {
+    if (field_count == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    *field_count = 0;
+    for (auto id : field_ids_) {
+        if (*field_count >= MAX_NUM_FIELDS) {
+            break;
+        }
+        field_ids[(*field_count)++] = id;
+    }
+
+    return RDC_ST_OK;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,206 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcShmPublisher.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+// Readers may read the segment, only rdcd writes it
+static const mode_t kShmMode = 0640;
+
+RdcShmPublisher::RdcShmPublisher() : base_(nullptr), size_(0),
+    header_(nullptr), slots_(nullptr), max_keys_(0) {
+}
+
+RdcShmPublisher::~RdcShmPublisher() {
+    if (base_ != nullptr) {
+        // The readers which still map it stop reading it
+        header_->magic.store(0, std::memory_order_release);
+        munmap(base_, size_);
+        shm_unlink(name_.c_str());
+    }
+}
+
+rdc_status_t RdcShmPublisher::open(const std::string& name,
+                                   uint32_t capacity) {
+    if (base_ != nullptr || name.size() < 2 || name[0] != '/') {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    uint32_t slots = 16;
+    while (slots < capacity && slots < (1u << 30)) {
+        slots <<= 1;
+    }
+
+    // A segment left by an rdcd which did not exit cleanly
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, kShmMode);
+    if (fd < 0) {
+        RDC_LOG(RDC_ERROR, "Fail to create the shared memory " << name
+                << ": " << strerror(errno));
+        return RDC_ST_PERM_ERROR;
+    }
+    fchmod(fd, kShmMode);
+
+    size_t size = rdc_shm_size(slots);
+    if (ftruncate(fd, size) != 0) {
+        RDC_LOG(RDC_ERROR, "Fail to size the shared memory " << name
+                << ": " << strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return RDC_ST_INSUFF_RESOURCES;
+    }
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return RDC_ST_INSUFF_RESOURCES;
+    }
+
+    // ftruncate zero fills the segment
+    name_ = name;
+    base_ = base;
+    size_ = size;
+    header_ = new (base) RdcShmHeader;
+    slots_ = rdc_shm_slots(base);
+    for (uint32_t i = 0; i < slots; i++) {
+        RdcShmSlot* slot = new (&slots_[i]) RdcShmSlot;
+        slot->key.store(kRdcShmEmptyKey, std::memory_order_relaxed);
+        slot->seq.store(0, std::memory_order_relaxed);
+    }
+    // Keep the table sparse so that the probes stay short
+    max_keys_ = slots / 4 * 3;
+
+    header_->version = kRdcShmVersion;
+    header_->capacity = slots;
+    header_->slot_size = sizeof(RdcShmSlot);
+    header_->writer_pid = getpid();
+    header_->num_keys.store(0, std::memory_order_relaxed);
+    header_->dropped_keys.store(0, std::memory_order_relaxed);
+    header_->magic.store(kRdcShmMagic, std::memory_order_release);
+
+    RDC_LOG(RDC_INFO, "Publish the latest values to the shared memory "
+            << name << " with " << slots << " slots");
+    return RDC_ST_OK;
+}
+
+RdcShmSlot* RdcShmPublisher::find_slot(uint64_t key, bool claim) {
+    uint32_t mask = header_->capacity - 1;
+    uint32_t index = static_cast<uint32_t>(rdc_hash_key(key)) & mask;
+    while (true) {
+        RdcShmSlot* slot = &slots_[index];
+        uint64_t k = slot->key.load(std::memory_order_relaxed);
+        if (k == key) {
+            return slot;
+        }
+        if (k == kRdcShmEmptyKey) {
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    if (!claim) {
+        return nullptr;
+    }
+    if (header_->num_keys.load(std::memory_order_relaxed) >= max_keys_) {
+        header_->dropped_keys.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // The value is written before the key is published to the readers
+    RdcShmSlot* slot = &slots_[index];
+    slot->gpu_index = static_cast<uint32_t>(key >> 32);
+    header_->num_keys.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+void RdcShmPublisher::write_slot(RdcShmSlot* slot,
+                                 const rdc_field_value& value) {
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot->value, &value, sizeof(value));
+    slot->seq.store(seq + 2, std::memory_order_release);
+}
+
+void RdcShmPublisher::publish(uint32_t gpu_index,
+                              const rdc_field_value& value) {
+    if (base_ == nullptr) {
+        return;
+    }
+    uint64_t key = rdc_pack_key(RdcFieldKey(gpu_index, value.field_id));
+    RdcShmSlot* slot = find_slot(key, true);
+    if (slot == nullptr) {
+        return;
+    }
+    bool is_new = slot->key.load(std::memory_order_relaxed) != key;
+    write_slot(slot, value);
+    if (is_new) {
+        slot->key.store(key, std::memory_order_release);
+    }
+}
+
+void RdcShmPublisher::invalidate(uint32_t gpu_index, rdc_field_t field_id) {
+    if (base_ == nullptr) {
+        return;
+    }
+    uint64_t key = rdc_pack_key(RdcFieldKey(gpu_index, field_id));
+    RdcShmSlot* slot = find_slot(key, false);
+    if (slot == nullptr) {
+        return;
+    }
+    rdc_field_value value = slot->value;
+    value.status = RDC_ST_NOT_FOUND;
+    write_slot(slot, value);
+}
+
+RdcShmPublisherPtr rdc_shm_publisher_from_env() {
+    const char* name = getenv(RDC_SHM_NAME_ENV);
+    if (name == nullptr || *name == '\0') {
+        return nullptr;
+    }
+
+    uint32_t capacity = kRdcShmDefaultSlots;
+    const char* slots = getenv(RDC_SHM_SLOTS_ENV);
+    if (slots != nullptr && atoi(slots) > 0) {
+        capacity = static_cast<uint32_t>(atoi(slots));
+    }
+
+    RdcShmPublisherPtr publisher(new RdcShmPublisher());
+    if (publisher->open(name, capacity) != RDC_ST_OK) {
+        return nullptr;
+    }
+    return publisher;
+}
+
+}  // namespace rdc
+}  // namespace amd
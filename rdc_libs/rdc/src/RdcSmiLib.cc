@@ -22,6 +22,8 @@ THE SOFTWARE.
 #include <functional>
 #include "rdc_lib/rdc_common.h"
 #include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/RdcTracer.h"
 #include "rdc_lib/impl/RdcSmiLib.h"
 
 namespace amd {
@@ -41,10 +43,12 @@ rdc_status_t RdcSmiLib::rdc_telemetry_fields_value_get(rdc_gpu_field_t* fields,
 
     RDC_LOG(RDC_DEBUG, "Bulk fetch " << fields_count
             << " fields from rocm_smi_lib.");
+    RDC_TRACE_SCOPE("smi_fields_value_get");
 
     const int BULK_FIELDS_MAX = 16;
     rdc_gpu_field_value_t values[BULK_FIELDS_MAX];
     uint32_t bulk_count = 0;
+    RdcPerfCounters& perf = RdcPerfCounters::get();
     for (uint32_t i = 0; i < fields_count; i++) {
         if (bulk_count >= BULK_FIELDS_MAX) {
             rdc_status_t status = callback(values, bulk_count, user_data);
@@ -55,10 +59,12 @@ rdc_status_t RdcSmiLib::rdc_telemetry_fields_value_get(rdc_gpu_field_t* fields,
             bulk_count = 0;
         }
         values[bulk_count].gpu_index = fields[i].gpu_index;
+        auto start = std::chrono::steady_clock::now();
         metric_fetcher_->fetch_smi_field(
             fields[i].gpu_index,
             static_cast<rdc_field_t>(fields[i].field_id),
             &(values[bulk_count].field_value));
+        perf.record_fetch(fields[i].field_id, rdc_perf_elapsed_us(start));
         bulk_count++;
     }
     if (bulk_count != 0) {
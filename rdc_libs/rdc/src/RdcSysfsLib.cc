@@ -0,0 +1,352 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcSysfsLib.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/RdcTracer.h"
+
+namespace amd {
+namespace rdc {
+
+static const char kAmdVendorId[] = "0x1002";
+
+static uint64_t sysfs_now() {
+    struct timeval  tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+// Return the card number of a "cardN" entry, or -1 for connectors
+// like card0-DP-1 and the render nodes.
+static int get_card_number(const char* name) {
+    if (strncmp(name, "card", 4) != 0 || name[4] == '\0') {
+        return -1;
+    }
+    int number = 0;
+    for (const char* p = name + 4; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9') {
+            return -1;
+        }
+        number = number * 10 + (*p - '0');
+    }
+    return number;
+}
+
+// Only used at discovery time, not on the fetch path.
+static bool read_sysfs_string(const std::string& path, std::string* str) {
+    char buf[64];
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return false;
+    }
+    while (len > 0 && (buf[len-1] == '\n' || buf[len-1] == ' ')) {
+        len--;
+    }
+    str->assign(buf, len);
+    return true;
+}
+
+static int open_sysfs_file(const std::string& path) {
+    return open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+RdcSysfsLib::RdcSysfsLib(const std::string& sysfs_root,
+        const RdcMetricFetcherPtr& mf):
+    sysfs_root_(sysfs_root)
+    , metric_fetcher_(mf) {
+    discover_devices();
+}
+
+RdcSysfsLib::~RdcSysfsLib() {
+    for (auto& dev : devices_) {
+        for (int i = 0; i < SYSFS_FILE_COUNT; i++) {
+            if (dev.fds[i] >= 0) {
+                close(dev.fds[i]);
+                dev.fds[i] = -1;
+            }
+        }
+    }
+}
+
+uint32_t RdcSysfsLib::get_num_devices() const {
+    return devices_.size();
+}
+
+int RdcSysfsLib::field_to_file(uint32_t field_id) {
+    switch (field_id) {
+        case RDC_FI_GPU_TEMP:
+            return SYSFS_GPU_TEMP;
+        case RDC_FI_MEMORY_TEMP:
+            return SYSFS_MEMORY_TEMP;
+        case RDC_FI_POWER_USAGE:
+            return SYSFS_POWER_USAGE;
+        case RDC_FI_GPU_UTIL:
+            return SYSFS_GPU_UTIL;
+        case RDC_FI_GPU_MEMORY_USAGE:
+            return SYSFS_GPU_MEMORY_USAGE;
+        default:
+            return -1;
+    }
+}
+
+// The GPU index follows the order of the cardN number, which is the same
+// order the rocm_smi_lib enumerates the devices.
+void RdcSysfsLib::discover_devices() {
+    DIR* dir = opendir(sysfs_root_.c_str());
+    if (dir == nullptr) {
+        RDC_LOG(RDC_ERROR, "Fail to open the sysfs root " << sysfs_root_);
+        return;
+    }
+
+    std::vector<std::pair<int, std::string>> cards;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        int card = get_card_number(entry->d_name);
+        if (card < 0) {
+            continue;
+        }
+        std::string device_path = sysfs_root_ + "/" + entry->d_name
+                + "/device";
+        std::string vendor;
+        if (!read_sysfs_string(device_path + "/vendor", &vendor) ||
+                vendor != kAmdVendorId) {
+            continue;
+        }
+        cards.push_back({card, device_path});
+    }
+    closedir(dir);
+
+    std::sort(cards.begin(), cards.end());
+    for (auto& card : cards) {
+        SysfsDevice dev;
+        dev.device_path = card.second;
+        open_device_files(&dev);
+        RDC_LOG(RDC_DEBUG, "Sysfs GPU " << devices_.size() << ": "
+                << dev.device_path);
+        devices_.push_back(dev);
+    }
+}
+
+// Find the tempN_input by its label, i.e. edge, junction or mem.
+std::string RdcSysfsLib::find_hwmon_temp(const std::string& hwmon,
+        const char* label, uint32_t default_index) const {
+    for (uint32_t i = 1; i <= 8; i++) {
+        std::string temp_label;
+        std::string prefix = hwmon + "/temp" + std::to_string(i);
+        if (read_sysfs_string(prefix + "_label", &temp_label) &&
+                temp_label == label) {
+            return prefix + "_input";
+        }
+    }
+    return hwmon + "/temp" + std::to_string(default_index) + "_input";
+}
+
+void RdcSysfsLib::open_device_files(SysfsDevice* dev) {
+    for (int i = 0; i < SYSFS_FILE_COUNT; i++) {
+        dev->fds[i] = -1;
+    }
+
+    dev->fds[SYSFS_GPU_UTIL] = open_sysfs_file(
+            dev->device_path + "/gpu_busy_percent");
+    dev->fds[SYSFS_GPU_MEMORY_USAGE] = open_sysfs_file(
+            dev->device_path + "/mem_info_vram_used");
+
+    std::string hwmon;
+    DIR* dir = opendir((dev->device_path + "/hwmon").c_str());
+    if (dir != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strncmp(entry->d_name, "hwmon", 5) == 0) {
+                hwmon = dev->device_path + "/hwmon/" + entry->d_name;
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    if (hwmon.empty()) {
+        return;
+    }
+
+    dev->fds[SYSFS_GPU_TEMP] = open_sysfs_file(
+            find_hwmon_temp(hwmon, "edge", 1));
+    dev->fds[SYSFS_MEMORY_TEMP] = open_sysfs_file(
+            find_hwmon_temp(hwmon, "mem", 3));
+    dev->fds[SYSFS_POWER_USAGE] = open_sysfs_file(hwmon + "/power1_average");
+    if (dev->fds[SYSFS_POWER_USAGE] < 0) {
+        dev->fds[SYSFS_POWER_USAGE] = open_sysfs_file(hwmon + "/power1_input");
+    }
+}
+
+// Read an integer from the beginning of an opened sysfs file. The value is
+// parsed in place so that no memory is allocated on the fetch path.
+int RdcSysfsLib::read_file(int fd, int64_t* val) const {
+    char buf[32];
+    ssize_t len;
+    do {
+        len = pread(fd, buf, sizeof(buf) - 1, 0);
+    } while (len < 0 && errno == EINTR);
+    if (len <= 0) {
+        return RDC_ST_FILE_ERROR;
+    }
+
+    const char* p = buf;
+    const char* end = buf + len;
+    bool negative = false;
+    if (*p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+        return RDC_ST_NO_DATA;
+    }
+    int64_t result = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        result = result * 10 + (*p - '0');
+    }
+    *val = negative ? -result : result;
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcSysfsLib::rdc_telemetry_fields_value_get(
+            rdc_gpu_field_t* fields, uint32_t fields_count,
+            rdc_field_value_f callback, void*  user_data) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    RDC_TRACE_SCOPE("sysfs_fields_value_get");
+
+    const int BULK_FIELDS_MAX = 16;
+    rdc_gpu_field_value_t values[BULK_FIELDS_MAX];
+    uint32_t bulk_count = 0;
+    RdcPerfCounters& perf = RdcPerfCounters::get();
+    for (uint32_t i = 0; i < fields_count; i++) {
+        if (bulk_count >= BULK_FIELDS_MAX) {
+            rdc_status_t status = callback(values, bulk_count, user_data);
+            // When the callback returns errors, stop processing and return.
+            if (status != RDC_ST_OK) {
+                return status;
+            }
+            bulk_count = 0;
+        }
+        uint32_t gpu_index = fields[i].gpu_index;
+        rdc_field_value* value = &(values[bulk_count].field_value);
+        auto start = std::chrono::steady_clock::now();
+        values[bulk_count].gpu_index = gpu_index;
+
+        int file = field_to_file(fields[i].field_id);
+        int fd = -1;
+        if (file >= 0 && gpu_index < devices_.size()) {
+            fd = devices_[gpu_index].fds[file];
+        }
+        if (fd < 0) {
+            // Not exposed by this kernel, fall back to the rocm_smi_lib
+            if (metric_fetcher_) {
+                metric_fetcher_->fetch_smi_field(gpu_index,
+                    fields[i].field_id, value);
+            } else {
+                value->field_id = fields[i].field_id;
+                value->ts = sysfs_now();
+                value->status = RDC_ST_NOT_SUPPORTED;
+            }
+            perf.record_fetch(fields[i].field_id, rdc_perf_elapsed_us(start));
+            bulk_count++;
+            continue;
+        }
+
+        int64_t val = 0;
+        value->field_id = fields[i].field_id;
+        value->type = INTEGER;
+        value->ts = sysfs_now();
+        value->status = read_file(fd, &val);
+        if (value->status == RDC_ST_OK) {
+            value->value.l_int = val;
+        }
+        perf.record_fetch(fields[i].field_id, rdc_perf_elapsed_us(start));
+        bulk_count++;
+    }
+    if (bulk_count != 0) {
+        rdc_status_t status = callback(values, bulk_count, user_data);
+        if (status != RDC_ST_OK) {
+            return status;
+        }
+    }
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcSysfsLib::rdc_telemetry_fields_watch(rdc_gpu_field_t* fields,
+      uint32_t fields_count) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    (void)fields_count;
+    return RDC_ST_NOT_SUPPORTED;
+}
+
+rdc_status_t RdcSysfsLib::rdc_telemetry_fields_unwatch(
+      rdc_gpu_field_t* fields, uint32_t fields_count) {
+    if (fields == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    (void)fields_count;
+    return RDC_ST_NOT_SUPPORTED;
+}
+
+rdc_status_t RdcSysfsLib::rdc_telemetry_fields_query(
+     uint32_t field_ids[MAX_NUM_FIELDS],
+    uint32_t* field_count) {
+    if (field_count == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    *field_count = 0;
+    if (devices_.size() == 0) {
+        return RDC_ST_OK;
+    }
+
+    // List of fields can be read from the sysfs
+    const std::vector<uint32_t> fields{
+            RDC_FI_GPU_TEMP, RDC_FI_MEMORY_TEMP, RDC_FI_POWER_USAGE,
+            RDC_FI_GPU_UTIL, RDC_FI_GPU_MEMORY_USAGE
+    };
+    std::copy(fields.begin(), fields.end(), field_ids);
+    *field_count = fields.size();
+
+    return RDC_ST_OK;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,126 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcTelemetryCapture.h"
+#include <string.h>
+#include <sys/time.h>
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcLogger.h"
+
+namespace amd {
+namespace rdc {
+
+RdcCaptureSweep::RdcCaptureSweep(): count_(0) {
+    struct timeval  tv;
+    gettimeofday(&tv, NULL);
+    ts_ = static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+void RdcCaptureSweep::add(const rdc_gpu_field_value_t* values,
+        uint32_t num_values) {
+    for (uint32_t i = 0; i < num_values; i++) {
+        const rdc_field_value& field_value = values[i].field_value;
+        RdcCaptureValue v;
+        v.gpu_index = values[i].gpu_index;
+        v.field_id = field_value.field_id;
+        v.status = field_value.status;
+        v.ts_offset = static_cast<int32_t>(
+                static_cast<int64_t>(field_value.ts) - ts_);
+        v.type = field_value.type;
+        v.str_len = 0;
+        v.value = 0;
+        if (field_value.status == RDC_ST_OK) {
+            if (field_value.type == STRING) {
+                v.str_len = strnlen(field_value.value.str,
+                        RDC_MAX_STR_LENGTH - 1);
+            } else {
+                memcpy(&v.value, &field_value.value, sizeof(v.value));
+            }
+        }
+
+        const char* p = reinterpret_cast<const char*>(&v);
+        buffer_.insert(buffer_.end(), p, p + sizeof(v));
+        if (v.str_len > 0) {
+            buffer_.insert(buffer_.end(), field_value.value.str,
+                    field_value.value.str + v.str_len);
+        }
+        count_++;
+    }
+}
+
+RdcTelemetryRecorder::RdcTelemetryRecorder(const std::string& file_name):
+    file_name_(file_name)
+    , file_(nullptr) {
+    file_ = fopen(file_name.c_str(), "wb");
+    if (file_ == nullptr) {
+        RDC_LOG(RDC_ERROR, "Fail to open the capture file " << file_name);
+        return;
+    }
+
+    RdcCaptureFileHeader header;
+    memset(&header, 0, sizeof(header));
+    strncpy_with_null(header.magic, RDC_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = RDC_CAPTURE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+        RDC_LOG(RDC_ERROR, "Fail to write the capture file " << file_name);
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+RdcTelemetryRecorder::~RdcTelemetryRecorder() {
+    if (file_ != nullptr) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool RdcTelemetryRecorder::is_open() const {
+    return file_ != nullptr;
+}
+
+void RdcTelemetryRecorder::write(const RdcCaptureSweep& sweep) {
+    if (sweep.count() == 0) {
+        return;
+    }
+
+    RdcCaptureSweepHeader header;
+    header.ts = sweep.ts();
+    header.count = sweep.count();
+    header.size = sweep.buffer().size();
+
+    std::lock_guard<std::mutex> guard(recorder_mutex_);
+    if (file_ == nullptr) {
+        return;
+    }
+    if (fwrite(&header, sizeof(header), 1, file_) != 1 ||
+        fwrite(&sweep.buffer()[0], 1, header.size, file_) != header.size) {
+        RDC_LOG(RDC_ERROR, "Fail to write the capture file " << file_name_
+            << ", stop capturing.");
+        fclose(file_);
+        file_ = nullptr;
+        return;
+    }
+    fflush(file_);
+}
+
+}  // namespace rdc
+}  // namespace amd
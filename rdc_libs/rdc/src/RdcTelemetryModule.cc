@@ -20,9 +20,14 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 #include "rdc_lib/impl/RdcTelemetryModule.h"
+#include <stdlib.h>
 #include <functional>
 #include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcTracer.h"
+#include "rdc_lib/impl/RdcPerfLib.h"
 #include "rdc_lib/impl/RdcSmiLib.h"
+#include "rdc_lib/impl/RdcSysfsLib.h"
+#include "rdc_lib/impl/RdcReplayLib.h"
 
 namespace amd {
 namespace rdc {
@@ -38,7 +43,7 @@ rdc_status_t RdcTelemetryModule::rdc_telemetry_fields_query(
     uint32_t count = 0;
     for (; ite != telemetry_modules_.end(); ite++) {
         rdc_status_t status = (*ite)->rdc_telemetry_fields_query(
-                &(field_ids[count]), &count);
+                &(field_ids[*field_count]), &count);
         if (status == RDC_ST_OK) {
             *field_count += count;
         }
@@ -77,37 +82,125 @@ rdc_status_t RdcTelemetryModule::rdc_telemetry_fields_unwatch(
 RdcTelemetryModule::RdcTelemetryModule(
     const RdcMetricFetcherPtr& fetcher,
     const RdcRasLibPtr& ras_module) {
+    // The replayed fields take precedence over all other modules
+    const char* replay_file = getenv(RDC_REPLAY_FILE_ENV);
+    if (replay_file != nullptr && replay_file[0] != '\0') {
+        const char* speed = getenv(RDC_REPLAY_SPEED_ENV);
+        auto replay_module = std::make_shared<RdcReplayLib>(replay_file,
+                speed ? atof(speed) : 1.0);
+        if (replay_module->get_num_sweeps() > 0) {
+            telemetry_modules_.push_back(replay_module);
+        }
+    }
+
+    // The sysfs module is added first so that it takes the hot fields
+    // it supports, the rest are still fetched from the rocm_smi_lib.
+    const char* sysfs_root = getenv(RDC_SYSFS_ROOT_ENV);
+    if (sysfs_root != nullptr && sysfs_root[0] != '\0') {
+        auto sysfs_module = std::make_shared<RdcSysfsLib>(sysfs_root, fetcher);
+        if (sysfs_module->get_num_devices() > 0) {
+            RDC_LOG(RDC_INFO, "Read hot fields of "
+                << sysfs_module->get_num_devices() << " GPUs from "
+                << sysfs_root);
+            telemetry_modules_.push_back(sysfs_module);
+        }
+    }
+
     auto smi_telemetry_module = std::make_shared<RdcSmiLib>(fetcher);
     telemetry_modules_.push_back(smi_telemetry_module);
     if (ras_module) {
        telemetry_modules_.push_back(ras_module);
     }
+    // The self-telemetry pseudo-fields
+    telemetry_modules_.push_back(std::make_shared<RdcPerfLib>());
 
-    auto ite = telemetry_modules_.begin();
-    for (; ite != telemetry_modules_.end(); ite++) {
+    map_fields();
+
+    const char* capture_file = getenv(RDC_CAPTURE_FILE_ENV);
+    if (capture_file != nullptr && capture_file[0] != '\0') {
+        recorder_.reset(new RdcTelemetryRecorder(capture_file));
+        if (recorder_->is_open()) {
+            RDC_LOG(RDC_INFO, "Capture the telemetry to " << capture_file);
+        } else {
+            recorder_.reset();
+        }
+    }
+}
+
+RdcTelemetryModule::RdcTelemetryModule(
+    const std::list<RdcTelemetryPtr>& modules)
+    : telemetry_modules_(modules.begin(), modules.end()) {
+    map_fields();
+}
+
+void RdcTelemetryModule::map_fields() {
+    for (uint32_t m = 0; m < telemetry_modules_.size(); m++) {
        uint32_t field_ids[MAX_NUM_FIELDS];
        uint32_t field_count;
-       (*ite)->rdc_telemetry_fields_query(field_ids, &field_count);
+       telemetry_modules_[m]->rdc_telemetry_fields_query(field_ids,
+               &field_count);
        for (uint32_t index = 0; index < field_count; index++) {
-           fields_id_module_.insert({field_ids[index], (*ite)});
+           fields_id_module_.insert({field_ids[index], m});
        }
     }
 }
 
+namespace {
+// The fields of a sweep sorted by module. The lanes and the GPU workers
+// each keep theirs, so that the sweeps stop allocating once the buffers
+// grew to the number of fields watched.
+struct RdcDispatchScratch {
+    std::vector<std::vector<rdc_gpu_field_t>> module_fields;
+    std::vector<rdc_gpu_field_value_t> unsupported_fields;
+};
+thread_local RdcDispatchScratch dispatch_scratch;
+
+// Pass the values to the caller and keep a copy for the capture file
+struct CaptureContext {
+    rdc_field_value_f callback;
+    void* user_data;
+    RdcCaptureSweep sweep;
+};
+
+rdc_status_t capture_fields(rdc_gpu_field_value_t* values,
+        uint32_t num_values, void* user_data) {
+    CaptureContext* context = static_cast<CaptureContext*>(user_data);
+    context->sweep.add(values, num_values);
+    return context->callback(values, num_values, context->user_data);
+}
+}  // namespace
+
 rdc_status_t RdcTelemetryModule::rdc_telemetry_fields_value_get(
     rdc_gpu_field_t* fields, uint32_t fields_count,
     rdc_field_value_f callback, void*  user_data) {
     if (fields == nullptr) {
         return RDC_ST_BAD_PARAMETER;
     }
+    RDC_TRACE_SCOPE("telemetry_fields_value_get");
+
+    CaptureContext capture_context;
+    if (recorder_) {
+        capture_context.callback = callback;
+        capture_context.user_data = user_data;
+        callback = capture_fields;
+        user_data = &capture_context;
+    }
 
     // Dispatch the fields to the libraries
-    std::map<RdcTelemetryPtr, std::vector<rdc_gpu_field_t>> fields_to_fetch;
-    std::vector<rdc_gpu_field_value_t> unsupport_fields;
+    RdcDispatchScratch& scratch = dispatch_scratch;
+    auto& fields_to_fetch = scratch.module_fields;
+    if (fields_to_fetch.size() < telemetry_modules_.size()) {
+        fields_to_fetch.resize(telemetry_modules_.size());
+    }
+    for (auto& module_fields : fields_to_fetch) {
+        module_fields.clear();
+    }
+    auto& unsupport_fields = scratch.unsupported_fields;
+    unsupport_fields.clear();
     for (uint32_t findex = 0; findex < fields_count; findex++) {
-        RdcTelemetryPtr module = fields_id_module_[fields[findex].field_id];
-        if (module) {
-            fields_to_fetch[module].push_back(fields[findex]);
+        auto module = fields_id_module_.find(fields[findex].field_id);
+        if (module != fields_id_module_.end()) {
+            fields_to_fetch[module->second].push_back(fields[findex]);
         } else {
             RDC_LOG(RDC_DEBUG, "Unsupported field " <<
                     field_id_string(fields[findex].field_id));
@@ -119,16 +212,22 @@ rdc_status_t RdcTelemetryModule::rdc_telemetry_fields_value_get(
         }
     }
 
-    auto ite = fields_to_fetch.begin();
-    for (; ite != fields_to_fetch.end(); ite ++) {
-        rdc_gpu_field_t f[MAX_NUM_FIELDS];
-        std::copy(ite->second.begin(), ite->second.end(), f);
-        ite->first->rdc_telemetry_fields_value_get(f,
-            ite->second.size(), callback, user_data);
+    for (uint32_t m = 0; m < telemetry_modules_.size(); m++) {
+        auto& module_fields = fields_to_fetch[m];
+        if (module_fields.size() != 0) {
+            telemetry_modules_[m]->rdc_telemetry_fields_value_get(
+                &module_fields[0], module_fields.size(), callback, user_data);
+        }
     }
 
     // Notify the caller unsupported fields
-    callback(&unsupport_fields[0],  unsupport_fields.size(), user_data);
+    if (unsupport_fields.size() != 0) {
+        callback(&unsupport_fields[0], unsupport_fields.size(), user_data);
+    }
+
+    if (recorder_) {
+        recorder_->write(capture_context.sweep);
+    }
 
     return RDC_ST_OK;
 }
@@ -20,7 +20,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 */
 
+#include <stdlib.h>
 #include <sys/time.h>
+#include <chrono>  // NOLINT
 #include <ctime>
 #include <sstream>
 #include <algorithm>
@@ -31,11 +33,47 @@ THE SOFTWARE.
 #include "rdc_lib/rdc_common.h"
 #include "common/rdc_utils.h"
 #include "rdc_lib/RdcLogger.h"
+#include "rdc_lib/RdcTracer.h"
 #include "rdc/rdc.h"
 
 namespace amd {
 namespace rdc {
 
+namespace {
+const uint64_t kDefaultFastLaneUs = 1000000;
+const uint64_t kDefaultSlowFetchUs = 1000;
+//!< Fetches needed before the measured cost overrides expensive_field()
+const uint64_t kMinCostSamples = 8;
+//!< How long an idle lane sleeps before it checks its fields again
+const uint64_t kMaxLaneSleepMs = 1000;
+//!< How many times the CPU budget may stretch the period of a watch,
+//!< unless set with rdc_field_watch_set_limits()
+const uint64_t kDefaultMaxStretch = 10;
+//!< The samples reserved in the cache per field, beyond which it grows as
+//!< the samples come, to bound the memory of long histories
+const uint64_t kMaxReservedSamples = 4096;
+
+const char* const kLaneSweepNames[RDC_LANE_COUNT] = {
+    "fast_lane_sweep", "normal_lane_sweep", "slow_lane_sweep"};
+
+uint64_t env_to_uint64(const char* name, uint64_t default_value) {
+    const char* value = getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return default_value;
+    }
+    return strtoull(value, nullptr, 10);
+}
+
+// The fields known to be slow before they are measured: ECC totals walk
+// all the RAS blocks, XGMI events read hardware counters.
+bool expensive_field(rdc_field_t field_id) {
+    return field_id == RDC_FI_ECC_CORRECT_TOTAL ||
+        field_id == RDC_FI_ECC_UNCORRECT_TOTAL ||
+        (field_id >= RDC_EVNT_XGMI_0_NOP_TX &&
+         field_id <= RDC_EVNT_XGMI_1_THRPUT);
+}
+}  // namespace
+
 RdcWatchTableImpl::RdcWatchTableImpl(const RdcGroupSettingsPtr& group_settings,
         const RdcCacheManagerPtr& cache_mgr,
         const RdcMetricFetcherPtr& metric_fetcher,
@@ -44,14 +82,49 @@ RdcWatchTableImpl::RdcWatchTableImpl(const RdcGroupSettingsPtr& group_settings,
     , cache_mgr_(cache_mgr)
     , metric_fetcher_(metric_fetcher)
     , rdc_module_mgr_(module_mgr)
-    , last_cleanup_time_(0) {
+    , shm_publisher_(rdc_shm_publisher_from_env())
+    , prometheus_exporter_(rdc_prometheus_exporter_from_env())
+    , export_pipeline_(rdc_export_pipeline_from_env())
+    , cpu_governor_(rdc_cpu_governor_from_env())
+    , last_cleanup_time_(0)
+    , perf_(RdcPerfCounters::get())
+    , fast_lane_us_(env_to_uint64(RDC_FAST_LANE_US_ENV, kDefaultFastLaneUs))
+    , slow_fetch_us_(env_to_uint64(RDC_SLOW_FETCH_US_ENV,
+                kDefaultSlowFetchUs))
+    , watch_generation_(0)
+    , gpu_collector_(rdc_gpu_collector_from_env(handle_fields, this)) {
+    for (uint32_t i = 0; i < RDC_LANE_COUNT; i++) {
+        lane_generation_[i] = 0;
+    }
+    if (cpu_governor_) {
+        perf_.enable_collection_cpu();
+    }
+}
+
+uint32_t RdcWatchTableImpl::classify_field(rdc_field_t field_id,
+        uint64_t update_freq, uint32_t lane) const {
+    uint64_t count = 0;
+    uint64_t median_us = 0;
+    perf_.fetch_latency(field_id, &count, &median_us);
+    bool slow;
+    if (count < kMinCostSamples) {
+        slow = expensive_field(field_id);
+    } else if (lane == RDC_LANE_SLOW) {  // Do not flip around the limit
+        slow = median_us > slow_fetch_us_ / 2;
+    } else {
+        slow = median_us > slow_fetch_us_;
+    }
+    if (slow) {
+        return RDC_LANE_SLOW;
+    }
+    return update_freq <= fast_lane_us_ ? RDC_LANE_FAST : RDC_LANE_NORMAL;
 }
 
 rdc_status_t  RdcWatchTableImpl::rdc_job_start_stats(rdc_gpu_group_t group_id,
                 const char  job_id[64], uint64_t update_freq,
                 const rdc_gpu_gauges_t& gpu_gauges) {
     do {  //< lock guard for thread safe
-        std::lock_guard<std::mutex> guard(watch_mutex_);
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
         if (job_watch_table_.find(job_id) != job_watch_table_.end()) {
             return RDC_ST_ALREADY_EXIST;
         }
@@ -71,25 +144,26 @@ rdc_status_t  RdcWatchTableImpl::rdc_job_start_stats(rdc_gpu_group_t group_id,
 
     JobWatchTableEntry jentry {group_id, fields_in_watch};
     do {  //< lock guard for thread safe
-        std::lock_guard<std::mutex> guard(watch_mutex_);
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
         job_watch_table_.insert({job_id, jentry});
     } while (0);
 
 
-    rdc_field_group_info_t finfo;
-    rdc_group_info_t ginfo;
-    result = group_settings_->rdc_group_gpu_get_info(
-                    group_id, &ginfo);
+    RdcFieldGroupSnapshot finfo;
+    RdcGpuGroupSnapshot ginfo;
+    result = group_settings_->rdc_group_gpu_get_snapshot(group_id, &ginfo);
     if (result != RDC_ST_OK) {
         return result;
     }
 
-    result = group_settings_->rdc_group_field_get_info(JOB_FIELD_ID, &finfo);
+    result = group_settings_->rdc_group_field_get_snapshot(
+                    JOB_FIELD_ID, &finfo);
     if (result != RDC_ST_OK) {
         return result;
     }
 
-    result = cache_mgr_->rdc_job_start_stats(job_id, ginfo, finfo, gpu_gauges);
+    result = cache_mgr_->rdc_job_start_stats(job_id, *ginfo, *finfo,
+                    gpu_gauges);
     if (result != RDC_ST_OK) {
         return result;
     }
@@ -103,7 +177,7 @@ rdc_status_t RdcWatchTableImpl::rdc_job_stop_stats(const char job_id[64],
                         const rdc_gpu_gauges_t& gpu_gauge) {
     uint32_t job_group_id;
     do {  //< lock guard for thread safe
-        std::lock_guard<std::mutex> guard(watch_mutex_);
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
         auto job = job_watch_table_.find(job_id);
         if (job == job_watch_table_.end()) {
             return RDC_ST_NOT_FOUND;
@@ -117,7 +191,7 @@ rdc_status_t RdcWatchTableImpl::rdc_job_stop_stats(const char job_id[64],
     }
 
     do {  //< lock guard for thread safe
-        std::lock_guard<std::mutex> guard(watch_mutex_);
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
         job_watch_table_.erase(job_id);
     } while (0);
 
@@ -136,7 +210,7 @@ rdc_status_t RdcWatchTableImpl::rdc_job_remove_all() {
     // Get all the job ids;
     std::vector<std::string> v;
     do {  //< lock guard for thread safe
-        std::lock_guard<std::mutex> guard(watch_mutex_);
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
         for (auto ite = job_watch_table_.begin();
             ite != job_watch_table_.end(); ite++) {
             v.push_back(ite->first);
@@ -155,23 +229,25 @@ rdc_status_t RdcWatchTableImpl::rdc_job_remove_all() {
 
 rdc_status_t RdcWatchTableImpl::get_fields_from_group(rdc_gpu_group_t group_id,
     rdc_field_grp_t field_group_id, std::vector<RdcFieldKey> & fields) {
-    rdc_field_group_info_t finfo;
-    rdc_group_info_t ginfo;
+    RdcFieldGroupSnapshot finfo;
+    RdcGpuGroupSnapshot ginfo;
     rdc_status_t result = group_settings_->
-                    rdc_group_gpu_get_info(group_id, &ginfo);
+                    rdc_group_gpu_get_snapshot(group_id, &ginfo);
     if (result != RDC_ST_OK) {
         return result;
     }
 
-    result = group_settings_->rdc_group_field_get_info(field_group_id, &finfo);
+    result = group_settings_->rdc_group_field_get_snapshot(
+                    field_group_id, &finfo);
     if (result != RDC_ST_OK) {
         return result;
     }
 
-    for (uint32_t i = 0 ; i < ginfo.count; i++) {  // GPUs
-        for (uint32_t j = 0; j < finfo.count; j++) {  // Fields
-            fields.push_back(RdcFieldKey({ginfo.entity_ids[i],
-                        finfo.field_ids[j]}));
+    fields.reserve(fields.size() +
+                    ginfo->entity_ids.size() * finfo->field_ids.size());
+    for (auto gpu : ginfo->entity_ids) {  // GPUs
+        for (auto field : finfo->field_ids) {  // Fields
+            fields.push_back(RdcFieldKey({gpu, field}));
         }
     }
 
@@ -181,7 +257,7 @@ rdc_status_t RdcWatchTableImpl::get_fields_from_group(rdc_gpu_group_t group_id,
 rdc_status_t RdcWatchTableImpl::rdc_field_watch(rdc_gpu_group_t group_id,
         rdc_field_grp_t field_group_id, uint64_t update_freq,
         double  max_keep_age, uint32_t max_keep_samples) {
-    std::lock_guard<std::mutex> guard(watch_mutex_);
+    RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
     RdcFieldGroupKey gkey({group_id, field_group_id});
     auto table_iter = watch_table_.find(gkey);
 
@@ -196,11 +272,19 @@ rdc_status_t RdcWatchTableImpl::rdc_field_watch(rdc_gpu_group_t group_id,
 
     // The field settings for this watch
     FieldSettings f;
+    f.requested_freq = update_freq;
+    f.max_update_freq = update_freq * kDefaultMaxStretch;
+    f.priority = 0;
     f.update_freq = update_freq;
+    if (cpu_governor_) {
+        f.update_freq = cpu_governor_->effective_freq(
+                {f.priority, f.requested_freq, f.max_update_freq});
+    }
     f.max_keep_age = max_keep_age;
     f.max_keep_samples = max_keep_samples;
     f.last_update_time = 0;
     f.is_watching = true;
+    f.lane = RDC_LANE_NORMAL;
 
 
     // Get individual fields for the watch
@@ -222,29 +306,59 @@ rdc_status_t RdcWatchTableImpl::rdc_field_watch(rdc_gpu_group_t group_id,
        }
        auto ite = fields_to_watch_.find(*f_in_watch_iter);
        if (ite == fields_to_watch_.end()) {  // A new field
-          fields_to_watch_.insert({*f_in_watch_iter, f});
+          FieldSettings field_settings = f;
+          field_settings.lane = classify_field(f_in_watch_iter->second,
+                f.update_freq, RDC_LANE_NORMAL);
+          fields_to_watch_.insert({*f_in_watch_iter, field_settings});
+          reserve_samples(*f_in_watch_iter, field_settings);
        } else {  // Merge the settings
           auto& f_in_table = ite->second;
           f_in_table.max_keep_age =
                 std::max(f_in_table.max_keep_age, max_keep_age);
-          f_in_table.max_keep_samples =
+          // 0 keeps any number of samples, so it wins the merge
+          if (f_in_table.max_keep_samples != 0) {
+              f_in_table.max_keep_samples = max_keep_samples == 0 ? 0 :
                 std::max(f_in_table.max_keep_samples, max_keep_samples);
+          }
           if (f_in_table.is_watching) {  // Already watching
               f_in_table.update_freq =
-                std::min(f_in_table.update_freq, update_freq);
+                std::min(f_in_table.update_freq, f.update_freq);
           } else {  // Not watching before
               f_in_table.is_watching = true;
-              f_in_table.update_freq = update_freq;
+              f_in_table.update_freq = f.update_freq;
+              // Not a missed deadline when fetched again
+              f_in_table.last_update_time = 0;
           }
+          f_in_table.lane = classify_field(f_in_watch_iter->second,
+                f_in_table.update_freq, f_in_table.lane);
+          reserve_samples(*f_in_watch_iter, f_in_table);
        }
     }
 
     // Add to the watch table
     watch_table_.insert({gkey, f});
 
+    // The new fields may be due before the lanes planned to wake up
+    rdc_field_wake_lanes();
+
     return RDC_ST_OK;
 }
 
+void RdcWatchTableImpl::reserve_samples(const RdcFieldKey& key,
+        const FieldSettings& settings) {
+    uint64_t period_ms = std::max<uint64_t>(settings.update_freq / 1000, 1);
+    double kept_by_age = settings.max_keep_age * 1000 / period_ms + 1;
+    uint64_t kept = static_cast<uint64_t>(kept_by_age);
+    if (settings.max_keep_samples != 0 && settings.max_keep_samples < kept) {
+        kept = settings.max_keep_samples;
+    }
+    // The clean up evicts once a second, or a bit later when the normal
+    // lane runs late
+    uint64_t added = 2 * (1000 / period_ms + 1);
+    cache_mgr_->reserve_cache(key.first, key.second,
+            std::min(kept + added, kMaxReservedSamples));
+}
+
 rdc_status_t RdcWatchTableImpl::update_field_in_table_when_unwatch(
                     const RdcFieldGroupKey& entry) {
     // Get individual fields for this unwatch
@@ -258,7 +372,7 @@ rdc_status_t RdcWatchTableImpl::update_field_in_table_when_unwatch(
     // Unwatch will only impact the update_freq, but not the max_keep_age
     // and max_keep_samples. Walk through  watch_table_ to get new update
     // frequency for all fields and store it in update_frequencies
-    std::map<RdcFieldKey, uint64_t> update_frequencies;
+    RdcFlatMap<RdcFieldKey, uint64_t> update_frequencies;
     auto w_iter = watch_table_.begin();
     for (; w_iter != watch_table_.end(); w_iter++) {
         // Skip the table is not in watching status
@@ -302,8 +416,14 @@ rdc_status_t RdcWatchTableImpl::update_field_in_table_when_unwatch(
          auto freq_iter = update_frequencies.find(*fite);
          if (freq_iter == update_frequencies.end()) {
              f_in_table->second.is_watching = false;
+             // Local readers go back to rdcd, which has the history
+             if (shm_publisher_) {
+                 shm_publisher_->invalidate(fite->first, fite->second);
+             }
          } else {
              f_in_table->second.update_freq = freq_iter->second;
+             f_in_table->second.lane = classify_field(fite->second,
+                    freq_iter->second, f_in_table->second.lane);
          }
     }
 
@@ -325,7 +445,7 @@ rdc_status_t RdcWatchTableImpl::rdc_field_unwatch(
     gettimeofday(&tv, NULL);
     uint64_t now = static_cast<uint64_t>(tv.tv_sec)*1000+tv.tv_usec/1000;
 
-    std::lock_guard<std::mutex> guard(watch_mutex_);
+    RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
     // Set is_watching = false
     auto ite = watch_table_.find(RdcFieldGroupKey({group_id, field_group_id}));
     if (ite == watch_table_.end()) {
@@ -338,20 +458,124 @@ rdc_status_t RdcWatchTableImpl::rdc_field_unwatch(
     return update_field_in_table_when_unwatch(ite->first);
 }
 
-bool RdcWatchTableImpl::is_job_watch_field(uint32_t gpu_index,
-        rdc_field_t field_id, std::string& job_id) const {
+rdc_status_t RdcWatchTableImpl::rdc_field_watch_set_limits(
+        rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
+        uint32_t priority, uint64_t max_update_freq) {
+    RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
+    auto ite = watch_table_.find(RdcFieldGroupKey({group_id, field_group_id}));
+    if (ite == watch_table_.end() || !ite->second.is_watching) {
+        return RDC_ST_NOT_FOUND;
+    }
+    ite->second.priority = priority;
+    ite->second.max_update_freq = max_update_freq;
+    if (cpu_governor_) {
+        apply_update_freqs();
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcWatchTableImpl::rdc_field_get_watch_rates(
+        std::vector<rdc_watch_rate_t>* rates) {
+    if (rates == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
+    for (auto ite = watch_table_.begin(); ite != watch_table_.end(); ite++) {
+        if (!ite->second.is_watching) {
+            continue;
+        }
+        rdc_watch_rate_t rate;
+        rate.group_id = ite->first.first;
+        rate.field_group_id = ite->first.second;
+        rate.priority = ite->second.priority;
+        rate.requested_freq = ite->second.requested_freq;
+        rate.max_update_freq = ite->second.max_update_freq;
+        rate.effective_freq = ite->second.update_freq;
+        rates->push_back(rate);
+    }
+    return RDC_ST_OK;
+}
+
+void RdcWatchTableImpl::govern() {
+    std::vector<RdcGovernedWatch>& watches = governed_watches_;
+    watches.clear();
+    for (auto ite = watch_table_.begin(); ite != watch_table_.end(); ite++) {
+        if (ite->second.is_watching) {
+            watches.push_back({ite->second.priority,
+                    ite->second.requested_freq, ite->second.max_update_freq});
+        }
+    }
+    if (cpu_governor_->update(perf_.collection_cpu_ns(), watches)) {
+        apply_update_freqs();
+    }
+
+    uint64_t stretched = 0;
+    for (auto ite = watch_table_.begin(); ite != watch_table_.end(); ite++) {
+        if (ite->second.is_watching &&
+                ite->second.update_freq != ite->second.requested_freq) {
+            stretched++;
+        }
+    }
+    perf_.set_stretched_watches(stretched);
+}
+
+void RdcWatchTableImpl::apply_update_freqs() {
+    RDC_TRACE_SCOPE("apply_update_freqs");
+    // The shortest period of the watches of each field
+    RdcFlatMap<RdcFieldKey, uint64_t> update_frequencies;
+    for (auto w_iter = watch_table_.begin(); w_iter != watch_table_.end();
+            w_iter++) {
+        FieldSettings& watch = w_iter->second;
+        if (!watch.is_watching) {
+            continue;
+        }
+        watch.update_freq = cpu_governor_->effective_freq(
+                {watch.priority, watch.requested_freq, watch.max_update_freq});
+
+        std::vector<RdcFieldKey> watch_fields;
+        if (get_fields_from_group(w_iter->first.first, w_iter->first.second,
+                    watch_fields) != RDC_ST_OK) {
+            continue;
+        }
+        for (const auto& key : watch_fields) {
+            auto freq_iter = update_frequencies.find(key);
+            if (freq_iter == update_frequencies.end()) {
+                update_frequencies.insert({key, watch.update_freq});
+            } else {
+                freq_iter->second = std::min(freq_iter->second,
+                        watch.update_freq);
+            }
+        }
+    }
+    for (auto fite = fields_to_watch_.begin(); fite != fields_to_watch_.end();
+            fite++) {
+        auto freq_iter = update_frequencies.find(fite->first);
+        if (!fite->second.is_watching ||
+                freq_iter == update_frequencies.end()) {
+            continue;
+        }
+        fite->second.update_freq = freq_iter->second;
+        fite->second.lane = classify_field(fite->first.second,
+                freq_iter->second, fite->second.lane);
+    }
+
+    // The restored fields may be due before the lanes planned to wake up
+    rdc_field_wake_lanes();
+}
+
+const std::string* RdcWatchTableImpl::get_job_watching(uint32_t gpu_index,
+        rdc_field_t field_id) const {
     RdcFieldKey key{gpu_index, field_id};
 
     for (auto ite = job_watch_table_.begin();
                 ite != job_watch_table_.end(); ite++) {
         auto& fields = ite->second.fields;
         if (std::find(fields.begin(), fields.end(), key) != fields.end()) {
-            job_id = ite->first;
-            return true;
+            return &ite->first;
         }
     }
 
-    return false;
+    return nullptr;
 }
 
 rdc_status_t RdcWatchTableImpl::handle_fields(rdc_gpu_field_value_t*  values,
@@ -360,6 +584,11 @@ rdc_status_t RdcWatchTableImpl::handle_fields(rdc_gpu_field_value_t*  values,
         return RDC_ST_BAD_PARAMETER;
     }
     RdcWatchTableImpl* watchTable = static_cast<RdcWatchTableImpl*>(user_data);
+    RDC_TRACE_SCOPE("handle_fields");
+    // The lanes fetch without the lock, and the publishers need a single
+    // writer
+    RdcTimedLockGuard guard(&watchTable->watch_mutex_,
+            watchTable->perf_.watch_lock_wait());
 
     for (uint32_t i = 0; i < num_values; i++) {
         auto gpu_index = values[i].gpu_index;
@@ -367,12 +596,29 @@ rdc_status_t RdcWatchTableImpl::handle_fields(rdc_gpu_field_value_t*  values,
 
         // Always Update the timestamp
         auto ite = watchTable->fields_to_watch_.find({gpu_index, field_id});
+        bool watched = false;
         if (ite != watchTable->fields_to_watch_.end()) {
             struct timeval  tv;
             gettimeofday(&tv, NULL);
             uint64_t now = static_cast<uint64_t>(tv.tv_sec) * 1000
                     + tv.tv_usec / 1000;
             ite->second.last_update_time = now;
+            watched = ite->second.is_watching;
+        }
+
+        // A sweep may still carry a field unwatched since, which must not
+        // take a slot again
+        if (watched && watchTable->shm_publisher_) {
+            watchTable->shm_publisher_->publish(gpu_index,
+                        values[i].field_value);
+        }
+        if (watchTable->prometheus_exporter_) {
+            watchTable->prometheus_exporter_->update(gpu_index,
+                        values[i].field_value);
+        }
+        if (watchTable->export_pipeline_) {
+            watchTable->export_pipeline_->push(gpu_index,
+                        values[i].field_value);
         }
 
         // Only cache valid results
@@ -385,72 +631,223 @@ rdc_status_t RdcWatchTableImpl::handle_fields(rdc_gpu_field_value_t*  values,
                         values[i].field_value);
 
         // Update the job stats cache
-        std::string job_id;
-        if (watchTable->is_job_watch_field(gpu_index, field_id, job_id)) {
+        const std::string* job_id = watchTable->get_job_watching(gpu_index,
+                        field_id);
+        if (job_id) {
             watchTable->cache_mgr_->rdc_update_job_stats(gpu_index,
-                        job_id, values[i].field_value);
+                        *job_id, values[i].field_value);
         }
     }
     return RDC_ST_OK;
 }
 
 rdc_status_t RdcWatchTableImpl::rdc_field_update_all() {
+    for (uint32_t lane = 0; lane < RDC_LANE_COUNT; lane++) {
+        uint64_t next_due = 0;
+        rdc_field_update_lane(lane, &next_due);
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcWatchTableImpl::rdc_field_update_lane(uint32_t lane,
+        uint64_t* next_due) {
+    if (lane >= RDC_LANE_COUNT || next_due == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    RdcTraceScope sweep_scope(kLaneSweepNames[lane]);
+    bool measure_cpu = perf_.collection_cpu_enabled();
+    uint64_t cpu_start = measure_cpu ? rdc_thread_cpu_ns() : 0;
     struct timeval  tv;
     gettimeofday(&tv, NULL);
     uint64_t now = static_cast<uint64_t>(tv.tv_sec)*1000+tv.tv_usec/1000;
+    auto sweep_start = std::chrono::steady_clock::now();
 
-    // Collect all fields need to be updated for bulk fetch
-    std::vector<rdc_gpu_field_t> fields;
-    std::lock_guard<std::mutex> guard(watch_mutex_);
-    auto fite = fields_to_watch_.begin();
-    for (; fite != fields_to_watch_.end(); fite++) {
-        // Is this field need to be updated?
-        uint64_t track_freq = fite->second.update_freq/1000;
-        if (!fite->second.is_watching ||
-            fite->second.last_update_time+track_freq > now) {
-           continue;
+    std::lock_guard<std::mutex> lane_guard(lane_mutex_[lane]);
+    do {
+        std::lock_guard<std::mutex> wait_guard(lane_wait_mutex_);
+        lane_generation_[lane] = watch_generation_;
+    } while (0);
+
+    // Collect all fields of the lane need to be updated for bulk fetch
+    std::vector<rdc_gpu_field_t>& fields = lane_fields_[lane];
+    fields.clear();
+    uint64_t missed = 0;
+    uint64_t lateness = 0;
+    uint64_t due = now + kMaxLaneSleepMs;
+    bool clean_up_due = false;
+    do {  //< lock guard for thread safe
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
+        RdcTraceScope collect_scope("collect_fields");
+        auto fite = fields_to_watch_.begin();
+        for (; fite != fields_to_watch_.end(); fite++) {
+            if (!fite->second.is_watching || fite->second.lane != lane) {
+                continue;
+            }
+            // Is this field need to be updated?
+            uint64_t track_freq = fite->second.update_freq/1000;
+            uint64_t last_update_time = fite->second.last_update_time;
+            if (last_update_time+track_freq > now) {
+                due = std::min(due, last_update_time + track_freq);
+                continue;
+            }
+            if (last_update_time != 0) {
+                lateness = std::max(lateness,
+                        now - (last_update_time + track_freq));
+            }
+            // Overdue by a whole period, the previous sweeps fell behind
+            if (last_update_time != 0 && track_freq != 0 &&
+                last_update_time + 2*track_freq <= now) {
+                missed++;
+            }
+            fields.push_back({fite->first.first, fite->first.second});
+            due = std::min(due, now + track_freq);
         }
-        fields.push_back({fite->first.first, fite->first.second});
-    }
+
+        // Clean up is expensive, only do it once per second
+        if (lane == RDC_LANE_NORMAL) {
+            clean_up_due = now - last_cleanup_time_ > 1000;
+            due = std::min(due, (clean_up_due ? now : last_cleanup_time_.load())
+                    + 1001);
+        }
+        if (fields.size() == 0 && !clean_up_due) {
+            // Nothing to do, keep the idle sweeps out of the trace
+            sweep_scope.cancel();
+            collect_scope.cancel();
+        }
+    } while (0);
+    *next_due = due;
 
     if (fields.size() != 0) {
         auto rdc_telemetry = rdc_module_mgr_->get_telemetry_module();
-        if (rdc_telemetry) {
+        if (rdc_telemetry && gpu_collector_) {
+            std::vector<rdc_gpu_field_t>& stale = lane_stale_[lane];
+            stale.clear();
+            gpu_collector_->dispatch(lane, rdc_telemetry, fields, &stale);
+            if (stale.size() != 0) {
+                handle_stale_fields(lane, stale, now);
+            }
+            // Until the lane is due again, so that a GPU running late
+            // does not hold up the others
+            uint64_t until = now + gpu_collector_->timeout_ms();
+            if (due > now) {
+                until = std::min(until, due);
+            }
+            gpu_collector_->wait(lane, until);
+        } else if (rdc_telemetry) {
             rdc_telemetry->rdc_telemetry_fields_value_get(&fields[0],
                         fields.size(), RdcWatchTableImpl::handle_fields, this);
         } else {
             RDC_LOG(RDC_ERROR,
                 "RdcWatchTableImpl: Fail to get the telemetry module");
         }
+        perf_.record_sweep(lane, rdc_perf_elapsed_us(sweep_start),
+                lateness * 1000, missed);
     }
 
-    // Clean up is expensive, only do it once per second
-    if (now - last_cleanup_time_ >1000) {
-        clean_up();
-        last_cleanup_time_ = now;
+    if (fields.size() != 0 || clean_up_due) {
+        RdcTimedLockGuard guard(&watch_mutex_, perf_.watch_lock_wait());
+        if (clean_up_due) {
+            clean_up();
+            last_cleanup_time_ = now;
+            if (cpu_governor_) {
+                govern();
+            }
+        }
+
+        // Render once all the values of the sweep are in
+        if (prometheus_exporter_) {
+            RDC_TRACE_SCOPE("prometheus_render");
+            prometheus_exporter_->render();
+        }
     }
 
+    if (measure_cpu) {
+        perf_.record_collection_cpu(rdc_thread_cpu_ns() - cpu_start);
+    }
     return RDC_ST_OK;
 }
 
+void RdcWatchTableImpl::handle_stale_fields(uint32_t lane,
+        const std::vector<rdc_gpu_field_t>& fields, uint64_t now) {
+    std::vector<rdc_gpu_field_value_t>& values = lane_stale_values_[lane];
+    values.resize(fields.size());
+    for (size_t i = 0; i < fields.size(); i++) {
+        values[i].gpu_index = fields[i].gpu_index;
+        values[i].field_value.field_id = fields[i].field_id;
+        values[i].field_value.status = RDC_ST_TIMEOUT;
+        values[i].field_value.ts = now;
+        values[i].field_value.type = INTEGER;
+        values[i].field_value.value.l_int = 0;
+    }
+    // Also moves their next update a period later, like a fetch would
+    handle_fields(&values[0], values.size(), this);
+}
+
+bool RdcWatchTableImpl::rdc_gpu_quarantined(uint32_t gpu_index) const {
+    return gpu_collector_ && gpu_collector_->is_quarantined(gpu_index);
+}
+
+void RdcWatchTableImpl::rdc_field_wait_lane(uint32_t lane,
+        uint64_t next_due) {
+    if (lane >= RDC_LANE_COUNT) {
+        return;
+    }
+    auto until = std::chrono::system_clock::time_point(
+            std::chrono::milliseconds(next_due));
+    std::unique_lock<std::mutex> lock(lane_wait_mutex_);
+    lane_wait_cv_.wait_until(lock, until, [this, lane]() {
+        return lane_generation_[lane] != watch_generation_;
+    });
+}
+
+void RdcWatchTableImpl::rdc_field_wake_lanes() {
+    do {
+        std::lock_guard<std::mutex> guard(lane_wait_mutex_);
+        watch_generation_++;
+    } while (0);
+    lane_wait_cv_.notify_all();
+}
+
 void RdcWatchTableImpl::clean_up() {
+    RDC_TRACE_SCOPE("clean_up");
     struct timeval  tv;
     gettimeofday(&tv, NULL);
     uint64_t now = static_cast<uint64_t>(tv.tv_sec)*1000+tv.tv_usec/1000;
 
     // Clean the cache and the fields_to_watch_ table
+    bool moved = false;
     auto fite = fields_to_watch_.begin();
     while (fite != fields_to_watch_.end()) {
         cache_mgr_->evict_cache(fite->first.first, fite->first.second,
                 fite->second.max_keep_samples, fite->second.max_keep_age);
+        // Move the fields whose measured fetch time changed their lane
+        uint32_t lane = classify_field(fite->first.second,
+                fite->second.update_freq, fite->second.lane);
+        if (lane != fite->second.lane) {
+            fite->second.lane = lane;
+            moved = true;
+        }
         if (!fite->second.is_watching && fite->second.last_update_time +
                         fite->second.max_keep_age*1000 < now ) {
+            if (shm_publisher_) {
+                shm_publisher_->invalidate(fite->first.first,
+                        fite->first.second);
+            }
+            if (prometheus_exporter_) {
+                prometheus_exporter_->invalidate(fite->first.first,
+                        fite->first.second);
+            }
             fite = fields_to_watch_.erase(fite);
         } else {
             ++fite;
         }
     }
 
+    // The lane a field moved to may be asleep
+    if (moved) {
+        rdc_field_wake_lanes();
+    }
+
     // Clean the watch table
     auto wite = watch_table_.begin();
     while (wite != watch_table_.end()) {
@@ -469,6 +866,10 @@ void RdcWatchTableImpl::clean_up() {
 }
 
 void RdcWatchTableImpl::debug_status() {
+    // The job fields are formatted before they are logged
+    if (!RdcLogger::getLogger().should_log(RDC_DEBUG)) {
+        return;
+    }
     RDC_LOG(RDC_DEBUG, "fields_to_watch_:" << fields_to_watch_.size()
             << " watch_table_:" << watch_table_.size()
             << " job_watch_table_:" << job_watch_table_.size()
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcAsyncClientQueue.h"
+#include <stdlib.h>
+#include <mutex>  // NOLINT
+
+namespace amd {
+namespace rdc {
+
+static const uint32_t kDefaultClientCQThreads = 2;
+
+std::shared_ptr<RdcAsyncClientQueue> RdcAsyncClientQueue::get() {
+    static std::mutex mutex;
+    static std::weak_ptr<RdcAsyncClientQueue> shared;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    std::shared_ptr<RdcAsyncClientQueue> queue = shared.lock();
+    if (!queue) {
+        uint32_t num_threads = kDefaultClientCQThreads;
+        const char* env = getenv(RDC_CLIENT_CQ_THREADS_ENV);
+        if (env != nullptr && strtoul(env, nullptr, 10) > 0) {
+            num_threads = strtoul(env, nullptr, 10);
+        }
+        queue.reset(new RdcAsyncClientQueue(num_threads));
+        shared = queue;
+    }
+    return queue;
+}
+
+RdcAsyncClientQueue::RdcAsyncClientQueue(uint32_t num_threads) {
+    for (uint32_t i = 0; i < num_threads; i++) {
+        threads_.emplace_back(&RdcAsyncClientQueue::poll, this);
+    }
+}
+
+// The connections cancel and wait for their requests before releasing the
+// queue, so nothing is left in flight here.
+RdcAsyncClientQueue::~RdcAsyncClientQueue() {
+    cq_.Shutdown();
+    for (auto& t : threads_) {
+        t.join();
+    }
+}
+
+void RdcAsyncClientQueue::poll() {
+    void* tag;
+    bool ok;
+    while (cq_.Next(&tag, &ok)) {
+        // Finish of a unary request always completes with ok
+        RdcAsyncClientCall* call = static_cast<RdcAsyncClientCall*>(tag);
+        call->complete();
+        delete call;
+    }
+}
+
+}  // namespace rdc
+}  // namespace amd
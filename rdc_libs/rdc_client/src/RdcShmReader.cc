@@ -0,0 +1,201 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "rdc_lib/impl/RdcShmReader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include "rdc_lib/rdc_common.h"
+
+namespace amd {
+namespace rdc {
+
+// Give up on a slot which is rewritten faster than it can be copied
+static const uint32_t kMaxReadRetries = 64;
+// How long the values of a gone rdcd may still be read
+static const int64_t kShmWriterCheckMs = 100;
+
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RdcShmReader::RdcShmReader() : segment_(nullptr), next_check_ms_(0) {
+}
+
+RdcShmReader::~RdcShmReader() {
+    unmap_segment(segment_.load(std::memory_order_relaxed));
+    for (Segment* segment : retired_) {
+        unmap_segment(segment);
+    }
+}
+
+bool RdcShmReader::writer_alive(const RdcShmHeader* header) {
+    // rdcd clears the magic when it exits cleanly
+    return header->magic.load(std::memory_order_acquire) == kRdcShmMagic &&
+        (kill(header->writer_pid, 0) == 0 || errno == EPERM);
+}
+
+RdcShmReader::Segment* RdcShmReader::map_segment(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+            static_cast<size_t>(st.st_size) < rdc_shm_size(0)) {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    const RdcShmHeader* header = static_cast<const RdcShmHeader*>(base);
+    bool valid =
+        header->magic.load(std::memory_order_acquire) == kRdcShmMagic &&
+        header->version == kRdcShmVersion &&
+        header->slot_size == sizeof(RdcShmSlot) &&
+        header->capacity > 0 &&
+        (header->capacity & (header->capacity - 1)) == 0 &&
+        rdc_shm_size(header->capacity) <= size &&
+        writer_alive(header);
+    if (!valid) {
+        munmap(base, size);
+        return nullptr;
+    }
+
+    Segment* segment = new Segment;
+    segment->base = base;
+    segment->size = size;
+    segment->header = header;
+    segment->slots = rdc_shm_slots(base);
+    return segment;
+}
+
+void RdcShmReader::unmap_segment(Segment* segment) {
+    if (segment != nullptr) {
+        munmap(segment->base, segment->size);
+        delete segment;
+    }
+}
+
+rdc_status_t RdcShmReader::open(const std::string& name) {
+    if (segment_.load(std::memory_order_relaxed) != nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    Segment* segment = map_segment(name);
+    if (segment == nullptr) {
+        return RDC_ST_NOT_FOUND;
+    }
+    name_ = name;
+    next_check_ms_.store(now_ms() + kShmWriterCheckMs,
+                         std::memory_order_relaxed);
+    segment_.store(segment, std::memory_order_release);
+    return RDC_ST_OK;
+}
+
+const RdcShmReader::Segment* RdcShmReader::current_segment() {
+    int64_t now = now_ms();
+    if (name_.empty() ||
+            now < next_check_ms_.load(std::memory_order_relaxed)) {
+        return segment_.load(std::memory_order_acquire);
+    }
+
+    // The other threads keep reading while one of them checks
+    std::unique_lock<std::mutex> lock(check_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() ||
+            now < next_check_ms_.load(std::memory_order_relaxed)) {
+        return segment_.load(std::memory_order_acquire);
+    }
+    next_check_ms_.store(now + kShmWriterCheckMs, std::memory_order_relaxed);
+
+    Segment* segment = segment_.load(std::memory_order_relaxed);
+    if (segment != nullptr && writer_alive(segment->header)) {
+        return segment;
+    }
+    // rdcd is gone. A restarted rdcd creates a new segment of that name.
+    Segment* fresh = map_segment(name_);
+    if (segment != nullptr) {
+        retired_.push_back(segment);
+    }
+    segment_.store(fresh, std::memory_order_release);
+    return fresh;
+}
+
+rdc_status_t RdcShmReader::read(uint32_t gpu_index, rdc_field_t field_id,
+                                rdc_field_value* value) {
+    if (value == nullptr) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    const Segment* segment = current_segment();
+    if (segment == nullptr) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    const RdcShmSlot* slots = segment->slots;
+    uint64_t key = rdc_pack_key(RdcFieldKey(gpu_index, field_id));
+    uint32_t mask = segment->header->capacity - 1;
+    uint32_t index = static_cast<uint32_t>(rdc_hash_key(key)) & mask;
+    const RdcShmSlot* slot = nullptr;
+    for (uint32_t probes = 0; probes <= mask; probes++) {
+        uint64_t k = slots[index].key.load(std::memory_order_acquire);
+        if (k == key) {
+            slot = &slots[index];
+            break;
+        }
+        if (k == kRdcShmEmptyKey) {
+            return RDC_ST_NOT_FOUND;
+        }
+        index = (index + 1) & mask;
+    }
+    if (slot == nullptr) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    for (uint32_t retry = 0; retry < kMaxReadRetries; retry++) {
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            // Let the writer finish, it may be waiting for this CPU
+            sched_yield();
+            continue;
+        }
+        memcpy(value, &slot->value, sizeof(*value));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->seq.load(std::memory_order_relaxed) == seq) {
+            return value->status == RDC_ST_OK ? RDC_ST_OK : RDC_ST_NOT_FOUND;
+        }
+    }
+    return RDC_ST_NOT_FOUND;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -21,7 +21,19 @@ THE SOFTWARE.
 */
 #include "rdc_lib/impl/RdcStandaloneHandler.h"
 #include <grpcpp/grpcpp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
 #include "rdc.grpc.pb.h" // NOLINT
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcTracer.h"
 
 amd::rdc::RdcHandler *make_handler(const char* ip_and_port,
         const char* root_ca, const char* client_cert, const char* client_key) {
@@ -32,25 +44,175 @@ amd::rdc::RdcHandler *make_handler(const char* ip_and_port,
 namespace amd {
 namespace rdc {
 
+// Whether an rdcd is accepting connections on the socket
+static bool unix_socket_alive(const std::string& path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    int ret = connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                      sizeof(addr));
+    close(fd);
+    return ret == 0;
+}
+
+// Whether ip_and_port is an rdcd on this node, and its port
+static bool is_local_target(const char* ip_and_port, std::string* port) {
+    std::string target(ip_and_port);
+    size_t colon = target.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    std::string host = target.substr(0, colon);
+    *port = target.substr(colon + 1);
+    return host == "localhost" || host == "127.0.0.1" || host == "[::1]";
+}
+
+// When connecting to an rdcd on this node, use its Unix socket instead of
+// TCP and TLS. Returns the "unix:" target, or an empty string to connect
+// to ip_and_port as given.
+static std::string local_socket_target(const std::string& port) {
+
+    std::vector<std::string> candidates;
+    const char* env = getenv(RDC_UNIX_SOCKET_ENV);
+    if (env != nullptr) {
+        if (*env == '\0' || strcmp(env, "none") == 0) {
+            return "";
+        }
+        candidates.push_back(env);
+    } else {
+        candidates.push_back(rdc_unix_socket_path(RDC_UNIX_SOCKET_RUN_DIR,
+                                                  port));
+        candidates.push_back(rdc_unix_socket_path(RDC_UNIX_SOCKET_TMP_DIR,
+                                                  port));
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        const std::string& path = candidates[i];
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode) ||
+                access(path.c_str(), W_OK) != 0) {
+            continue;
+        }
+        // Anyone can create a socket in /tmp, so only trust one created
+        // by root or by ourselves.
+        if (env == nullptr && i > 0 && st.st_uid != 0 &&
+                st.st_uid != geteuid()) {
+            continue;
+        }
+        if (unix_socket_alive(path)) {
+            return "unix:" + path;
+        }
+    }
+    return "";
+}
+
+// How long cached metadata is trusted when nothing else is heard from rdcd,
+// e.g. when the latest values come from the shared memory
+static const uint32_t kDefaultMetadataCacheMs = 1000;
+
+static std::chrono::milliseconds metadata_cache_ttl() {
+    const char* env = getenv(RDC_METADATA_CACHE_MS_ENV);
+    if (env == nullptr || *env == '\0') {
+        return std::chrono::milliseconds(kDefaultMetadataCacheMs);
+    }
+    return std::chrono::milliseconds(strtoul(env, nullptr, 10));
+}
+
+// The configuration generation rdcd attached to a response, 0 if none
+static uint64_t response_generation(const ::grpc::ClientContext& context) {
+    const auto& metadata = context.GetServerInitialMetadata();
+    auto it = metadata.find(RDC_CONFIG_GENERATION_KEY);
+    if (it == metadata.end()) {
+        return 0;
+    }
+    std::string value(it->second.data(), it->second.size());
+    return strtoull(value.c_str(), nullptr, 10);
+}
+
+// Copy a GetLatestFieldValue or GetFieldSince reply, or a value of
+// GetLatestFieldValues or GetFieldValuesSince
+template <typename Reply>
+static void copy_field_value(const Reply& reply, rdc_field_value* value) {
+    value->field_id = static_cast<rdc_field_t>(reply.field_id());
+    value->status = reply.rdc_status();
+    value->ts = reply.ts();
+    value->type = static_cast<rdc_field_type_t>(reply.type());
+    if (value->type == INTEGER) {
+        value->value.l_int = reply.l_int();
+    } else if (value->type == DOUBLE) {
+        value->value.dbl = reply.dbl();
+    } else if (value->type == STRING || value->type == BLOB) {
+        strncpy_with_null(value->value.str,
+            reply.str().c_str(), RDC_MAX_STR_LENGTH);
+    }
+}
+
+// Map the latest value segment of a local rdcd started with --shm
+static std::unique_ptr<RdcShmReader> local_shm_reader(const std::string& port) {
+    std::string name = rdc_shm_default_name(port);
+    const char* env = getenv(RDC_SHM_NAME_ENV);
+    if (env != nullptr) {
+        if (*env == '\0' || strcmp(env, "none") == 0) {
+            return nullptr;
+        }
+        name = env;
+    }
+
+    std::unique_ptr<RdcShmReader> reader(new RdcShmReader());
+    if (reader->open(name) != RDC_ST_OK) {
+        return nullptr;
+    }
+    return reader;
+}
+
 RdcStandaloneHandler::RdcStandaloneHandler(const char* ip_and_port,
-    const char* root_ca, const char* client_cert, const char* client_key) {
+    const char* root_ca, const char* client_cert, const char* client_key):
+    config_generation_(0), cache_ttl_(metadata_cache_ttl()),
+    devices_cached_(false) {
         std::shared_ptr<grpc::ChannelCredentials> cred(nullptr);
-        if (root_ca == nullptr || client_cert == nullptr
-         || client_key == nullptr) {
-             cred = grpc::InsecureChannelCredentials();
-         } else {
-             grpc::SslCredentialsOptions sslOpts{};
-             sslOpts.pem_root_certs = root_ca;
-             sslOpts.pem_private_key = client_key;
-             sslOpts.pem_cert_chain = client_cert;
-             cred = grpc::SslCredentials(sslOpts);
-         }
-        stub_ = ::rdc::RdcAPI::NewStub(grpc::CreateChannel(ip_and_port, cred));
+        std::string port;
+        std::string local_target;
+        if (is_local_target(ip_and_port, &port)) {
+            shm_reader_ = local_shm_reader(port);
+            local_target = local_socket_target(port);
+        }
+        std::shared_ptr<grpc::Channel> channel;
+        if (!local_target.empty()) {
+            // The socket is authorized by the uid of the peer
+            channel = grpc::CreateChannel(local_target,
+                        grpc::InsecureChannelCredentials());
+        } else {
+            if (root_ca == nullptr || client_cert == nullptr
+             || client_key == nullptr) {
+                 cred = grpc::InsecureChannelCredentials();
+             } else {
+                 grpc::SslCredentialsOptions sslOpts{};
+                 sslOpts.pem_root_certs = root_ca;
+                 sslOpts.pem_private_key = client_key;
+                 sslOpts.pem_cert_chain = client_cert;
+                 cred = grpc::SslCredentials(sslOpts);
+             }
+            channel = grpc::CreateChannel(ip_and_port, cred);
+        }
+        stub_ = ::rdc::RdcAPI::NewStub(channel);
+        aggregator_stub_ = ::rdc::RdcAggregator::NewStub(channel);
+        admin_stub_ = ::rdc::RdcAdmin::NewStub(channel);
     }
 
 
-rdc_status_t RdcStandaloneHandler::error_handle(::grpc::Status status,
+rdc_status_t RdcStandaloneHandler::error_handle(
+        const ::grpc::ClientContext& context, ::grpc::Status status,
         uint32_t rdc_status) {
+    observe_generation(context);
     if (!status.ok()) {
         std::cout<< status.error_message() <<". Error code:"
             << status.error_code() << std::endl;
@@ -60,6 +222,36 @@ rdc_status_t RdcStandaloneHandler::error_handle(::grpc::Status status,
     return static_cast<rdc_status_t>(rdc_status);
 }
 
+void RdcStandaloneHandler::observe_generation(
+        const ::grpc::ClientContext& context) {
+    uint64_t generation = response_generation(context);
+    if (generation == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(cache_mutex_);
+    if (generation != config_generation_) {
+        config_generation_ = generation;
+        devices_cached_ = false;
+        devices_.clear();
+        device_names_.clear();
+        gpu_groups_.clear();
+        field_groups_.clear();
+    }
+    generation_seen_ = std::chrono::steady_clock::now();
+}
+
+bool RdcStandaloneHandler::cache_usable() const {
+    return cache_ttl_.count() > 0 && config_generation_ != 0 &&
+        std::chrono::steady_clock::now() - generation_seen_ <= cache_ttl_;
+}
+
+bool RdcStandaloneHandler::cache_current(
+        const ::grpc::ClientContext& context) const {
+    return cache_ttl_.count() > 0 &&
+        response_generation(context) == config_generation_;
+}
+
 // JOB RdcAPI
 rdc_status_t RdcStandaloneHandler::rdc_job_start_stats(
        rdc_gpu_group_t groupId, const char job_id[64], uint64_t update_freq) {
@@ -71,7 +263,7 @@ rdc_status_t RdcStandaloneHandler::rdc_job_start_stats(
     request.set_job_id(job_id);
     request.set_update_freq(update_freq);
     ::grpc::Status status = stub_->StartJobStats(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
 
     return err_status;
 }
@@ -153,16 +345,63 @@ rdc_status_t RdcStandaloneHandler::rdc_job_get_stats(const char job_id[64],
 
     request.set_job_id(job_id);
     ::grpc::Status status = stub_->GetJobStats(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    copy_job_info(reply, p_job_info);
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_job_get_moments(const char job_id[64],
+            rdc_job_gpu_moments_t* gpus, uint32_t* count) {
+    ::rdc::GetJobMomentsRequest request;
+    ::rdc::GetJobMomentsResponse reply;
+    ::grpc::ClientContext context;
+
+    request.set_job_id(job_id);
+    ::grpc::Status status = stub_->GetJobMoments(&context, request, &reply);
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    p_job_info->num_gpus = reply.num_gpus();
-    copy_gpu_usage_info(reply.summary(), &(p_job_info->summary));
+    std::vector<rdc_job_gpu_moments_t> result;
     for (int i = 0; i < reply.gpus_size(); i++) {
-        copy_gpu_usage_info(reply.gpus(i), &(p_job_info->gpus[i]));
+        const ::rdc::GpuMoments& src = reply.gpus(i);
+        rdc_job_gpu_moments_t gpu;
+        gpu.gpu_index = src.gpu_index();
+        gpu.start_time = src.start_time();
+        gpu.end_time = src.end_time();
+        gpu.energy_consumed = src.energy_consumed();
+        gpu.ecc_correct = src.ecc_correct();
+        gpu.ecc_uncorrect = src.ecc_uncorrect();
+        gpu.memory_total = src.memory_total();
+        gpu.num_fields = 0;
+        for (int f = 0; f < src.fields_size() &&
+                gpu.num_fields < RDC_MAX_JOB_FIELDS; f++) {
+            rdc_field_moments_t& field = gpu.fields[gpu.num_fields++];
+            field.field_id = static_cast<rdc_field_t>(
+                    src.fields(f).field_id());
+            field.count = src.fields(f).count();
+            field.min_value = src.fields(f).min_value();
+            field.max_value = src.fields(f).max_value();
+            field.mean = src.fields(f).mean();
+            field.m2 = src.fields(f).m2();
+        }
+        result.push_back(gpu);
     }
 
-    return RDC_ST_OK;
+    return copy_to_ext_array(result, gpus, count);
+}
+
+void RdcStandaloneHandler::copy_job_info(
+            const ::rdc::GetJobStatsResponse& src, rdc_job_info_t* target) {
+    target->num_gpus = src.num_gpus();
+    copy_gpu_usage_info(src.summary(), &(target->summary));
+    const int max_job_gpus = sizeof(target->gpus) /
+                sizeof(target->gpus[0]);
+    for (int i = 0; i < src.gpus_size() && i < max_job_gpus; i++) {
+        copy_gpu_usage_info(src.gpus(i), &(target->gpus[i]));
+    }
 }
 
 rdc_status_t RdcStandaloneHandler::rdc_job_stop_stats(const char job_id[64]) {
@@ -172,7 +411,7 @@ rdc_status_t RdcStandaloneHandler::rdc_job_stop_stats(const char job_id[64]) {
 
     request.set_job_id(job_id);
     ::grpc::Status status = stub_->StopJobStats(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
 
     return err_status;
 }
@@ -184,7 +423,7 @@ rdc_status_t RdcStandaloneHandler::rdc_job_remove(const char job_id[64]) {
 
     request.set_job_id(job_id);
     ::grpc::Status status = stub_->RemoveJob(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
 
     return err_status;
 }
@@ -195,42 +434,89 @@ rdc_status_t RdcStandaloneHandler::rdc_job_remove_all() {
     ::grpc::ClientContext context;
 
     ::grpc::Status status = stub_->RemoveAllJob(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
 
     return err_status;
 }
 
 // Discovery RdcAPI
-rdc_status_t RdcStandaloneHandler::rdc_device_get_all(
-        uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count)  {
-    if (!count) {
-        return RDC_ST_BAD_PARAMETER;
+rdc_status_t RdcStandaloneHandler::get_all_devices(
+        std::vector<uint32_t>* gpus) {
+    {
+        std::lock_guard<std::mutex> guard(cache_mutex_);
+        if (devices_cached_ && cache_usable()) {
+            *gpus = devices_;
+            return RDC_ST_OK;
+        }
     }
+
     ::rdc::Empty request;
     ::rdc::GetAllDevicesResponse reply;
     ::grpc::ClientContext context;
 
     ::grpc::Status status = stub_->GetAllDevices(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    if (reply.gpus_size() > RDC_MAX_NUM_DEVICES) {
+    gpus->assign(reply.gpus().begin(), reply.gpus().end());
+    std::lock_guard<std::mutex> guard(cache_mutex_);
+    if (cache_current(context)) {
+        devices_ = *gpus;
+        devices_cached_ = true;
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_device_get_all(
+        uint32_t gpu_index_list[RDC_MAX_NUM_DEVICES], uint32_t* count)  {
+    if (!count) {
         return RDC_ST_BAD_PARAMETER;
     }
+    std::vector<uint32_t> gpus;
+    rdc_status_t err_status = get_all_devices(&gpus);
+    if (err_status != RDC_ST_OK) return err_status;
 
-    *count = reply.gpus_size();
+    // Only the first RDC_MAX_NUM_DEVICES fit, rdc_device_get_all_ext
+    // returns the rest.
+    *count = std::min(static_cast<uint32_t>(gpus.size()),
+                      static_cast<uint32_t>(RDC_MAX_NUM_DEVICES));
     for (uint32_t i =0 ; i < *count; i++) {
-        gpu_index_list[i] = reply.gpus(i);
+        gpu_index_list[i] = gpus[i];
+    }
+    if (gpus.size() > RDC_MAX_NUM_DEVICES) {
+        return RDC_ST_MAX_LIMIT;
     }
 
     return RDC_ST_OK;
 }
 
+rdc_status_t RdcStandaloneHandler::rdc_device_get_all_ext(
+        uint32_t* gpu_index_list, uint32_t* count)  {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    std::vector<uint32_t> gpus;
+    rdc_status_t err_status = get_all_devices(&gpus);
+    if (err_status != RDC_ST_OK) return err_status;
+
+    return copy_to_ext_array(gpus, gpu_index_list, count);
+}
+
 rdc_status_t RdcStandaloneHandler::rdc_device_get_attributes(uint32_t gpu_index,
         rdc_device_attributes_t* p_rdc_attr) {
     if (!p_rdc_attr) {
         return RDC_ST_BAD_PARAMETER;
     }
+    {
+        std::lock_guard<std::mutex> guard(cache_mutex_);
+        auto it = device_names_.find(gpu_index);
+        if (it != device_names_.end() && cache_usable()) {
+            strncpy_with_null(p_rdc_attr->device_name, it->second.c_str(),
+                    RDC_MAX_STR_LENGTH);
+            return RDC_ST_OK;
+        }
+    }
+
     ::rdc::GetDeviceAttributesRequest request;
     ::rdc::GetDeviceAttributesResponse reply;
     ::grpc::ClientContext context;
@@ -238,12 +524,16 @@ rdc_status_t RdcStandaloneHandler::rdc_device_get_attributes(uint32_t gpu_index,
     request.set_gpu_index(gpu_index);
     ::grpc::Status status = stub_->
                 GetDeviceAttributes(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
     strncpy_with_null(p_rdc_attr->device_name,
         reply.attributes().device_name().c_str(), RDC_MAX_STR_LENGTH);
 
+    std::lock_guard<std::mutex> guard(cache_mutex_);
+    if (cache_current(context)) {
+        device_names_[gpu_index] = reply.attributes().device_name();
+    }
 
     return RDC_ST_OK;
 }
@@ -266,7 +556,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_gpu_create(rdc_group_type_t type,
     request.set_group_name(group_name);
     ::grpc::Status status = stub_->
         CreateGpuGroup(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
     *p_rdc_group_id = reply.group_id();
@@ -284,7 +574,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_gpu_add(rdc_gpu_group_t group_id,
     request.set_gpu_index(gpu_index);
     ::grpc::Status status = stub_->
         AddToGpuGroup(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
 
     return err_status;
 }
@@ -307,76 +597,146 @@ rdc_status_t RdcStandaloneHandler::rdc_group_field_create(
 
     ::grpc::Status status = stub_->
         CreateFieldGroup(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
     *rdc_field_group_id = reply.field_group_id();
 
     return RDC_ST_OK;
 }
 
-rdc_status_t RdcStandaloneHandler::rdc_group_field_get_info(
-        rdc_field_grp_t rdc_field_group_id,
-        rdc_field_group_info_t* field_group_info) {
-    if (!field_group_info) {
-         return RDC_ST_BAD_PARAMETER;
+rdc_status_t RdcStandaloneHandler::get_field_group(
+        rdc_field_grp_t field_group_id, RdcGroupCacheEntry* group) {
+    {
+        std::lock_guard<std::mutex> guard(cache_mutex_);
+        auto it = field_groups_.find(field_group_id);
+        if (it != field_groups_.end() && cache_usable()) {
+            *group = it->second;
+            return RDC_ST_OK;
+        }
     }
 
     ::rdc::GetFieldGroupInfoRequest request;
     ::rdc::GetFieldGroupInfoResponse reply;
     ::grpc::ClientContext context;
 
-    request.set_field_group_id(rdc_field_group_id);
+    request.set_field_group_id(field_group_id);
     ::grpc::Status status = stub_->
         GetFieldGroupInfo(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    if (reply.field_ids_size() > RDC_MAX_FIELD_IDS_PER_FIELD_GROUP) {
+    group->name = reply.filed_group_name();
+    group->ids.assign(reply.field_ids().begin(), reply.field_ids().end());
+
+    std::lock_guard<std::mutex> guard(cache_mutex_);
+    if (cache_current(context)) {
+        field_groups_[field_group_id] = *group;
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_group_field_get_info(
+        rdc_field_grp_t rdc_field_group_id,
+        rdc_field_group_info_t* field_group_info) {
+    if (!field_group_info) {
+         return RDC_ST_BAD_PARAMETER;
+    }
+
+    RdcGroupCacheEntry group;
+    rdc_status_t err_status = get_field_group(rdc_field_group_id, &group);
+    if (err_status != RDC_ST_OK) return err_status;
+
+    if (group.ids.size() > RDC_MAX_FIELD_IDS_PER_FIELD_GROUP) {
         return RDC_ST_MAX_LIMIT;
     }
 
-    field_group_info->count = reply.field_ids_size();
+    field_group_info->count = group.ids.size();
     strncpy_with_null(field_group_info->group_name,
-                reply.filed_group_name().c_str(), RDC_MAX_STR_LENGTH);
-    for (int i = 0; i < reply.field_ids_size(); i++) {
+                group.name.c_str(), RDC_MAX_STR_LENGTH);
+    for (uint32_t i = 0; i < group.ids.size(); i++) {
         field_group_info->field_ids[i] =
-                                 static_cast<rdc_field_t>(reply.field_ids(i));
+                                 static_cast<rdc_field_t>(group.ids[i]);
     }
 
     return RDC_ST_OK;
 }
 
-rdc_status_t RdcStandaloneHandler::rdc_group_gpu_get_info(
-        rdc_gpu_group_t p_rdc_group_id,
-        rdc_group_info_t* p_rdc_group_info) {
-    if (!p_rdc_group_info) {
-         return RDC_ST_BAD_PARAMETER;
+rdc_status_t RdcStandaloneHandler::get_gpu_group(rdc_gpu_group_t group_id,
+        RdcGroupCacheEntry* group) {
+    {
+        std::lock_guard<std::mutex> guard(cache_mutex_);
+        auto it = gpu_groups_.find(group_id);
+        if (it != gpu_groups_.end() && cache_usable()) {
+            *group = it->second;
+            return RDC_ST_OK;
+        }
     }
 
     ::rdc::GetGpuGroupInfoRequest request;
     ::rdc::GetGpuGroupInfoResponse reply;
     ::grpc::ClientContext context;
 
-    request.set_group_id(p_rdc_group_id);
+    request.set_group_id(group_id);
     ::grpc::Status status = stub_->
         GetGpuGroupInfo(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    if (reply.entity_ids_size() > RDC_GROUP_MAX_ENTITIES) {
-        return RDC_ST_MAX_LIMIT;
+    group->name = reply.group_name();
+    group->ids.assign(reply.entity_ids().begin(), reply.entity_ids().end());
+
+    std::lock_guard<std::mutex> guard(cache_mutex_);
+    if (cache_current(context)) {
+        gpu_groups_[group_id] = *group;
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_group_gpu_get_info(
+        rdc_gpu_group_t p_rdc_group_id,
+        rdc_group_info_t* p_rdc_group_info) {
+    if (!p_rdc_group_info) {
+         return RDC_ST_BAD_PARAMETER;
     }
 
-    p_rdc_group_info->count = reply.entity_ids_size();
+    RdcGroupCacheEntry group;
+    rdc_status_t err_status = get_gpu_group(p_rdc_group_id, &group);
+    if (err_status != RDC_ST_OK) return err_status;
+
+    // Fill what fits, the callers of the legacy struct see the first GPUs
+    uint32_t count = std::min<uint32_t>(group.ids.size(),
+                RDC_GROUP_MAX_ENTITIES);
+    p_rdc_group_info->count = count;
     strncpy_with_null(p_rdc_group_info->group_name,
-                reply.group_name().c_str(), RDC_MAX_STR_LENGTH);
-    for (int i = 0; i < reply.entity_ids_size(); i++) {
-        p_rdc_group_info->entity_ids[i] = reply.entity_ids(i);
+                group.name.c_str(), RDC_MAX_STR_LENGTH);
+    for (uint32_t i = 0; i < count; i++) {
+        p_rdc_group_info->entity_ids[i] = group.ids[i];
     }
 
+    if (group.ids.size() > RDC_GROUP_MAX_ENTITIES) {
+        return RDC_ST_MAX_LIMIT;
+    }
     return RDC_ST_OK;
 }
 
+rdc_status_t RdcStandaloneHandler::rdc_group_gpu_get_info_ext(
+        rdc_gpu_group_t p_rdc_group_id, char group_name[RDC_MAX_STR_LENGTH],
+        uint32_t* entity_ids, uint32_t* count) {
+    if (!count) {
+         return RDC_ST_BAD_PARAMETER;
+    }
+
+    RdcGroupCacheEntry group;
+    rdc_status_t err_status = get_gpu_group(p_rdc_group_id, &group);
+    if (err_status != RDC_ST_OK) return err_status;
+
+    if (group_name) {
+        strncpy_with_null(group_name, group.name.c_str(),
+                    RDC_MAX_STR_LENGTH);
+    }
+    return copy_to_ext_array(group.ids, entity_ids, count);
+}
+
 rdc_status_t RdcStandaloneHandler::rdc_group_get_all_ids(
     rdc_gpu_group_t group_id_list[], uint32_t* count) {
     if (!count) {
@@ -388,7 +748,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_get_all_ids(
 
     ::grpc::Status status = stub_->
         GetGroupAllIds(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
     *count = reply.group_ids_size();
@@ -414,7 +774,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_field_get_all_ids(
 
     ::grpc::Status status = stub_->
         GetFieldGroupAllIds(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
     *count = reply.field_group_ids_size();
@@ -428,6 +788,45 @@ rdc_status_t RdcStandaloneHandler::rdc_group_field_get_all_ids(
     return RDC_ST_OK;
 }
 
+rdc_status_t RdcStandaloneHandler::rdc_group_get_all_ids_ext(
+    rdc_gpu_group_t* group_id_list, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::Empty request;
+    ::rdc::GetGroupAllIdsResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = stub_->
+        GetGroupAllIds(&context, request, &reply);
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    std::vector<rdc_gpu_group_t> ids(reply.group_ids().begin(),
+                    reply.group_ids().end());
+    return copy_to_ext_array(ids, group_id_list, count);
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_group_field_get_all_ids_ext(
+    rdc_field_grp_t* field_group_id_list, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    ::rdc::Empty request;
+    ::rdc::GetFieldGroupAllIdsResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = stub_->
+        GetFieldGroupAllIds(&context, request, &reply);
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    std::vector<rdc_field_grp_t> ids(reply.field_group_ids().begin(),
+                    reply.field_group_ids().end());
+    return copy_to_ext_array(ids, field_group_id_list, count);
+}
+
 rdc_status_t RdcStandaloneHandler::rdc_group_gpu_destroy(
         rdc_gpu_group_t p_rdc_group_id) {
     ::rdc::DestroyGpuGroupRequest request;
@@ -437,7 +836,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_gpu_destroy(
     request.set_group_id(p_rdc_group_id);
     ::grpc::Status status = stub_->
         DestroyGpuGroup(&context, request, &reply);
-    return error_handle(status, reply.status());
+    return error_handle(context, status, reply.status());
 }
 
 rdc_status_t RdcStandaloneHandler::rdc_group_field_destroy(
@@ -449,7 +848,7 @@ rdc_status_t RdcStandaloneHandler::rdc_group_field_destroy(
     request.set_field_group_id(rdc_field_group_id);
     ::grpc::Status status = stub_->
         DestroyFieldGroup(&context, request, &reply);
-    return error_handle(status, reply.status());
+    return error_handle(context, status, reply.status());
 }
 
 // Field RdcAPI
@@ -468,7 +867,7 @@ rdc_status_t RdcStandaloneHandler::rdc_field_watch(rdc_gpu_group_t group_id,
     ::grpc::Status status = stub_->
         WatchFields(&context, request, &reply);
 
-    return error_handle(status, reply.status());
+    return error_handle(context, status, reply.status());
 }
 
 rdc_status_t RdcStandaloneHandler::rdc_field_get_latest_value(
@@ -477,6 +876,12 @@ rdc_status_t RdcStandaloneHandler::rdc_field_get_latest_value(
         return RDC_ST_BAD_PARAMETER;
     }
 
+    // Fields not in the shared memory still come from the cache of rdcd
+    if (shm_reader_ &&
+            shm_reader_->read(gpu_index, field, value) == RDC_ST_OK) {
+        return RDC_ST_OK;
+    }
+
     ::rdc::GetLatestFieldValueRequest request;
     ::rdc::GetLatestFieldValueResponse reply;
     ::grpc::ClientContext context;
@@ -485,20 +890,62 @@ rdc_status_t RdcStandaloneHandler::rdc_field_get_latest_value(
     request.set_field_id(field);
     ::grpc::Status status = stub_->
         GetLatestFieldValue(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    value->field_id = static_cast<rdc_field_t>(reply.field_id());
-    value->status = reply.rdc_status();
-    value->ts = reply.ts();
-    value->type = static_cast<rdc_field_type_t>(reply.type());
-    if (value->type == INTEGER) {
-        value->value.l_int = reply.l_int();
-    } else if (value->type == DOUBLE) {
-        value->value.dbl = reply.dbl();
-    } else if (value->type == STRING || value->type == BLOB) {
-        strncpy_with_null(value->value.str,
-            reply.str().c_str(), RDC_MAX_STR_LENGTH);
+    copy_field_value(reply, value);
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_field_get_latest_values(
+        const uint32_t* gpu_indexes, uint32_t num_gpus,
+        const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_field_value* values) {
+    if ((num_gpus > 0 && !gpu_indexes) || (num_fields > 0 && !field_ids) ||
+            (num_gpus > 0 && num_fields > 0 && !values)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    // Ask rdcd at once for those not in the shared memory
+    ::rdc::GetLatestFieldValuesRequest request;
+    std::vector<uint32_t> requested;
+    for (uint32_t i = 0; i < num_gpus; i++) {
+        for (uint32_t j = 0; j < num_fields; j++) {
+            uint32_t index = i * num_fields + j;
+            if (shm_reader_ && shm_reader_->read(gpu_indexes[i],
+                    field_ids[j], &values[index]) == RDC_ST_OK) {
+                continue;
+            }
+            ::rdc::GetLatestFieldValueRequest* field = request.add_fields();
+            field->set_gpu_index(gpu_indexes[i]);
+            field->set_field_id(field_ids[j]);
+            requested.push_back(index);
+        }
+    }
+    if (requested.empty()) {
+        return RDC_ST_OK;
+    }
+
+    ::rdc::GetLatestFieldValuesResponse reply;
+    ::grpc::ClientContext context;
+    ::grpc::Status status = stub_->
+        GetLatestFieldValues(&context, request, &reply);
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+    if (reply.values_size() != static_cast<int>(requested.size())) {
+        return RDC_ST_CLIENT_ERROR;
+    }
+
+    for (size_t k = 0; k < requested.size(); k++) {
+        const ::rdc::GetLatestFieldValueResponse& item = reply.values(k);
+        rdc_field_value* value = &values[requested[k]];
+        if (item.status() != RDC_ST_OK) {
+            value->field_id = field_ids[requested[k] % num_fields];
+            value->status = item.status();
+            continue;
+        }
+        copy_field_value(item, value);
     }
 
     return RDC_ST_OK;
@@ -520,20 +967,50 @@ rdc_status_t RdcStandaloneHandler::rdc_field_get_value_since(uint32_t gpu_index,
     request.set_since_time_stamp(since_time_stamp);
     ::grpc::Status status = stub_->
         GetFieldSince(&context, request, &reply);
-    rdc_status_t err_status = error_handle(status, reply.status());
+    rdc_status_t err_status = error_handle(context, status, reply.status());
     if (err_status != RDC_ST_OK) return err_status;
 
-    value->field_id = static_cast<rdc_field_t>(reply.field_id());
-    value->status = reply.rdc_status();
-    value->ts = reply.ts();
-    value->type = static_cast<rdc_field_type_t>(reply.type());
-    if (value->type == INTEGER) {
-        value->value.l_int = reply.l_int();
-    } else if (value->type == DOUBLE) {
-        value->value.dbl = reply.dbl();
-    } else if (value->type == STRING || value->type == BLOB) {
-        strncpy_with_null(value->value.str,
-            reply.str().c_str(), RDC_MAX_STR_LENGTH);
+    copy_field_value(reply, value);
+    *next_since_time_stamp = reply.next_since_time_stamp();
+
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_field_get_values_since(
+        uint32_t gpu_index, rdc_field_t field, uint64_t since_time_stamp,
+        uint64_t *next_since_time_stamp, rdc_field_value* values,
+        uint32_t* count) {
+    if (!next_since_time_stamp || !count || (*count > 0 && !values)) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    uint32_t capacity = *count;
+    *count = 0;
+    *next_since_time_stamp = since_time_stamp;
+
+    ::rdc::GetFieldValuesSinceRequest request;
+    ::rdc::GetFieldValuesSinceResponse reply;
+    ::grpc::ClientContext context;
+
+    request.set_gpu_index(gpu_index);
+    request.set_field_id(field);
+    request.set_since_time_stamp(since_time_stamp);
+    request.set_max_values(capacity);
+    ::grpc::Status status = stub_->
+        GetFieldValuesSince(&context, request, &reply);
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        // An rdcd predating the request, read one value per request
+        *count = capacity;
+        return RdcHandler::rdc_field_get_values_since(gpu_index, field,
+                since_time_stamp, next_since_time_stamp, values, count);
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+    if (reply.values_size() > static_cast<int>(capacity)) {
+        return RDC_ST_CLIENT_ERROR;
+    }
+
+    for (const auto& item : reply.values()) {
+        copy_field_value(item, &values[(*count)++]);
     }
     *next_since_time_stamp = reply.next_since_time_stamp();
 
@@ -551,7 +1028,60 @@ rdc_status_t RdcStandaloneHandler::rdc_field_unwatch(rdc_gpu_group_t group_id,
     ::grpc::Status status = stub_->
         UnWatchFields(&context, request, &reply);
 
-    return error_handle(status, reply.status());
+    return error_handle(context, status, reply.status());
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_field_watch_set_limits(
+        rdc_gpu_group_t group_id, rdc_field_grp_t field_group_id,
+        uint32_t priority, uint64_t max_update_freq) {
+    ::rdc::SetWatchLimitsRequest request;
+    ::rdc::SetWatchLimitsResponse reply;
+    ::grpc::ClientContext context;
+
+    request.set_group_id(group_id);
+    request.set_field_group_id(field_group_id);
+    request.set_priority(priority);
+    request.set_max_update_freq(max_update_freq);
+    ::grpc::Status status = stub_->
+        SetWatchLimits(&context, request, &reply);
+    // Older rdcd do not have it
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+
+    return error_handle(context, status, reply.status());
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_field_get_watch_rates(
+        rdc_watch_rate_t* rates, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::Empty request;
+    ::rdc::GetWatchRatesResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = stub_->
+        GetWatchRates(&context, request, &reply);
+    // Older rdcd do not have it
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    std::vector<rdc_watch_rate_t> result(reply.rates_size());
+    for (int i = 0; i < reply.rates_size(); i++) {
+        const ::rdc::WatchRate& src = reply.rates(i);
+        rdc_watch_rate_t& target = result[i];
+        target.group_id = src.group_id();
+        target.field_group_id = src.field_group_id();
+        target.priority = src.priority();
+        target.requested_freq = src.requested_freq();
+        target.max_update_freq = src.max_update_freq();
+        target.effective_freq = src.effective_freq();
+    }
+    return copy_to_ext_array(result, rates, count);
 }
 
 
@@ -566,10 +1096,327 @@ rdc_status_t RdcStandaloneHandler::rdc_field_update_all(
     ::grpc::Status status = stub_->
         UpdateAllFields(&context, request, &reply);
 
-    return error_handle(status, reply.status());
+    return error_handle(context, status, reply.status());
+}
+
+
+// Async RdcAPI
+template <typename Reply>
+class RdcStandaloneHandler::AsyncCall : public RdcAsyncClientCall {
+ public:
+    typedef std::function<void(rdc_status_t, const Reply&)> Done;
+
+    AsyncCall(RdcStandaloneHandler* handler, Done done):
+        handler_(handler), done_(done) {}
+
+    void complete() override {
+        rdc_status_t result = static_cast<rdc_status_t>(reply.status());
+        if (status.error_code() == ::grpc::StatusCode::DEADLINE_EXCEEDED) {
+            result = RDC_ST_TIMEOUT;
+        } else if (!status.ok()) {
+            result = RDC_ST_CLIENT_ERROR;
+        }
+        handler_->observe_generation(context);
+        done_(result, reply);
+        handler_->finish_call(this);
+    }
+
+    Reply reply;
+    std::unique_ptr<::grpc::ClientAsyncResponseReader<Reply>> reader;
+
+ private:
+    RdcStandaloneHandler* handler_;
+    Done done_;
+};
+
+::grpc::CompletionQueue* RdcStandaloneHandler::start_call(
+        RdcAsyncClientCall* call, uint32_t timeout_ms) {
+    if (timeout_ms > 0) {
+        call->context.set_deadline(std::chrono::system_clock::now() +
+                std::chrono::milliseconds(timeout_ms));
+    }
+
+    std::lock_guard<std::mutex> guard(async_mutex_);
+    if (!async_queue_) {
+        async_queue_ = RdcAsyncClientQueue::get();
+    }
+    pending_calls_.insert(call);
+    return async_queue_->cq();
+}
+
+void RdcStandaloneHandler::finish_call(RdcAsyncClientCall* call) {
+    std::lock_guard<std::mutex> guard(async_mutex_);
+    pending_calls_.erase(call);
+    if (pending_calls_.empty()) {
+        async_cv_.notify_all();
+    }
+}
+
+RdcStandaloneHandler::~RdcStandaloneHandler() {
+    // A call stays alive until finish_call() took it out of the set
+    std::unique_lock<std::mutex> lock(async_mutex_);
+    for (auto call : pending_calls_) {
+        call->context.TryCancel();
+    }
+    async_cv_.wait(lock, [this] { return pending_calls_.empty(); });
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_field_get_latest_value_async(
+        uint32_t gpu_index, rdc_field_t field, uint32_t timeout_ms,
+        rdc_field_value_callback_t callback, void* user_data) {
+    if (!callback) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    if (shm_reader_) {
+        rdc_field_value value;
+        if (shm_reader_->read(gpu_index, field, &value) == RDC_ST_OK) {
+            callback(RDC_ST_OK, &value, user_data);
+            return RDC_ST_OK;
+        }
+    }
+
+    typedef ::rdc::GetLatestFieldValueResponse Reply;
+    AsyncCall<Reply>* call = new AsyncCall<Reply>(this,
+        [callback, user_data](rdc_status_t status, const Reply& reply) {
+            if (status != RDC_ST_OK) {
+                callback(status, nullptr, user_data);
+                return;
+            }
+            rdc_field_value value;
+            copy_field_value(reply, &value);
+            callback(RDC_ST_OK, &value, user_data);
+        });
+
+    ::rdc::GetLatestFieldValueRequest request;
+    request.set_gpu_index(gpu_index);
+    request.set_field_id(field);
+    ::grpc::CompletionQueue* cq = start_call(call, timeout_ms);
+    call->reader = stub_->
+        PrepareAsyncGetLatestFieldValue(&call->context, request, cq);
+    call->reader->StartCall();
+    // The call may complete and be deleted from here on
+    call->reader->Finish(&call->reply, &call->status, call);
+
+    return RDC_ST_OK;
 }
 
+rdc_status_t RdcStandaloneHandler::rdc_job_get_stats_async(
+        const char job_id[64], uint32_t timeout_ms,
+        rdc_job_info_callback_t callback, void* user_data) {
+    if (!callback) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    typedef ::rdc::GetJobStatsResponse Reply;
+    AsyncCall<Reply>* call = new AsyncCall<Reply>(this,
+        [this, callback, user_data](rdc_status_t status, const Reply& reply) {
+            if (status != RDC_ST_OK) {
+                callback(status, nullptr, user_data);
+                return;
+            }
+            rdc_job_info_t job_info;
+            copy_job_info(reply, &job_info);
+            callback(RDC_ST_OK, &job_info, user_data);
+        });
+
+    ::rdc::GetJobStatsRequest request;
+    request.set_job_id(job_id);
+    ::grpc::CompletionQueue* cq = start_call(call, timeout_ms);
+    call->reader = stub_->PrepareAsyncGetJobStats(&call->context, request, cq);
+    call->reader->StartCall();
+    call->reader->Finish(&call->reply, &call->status, call);
 
+    return RDC_ST_OK;
+}
+
+// Cluster RdcAPI
+rdc_status_t RdcStandaloneHandler::rdc_cluster_get_hosts(
+        rdc_cluster_host_t* hosts, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::Empty request;
+    ::rdc::GetClusterHostsResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = aggregator_stub_->
+                    GetClusterHosts(&context, request, &reply);
+    // Only an rdcd started with --aggregate has the service
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    std::vector<rdc_cluster_host_t> result(reply.hosts_size());
+    for (int i = 0; i < reply.hosts_size(); i++) {
+        const ::rdc::ClusterHost& src = reply.hosts(i);
+        strncpy_with_null(result[i].host, src.host().c_str(),
+                RDC_MAX_STR_LENGTH);
+        result[i].connected = src.connected() ? 1 : 0;
+        result[i].num_gpus = src.num_gpus();
+        result[i].age_ms = src.age_ms();
+        result[i].num_errors = src.num_errors();
+    }
+    return copy_to_ext_array(result, hosts, count);
+}
+
+rdc_status_t RdcStandaloneHandler::get_cluster_values(
+        const ::rdc::GetClusterLatestValuesRequest& request,
+        std::vector<rdc_cluster_field_value_t>* values) {
+    ::rdc::GetClusterLatestValuesResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = aggregator_stub_->
+                    GetClusterLatestValues(&context, request, &reply);
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    values->resize(reply.values_size());
+    for (int i = 0; i < reply.values_size(); i++) {
+        const ::rdc::ClusterFieldValue& src = reply.values(i);
+        rdc_cluster_field_value_t& target = (*values)[i];
+        strncpy_with_null(target.host, src.host().c_str(),
+                RDC_MAX_STR_LENGTH);
+        target.gpu_index = src.gpu_index();
+        target.age_ms = src.age_ms();
+        copy_field_value(src, &target.value);
+    }
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_cluster_get_latest_values(
+        const char* host, const rdc_field_t* field_ids, uint32_t num_fields,
+        rdc_cluster_field_value_t* values, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::GetClusterLatestValuesRequest request;
+    if (host) {
+        request.add_hosts(host);
+    }
+    for (uint32_t i = 0; i < num_fields; i++) {
+        request.add_field_ids(field_ids[i]);
+    }
+
+    std::vector<rdc_cluster_field_value_t> result;
+    rdc_status_t err_status = get_cluster_values(request, &result);
+    if (err_status != RDC_ST_OK) return err_status;
+
+    return copy_to_ext_array(result, values, count);
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_cluster_get_latest_value(
+        const char* host, uint32_t gpu_index, rdc_field_t field,
+        rdc_cluster_field_value_t* value) {
+    if (!host || !value) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::GetClusterLatestValuesRequest request;
+    request.add_hosts(host);
+    request.add_gpu_indexes(gpu_index);
+    request.add_field_ids(field);
+
+    std::vector<rdc_cluster_field_value_t> result;
+    rdc_status_t err_status = get_cluster_values(request, &result);
+    if (err_status != RDC_ST_OK) return err_status;
+    if (result.empty()) {
+        return RDC_ST_NOT_FOUND;
+    }
+
+    *value = result[0];
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_cluster_get_aggregate(
+        rdc_field_t field, uint32_t max_age_ms,
+        rdc_cluster_aggregate_t* aggregate) {
+    if (!aggregate) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::GetClusterAggregateRequest request;
+    ::rdc::GetClusterAggregateResponse reply;
+    ::grpc::ClientContext context;
+
+    request.set_field_id(field);
+    request.set_max_age_ms(max_age_ms);
+    ::grpc::Status status = aggregator_stub_->
+                    GetClusterAggregate(&context, request, &reply);
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    aggregate->field_id = static_cast<rdc_field_t>(reply.field_id());
+    aggregate->num_hosts = reply.num_hosts();
+    aggregate->num_values = reply.num_values();
+    aggregate->num_skipped = reply.num_skipped();
+    aggregate->min_value = reply.min_value();
+    aggregate->max_value = reply.max_value();
+    aggregate->sum = reply.sum();
+    aggregate->average = reply.average();
+    return RDC_ST_OK;
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_perf_metrics_get(
+        rdc_perf_metric_t* metrics, uint32_t* count) {
+    if (!count) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    ::rdc::Empty request;
+    ::rdc::GetPerfMetricsResponse reply;
+    ::grpc::ClientContext context;
+
+    ::grpc::Status status = admin_stub_->
+                    GetPerfMetrics(&context, request, &reply);
+    // Older rdcd do not have it
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    std::vector<rdc_perf_metric_t> result(reply.metrics_size());
+    for (int i = 0; i < reply.metrics_size(); i++) {
+        const ::rdc::PerfMetric& src = reply.metrics(i);
+        rdc_perf_metric_t& target = result[i];
+        memset(&target, 0, sizeof(target));
+        strncpy_with_null(target.name, src.name().c_str(),
+                RDC_PERF_NAME_LENGTH);
+        strncpy_with_null(target.label, src.label().c_str(),
+                RDC_PERF_NAME_LENGTH);
+        target.type = static_cast<rdc_perf_metric_type_t>(src.type());
+        target.value = src.value();
+        target.sum = src.sum();
+        for (int b = 0; b < src.buckets_size() &&
+                b < RDC_PERF_HISTOGRAM_BUCKETS; b++) {
+            target.buckets[b] = src.buckets(b);
+        }
+    }
+    return copy_to_ext_array(result, metrics, count);
+}
+
+rdc_status_t RdcStandaloneHandler::rdc_trace_get(uint32_t last_seconds,
+        char* buffer, uint32_t* size) {
+    ::rdc::GetTraceRequest request;
+    ::rdc::GetTraceResponse reply;
+    ::grpc::ClientContext context;
+
+    request.set_last_seconds(last_seconds);
+    ::grpc::Status status = admin_stub_->GetTrace(&context, request, &reply);
+    if (status.error_code() == ::grpc::StatusCode::UNIMPLEMENTED) {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+    rdc_status_t err_status = error_handle(context, status, reply.status());
+    if (err_status != RDC_ST_OK) return err_status;
+
+    return rdc_trace_copy(reply.trace(), buffer, size);
+}
 
 }  // namespace rdc
 }  // namespace amd
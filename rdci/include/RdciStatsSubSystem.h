@@ -23,6 +23,7 @@ THE SOFTWARE.
 #define RDCI_INCLUDE_RDCISTATSSUBSYSTEM_H_
 #include <signal.h>
 #include <string>
+#include <vector>
 #include "RdciSubSystem.h"
 
 
@@ -35,11 +36,14 @@ class RdciStatsSubSystem: public RdciSubSystem {
      ~RdciStatsSubSystem();
      void parse_cmd_opts(int argc, char ** argv) override;
      void process() override;
+     void connect() override;
 
  private:
      void show_help() const;
      void show_job_stats(const rdc_gpu_usage_info_t& gpu_info) const;
      void show_job_stats_json(const rdc_gpu_usage_info_t& gpu_info) const;
+     void get_job_moments(rdc_job_info_t* job_info,
+             std::vector<std::string>* gpu_names) const;
 
      enum OPERATIONS {
         STATS_UNKNOWN = 0,
@@ -55,6 +59,8 @@ class RdciStatsSubSystem: public RdciSubSystem {
      std::string job_id_;
      uint32_t group_id_;
      bool is_verbose_ = false;
+     std::vector<std::string> job_hosts_;
+     std::vector<rdc_handle_t> job_handles_;
 };
 
 
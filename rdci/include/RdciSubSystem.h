@@ -47,6 +47,7 @@ class RdciSubSystem {
      std::vector<std::string> split_string(const std::string& s,
             char delimiter) const;
      void show_common_usage() const;
+     rdc_handle_t connect_to(const std::string& ip_port);
      rdc_handle_t rdc_handle_;
      std::string ip_port_;
 
@@ -21,6 +21,7 @@ THE SOFTWARE.
 */
 #include <getopt.h>
 #include <unistd.h>
+#include <vector>
 #include "rdc_lib/rdc_common.h"
 #include "rdc/rdc.h"
 #include "rdc_lib/RdcException.h"
@@ -102,10 +103,10 @@ void RdciDiscoverySubSystem::process() {
         return show_help();
     }
 
-    uint32_t  gpu_index_list[RDC_MAX_NUM_DEVICES];
-    uint32_t count = 0;
-    rdc_status_t result =  rdc_device_get_all(rdc_handle_,
-            gpu_index_list, &count);
+    std::vector<uint32_t> gpu_index_list(RDC_MAX_NUM_DEVICES_EXT);
+    uint32_t count = gpu_index_list.size();
+    rdc_status_t result =  rdc_device_get_all_ext(rdc_handle_,
+            gpu_index_list.data(), &count);
     if (result != RDC_ST_OK) {
          throw RdcException(result, "Fail to get device information");
     }
@@ -401,7 +401,7 @@ void RdciDmonSubSystem::process() {
                  result = rdc_field_get_latest_value(rdc_handle_,
                     group_info.entity_ids[gindex],
                     field_info.field_ids[findex], &value);
-                 if (result != RDC_ST_OK) {
+                 if (result != RDC_ST_OK || value.status != RDC_ST_OK) {
                      std::cout << std::left << std::setw(20) << "N/A";
                  } else {
                      if (value.type == INTEGER) {
@@ -155,7 +155,10 @@ void RdciGroupSubSystem::show_help() const {
 void RdciGroupSubSystem::process() {
     rdc_status_t result = RDC_ST_OK;
     std::vector<std::string> gpu_ids;
-    rdc_group_info_t group_info;
+    char group_name[RDC_MAX_STR_LENGTH];
+    std::vector<uint32_t> entity_ids(RDC_GROUP_MAX_ENTITIES_EXT);
+    uint32_t entity_count = 0;
+    std::vector<rdc_gpu_group_t> group_id_list(RDC_MAX_NUM_GROUPS_EXT);
     uint32_t count = 0;
     std::string json_group_ids = "\"gpu_groups\": [";
     switch (group_ops_) {
@@ -220,8 +223,9 @@ void RdciGroupSubSystem::process() {
             }
             break;
         case GROUP_LIST:
-            rdc_gpu_group_t group_id_list[RDC_MAX_NUM_GROUPS];
-            result = rdc_group_get_all_ids(rdc_handle_, group_id_list, &count);
+            count = group_id_list.size();
+            result = rdc_group_get_all_ids_ext(rdc_handle_,
+                            group_id_list.data(), &count);
             if ( result != RDC_ST_OK) break;
 
              if (!is_json_output()) {
@@ -229,8 +233,10 @@ void RdciGroupSubSystem::process() {
                 std::cout << "GroupID\t" << "GroupName\t" << "GPUIndex\n";
             }
             for (uint32_t i = 0; i < count; i++) {
-                result = rdc_group_gpu_get_info(rdc_handle_,
-                            group_id_list[i], &group_info);
+                entity_count = entity_ids.size();
+                result = rdc_group_gpu_get_info_ext(rdc_handle_,
+                            group_id_list[i], group_name,
+                            entity_ids.data(), &entity_count);
                 if (result != RDC_ST_OK) {
                     throw RdcException(RDC_ST_BAD_PARAMETER,
                     "Fail to get information for group "
@@ -239,22 +245,22 @@ void RdciGroupSubSystem::process() {
 
                 if (!is_json_output()) {
                     std::cout << group_id_list[i] << "\t"
-                            << group_info.group_name << "\t\t";
+                            << group_name << "\t\t";
                 } else {
                     json_group_ids += "{\"group_id\": \"";
                     json_group_ids += std::to_string(group_id_list[i]);
                     json_group_ids += "\", \"group_name\": \"";
-                    json_group_ids += group_info.group_name;
+                    json_group_ids += group_name;
                     json_group_ids += "\", \"gpu_indexes\": [";
                 }
-                for (uint32_t j = 0; j < group_info.count; j++) {
+                for (uint32_t j = 0; j < entity_count; j++) {
                     if (!is_json_output()) {
-                        std::cout << group_info.entity_ids[j];
+                        std::cout << entity_ids[j];
                     } else {
                         json_group_ids +=
-                            std::to_string(group_info.entity_ids[j]);
+                            std::to_string(entity_ids[j]);
                     }
-                    if (j < group_info.count -1) {
+                    if (j < entity_count -1) {
                         if (!is_json_output()) {
                             std::cout << ",";
                         } else {
@@ -313,25 +319,27 @@ void RdciGroupSubSystem::process() {
                 throw RdcException(RDC_ST_BAD_PARAMETER,
                         "Need to specify the group id to show group info");
             }
-            result = rdc_group_gpu_get_info(rdc_handle_,
-                            group_id_, &group_info);
+            entity_count = entity_ids.size();
+            result = rdc_group_gpu_get_info_ext(rdc_handle_,
+                            group_id_, group_name,
+                            entity_ids.data(), &entity_count);
             if (result == RDC_ST_OK) {
                 if (is_json_output()) {
-                    std::cout << "\"group_name\": \"" << group_info.group_name
+                    std::cout << "\"group_name\": \"" << group_name
                         << "\", \"gpu_indexes\": [";
                 } else {
                     std::cout << "Group name: "
-                            << group_info.group_name << std::endl;
+                            << group_name << std::endl;
                     std::cout << "Gpu indexes: ";
                 }
-                for (uint32_t i = 0; i < group_info.count; i++) {
+                for (uint32_t i = 0; i < entity_count; i++) {
                     if (is_json_output()) {
-                        std::cout << group_info.entity_ids[i];
-                        if ( i != group_info.count-1 ) {
+                        std::cout << entity_ids[i];
+                        if ( i != entity_count-1 ) {
                             std::cout << ",";
                         }
                     } else {
-                        std::cout << group_info.entity_ids[i] << " ";
+                        std::cout << entity_ids[i] << " ";
                     }
                 }
                 if (is_json_output()) {
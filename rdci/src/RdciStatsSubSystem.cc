@@ -38,6 +38,9 @@ RdciStatsSubSystem::RdciStatsSubSystem() {
 }
 
 RdciStatsSubSystem::~RdciStatsSubSystem() {
+    for (auto handle : job_handles_) {
+        rdc_disconnect(handle);
+    }
 }
 
 
@@ -116,6 +119,14 @@ void RdciStatsSubSystem::parse_cmd_opts(int argc, char ** argv) {
         }
     }
 
+    // The stats of a job running on several hosts can be merged
+    job_hosts_ = split_string(ip_port_, ',');
+    if (job_hosts_.size() > 1 && stats_ops_ != STATS_DISPLAY) {
+        show_help();
+        throw RdcException(RDC_ST_BAD_PARAMETER,
+                "Only the job statistics can be read from several hosts");
+    }
+
     if (stats_ops_ == STATS_START_RECORDING
         && is_group_id_set == false) {
             show_help();
@@ -134,6 +145,8 @@ void RdciStatsSubSystem::show_help() const {
             << "-x <jobId>\n";
     std::cout << "    rdci stats [--host <IP/FQDN>:port] [-u] [--json] [-v] "
               << "-j <jobId>\n";
+    std::cout << "    rdci stats --host <IP/FQDN>:port,<IP/FQDN>:port... "
+              << "[-u] [--json] [-v] -j <jobId>\n";
     std::cout << "    rdci stats [--host <IP/FQDN>:port] [-u] [--json] "
               << "-r <jobId>\n";
     std::cout << "    rdci stats [--host <IP/FQDN>:port] [-u] [--json] -a\n";
@@ -149,6 +162,9 @@ void RdciStatsSubSystem::show_help() const {
               << "job statistics.\n";
     std::cout << "  -j  --job                      Display "
               << "job statistics.\n";
+    std::cout << "                                 With several hosts, the "
+              << "job statistics of all\n"
+              << "                                 their GPUs are merged.\n";
     std::cout << "  -v  --verbose                  Show job information "
               << "for each GPU.\n";
     std::cout << "  -r  --jremove                  Remove "
@@ -318,6 +334,47 @@ void RdciStatsSubSystem::show_job_stats(
         << "+------------------------------------\n";
 }
 
+void RdciStatsSubSystem::connect() {
+    if (job_hosts_.size() <= 1) {
+        RdciSubSystem::connect();
+        return;
+    }
+    for (auto& host : job_hosts_) {
+        job_handles_.push_back(connect_to(host));
+    }
+}
+
+void RdciStatsSubSystem::get_job_moments(rdc_job_info_t* job_info,
+        std::vector<std::string>* gpu_names) const {
+    std::vector<rdc_job_gpu_moments_t> gpus;
+    for (uint32_t h = 0; h < job_handles_.size(); h++) {
+        std::vector<rdc_job_gpu_moments_t> host_gpus(RDC_MAX_NUM_DEVICES);
+        uint32_t count = host_gpus.size();
+        rdc_status_t result = rdc_job_get_moments(job_handles_[h],
+                    job_id_.c_str(), host_gpus.data(), &count);
+        if (result == RDC_ST_INSUFF_RESOURCES) {
+            host_gpus.resize(count);
+            result = rdc_job_get_moments(job_handles_[h], job_id_.c_str(),
+                    host_gpus.data(), &count);
+        }
+        if (result != RDC_ST_OK) {
+            throw RdcException(result, job_hosts_[h] + ": " +
+                    rdc_status_string(result));
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            gpus.push_back(host_gpus[i]);
+            gpu_names->push_back(job_hosts_[h] + " GPU " +
+                    std::to_string(host_gpus[i].gpu_index));
+        }
+    }
+
+    rdc_status_t result = rdc_job_merge_moments(gpus.data(), gpus.size(),
+                job_info);
+    if (result != RDC_ST_OK) {
+        throw RdcException(result, rdc_status_string(result));
+    }
+}
+
 void RdciStatsSubSystem::process() {
     if (stats_ops_ == STATS_HELP ||
             stats_ops_ == STATS_UNKNOWN) {
@@ -361,10 +418,15 @@ void RdciStatsSubSystem::process() {
 
     if (stats_ops_ == STATS_DISPLAY) {
         rdc_job_info_t job_info;
-        result = rdc_job_get_stats(rdc_handle_,
-                    const_cast<char*>(job_id_.c_str()), &job_info);
-        if (result != RDC_ST_OK) {
-            throw RdcException(result, rdc_status_string(result));
+        std::vector<std::string> gpu_names;
+        if (job_handles_.empty()) {
+            result = rdc_job_get_stats(rdc_handle_,
+                        const_cast<char*>(job_id_.c_str()), &job_info);
+            if (result != RDC_ST_OK) {
+                throw RdcException(result, rdc_status_string(result));
+            }
+        } else {
+            get_job_moments(&job_info, &gpu_names);
         }
 
         if (!is_json_output()) {
@@ -378,12 +440,22 @@ void RdciStatsSubSystem::process() {
         if (is_verbose_ == false) {
             return;
         }
-        for (uint32_t i = 0; i < job_info.num_gpus; i++) {
+        const uint32_t max_job_gpus =
+            sizeof(job_info.gpus) / sizeof(job_info.gpus[0]);
+        for (uint32_t i = 0; i < job_info.num_gpus && i < max_job_gpus;
+                i++) {
             if (!is_json_output()) {
-                std::cout << "|         GPU " << i << "\n";
+                if (gpu_names.empty()) {
+                    std::cout << "|         GPU " << i << "\n";
+                } else {
+                    std::cout << "|         " << gpu_names[i] << "\n";
+                }
                 show_job_stats(job_info.gpus[i]);
             } else {
                 std:: cout << ", \"gpu_" << i << "\": {";
+                if (!gpu_names.empty()) {
+                    std::cout << "\"name\": \"" << gpu_names[i] << "\",";
+                }
                 show_job_stats_json(job_info.gpus[i]);
                 std::cout << "}";
             }
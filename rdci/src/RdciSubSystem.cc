@@ -58,7 +58,12 @@ std::vector<std::string> RdciSubSystem::split_string(const std::string& s,
 }
 
 void RdciSubSystem::connect() {
+    rdc_handle_ = connect_to(ip_port_);
+}
+
+rdc_handle_t RdciSubSystem::connect_to(const std::string& ip_port) {
     rdc_status_t status;
+    rdc_handle_t rdc_handle = nullptr;
 
     if (use_auth_) {
         std::string ca_pem;
@@ -100,10 +105,10 @@ void RdciSubSystem::connect() {
                std::string("Fail to read client key at ") + client_key_);
         }
 
-        status = rdc_connect(ip_port_.c_str(), &rdc_handle_,
+        status = rdc_connect(ip_port.c_str(), &rdc_handle,
            ca_pem.c_str(), client_cert_pem.c_str(), client_key_pem.c_str());
     } else {  // Not use the SSL mutual authentication
-        status = rdc_connect(ip_port_.c_str(), &rdc_handle_,
+        status = rdc_connect(ip_port.c_str(), &rdc_handle,
             nullptr, nullptr, nullptr);
     }
 
@@ -111,6 +116,7 @@ void RdciSubSystem::connect() {
         throw RdcException(status,
     "Fail to setup the connection. Please check all libraries in right folder");
     }
+    return rdc_handle;
 }
 
 void RdciSubSystem::show_common_usage() const {
@@ -0,0 +1,143 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <getopt.h>
+#include <unistd.h>
+#include <fstream>
+#include <vector>
+#include "rdc_lib/rdc_common.h"
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcException.h"
+#include "common/rdc_utils.h"
+#include "RdciTraceSubSystem.h"
+
+
+namespace amd {
+namespace rdc {
+
+RdciTraceSubSystem::RdciTraceSubSystem() : show_help_(false),
+    last_seconds_(10) {
+}
+
+void RdciTraceSubSystem::parse_cmd_opts(int argc, char ** argv) {
+    const int HOST_OPTIONS = 1000;
+    const struct option long_options[] = {
+        {"host",    required_argument, nullptr, HOST_OPTIONS },
+        {"help", optional_argument, nullptr, 'h' },
+        {"unauth", optional_argument, nullptr, 'u' },
+        {"seconds", required_argument, nullptr, 's' },
+        {"output", required_argument, nullptr, 'o' },
+        { nullptr,  0 , nullptr, 0 }
+    };
+
+    int option_index = 0;
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "hus:o:",
+                long_options, &option_index)) != -1) {
+        switch (opt) {
+            case HOST_OPTIONS:
+                ip_port_ = optarg;
+                break;
+            case 'h':
+                 show_help_ = true;
+                 return;
+            case 'u':
+                 use_auth_ = false;
+                 break;
+            case 's':
+                 if (!IsNumber(optarg)) {
+                     show_help();
+                     throw RdcException(RDC_ST_BAD_PARAMETER,
+                        "The seconds needs to be a number");
+                 }
+                 last_seconds_ = std::stoi(optarg);
+                 break;
+            case 'o':
+                 output_file_ = optarg;
+                 break;
+            default:
+                show_help();
+                throw RdcException(RDC_ST_BAD_PARAMETER,
+                        "Unknown command line options");
+        }
+    }
+}
+
+void RdciTraceSubSystem::show_help() const {
+    std::cout << " trace -- Used to dump the recent sweeps and RPCs of rdcd "
+        << "as a Chrome trace.\n\n";
+    std::cout << "Usage\n";
+    std::cout << "    rdci trace [--host <IP/FQDN>:port] [-u] [-s <seconds>]"
+            << " [-o <file>]\n";
+    std::cout << "\nFlags:\n";
+    show_common_usage();
+    std::cout << "  -s  --seconds  seconds         The last seconds to dump."
+              << " Default: 10\n";
+    std::cout << "  -o  --output   file            Write the trace to file"
+              << " instead of stdout\n";
+    std::cout << "\nrdcd records the trace when started with "
+              << "RDC_TRACE_EVENTS=<events per thread>. Open the file in "
+              << "ui.perfetto.dev or chrome://tracing.\n";
+}
+
+
+void RdciTraceSubSystem::process() {
+    if (show_help_) {
+        return show_help();
+    }
+
+    // Ask for the size first, the trace keeps growing meanwhile
+    uint32_t size = 0;
+    std::vector<char> trace;
+    rdc_status_t result = rdc_trace_get(rdc_handle_, last_seconds_,
+            nullptr, &size);
+    while (result == RDC_ST_INSUFF_RESOURCES) {
+        trace.resize(size + size / 4);
+        size = trace.size();
+        result = rdc_trace_get(rdc_handle_, last_seconds_,
+                trace.data(), &size);
+    }
+    if (result == RDC_ST_NOT_SUPPORTED) {
+        throw RdcException(result,
+            "Tracing is disabled, start rdcd with RDC_TRACE_EVENTS set");
+    }
+    if (result != RDC_ST_OK) {
+        throw RdcException(result, "Fail to get the trace");
+    }
+
+    if (output_file_.empty()) {
+        std::cout << trace.data() << std::endl;
+        return;
+    }
+    std::ofstream out(output_file_);
+    out << trace.data();
+    if (!out) {
+        throw RdcException(RDC_ST_PERM_ERROR,
+            "Fail to write the trace to " + output_file_);
+    }
+    std::cout << "Trace of the last " << last_seconds_ << " seconds written "
+              << "to " << output_file_ << std::endl;
+}
+
+
+}  // namespace rdc
+}  // namespace amd
@@ -30,12 +30,13 @@ THE SOFTWARE.
 #include "RdciFieldGroupSubSystem.h"
 #include "RdciGroupSubSystem.h"
 #include "RdciStatsSubSystem.h"
+#include "RdciTraceSubSystem.h"
 
 
 int main(int argc, char ** argv) {
     const std::string usage_help =
     "Usage:\trdci <subsystem>\nsubsystem: discovery, dmon, group, "
-    "fieldgroup, stats\n";
+    "fieldgroup, stats, trace\n";
 
     if (argc <= 1) {
         std::cout << usage_help;
@@ -55,6 +56,8 @@ int main(int argc, char ** argv) {
            subsystem.reset(new amd::rdc::RdciFieldGroupSubSystem());
        } else if (subsystem_name == "stats") {
            subsystem.reset(new amd::rdc::RdciStatsSubSystem());
+       } else if (subsystem_name == "trace") {
+           subsystem.reset(new amd::rdc::RdciTraceSubSystem());
        } else {
            std::cout << usage_help;
            exit(0);
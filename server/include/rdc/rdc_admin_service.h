@@ -22,21 +22,90 @@ THE SOFTWARE.
 #ifndef SERVER_INCLUDE_RDC_RDC_ADMIN_SERVICE_H_
 #define SERVER_INCLUDE_RDC_RDC_ADMIN_SERVICE_H_
 
+#include <grpcpp/support/server_interceptor.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
 #include "rdc.grpc.pb.h"  // NOLINT
 #include "rocm_smi/rocm_smi.h"
-#include "rdc/rdc_admin_service.h"
+#include "rdc/rdc_api_service.h"
+#include "rdc_lib/RdcPerfCounters.h"
+#include "rdc_lib/RdcTracer.h"
 
 namespace amd {
 namespace rdc {
 
+// Calls, errors and latencies of every RPC method served by rdcd
+class RdcRpcMetrics {
+ public:
+    struct Method {
+        Method() : name(nullptr), errors(0) {}
+        const char* name;  //!< The full method name, for the trace
+        RdcPerfHistogram latency;
+        std::atomic<uint64_t> errors;
+    };
+
+    // The metrics of the method, created on its first call
+    Method* get_method(const char* method);
+
+    // Append rpc_latency_us and rpc_errors of every method called so far
+    void snapshot(std::vector<rdc_perf_metric_t>* metrics);
+
+ private:
+    std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Method>> methods_;
+};
+
+// Times a call from its arrival until its status is sent
+class RdcRpcMetricsInterceptor : public ::grpc::experimental::Interceptor {
+ public:
+    explicit RdcRpcMetricsInterceptor(RdcRpcMetrics::Method* method);
+
+    void Intercept(
+        ::grpc::experimental::InterceptorBatchMethods* methods) override;
+
+ private:
+    RdcRpcMetrics::Method* method_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class RdcRpcMetricsInterceptorFactory :
+    public ::grpc::experimental::ServerInterceptorFactoryInterface {
+ public:
+    explicit RdcRpcMetricsInterceptorFactory(RdcRpcMetrics* metrics);
+
+    ::grpc::experimental::Interceptor* CreateServerInterceptor(
+        ::grpc::experimental::ServerRpcInfo* info) override;
+
+ private:
+    RdcRpcMetrics* metrics_;
+};
+
 class RDCAdminServiceImpl final : public ::rdc::RdcAdmin::Service {
  public:
-    RDCAdminServiceImpl();
+    // The metrics of librdc come from api_service, which may be nullptr
+    RDCAdminServiceImpl(RdcAPIServiceImpl* api_service,
+                        RdcRpcMetrics* rpc_metrics);
     ~RDCAdminServiceImpl();
     ::grpc::Status VerifyConnection(::grpc::ServerContext* context,
                                 const ::rdc::VerifyConnectionRequest* request,
                               ::rdc::VerifyConnectionResponse* reply) override;
+
+    ::grpc::Status GetPerfMetrics(::grpc::ServerContext* context,
+                                  const ::rdc::Empty* request,
+                                  ::rdc::GetPerfMetricsResponse* reply)
+                                  override;
+
+    ::grpc::Status GetTrace(::grpc::ServerContext* context,
+                            const ::rdc::GetTraceRequest* request,
+                            ::rdc::GetTraceResponse* reply) override;
  private:
+    RdcAPIServiceImpl* api_service_;
+    RdcRpcMetrics* rpc_metrics_;
 };
 
 }  // namespace rdc
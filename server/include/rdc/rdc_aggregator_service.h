@@ -0,0 +1,116 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef SERVER_INCLUDE_RDC_RDC_AGGREGATOR_SERVICE_H_
+#define SERVER_INCLUDE_RDC_RDC_AGGREGATOR_SERVICE_H_
+
+#include <grpcpp/grpcpp.h>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc.grpc.pb.h"  // NOLINT
+#include "rdc/rdc.h"
+
+namespace amd {
+namespace rdc {
+
+//!< The credentials used to reach the downstream rdcd, empty for none
+struct RdcAggregatorCredentials {
+    std::string root_ca;
+    std::string client_cert;
+    std::string client_key;
+};
+
+// Federates the GPUs of several rdcd. Every interval, the latest value of
+// each collected field on each GPU of each downstream rdcd is requested
+// on a completion queue, all requests in flight at once with the interval
+// as deadline, and kept in a cache keyed by (host, gpu, field). The
+// cluster queries are answered from that cache without calling the
+// downstream rdcd.
+//
+// The RdcAPI stubs are used directly rather than through librdc_client,
+// which cannot be loaded into rdcd as both contain the generated
+// protobuf code.
+//
+// A host which answers nothing for kMaxFailedSweeps sweeps in a row is
+// reconnected, with a growing delay. Its values are kept meanwhile, and
+// their age tells how stale they are.
+class RdcAggregatorServiceImpl final : public ::rdc::RdcAggregator::Service {
+ public:
+    RdcAggregatorServiceImpl();
+    ~RdcAggregatorServiceImpl();
+
+    // Start polling the hosts, given as host:port
+    rdc_status_t Initialize(const std::vector<std::string>& hosts,
+                            const std::vector<rdc_field_t>& fields,
+                            uint32_t interval_ms,
+                            const RdcAggregatorCredentials& credentials);
+
+    ::grpc::Status GetClusterHosts(::grpc::ServerContext* context,
+                  const ::rdc::Empty* request,
+                  ::rdc::GetClusterHostsResponse* reply) override;
+
+    ::grpc::Status GetClusterLatestValues(::grpc::ServerContext* context,
+                  const ::rdc::GetClusterLatestValuesRequest* request,
+                  ::rdc::GetClusterLatestValuesResponse* reply) override;
+
+    ::grpc::Status GetClusterAggregate(::grpc::ServerContext* context,
+                  const ::rdc::GetClusterAggregateRequest* request,
+                  ::rdc::GetClusterAggregateResponse* reply) override;
+
+ private:
+    struct Downstream;
+    struct Request;
+    struct AsyncCall;
+
+    void poll_loop();
+    void drain_queue();
+    void set_setup_deadline(::grpc::ClientContext* context) const;
+    void connect(Downstream* host);
+    void disconnect(Downstream* host);
+    void start_sweep(Downstream* host);
+    void finish_sweep(Downstream* host);
+    static void on_value(rdc_status_t status, const rdc_field_value* value,
+                         Request* request);
+
+    std::vector<std::unique_ptr<Downstream>> hosts_;
+    std::vector<rdc_field_t> fields_;
+    uint32_t interval_ms_;
+    std::shared_ptr<::grpc::ChannelCredentials> channel_credentials_;
+
+    //!< Receives the latest values of all the hosts
+    ::grpc::CompletionQueue cq_;
+    std::thread cq_thread_;
+
+    //!< Wakes up the polling thread to stop it
+    std::mutex poll_mutex_;
+    std::condition_variable poll_cv_;
+    bool stop_polling_;
+    std::thread poll_thread_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // SERVER_INCLUDE_RDC_RDC_AGGREGATOR_SERVICE_H_
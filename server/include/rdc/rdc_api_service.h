@@ -22,6 +22,9 @@ THE SOFTWARE.
 #ifndef SERVER_INCLUDE_RDC_RDC_API_SERVICE_H_
 #define SERVER_INCLUDE_RDC_RDC_API_SERVICE_H_
 
+#include <grpcpp/support/server_interceptor.h>
+#include <atomic>
+#include <vector>
 #include "rdc.grpc.pb.h"  // NOLINT
 #include "rdc/rdc.h"
 
@@ -35,6 +38,11 @@ class RdcAPIServiceImpl final : public ::rdc::RdcAPI::Service {
 
     rdc_status_t Initialize(uint64_t rdcd_init_flags = 0);
 
+    //!< Watch the fields on all GPUs on behalf of rdcd itself, for the
+    //!< values it exports without a client asking for them
+    rdc_status_t WatchAllGpus(const char* name,
+        const std::vector<rdc_field_t>& fields, uint64_t update_freq);
+
     ::grpc::Status GetAllDevices(::grpc::ServerContext* context,
                   const ::rdc::Empty* request,
                   ::rdc::GetAllDevicesResponse* reply) override;
@@ -87,14 +95,30 @@ class RdcAPIServiceImpl final : public ::rdc::RdcAPI::Service {
                   const ::rdc::GetLatestFieldValueRequest* request,
                   ::rdc::GetLatestFieldValueResponse* reply) override;
 
+    ::grpc::Status GetLatestFieldValues(::grpc::ServerContext* context,
+                  const ::rdc::GetLatestFieldValuesRequest* request,
+                  ::rdc::GetLatestFieldValuesResponse* reply) override;
+
     ::grpc::Status GetFieldSince(::grpc::ServerContext* context,
                   const ::rdc::GetFieldSinceRequest* request,
                   ::rdc::GetFieldSinceResponse* reply) override;
 
+    ::grpc::Status GetFieldValuesSince(::grpc::ServerContext* context,
+                  const ::rdc::GetFieldValuesSinceRequest* request,
+                  ::rdc::GetFieldValuesSinceResponse* reply) override;
+
     ::grpc::Status UnWatchFields(::grpc::ServerContext* context,
                   const ::rdc::UnWatchFieldsRequest* request,
                   ::rdc::UnWatchFieldsResponse* reply) override;
 
+    ::grpc::Status SetWatchLimits(::grpc::ServerContext* context,
+                  const ::rdc::SetWatchLimitsRequest* request,
+                  ::rdc::SetWatchLimitsResponse* reply) override;
+
+    ::grpc::Status GetWatchRates(::grpc::ServerContext* context,
+                  const ::rdc::Empty* request,
+                  ::rdc::GetWatchRatesResponse* reply) override;
+
     ::grpc::Status UpdateAllFields(::grpc::ServerContext* context,
                   const ::rdc::UpdateAllFieldsRequest* request,
                   ::rdc::UpdateAllFieldsResponse* reply) override;
@@ -108,6 +132,10 @@ class RdcAPIServiceImpl final : public ::rdc::RdcAPI::Service {
                   const ::rdc::GetJobStatsRequest* request,
                   ::rdc::GetJobStatsResponse* reply) override;
 
+    ::grpc::Status GetJobMoments(::grpc::ServerContext* context,
+                  const ::rdc::GetJobMomentsRequest* request,
+                  ::rdc::GetJobMomentsResponse* reply) override;
+
     ::grpc::Status StopJobStats(::grpc::ServerContext* context,
                   const ::rdc::StopJobStatsRequest* request,
                   ::rdc::StopJobStatsResponse* reply) override;
@@ -120,10 +148,45 @@ class RdcAPIServiceImpl final : public ::rdc::RdcAPI::Service {
                   const ::rdc::Empty* request,
                   ::rdc::RemoveAllJobResponse* reply) override;
 
+    //!< The self-telemetry of the embedded librdc, for RdcAdmin
+    rdc_status_t GetPerfMetrics(std::vector<rdc_perf_metric_t>* metrics);
+
+    //!< Changes whenever a group or field group changes, and across
+    //!< restarts, so clients know when their cached metadata is stale.
+    uint64_t config_generation() const;
+
  private:
     bool copy_gpu_usage_info(const rdc_gpu_usage_info_t& src,
             ::rdc::GpuUsageInfo* target);
+    void bump_config_generation(rdc_status_t result);
     rdc_handle_t rdc_handle_;
+    std::atomic<uint64_t> config_generation_;
+};
+
+// Attaches the configuration generation to the initial metadata of
+// every RdcAPI response, under RDC_CONFIG_GENERATION_KEY.
+class RdcGenerationInterceptor : public ::grpc::experimental::Interceptor {
+ public:
+    explicit RdcGenerationInterceptor(const RdcAPIServiceImpl* service);
+
+    void Intercept(
+        ::grpc::experimental::InterceptorBatchMethods* methods) override;
+
+ private:
+    const RdcAPIServiceImpl* service_;
+};
+
+class RdcGenerationInterceptorFactory :
+    public ::grpc::experimental::ServerInterceptorFactoryInterface {
+ public:
+    explicit RdcGenerationInterceptorFactory(
+        const RdcAPIServiceImpl* service);
+
+    ::grpc::experimental::Interceptor* CreateServerInterceptor(
+        ::grpc::experimental::ServerRpcInfo* info) override;
+
+ private:
+    const RdcAPIServiceImpl* service_;
 };
 
 }  // namespace rdc
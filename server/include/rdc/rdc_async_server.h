@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef SERVER_INCLUDE_RDC_RDC_ASYNC_SERVER_H_
+#define SERVER_INCLUDE_RDC_RDC_ASYNC_SERVER_H_
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "rdc.grpc.pb.h"  // NOLINT
+#include "rdc/rdc_rsmi_service.h"
+#include "rdc/rdc_admin_service.h"
+#include "rdc/rdc_api_service.h"
+
+namespace amd {
+namespace rdc {
+
+class RdcAsyncMethod;
+struct RdcAsyncQueue;
+
+// Serves the RDC services through completion queues instead of the
+// synchronous gRPC thread manager. The requests are still handled by the
+// synchronous service implementations, but on a fixed pool of threads:
+// num_cqs completion queues, each polled by threads_per_cq threads. Each
+// call allocates its request and reply on a protobuf arena.
+//
+// Usage:
+//   RdcAsyncServer async(rsmi, admin, api);
+//   if (!async.RegisterServices(&builder, num_cqs)) return;
+//   server = builder.BuildAndStart();
+//   async.Start(threads_per_cq);
+//   ...
+//   server->Shutdown();
+//   async.Shutdown();
+class RdcAsyncServer {
+ public:
+    // Any of the services may be nullptr if it is not started
+    RdcAsyncServer(RsmiServiceImpl* rsmi_service,
+                   RDCAdminServiceImpl* admin_service,
+                   RdcAPIServiceImpl* api_service);
+    ~RdcAsyncServer();
+
+    // Must be called before the builder builds the server. Returns false
+    // if a service has a method the asynchronous server does not handle.
+    bool RegisterServices(::grpc::ServerBuilder* builder, uint32_t num_cqs);
+
+    // Arm every method on every queue and start the polling threads
+    void Start(uint32_t threads_per_cq);
+
+    // Drain and join. The grpc server must have been shut down first.
+    void Shutdown();
+
+ private:
+    void PollQueue(::grpc::ServerCompletionQueue* cq);
+
+    RsmiServiceImpl* rsmi_service_;
+    RDCAdminServiceImpl* admin_service_;
+    RdcAPIServiceImpl* api_service_;
+
+    ::rdc::Rsmi::AsyncService rsmi_async_;
+    ::rdc::RdcAdmin::AsyncService admin_async_;
+    ::rdc::RdcAPI::AsyncService api_async_;
+
+    std::vector<std::unique_ptr<RdcAsyncMethod>> methods_;
+    std::vector<std::unique_ptr<RdcAsyncQueue>> cqs_;
+    std::vector<std::thread> threads_;
+    bool started_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // SERVER_INCLUDE_RDC_RDC_ASYNC_SERVER_H_
@@ -26,16 +26,36 @@ THE SOFTWARE.
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "rdc/rdc_rsmi_service.h"
 #include "rdc/rdc_admin_service.h"
 #include "rdc/rdc_api_service.h"
+#include "rdc/rdc_aggregator_service.h"
+#include "rdc/rdc_async_server.h"
+#include "rdc/rdc_unix_listener.h"
 
 typedef struct {
   std::string listen_port;
   bool no_authentication;
   bool use_pinned_certs;
   bool log_dbg;
+  std::string capture_file;
+  std::string replay_file;
+  std::string replay_speed;
+  std::string unix_socket;  //!< empty for the default path, or "none"
+  bool publish_shm;
+  std::string prometheus_listen;  //!< [address:]port, empty to not serve
+  std::vector<rdc_field_t> prometheus_fields;
+  std::vector<std::string> export_sinks;  //!< URLs of the export sinks
+  bool async_server;
+  uint32_t num_cqs;       //!< 0 to use the gRPC default
+  uint32_t cq_threads;    //!< 0 to use the gRPC default
+  uint32_t max_threads;   //!< 0 for no resource quota
+  uint32_t max_streams;   //!< 0 for no limit
+  std::vector<std::string> aggregate_hosts;  //!< empty unless an aggregator
+  std::vector<rdc_field_t> aggregate_fields;
+  uint32_t aggregate_interval_ms;
 } RdcdCmdLineOpts;
 
 class RDCServer {
@@ -73,9 +93,15 @@ class RDCServer {
 
     bool start_rdc_admin_service_;
     amd::rdc::RDCAdminServiceImpl *rdc_admin_service_;
+    amd::rdc::RdcRpcMetrics rpc_metrics_;
 
     bool start_api_service_;
     amd::rdc::RdcAPIServiceImpl *api_service_;
+
+    amd::rdc::RdcAggregatorServiceImpl *aggregator_service_;
+
+    std::unique_ptr<amd::rdc::RdcAsyncServer> async_server_;
+    amd::rdc::RdcUnixListener unix_listener_;
 };
 
 #endif  // SERVER_INCLUDE_RDC_RDC_SERVER_MAIN_H_
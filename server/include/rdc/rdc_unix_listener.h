@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef SERVER_INCLUDE_RDC_RDC_UNIX_LISTENER_H_
+#define SERVER_INCLUDE_RDC_RDC_UNIX_LISTENER_H_
+
+#include <grpcpp/grpcpp.h>
+
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT
+
+namespace amd {
+namespace rdc {
+
+// Accepts node-local clients on a Unix domain socket and hands the
+// connections to the grpc server, without TLS. Access is limited by the
+// permissions of the socket file (0660), and each peer is checked with
+// SO_PEERCRED: root, the rdcd user and members of the rdcd group are
+// allowed.
+class RdcUnixListener {
+ public:
+    RdcUnixListener();
+    ~RdcUnixListener();
+
+    // Start listening on path. The server must have been started.
+    // Returns 0 or an errno value.
+    int Start(const std::string& path, ::grpc::Server* server);
+
+    // Stop accepting and remove the socket file
+    void Stop();
+
+ private:
+    void AcceptLoop();
+    bool PeerAllowed(int fd) const;
+
+    std::string path_;
+    int listen_fd_;
+    ::grpc::Server* server_;
+    std::thread accept_thread_;
+    std::atomic<bool> stopping_;
+};
+
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // SERVER_INCLUDE_RDC_RDC_UNIX_LISTENER_H_
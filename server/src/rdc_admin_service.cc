@@ -29,14 +29,81 @@ THE SOFTWARE.
 #include <memory>
 #include <string>
 #include <csignal>
+#include <vector>
 
 #include "rdc.grpc.pb.h"  // NOLINT
 #include "rdc/rdc_admin_service.h"
+#include "rdc_lib/RdcThreads.h"
 
 namespace amd {
 namespace rdc {
 
-RDCAdminServiceImpl::RDCAdminServiceImpl() {
+RdcRpcMetrics::Method* RdcRpcMetrics::get_method(const char* method) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& m = *methods_.emplace(method, nullptr).first;
+  if (!m.second) {
+    m.second.reset(new Method());
+    m.second->name = m.first.c_str();
+  }
+  return m.second.get();
+}
+
+void RdcRpcMetrics::snapshot(std::vector<rdc_perf_metric_t>* metrics) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  rdc_perf_metric_t metric;
+  for (auto& m : methods_) {
+    // "/rdc.RdcAPI/GetLatestFieldValue" is labeled RdcAPI/GetLatestFieldValue
+    std::string label = m.first;
+    size_t service = label.find('.');
+    if (service != std::string::npos) {
+      label = label.substr(service + 1);
+    }
+    m.second->latency.snapshot("rpc_latency_us", label, metrics);
+    rdc_perf_metric_init(&metric, "rpc_errors", label, RDC_PERF_COUNTER,
+                         m.second->errors.load(std::memory_order_relaxed));
+    metrics->push_back(metric);
+  }
+}
+
+RdcRpcMetricsInterceptor::RdcRpcMetricsInterceptor(
+    RdcRpcMetrics::Method* method): method_(method),
+    start_(std::chrono::steady_clock::now()) {
+}
+
+void RdcRpcMetricsInterceptor::Intercept(
+    ::grpc::experimental::InterceptorBatchMethods* methods) {
+  // gRPC creates the threads of the synchronous server, set them up on
+  // their first call
+  RdcThreads::get().setup_once(RDC_THREAD_RPC, "rdc-rpc");
+  if (methods->QueryInterceptionHookPoint(::grpc::experimental::
+          InterceptionHookPoints::PRE_SEND_STATUS)) {
+    method_->latency.record(rdc_perf_elapsed_us(start_));
+    if (!methods->GetSendStatus().ok()) {
+      method_->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    RdcTracer& tracer = RdcTracer::get();
+    if (tracer.enabled()) {
+      tracer.record(method_->name,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              start_.time_since_epoch()).count(), RdcTracer::now_ns());
+    }
+  }
+  methods->Proceed();
+}
+
+RdcRpcMetricsInterceptorFactory::RdcRpcMetricsInterceptorFactory(
+    RdcRpcMetrics* metrics): metrics_(metrics) {
+}
+
+::grpc::experimental::Interceptor*
+RdcRpcMetricsInterceptorFactory::CreateServerInterceptor(
+    ::grpc::experimental::ServerRpcInfo* info) {
+  return new RdcRpcMetricsInterceptor(metrics_->get_method(info->method()));
+}
+
+RDCAdminServiceImpl::RDCAdminServiceImpl(RdcAPIServiceImpl* api_service,
+    RdcRpcMetrics* rpc_metrics): api_service_(api_service),
+    rpc_metrics_(rpc_metrics) {
 }
 
 RDCAdminServiceImpl::~RDCAdminServiceImpl() {
@@ -51,5 +118,58 @@ RDCAdminServiceImpl::VerifyConnection(::grpc::ServerContext* context,
   return ::grpc::Status::OK;
 }
 
+::grpc::Status
+RDCAdminServiceImpl::GetPerfMetrics(::grpc::ServerContext* context,
+                            const ::rdc::Empty* request,
+                            ::rdc::GetPerfMetricsResponse* reply) {
+  (void)context;
+  (void)request;
+
+  std::vector<rdc_perf_metric_t> metrics;
+  rdc_status_t result = RDC_ST_OK;
+  if (api_service_) {
+    result = api_service_->GetPerfMetrics(&metrics);
+  }
+  if (rpc_metrics_) {
+    rpc_metrics_->snapshot(&metrics);
+  }
+
+  for (const auto& m : metrics) {
+    ::rdc::PerfMetric* metric = reply->add_metrics();
+    metric->set_name(m.name);
+    metric->set_label(m.label);
+    metric->set_type(static_cast<::rdc::PerfMetric_MetricType>(m.type));
+    metric->set_value(m.value);
+    metric->set_sum(m.sum);
+    if (m.type == RDC_PERF_HISTOGRAM) {
+      for (uint32_t i = 0; i < RDC_PERF_HISTOGRAM_BUCKETS; i++) {
+        metric->add_buckets(m.buckets[i]);
+      }
+    }
+  }
+  reply->set_status(result);
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status
+RDCAdminServiceImpl::GetTrace(::grpc::ServerContext* context,
+                            const ::rdc::GetTraceRequest* request,
+                            ::rdc::GetTraceResponse* reply) {
+  (void)context;
+
+  // Stay below the default 4MB limit of the clients on a message
+  const size_t kMaxTraceBytes = 3 * 1024 * 1024;
+
+  RdcTracer& tracer = RdcTracer::get();
+  if (!tracer.enabled()) {
+    reply->set_status(RDC_ST_NOT_SUPPORTED);
+    return ::grpc::Status::OK;
+  }
+  tracer.dump(request->last_seconds() * 1000ULL, kMaxTraceBytes,
+              reply->mutable_trace());
+  reply->set_status(RDC_ST_OK);
+  return ::grpc::Status::OK;
+}
+
 }  // namespace rdc
 }  // namespace amd
@@ -0,0 +1,607 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <grpcpp/grpcpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "rdc.grpc.pb.h"  // NOLINT
+#include "rdc/rdc_aggregator_service.h"
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/RdcFlatMap.h"
+#include "rdc_lib/RdcThreads.h"
+
+namespace amd {
+namespace rdc {
+
+// Sweeps without any value before a host is reconnected
+static const uint32_t kMaxFailedSweeps = 3;
+// The longest delay between two connection attempts to a host
+static const uint32_t kMaxRetryMs = 30000;
+// Values older than this many intervals are not aggregated by default
+static const uint32_t kStaleIntervals = 3;
+// The shortest deadline of the calls setting up or removing the watches
+static const uint32_t kMinSetupMs = 1000;
+// The downstream rdcd only need to keep the latest values
+static const double kKeepAgeSeconds = 10;
+static const uint32_t kKeepSamples = 2;
+static const char kGroupName[] = "rdcd-aggregator";
+
+typedef std::chrono::steady_clock::time_point RdcAggregatorTime;
+
+struct RdcAggregatedValue {
+    rdc_field_value value;
+    RdcAggregatorTime received;
+};
+
+struct RdcAggregatorServiceImpl::Request {
+    Downstream* host;
+    uint32_t gpu_index;
+    rdc_field_t field;
+};
+
+// A GetLatestFieldValue call in flight on the completion queue
+struct RdcAggregatorServiceImpl::AsyncCall {
+    Request* request;
+    ::grpc::ClientContext context;
+    ::rdc::GetLatestFieldValueResponse reply;
+    ::grpc::Status status;
+    std::unique_ptr<::grpc::ClientAsyncResponseReader<
+        ::rdc::GetLatestFieldValueResponse>> reader;
+};
+
+struct RdcAggregatorServiceImpl::Downstream {
+    std::string address;
+    std::unique_ptr<::rdc::RdcAPI::Stub> stub;
+
+    // Only used by the polling thread
+    bool group_created;
+    rdc_gpu_group_t group_id;
+    bool field_group_created;
+    rdc_field_grp_t field_group_id;
+    bool watching;
+    bool sweeping;
+    uint32_t failed_sweeps;
+    uint32_t retry_ms;
+    RdcAggregatorTime retry_at;
+    //!< One per GPU and field, reused by every sweep
+    std::vector<Request> requests;
+
+    //!< Requests of the current sweep not completed yet
+    std::atomic<uint32_t> in_flight;
+    //!< Values received in the current sweep
+    std::atomic<uint32_t> received;
+
+    //!< Protects the members below, which the queries read
+    std::mutex mutex;
+    bool connected;
+    std::vector<uint32_t> gpus;
+    RdcAggregatorTime last_value;
+    uint64_t num_errors;
+    RdcFlatMap<RdcFieldKey, RdcAggregatedValue> values;
+};
+
+// The status of a call to a downstream rdcd
+static rdc_status_t call_status(const ::grpc::Status& status,
+                                uint32_t rdc_status) {
+    if (status.error_code() == ::grpc::StatusCode::DEADLINE_EXCEEDED) {
+        return RDC_ST_TIMEOUT;
+    }
+    if (!status.ok()) {
+        return RDC_ST_CLIENT_ERROR;
+    }
+    return static_cast<rdc_status_t>(rdc_status);
+}
+
+// UINT32_MAX if it never happened
+static uint32_t age_ms(RdcAggregatorTime since, RdcAggregatorTime now) {
+    if (since == RdcAggregatorTime()) {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                        now - since).count();
+    return static_cast<uint32_t>(std::min<int64_t>(age,
+                                std::numeric_limits<uint32_t>::max() - 1));
+}
+
+static void copy_field_value(const rdc_field_value& value,
+                             ::rdc::ClusterFieldValue* target) {
+    target->set_field_id(value.field_id);
+    target->set_rdc_status(value.status);
+    target->set_ts(value.ts);
+    target->set_type(static_cast<::rdc::ClusterFieldValue_FieldType>
+                        (value.type));
+    if (value.type == INTEGER) {
+        target->set_l_int(value.value.l_int);
+    } else if (value.type == DOUBLE) {
+        target->set_dbl(value.value.dbl);
+    } else if (value.type == STRING || value.type == BLOB) {
+        target->set_str(value.value.str);
+    }
+}
+
+RdcAggregatorServiceImpl::RdcAggregatorServiceImpl() : interval_ms_(0),
+    stop_polling_(false) {
+}
+
+RdcAggregatorServiceImpl::~RdcAggregatorServiceImpl() {
+    {
+        std::lock_guard<std::mutex> guard(poll_mutex_);
+        stop_polling_ = true;
+    }
+    poll_cv_.notify_all();
+    if (poll_thread_.joinable()) {
+        poll_thread_.join();
+    }
+
+    // The calls in flight still complete, at the latest on their deadline
+    cq_.Shutdown();
+    if (cq_thread_.joinable()) {
+        cq_thread_.join();
+    }
+    for (auto& host : hosts_) {
+        disconnect(host.get());
+    }
+}
+
+rdc_status_t RdcAggregatorServiceImpl::Initialize(
+        const std::vector<std::string>& hosts,
+        const std::vector<rdc_field_t>& fields, uint32_t interval_ms,
+        const RdcAggregatorCredentials& credentials) {
+    if (hosts.empty() || fields.empty() || interval_ms == 0) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+
+    if (credentials.root_ca.empty()) {
+        channel_credentials_ = ::grpc::InsecureChannelCredentials();
+    } else {
+        ::grpc::SslCredentialsOptions ssl_opts{};
+        ssl_opts.pem_root_certs = credentials.root_ca;
+        ssl_opts.pem_private_key = credentials.client_key;
+        ssl_opts.pem_cert_chain = credentials.client_cert;
+        channel_credentials_ = ::grpc::SslCredentials(ssl_opts);
+    }
+
+    fields_ = fields;
+    interval_ms_ = interval_ms;
+    for (const std::string& address : hosts) {
+        std::unique_ptr<Downstream> host(new Downstream());
+        host->address = address;
+        // The channel reconnects by itself
+        host->stub = ::rdc::RdcAPI::NewStub(
+                ::grpc::CreateChannel(address, channel_credentials_));
+        host->group_created = false;
+        host->group_id = 0;
+        host->field_group_created = false;
+        host->field_group_id = 0;
+        host->watching = false;
+        host->sweeping = false;
+        host->failed_sweeps = 0;
+        host->retry_ms = interval_ms_;
+        host->in_flight = 0;
+        host->received = 0;
+        host->connected = false;
+        host->num_errors = 0;
+        hosts_.push_back(std::move(host));
+    }
+
+    cq_thread_ = std::thread(&RdcAggregatorServiceImpl::drain_queue, this);
+    poll_thread_ = std::thread(&RdcAggregatorServiceImpl::poll_loop, this);
+    return RDC_ST_OK;
+}
+
+void RdcAggregatorServiceImpl::poll_loop() {
+    RdcThreads::get().setup(RDC_THREAD_RPC, "rdc-agg-poll");
+    std::unique_lock<std::mutex> lock(poll_mutex_);
+    while (!stop_polling_) {
+        RdcAggregatorTime start = std::chrono::steady_clock::now();
+        lock.unlock();
+
+        for (auto& ite : hosts_) {
+            Downstream* host = ite.get();
+            // The previous sweep is still waiting for its deadline
+            if (host->in_flight > 0) {
+                continue;
+            }
+            if (host->sweeping) {
+                finish_sweep(host);
+            }
+            if (!host->watching) {
+                if (start < host->retry_at) {
+                    continue;
+                }
+                connect(host);
+                if (!host->watching) {
+                    continue;
+                }
+            }
+            start_sweep(host);
+        }
+
+        lock.lock();
+        poll_cv_.wait_until(lock,
+                start + std::chrono::milliseconds(interval_ms_),
+                [this] { return stop_polling_; });
+    }
+}
+
+void RdcAggregatorServiceImpl::drain_queue() {
+    RdcThreads::get().setup(RDC_THREAD_RPC, "rdc-agg-cq");
+    void* tag;
+    bool ok;
+    while (cq_.Next(&tag, &ok)) {
+        std::unique_ptr<AsyncCall> call(static_cast<AsyncCall*>(tag));
+        rdc_status_t status = call_status(call->status,
+                                          call->reply.status());
+        if (status != RDC_ST_OK) {
+            on_value(status, nullptr, call->request);
+            continue;
+        }
+        rdc_field_value value;
+        value.field_id = static_cast<rdc_field_t>(call->reply.field_id());
+        value.status = call->reply.rdc_status();
+        value.ts = call->reply.ts();
+        value.type = static_cast<rdc_field_type_t>(call->reply.type());
+        if (value.type == INTEGER) {
+            value.value.l_int = call->reply.l_int();
+        } else if (value.type == DOUBLE) {
+            value.value.dbl = call->reply.dbl();
+        } else if (value.type == STRING || value.type == BLOB) {
+            strncpy_with_null(value.value.str, call->reply.str().c_str(),
+                              RDC_MAX_STR_LENGTH);
+        }
+        on_value(RDC_ST_OK, &value, call->request);
+    }
+}
+
+// A host which does not answer must not stall the polling for long
+void RdcAggregatorServiceImpl::set_setup_deadline(
+        ::grpc::ClientContext* context) const {
+    context->set_deadline(std::chrono::system_clock::now() +
+        std::chrono::milliseconds(std::max(interval_ms_, kMinSetupMs)));
+}
+
+void RdcAggregatorServiceImpl::connect(Downstream* host) {
+    ::rdc::GetAllDevicesResponse devices;
+    rdc_status_t result;
+    {
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        ::grpc::Status status = host->stub->GetAllDevices(&context,
+                                                ::rdc::Empty(), &devices);
+        result = call_status(status, devices.status());
+    }
+    if (result == RDC_ST_OK) {
+        ::rdc::CreateGpuGroupRequest request;
+        ::rdc::CreateGpuGroupResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        request.set_type(::rdc::CreateGpuGroupRequest::RDC_GROUP_DEFAULT);
+        request.set_group_name(kGroupName);
+        ::grpc::Status status = host->stub->CreateGpuGroup(&context,
+                                                        request, &reply);
+        result = call_status(status, reply.status());
+        host->group_created = (result == RDC_ST_OK);
+        host->group_id = reply.group_id();
+    }
+    if (result == RDC_ST_OK) {
+        ::rdc::CreateFieldGroupRequest request;
+        ::rdc::CreateFieldGroupResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        for (rdc_field_t field : fields_) {
+            request.add_field_ids(field);
+        }
+        request.set_field_group_name(kGroupName);
+        ::grpc::Status status = host->stub->CreateFieldGroup(&context,
+                                                        request, &reply);
+        result = call_status(status, reply.status());
+        host->field_group_created = (result == RDC_ST_OK);
+        host->field_group_id = reply.field_group_id();
+    }
+    if (result == RDC_ST_OK) {
+        ::rdc::WatchFieldsRequest request;
+        ::rdc::WatchFieldsResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        request.set_group_id(host->group_id);
+        request.set_field_group_id(host->field_group_id);
+        request.set_update_freq(interval_ms_ * 1000ULL);
+        request.set_max_keep_age(kKeepAgeSeconds);
+        request.set_max_keep_samples(kKeepSamples);
+        ::grpc::Status status = host->stub->WatchFields(&context,
+                                                        request, &reply);
+        result = call_status(status, reply.status());
+    }
+
+    if (result != RDC_ST_OK) {
+        std::cerr << "Failed to watch the GPUs of " << host->address << ": "
+                  << rdc_status_string(result) << std::endl;
+        disconnect(host);
+        host->retry_at = std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(host->retry_ms);
+        host->retry_ms = std::min(host->retry_ms * 2, kMaxRetryMs);
+        return;
+    }
+
+    std::vector<uint32_t> gpus(devices.gpus().begin(), devices.gpus().end());
+    host->watching = true;
+    host->failed_sweeps = 0;
+    host->retry_ms = interval_ms_;
+    host->requests.clear();
+    for (uint32_t gpu_index : gpus) {
+        for (rdc_field_t field : fields_) {
+            Request request = {host, gpu_index, field};
+            host->requests.push_back(request);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(host->mutex);
+        host->connected = true;
+        host->gpus = gpus;
+    }
+    std::cout << "Aggregating " << gpus.size() << " GPUs of " <<
+                 host->address << std::endl;
+}
+
+void RdcAggregatorServiceImpl::disconnect(Downstream* host) {
+    // Best effort, the host may be gone
+    if (host->watching) {
+        ::rdc::UnWatchFieldsRequest request;
+        ::rdc::UnWatchFieldsResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        request.set_group_id(host->group_id);
+        request.set_field_group_id(host->field_group_id);
+        host->stub->UnWatchFields(&context, request, &reply);
+    }
+    if (host->field_group_created) {
+        ::rdc::DestroyFieldGroupRequest request;
+        ::rdc::DestroyFieldGroupResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        request.set_field_group_id(host->field_group_id);
+        host->stub->DestroyFieldGroup(&context, request, &reply);
+    }
+    if (host->group_created) {
+        ::rdc::DestroyGpuGroupRequest request;
+        ::rdc::DestroyGpuGroupResponse reply;
+        ::grpc::ClientContext context;
+        set_setup_deadline(&context);
+        request.set_group_id(host->group_id);
+        host->stub->DestroyGpuGroup(&context, request, &reply);
+    }
+
+    host->watching = false;
+    host->group_created = false;
+    host->field_group_created = false;
+    std::lock_guard<std::mutex> guard(host->mutex);
+    host->connected = false;
+}
+
+void RdcAggregatorServiceImpl::start_sweep(Downstream* host) {
+    host->sweeping = true;
+    host->received = 0;
+    host->in_flight = static_cast<uint32_t>(host->requests.size());
+    std::chrono::system_clock::time_point deadline =
+            std::chrono::system_clock::now() +
+            std::chrono::milliseconds(interval_ms_);
+    for (Request& request : host->requests) {
+        AsyncCall* call = new AsyncCall();
+        call->request = &request;
+        call->context.set_deadline(deadline);
+        ::rdc::GetLatestFieldValueRequest message;
+        message.set_gpu_index(request.gpu_index);
+        message.set_field_id(request.field);
+        call->reader = host->stub->PrepareAsyncGetLatestFieldValue(
+                                            &call->context, message, &cq_);
+        call->reader->StartCall();
+        call->reader->Finish(&call->reply, &call->status, call);
+    }
+}
+
+void RdcAggregatorServiceImpl::finish_sweep(Downstream* host) {
+    host->sweeping = false;
+    if (host->received > 0) {
+        host->failed_sweeps = 0;
+        return;
+    }
+    if (++host->failed_sweeps < kMaxFailedSweeps) {
+        return;
+    }
+
+    // Also covers an rdcd which restarted and forgot the watches
+    std::cerr << "No values from " << host->address << ", reconnecting"
+              << std::endl;
+    disconnect(host);
+    host->retry_at = std::chrono::steady_clock::now() +
+                     std::chrono::milliseconds(host->retry_ms);
+}
+
+void RdcAggregatorServiceImpl::on_value(rdc_status_t status,
+        const rdc_field_value* value, Request* request) {
+    Downstream* host = request->host;
+    {
+        std::lock_guard<std::mutex> guard(host->mutex);
+        if (status == RDC_ST_OK) {
+            RdcAggregatedValue& entry = host->values[
+                        RdcFieldKey(request->gpu_index, request->field)];
+            entry.value = *value;
+            entry.received = std::chrono::steady_clock::now();
+            host->last_value = entry.received;
+        } else {
+            host->num_errors++;
+        }
+    }
+    if (status == RDC_ST_OK) {
+        host->received++;
+    }
+    host->in_flight--;
+}
+
+::grpc::Status RdcAggregatorServiceImpl::GetClusterHosts(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::Empty* request,
+                  ::rdc::GetClusterHostsResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    RdcAggregatorTime now = std::chrono::steady_clock::now();
+    for (auto& host : hosts_) {
+        std::lock_guard<std::mutex> guard(host->mutex);
+        ::rdc::ClusterHost* target = reply->add_hosts();
+        target->set_host(host->address);
+        target->set_connected(host->connected);
+        target->set_num_gpus(host->gpus.size());
+        target->set_age_ms(age_ms(host->last_value, now));
+        target->set_num_errors(host->num_errors);
+    }
+    reply->set_status(RDC_ST_OK);
+
+    return ::grpc::Status::OK;
+}
+
+::grpc::Status RdcAggregatorServiceImpl::GetClusterLatestValues(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::GetClusterLatestValuesRequest* request,
+                  ::rdc::GetClusterLatestValuesResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    // An empty filter selects everything
+    std::set<std::string> hosts(request->hosts().begin(),
+                                request->hosts().end());
+    std::set<uint32_t> gpus(request->gpu_indexes().begin(),
+                            request->gpu_indexes().end());
+    std::set<uint32_t> fields(request->field_ids().begin(),
+                              request->field_ids().end());
+
+    RdcAggregatorTime now = std::chrono::steady_clock::now();
+    for (auto& host : hosts_) {
+        if (!hosts.empty() && hosts.count(host->address) == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> guard(host->mutex);
+        for (uint32_t gpu_index : host->gpus) {
+            if (!gpus.empty() && gpus.count(gpu_index) == 0) {
+                continue;
+            }
+            for (rdc_field_t field : fields_) {
+                if (!fields.empty() && fields.count(field) == 0) {
+                    continue;
+                }
+                auto ite = host->values.find(RdcFieldKey(gpu_index, field));
+                if (ite == host->values.end()) {
+                    continue;
+                }
+                ::rdc::ClusterFieldValue* target = reply->add_values();
+                target->set_host(host->address);
+                target->set_gpu_index(gpu_index);
+                target->set_age_ms(age_ms(ite->second.received, now));
+                copy_field_value(ite->second.value, target);
+            }
+        }
+    }
+    reply->set_status(RDC_ST_OK);
+
+    return ::grpc::Status::OK;
+}
+
+::grpc::Status RdcAggregatorServiceImpl::GetClusterAggregate(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::GetClusterAggregateRequest* request,
+                  ::rdc::GetClusterAggregateResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    rdc_field_t field = static_cast<rdc_field_t>(request->field_id());
+    uint32_t max_age_ms = request->max_age_ms() ? request->max_age_ms() :
+                                            kStaleIntervals * interval_ms_;
+    uint32_t num_hosts = 0;
+    uint32_t num_values = 0;
+    uint32_t num_skipped = 0;
+    double min_value = 0;
+    double max_value = 0;
+    double sum = 0;
+
+    RdcAggregatorTime now = std::chrono::steady_clock::now();
+    for (auto& host : hosts_) {
+        bool aggregated = false;
+        std::lock_guard<std::mutex> guard(host->mutex);
+        for (uint32_t gpu_index : host->gpus) {
+            auto ite = host->values.find(RdcFieldKey(gpu_index, field));
+            if (ite == host->values.end()) {
+                num_skipped++;
+                continue;
+            }
+            const rdc_field_value& value = ite->second.value;
+            if (value.status != RDC_ST_OK ||
+                    (value.type != INTEGER && value.type != DOUBLE) ||
+                    age_ms(ite->second.received, now) > max_age_ms) {
+                num_skipped++;
+                continue;
+            }
+            double v = value.type == INTEGER ?
+                    static_cast<double>(value.value.l_int) : value.value.dbl;
+            if (num_values == 0 || v < min_value) {
+                min_value = v;
+            }
+            if (num_values == 0 || v > max_value) {
+                max_value = v;
+            }
+            sum += v;
+            num_values++;
+            aggregated = true;
+        }
+        if (aggregated) {
+            num_hosts++;
+        }
+    }
+
+    reply->set_status(num_values > 0 ? RDC_ST_OK : RDC_ST_NOT_FOUND);
+    reply->set_field_id(field);
+    reply->set_num_hosts(num_hosts);
+    reply->set_num_values(num_values);
+    reply->set_num_skipped(num_skipped);
+    reply->set_min_value(min_value);
+    reply->set_max_value(max_value);
+    reply->set_sum(sum);
+    reply->set_average(num_values > 0 ? sum / num_values : 0);
+
+    return ::grpc::Status::OK;
+}
+
+}  // namespace rdc
+}  // namespace amd
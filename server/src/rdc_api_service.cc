@@ -21,10 +21,14 @@ THE SOFTWARE.
 */
 #include <assert.h>
 #include <grpcpp/grpcpp.h>
+#include <string.h>
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 #include <csignal>
 
 #include "rdc.grpc.pb.h"  // NOLINT
@@ -36,7 +40,95 @@ THE SOFTWARE.
 namespace amd {
 namespace rdc {
 
-RdcAPIServiceImpl::RdcAPIServiceImpl():rdc_handle_(nullptr) {
+namespace {
+
+// Calls one of the rdc_*_ext APIs straight into the reply list, growing
+// the list until everything fits.
+template <typename GetList>
+rdc_status_t get_ext_list(::google::protobuf::RepeatedField<uint32_t>* list,
+      GetList get_list) {
+  uint32_t count = 0;
+  rdc_status_t result = get_list(nullptr, &count);
+  while (result == RDC_ST_INSUFF_RESOURCES) {
+    list->Resize(count, 0);
+    result = get_list(list->mutable_data(), &count);
+  }
+  list->Truncate(result == RDC_ST_OK ? count : 0);
+  return result;
+}
+
+// At most that many values per GetLatestFieldValues request
+const int kMaxLatestValues = RDC_MAX_NUM_DEVICES_EXT *
+                                          RDC_MAX_FIELD_IDS_PER_FIELD_GROUP;
+
+// At most that many values per GetFieldValuesSince reply, the client
+// continues from next_since_time_stamp for more
+const uint32_t kMaxSinceValues = 1024;
+
+void copy_field_value(const rdc_field_value& value,
+      ::rdc::GetLatestFieldValueResponse* reply) {
+  reply->set_field_id(value.field_id);
+  reply->set_rdc_status(value.status);
+  reply->set_ts(value.ts);
+  reply->set_type(static_cast<::rdc::GetLatestFieldValueResponse_FieldType>
+                      (value.type));
+  if (value.type == INTEGER) {
+    reply->set_l_int(value.value.l_int);
+  } else if (value.type == DOUBLE) {
+    reply->set_dbl(value.value.dbl);
+  } else if (value.type == STRING || value.type == BLOB) {
+    reply->set_str(value.value.str);
+  }
+}
+
+}  // namespace
+
+// Start from the boot time in microseconds rather than 0, so a client
+// cache from before an rdcd restart is never mistaken for current.
+RdcAPIServiceImpl::RdcAPIServiceImpl():rdc_handle_(nullptr),
+    config_generation_(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()) {
+}
+
+uint64_t RdcAPIServiceImpl::config_generation() const {
+    return config_generation_.load(std::memory_order_acquire);
+}
+
+void RdcAPIServiceImpl::bump_config_generation(rdc_status_t result) {
+    if (result == RDC_ST_OK) {
+        config_generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+RdcGenerationInterceptor::RdcGenerationInterceptor(
+    const RdcAPIServiceImpl* service): service_(service) {
+}
+
+void RdcGenerationInterceptor::Intercept(
+    ::grpc::experimental::InterceptorBatchMethods* methods) {
+    // The initial metadata of a unary call goes out with the response, so
+    // a create or destroy already reports the generation it produced.
+    if (methods->QueryInterceptionHookPoint(::grpc::experimental::
+            InterceptionHookPoints::PRE_SEND_INITIAL_METADATA)) {
+        methods->GetSendInitialMetadata()->insert(std::make_pair(
+            std::string(RDC_CONFIG_GENERATION_KEY),
+            std::to_string(service_->config_generation())));
+    }
+    methods->Proceed();
+}
+
+RdcGenerationInterceptorFactory::RdcGenerationInterceptorFactory(
+    const RdcAPIServiceImpl* service): service_(service) {
+}
+
+::grpc::experimental::Interceptor*
+RdcGenerationInterceptorFactory::CreateServerInterceptor(
+    ::grpc::experimental::ServerRpcInfo* info) {
+    static const char kApiPrefix[] = "/rdc.RdcAPI/";
+    if (strncmp(info->method(), kApiPrefix, sizeof(kApiPrefix) - 1) != 0) {
+        return nullptr;
+    }
+    return new RdcGenerationInterceptor(service_);
 }
 
 rdc_status_t RdcAPIServiceImpl::Initialize(uint64_t rdcd_init_flags) {
@@ -54,6 +146,45 @@ rdc_status_t RdcAPIServiceImpl::Initialize(uint64_t rdcd_init_flags) {
     return result;
 }
 
+rdc_status_t RdcAPIServiceImpl::WatchAllGpus(const char* name,
+        const std::vector<rdc_field_t>& fields, uint64_t update_freq) {
+    rdc_gpu_group_t group_id;
+    rdc_status_t result = rdc_group_gpu_create(rdc_handle_,
+                RDC_GROUP_DEFAULT, name, &group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    rdc_field_grp_t field_group_id;
+    std::vector<rdc_field_t> field_ids(fields);
+    result = rdc_group_field_create(rdc_handle_, field_ids.size(),
+                field_ids.data(), name, &field_group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    // Keep a few samples only, nobody reads them from the cache
+    return rdc_field_watch(rdc_handle_, group_id, field_group_id,
+                update_freq, 60, 10);
+}
+
+rdc_status_t RdcAPIServiceImpl::GetPerfMetrics(
+        std::vector<rdc_perf_metric_t>* metrics) {
+    if (!metrics) {
+        return RDC_ST_BAD_PARAMETER;
+    }
+    uint32_t count = 0;
+    rdc_status_t result = rdc_perf_metrics_get(rdc_handle_, nullptr, &count);
+    while (result == RDC_ST_INSUFF_RESOURCES) {
+        // The cache may grow between the calls
+        metrics->resize(count + 16);
+        count = metrics->size();
+        result = rdc_perf_metrics_get(rdc_handle_, metrics->data(), &count);
+    }
+    metrics->resize(result == RDC_ST_OK ? count : 0);
+    return result;
+}
+
 RdcAPIServiceImpl::~RdcAPIServiceImpl() {
   if (rdc_handle_) {
     rdc_stop_embedded(rdc_handle_);
@@ -70,17 +201,11 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     if (!reply) {
       return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty reply");
     }
-    uint32_t  gpu_index_list[RDC_MAX_NUM_DEVICES];
-    uint32_t count = 0;
-    rdc_status_t result =  rdc_device_get_all(rdc_handle_,
-                  gpu_index_list, &count);
+    rdc_status_t result = get_ext_list(reply->mutable_gpus(),
+        [this](uint32_t* gpu_index_list, uint32_t* count) {
+          return rdc_device_get_all_ext(rdc_handle_, gpu_index_list, count);
+        });
     reply->set_status(result);
-    if (result != RDC_ST_OK) {
-        return ::grpc::Status::OK;
-    }
-    for (uint32_t i = 0; i < count; i++) {
-         reply->add_gpus(gpu_index_list[i]);
-    }
 
     return ::grpc::Status::OK;
 }
@@ -120,6 +245,7 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
                 static_cast<rdc_group_type_t>(request->type()),
                 request->group_name().c_str(), &group_id);
     reply->set_status(result);
+    bump_config_generation(result);
     if (result != RDC_ST_OK) {
         return ::grpc::Status::OK;
     }
@@ -141,6 +267,7 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     rdc_status_t result = rdc_group_gpu_add(rdc_handle_,
             request->group_id(), request->gpu_index());
     reply->set_status(result);
+    bump_config_generation(result);
 
     return ::grpc::Status::OK;
 }
@@ -154,18 +281,18 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
       return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
     }
 
-    rdc_group_info_t group_info;
-    rdc_status_t result = rdc_group_gpu_get_info(
-                rdc_handle_, request->group_id(), &group_info);
+    char group_name[RDC_MAX_STR_LENGTH];
+    rdc_status_t result = get_ext_list(reply->mutable_entity_ids(),
+        [this, request, &group_name](uint32_t* entity_ids, uint32_t* count) {
+          return rdc_group_gpu_get_info_ext(rdc_handle_, request->group_id(),
+                group_name, entity_ids, count);
+        });
     reply->set_status(result);
     if (result != RDC_ST_OK) {
         return ::grpc::Status::OK;
     }
 
-    reply->set_group_name(group_info.group_name);
-    for (uint32_t i = 0; i < group_info.count; i++) {
-         reply->add_entity_ids(group_info.entity_ids[i]);
-    }
+    reply->set_group_name(group_name);
 
     return ::grpc::Status::OK;
 }
@@ -178,18 +305,11 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
       return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
     }
 
-    rdc_gpu_group_t group_id_list[RDC_MAX_NUM_GROUPS];
-    uint32_t count = 0;
-    rdc_status_t result = rdc_group_get_all_ids(
-                rdc_handle_, group_id_list, &count);
+    rdc_status_t result = get_ext_list(reply->mutable_group_ids(),
+        [this](rdc_gpu_group_t* group_id_list, uint32_t* count) {
+          return rdc_group_get_all_ids_ext(rdc_handle_, group_id_list, count);
+        });
     reply->set_status(result);
-    if (result != RDC_ST_OK) {
-        return ::grpc::Status::OK;
-    }
-
-    for (uint32_t i = 0; i < count; i++) {
-         reply->add_group_ids(group_id_list[i]);
-    }
 
     return ::grpc::Status::OK;
 }
@@ -202,18 +322,12 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
       return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
     }
 
-    rdc_field_grp_t field_group_id_list[RDC_MAX_NUM_FIELD_GROUPS];
-    uint32_t count = 0;
-    rdc_status_t result = rdc_group_field_get_all_ids(
-                    rdc_handle_, field_group_id_list, &count);
+    rdc_status_t result = get_ext_list(reply->mutable_field_group_ids(),
+        [this](rdc_field_grp_t* field_group_id_list, uint32_t* count) {
+          return rdc_group_field_get_all_ids_ext(rdc_handle_,
+                field_group_id_list, count);
+        });
     reply->set_status(result);
-    if (result != RDC_ST_OK) {
-        return ::grpc::Status::OK;
-    }
-
-    for (uint32_t i = 0; i < count; i++) {
-         reply->add_field_group_ids(field_group_id_list[i]);
-    }
 
     return ::grpc::Status::OK;
 }
@@ -230,6 +344,7 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     rdc_status_t result = rdc_group_gpu_destroy(
                 rdc_handle_, request->group_id());
     reply->set_status(result);
+    bump_config_generation(result);
 
     return ::grpc::Status::OK;
 }
@@ -245,14 +360,15 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     }
 
     rdc_field_grp_t field_group_id;
-    rdc_field_t field_ids[RDC_MAX_FIELD_IDS_PER_FIELD_GROUP];
+    std::vector<rdc_field_t> field_ids;
     for (int i = 0; i < request->field_ids_size(); i++) {
-        field_ids[i] = static_cast<rdc_field_t>(request->field_ids(i));
+        field_ids.push_back(static_cast<rdc_field_t>(request->field_ids(i)));
     }
     rdc_status_t result = rdc_group_field_create(
-            rdc_handle_, request->field_ids_size() , &field_ids[0],
+            rdc_handle_, field_ids.size(), field_ids.data(),
             request->field_group_name().c_str(), &field_group_id);
     reply->set_status(result);
+    bump_config_generation(result);
     if (result != RDC_ST_OK) {
         return ::grpc::Status::OK;
     }
@@ -299,6 +415,7 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     rdc_status_t result = rdc_group_field_destroy(
                   rdc_handle_, request->field_group_id());
     reply->set_status(result);
+    bump_config_generation(result);
 
     return ::grpc::Status::OK;
 }
@@ -339,18 +456,37 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
         return ::grpc::Status::OK;
     }
 
-    reply->set_field_id(value.field_id);
-    reply->set_rdc_status(value.status);
-    reply->set_ts(value.ts);
-    reply->set_type(static_cast<::rdc::GetLatestFieldValueResponse_FieldType>
-                        (value.type));
-    if (value.type == INTEGER) {
-        reply->set_l_int(value.value.l_int);
-    } else if (value.type == DOUBLE) {
-        reply->set_dbl(value.value.dbl);
-    } else if (value.type == STRING || value.type == BLOB) {
-        reply->set_str(value.value.str);
+    copy_field_value(value, reply);
+
+    return ::grpc::Status::OK;
+}
+
+::grpc::Status RdcAPIServiceImpl::GetLatestFieldValues(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::GetLatestFieldValuesRequest* request,
+                  ::rdc::GetLatestFieldValuesResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+    if (request->fields_size() > kMaxLatestValues) {
+        reply->set_status(RDC_ST_MAX_LIMIT);
+        return ::grpc::Status::OK;
+    }
+
+    reply->mutable_values()->Reserve(request->fields_size());
+    for (auto& field : request->fields()) {
+        rdc_field_value value;
+        rdc_status_t result = rdc_field_get_latest_value(rdc_handle_,
+            field.gpu_index(), static_cast<rdc_field_t>(field.field_id()),
+                                                                      &value);
+        ::rdc::GetLatestFieldValueResponse* item = reply->add_values();
+        item->set_status(result);
+        if (result == RDC_ST_OK) {
+            copy_field_value(value, item);
+        }
     }
+    reply->set_status(RDC_ST_OK);
 
     return ::grpc::Status::OK;
 }
@@ -391,6 +527,35 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     return ::grpc::Status::OK;
 }
 
+::grpc::Status RdcAPIServiceImpl::GetFieldValuesSince(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::GetFieldValuesSinceRequest* request,
+                  ::rdc::GetFieldValuesSinceResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    uint32_t count = std::min(request->max_values(), kMaxSinceValues);
+    std::vector<rdc_field_value> values(count);
+    uint64_t next_timestamp = request->since_time_stamp();
+    rdc_status_t result = rdc_field_get_values_since(rdc_handle_,
+        request->gpu_index(), static_cast<rdc_field_t>(request->field_id()),
+        request->since_time_stamp(), &next_timestamp, values.data(), &count);
+    reply->set_status(result);
+    if (result != RDC_ST_OK) {
+        return ::grpc::Status::OK;
+    }
+
+    reply->set_next_since_time_stamp(next_timestamp);
+    reply->mutable_values()->Reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        copy_field_value(values[i], reply->add_values());
+    }
+
+    return ::grpc::Status::OK;
+}
+
 ::grpc::Status RdcAPIServiceImpl::UnWatchFields(
                   ::grpc::ServerContext* context,
                   const ::rdc::UnWatchFieldsRequest* request,
@@ -407,6 +572,60 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     return ::grpc::Status::OK;
 }
 
+::grpc::Status RdcAPIServiceImpl::SetWatchLimits(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::SetWatchLimitsRequest* request,
+                  ::rdc::SetWatchLimitsResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    rdc_status_t result = rdc_field_watch_set_limits(rdc_handle_,
+              request->group_id(), request->field_group_id(),
+              request->priority(), request->max_update_freq());
+    reply->set_status(result);
+
+    return ::grpc::Status::OK;
+}
+
+::grpc::Status RdcAPIServiceImpl::GetWatchRates(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::Empty* request,
+                  ::rdc::GetWatchRatesResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    uint32_t count = 0;
+    std::vector<rdc_watch_rate_t> rates;
+    rdc_status_t result = rdc_field_get_watch_rates(rdc_handle_, nullptr,
+              &count);
+    while (result == RDC_ST_INSUFF_RESOURCES) {
+      // The watches may change between the calls
+      rates.resize(count + 16);
+      count = rates.size();
+      result = rdc_field_get_watch_rates(rdc_handle_, rates.data(), &count);
+    }
+    rates.resize(result == RDC_ST_OK ? count : 0);
+    reply->set_status(result);
+    if (result != RDC_ST_OK) {
+      return ::grpc::Status::OK;
+    }
+    for (const auto& rate : rates) {
+      ::rdc::WatchRate* target = reply->add_rates();
+      target->set_group_id(rate.group_id);
+      target->set_field_group_id(rate.field_group_id);
+      target->set_priority(rate.priority);
+      target->set_requested_freq(rate.requested_freq);
+      target->set_max_update_freq(rate.max_update_freq);
+      target->set_effective_freq(rate.effective_freq);
+    }
+
+    return ::grpc::Status::OK;
+}
+
 ::grpc::Status RdcAPIServiceImpl::UpdateAllFields(
                   ::grpc::ServerContext* context,
                   const ::rdc::UpdateAllFieldsRequest* request,
@@ -465,7 +684,9 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     ::rdc::GpuUsageInfo* sinfo = reply->mutable_summary();
     copy_gpu_usage_info(job_info.summary, sinfo);
 
-    for (uint32_t i = 0; i < job_info.num_gpus; i++) {
+    const uint32_t max_job_gpus = sizeof(job_info.gpus) /
+                sizeof(job_info.gpus[0]);
+    for (uint32_t i = 0; i < job_info.num_gpus && i < max_job_gpus; i++) {
        ::rdc::GpuUsageInfo* ginfo = reply->add_gpus();
        copy_gpu_usage_info(job_info.gpus[i], ginfo);
     }
@@ -473,6 +694,56 @@ RdcAPIServiceImpl::~RdcAPIServiceImpl() {
     return ::grpc::Status::OK;
 }
 
+::grpc::Status RdcAPIServiceImpl::GetJobMoments(
+                  ::grpc::ServerContext* context,
+                  const ::rdc::GetJobMomentsRequest* request,
+                  ::rdc::GetJobMomentsResponse* reply) {
+    (void)(context);
+    if (!reply || !request) {
+      return ::grpc::Status(::grpc::StatusCode::INTERNAL, "Empty contents");
+    }
+
+    // Size the array from the GPUs of the job, which may change between
+    // the two calls if the job is restarted meanwhile.
+    std::vector<rdc_job_gpu_moments_t> gpus;
+    uint32_t count = 0;
+    rdc_status_t result;
+    do {
+      gpus.resize(count);
+      result = rdc_job_get_moments(rdc_handle_,
+                const_cast<char*>(request->job_id().c_str()),
+                gpus.data(), &count);
+    } while (result == RDC_ST_INSUFF_RESOURCES);
+
+    reply->set_status(result);
+    if (result != RDC_ST_OK) {
+      return ::grpc::Status::OK;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      const rdc_job_gpu_moments_t& src = gpus[i];
+      ::rdc::GpuMoments* gpu = reply->add_gpus();
+      gpu->set_gpu_index(src.gpu_index);
+      gpu->set_start_time(src.start_time);
+      gpu->set_end_time(src.end_time);
+      gpu->set_energy_consumed(src.energy_consumed);
+      gpu->set_ecc_correct(src.ecc_correct);
+      gpu->set_ecc_uncorrect(src.ecc_uncorrect);
+      gpu->set_memory_total(src.memory_total);
+      for (uint32_t f = 0; f < src.num_fields; f++) {
+        ::rdc::FieldMoments* field = gpu->add_fields();
+        field->set_field_id(src.fields[f].field_id);
+        field->set_count(src.fields[f].count);
+        field->set_min_value(src.fields[f].min_value);
+        field->set_max_value(src.fields[f].max_value);
+        field->set_mean(src.fields[f].mean);
+        field->set_m2(src.fields[f].m2);
+      }
+    }
+
+    return ::grpc::Status::OK;
+}
+
 bool RdcAPIServiceImpl::copy_gpu_usage_info(const rdc_gpu_usage_info_t& src,
             ::rdc::GpuUsageInfo* target) {
     if (target == nullptr) {
@@ -0,0 +1,391 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <google/protobuf/arena.h>
+#include <google/protobuf/descriptor.h>
+#include <grpcpp/grpcpp.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "rdc/rdc_async_server.h"
+#include "rdc_lib/RdcThreads.h"
+
+namespace amd {
+namespace rdc {
+
+// Replies that fit in this block are served without heap allocation
+static const size_t kCallArenaBlockSize = 4096;
+
+// A completion queue and the flag that stops calls from being armed on it
+// once it is shut down. gRPC does not allow requests on a shut down queue.
+struct RdcAsyncQueue {
+  std::unique_ptr<::grpc::ServerCompletionQueue> cq;
+  std::mutex mutex;
+  bool shutdown;
+};
+
+// Tag of every event on the completion queues
+class RdcAsyncCall {
+ public:
+  virtual ~RdcAsyncCall() {}
+  virtual void Proceed(bool ok) = 0;
+};
+
+class RdcAsyncMethod {
+ public:
+  virtual ~RdcAsyncMethod() {}
+
+  // Post one outstanding request for this method on the queue
+  void Arm(RdcAsyncQueue* queue) {
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    if (!queue->shutdown) {
+      NewCall(queue);
+    }
+  }
+
+ protected:
+  virtual void NewCall(RdcAsyncQueue* queue) = 0;
+};
+
+template <typename Req, typename Resp>
+class RdcAsyncUnaryMethod : public RdcAsyncMethod {
+ public:
+  typedef std::function<void(::grpc::ServerContext*, Req*,
+              ::grpc::ServerAsyncResponseWriter<Resp>*,
+              ::grpc::ServerCompletionQueue*, void*)> RequestFunc;
+  typedef std::function<::grpc::Status(::grpc::ServerContext*,
+                                       const Req*, Resp*)> HandlerFunc;
+
+  RdcAsyncUnaryMethod(RequestFunc request, HandlerFunc handler) :
+      request_(request), handler_(handler) {}
+
+  const RequestFunc& request() const { return request_; }
+  const HandlerFunc& handler() const { return handler_; }
+
+ protected:
+  void NewCall(RdcAsyncQueue* queue) override;
+
+ private:
+  RequestFunc request_;
+  HandlerFunc handler_;
+};
+
+template <typename Req, typename Resp>
+class RdcAsyncUnaryCall : public RdcAsyncCall {
+ public:
+  RdcAsyncUnaryCall(RdcAsyncUnaryMethod<Req, Resp>* method,
+                    RdcAsyncQueue* queue) :
+      method_(method), queue_(queue), arena_(arena_options()),
+      responder_(&ctx_), finished_(false) {
+    request_ = google::protobuf::Arena::CreateMessage<Req>(&arena_);
+    reply_ = google::protobuf::Arena::CreateMessage<Resp>(&arena_);
+    method_->request()(&ctx_, request_, &responder_, queue_->cq.get(),
+                       this);
+  }
+
+  void Proceed(bool ok) override {
+    // Either the reply was sent, or the request was cancelled because
+    // the server is shutting down.
+    if (finished_ || !ok) {
+      delete this;
+      return;
+    }
+
+    // Keep a request outstanding while this one is served
+    method_->Arm(queue_);
+
+    ::grpc::Status status = method_->handler()(&ctx_, request_, reply_);
+    finished_ = true;
+    responder_.Finish(*reply_, status, this);
+  }
+
+ private:
+  google::protobuf::ArenaOptions arena_options() {
+    google::protobuf::ArenaOptions opts;
+    opts.initial_block = arena_block_;
+    opts.initial_block_size = sizeof(arena_block_);
+    return opts;
+  }
+
+  RdcAsyncUnaryMethod<Req, Resp>* method_;
+  RdcAsyncQueue* queue_;
+  char arena_block_[kCallArenaBlockSize];
+  google::protobuf::Arena arena_;
+  ::grpc::ServerContext ctx_;
+  ::grpc::ServerAsyncResponseWriter<Resp> responder_;
+  Req* request_;
+  Resp* reply_;
+  bool finished_;
+};
+
+template <typename Req, typename Resp>
+void RdcAsyncUnaryMethod<Req, Resp>::NewCall(RdcAsyncQueue* queue) {
+  new RdcAsyncUnaryCall<Req, Resp>(this, queue);
+}
+
+namespace {
+
+// Bind the generated RequestXxx() of an async service to the synchronous
+// implementation of the same RPC.
+template <typename AsyncSvc, typename RequestBase,
+          typename SyncSvc, typename HandlerBase, typename Req, typename Resp>
+RdcAsyncMethod* make_method(AsyncSvc* async_svc,
+      void (RequestBase::*request)(::grpc::ServerContext*, Req*,
+              ::grpc::ServerAsyncResponseWriter<Resp>*,
+              ::grpc::CompletionQueue*, ::grpc::ServerCompletionQueue*,
+              void*),
+      SyncSvc* sync_svc,
+      ::grpc::Status (HandlerBase::*handler)(::grpc::ServerContext*,
+                                             const Req*, Resp*)) {
+  RequestBase* req_svc = async_svc;
+  HandlerBase* handler_svc = sync_svc;
+  return new RdcAsyncUnaryMethod<Req, Resp>(
+      [req_svc, request](::grpc::ServerContext* ctx, Req* req,
+                 ::grpc::ServerAsyncResponseWriter<Resp>* responder,
+                 ::grpc::ServerCompletionQueue* cq, void* tag) {
+        (req_svc->*request)(ctx, req, responder, cq, cq, tag);
+      },
+      [handler_svc, handler](::grpc::ServerContext* ctx, const Req* req,
+                             Resp* reply) {
+        return (handler_svc->*handler)(ctx, req, reply);
+      });
+}
+
+// An RPC registered with the service but left off the list below is never
+// requested from the completion queues, and its callers would hang.
+bool all_methods_added(const char* service_name, size_t added) {
+  const google::protobuf::ServiceDescriptor* service =
+      google::protobuf::DescriptorPool::generated_pool()->FindServiceByName(
+          service_name);
+  if (service == nullptr ||
+      static_cast<size_t>(service->method_count()) != added) {
+    std::cerr << "The asynchronous server handles " << added << " of the "
+              << (service ? service->method_count() : 0) << " methods of "
+              << service_name << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+RdcAsyncServer::RdcAsyncServer(RsmiServiceImpl* rsmi_service,
+                               RDCAdminServiceImpl* admin_service,
+                               RdcAPIServiceImpl* api_service) :
+    rsmi_service_(rsmi_service), admin_service_(admin_service),
+    api_service_(api_service), started_(false) {
+}
+
+RdcAsyncServer::~RdcAsyncServer() {
+  Shutdown();
+}
+
+bool
+RdcAsyncServer::RegisterServices(::grpc::ServerBuilder* builder,
+                                 uint32_t num_cqs) {
+  num_cqs = std::max(num_cqs, 1u);
+  for (uint32_t i = 0; i < num_cqs; i++) {
+    std::unique_ptr<RdcAsyncQueue> queue(new RdcAsyncQueue);
+    queue->cq = builder->AddCompletionQueue();
+    queue->shutdown = false;
+    cqs_.push_back(std::move(queue));
+  }
+
+  auto add = [this](RdcAsyncMethod* m) {
+    methods_.push_back(std::unique_ptr<RdcAsyncMethod>(m));
+  };
+
+  size_t first = methods_.size();
+  if (rsmi_service_) {
+    builder->RegisterService(&rsmi_async_);
+    ::rdc::Rsmi::AsyncService* s = &rsmi_async_;
+    RsmiServiceImpl* i = rsmi_service_;
+    add(make_method(s, &::rdc::Rsmi::AsyncService::RequestGetNumDevices,
+                    i, &RsmiServiceImpl::GetNumDevices));
+    add(make_method(s, &::rdc::Rsmi::AsyncService::RequestGetTemperature,
+                    i, &RsmiServiceImpl::GetTemperature));
+    add(make_method(s, &::rdc::Rsmi::AsyncService::RequestGetFanRpms,
+                    i, &RsmiServiceImpl::GetFanRpms));
+    add(make_method(s, &::rdc::Rsmi::AsyncService::RequestGetFanSpeed,
+                    i, &RsmiServiceImpl::GetFanSpeed));
+    add(make_method(s, &::rdc::Rsmi::AsyncService::RequestGetFanSpeedMax,
+                    i, &RsmiServiceImpl::GetFanSpeedMax));
+    if (!all_methods_added(::rdc::Rsmi::service_full_name(),
+                           methods_.size() - first)) {
+      return false;
+    }
+  }
+
+  first = methods_.size();
+  if (admin_service_) {
+    builder->RegisterService(&admin_async_);
+    add(make_method(&admin_async_,
+                    &::rdc::RdcAdmin::AsyncService::RequestVerifyConnection,
+                    admin_service_, &RDCAdminServiceImpl::VerifyConnection));
+    add(make_method(&admin_async_,
+                    &::rdc::RdcAdmin::AsyncService::RequestGetPerfMetrics,
+                    admin_service_, &RDCAdminServiceImpl::GetPerfMetrics));
+    add(make_method(&admin_async_,
+                    &::rdc::RdcAdmin::AsyncService::RequestGetTrace,
+                    admin_service_, &RDCAdminServiceImpl::GetTrace));
+    if (!all_methods_added(::rdc::RdcAdmin::service_full_name(),
+                           methods_.size() - first)) {
+      return false;
+    }
+  }
+
+  first = methods_.size();
+  if (api_service_) {
+    builder->RegisterService(&api_async_);
+    typedef ::rdc::RdcAPI::AsyncService S;
+    S* s = &api_async_;
+    RdcAPIServiceImpl* i = api_service_;
+    add(make_method(s, &S::RequestGetAllDevices,
+                    i, &RdcAPIServiceImpl::GetAllDevices));
+    add(make_method(s, &S::RequestGetDeviceAttributes,
+                    i, &RdcAPIServiceImpl::GetDeviceAttributes));
+    add(make_method(s, &S::RequestCreateGpuGroup,
+                    i, &RdcAPIServiceImpl::CreateGpuGroup));
+    add(make_method(s, &S::RequestAddToGpuGroup,
+                    i, &RdcAPIServiceImpl::AddToGpuGroup));
+    add(make_method(s, &S::RequestCreateFieldGroup,
+                    i, &RdcAPIServiceImpl::CreateFieldGroup));
+    add(make_method(s, &S::RequestGetFieldGroupInfo,
+                    i, &RdcAPIServiceImpl::GetFieldGroupInfo));
+    add(make_method(s, &S::RequestGetGpuGroupInfo,
+                    i, &RdcAPIServiceImpl::GetGpuGroupInfo));
+    add(make_method(s, &S::RequestDestroyGpuGroup,
+                    i, &RdcAPIServiceImpl::DestroyGpuGroup));
+    add(make_method(s, &S::RequestDestroyFieldGroup,
+                    i, &RdcAPIServiceImpl::DestroyFieldGroup));
+    add(make_method(s, &S::RequestWatchFields,
+                    i, &RdcAPIServiceImpl::WatchFields));
+    add(make_method(s, &S::RequestGetLatestFieldValue,
+                    i, &RdcAPIServiceImpl::GetLatestFieldValue));
+    add(make_method(s, &S::RequestGetLatestFieldValues,
+                    i, &RdcAPIServiceImpl::GetLatestFieldValues));
+    add(make_method(s, &S::RequestGetFieldSince,
+                    i, &RdcAPIServiceImpl::GetFieldSince));
+    add(make_method(s, &S::RequestGetFieldValuesSince,
+                    i, &RdcAPIServiceImpl::GetFieldValuesSince));
+    add(make_method(s, &S::RequestUnWatchFields,
+                    i, &RdcAPIServiceImpl::UnWatchFields));
+    add(make_method(s, &S::RequestSetWatchLimits,
+                    i, &RdcAPIServiceImpl::SetWatchLimits));
+    add(make_method(s, &S::RequestGetWatchRates,
+                    i, &RdcAPIServiceImpl::GetWatchRates));
+    add(make_method(s, &S::RequestUpdateAllFields,
+                    i, &RdcAPIServiceImpl::UpdateAllFields));
+    add(make_method(s, &S::RequestGetGroupAllIds,
+                    i, &RdcAPIServiceImpl::GetGroupAllIds));
+    add(make_method(s, &S::RequestGetFieldGroupAllIds,
+                    i, &RdcAPIServiceImpl::GetFieldGroupAllIds));
+    add(make_method(s, &S::RequestStartJobStats,
+                    i, &RdcAPIServiceImpl::StartJobStats));
+    add(make_method(s, &S::RequestGetJobStats,
+                    i, &RdcAPIServiceImpl::GetJobStats));
+    add(make_method(s, &S::RequestGetJobMoments,
+                    i, &RdcAPIServiceImpl::GetJobMoments));
+    add(make_method(s, &S::RequestStopJobStats,
+                    i, &RdcAPIServiceImpl::StopJobStats));
+    add(make_method(s, &S::RequestRemoveJob,
+                    i, &RdcAPIServiceImpl::RemoveJob));
+    add(make_method(s, &S::RequestRemoveAllJob,
+                    i, &RdcAPIServiceImpl::RemoveAllJob));
+    if (!all_methods_added(::rdc::RdcAPI::service_full_name(),
+                           methods_.size() - first)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+RdcAsyncServer::Start(uint32_t threads_per_cq) {
+  threads_per_cq = std::max(threads_per_cq, 1u);
+
+  // One outstanding request per method and polling thread, so that every
+  // thread of a queue can pick up a call of the same method at once.
+  for (auto& queue : cqs_) {
+    for (auto& method : methods_) {
+      for (uint32_t t = 0; t < threads_per_cq; t++) {
+        method->Arm(queue.get());
+      }
+    }
+  }
+
+  for (auto& queue : cqs_) {
+    for (uint32_t t = 0; t < threads_per_cq; t++) {
+      threads_.push_back(std::thread(&RdcAsyncServer::PollQueue, this,
+                                     queue->cq.get()));
+    }
+  }
+  started_ = true;
+
+  std::cout << "Serving asynchronously on " << cqs_.size() <<
+      " completion queue(s) with " << threads_per_cq <<
+      " thread(s) each" << std::endl;
+}
+
+void
+RdcAsyncServer::PollQueue(::grpc::ServerCompletionQueue* cq) {
+  RdcThreads::get().setup(RDC_THREAD_RPC, "rdc-rpc-cq");
+  void* tag;
+  bool ok;
+  while (cq->Next(&tag, &ok)) {
+    static_cast<RdcAsyncCall*>(tag)->Proceed(ok);
+  }
+}
+
+void
+RdcAsyncServer::Shutdown() {
+  for (auto& queue : cqs_) {
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    if (!queue->shutdown) {
+      queue->shutdown = true;
+      queue->cq->Shutdown();
+    }
+  }
+
+  for (auto& t : threads_) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+  threads_.clear();
+
+  // A queue that was never polled must still be drained
+  if (!started_) {
+    for (auto& queue : cqs_) {
+      PollQueue(queue->cq.get());
+    }
+  }
+  started_ = false;
+}
+
+}  // namespace rdc
+}  // namespace amd
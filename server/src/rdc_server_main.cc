@@ -31,9 +31,14 @@ THE SOFTWARE.
 #include <sys/capability.h>
 #include <getopt.h>
 #include <pwd.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <csignal>
 
 #include "rdc.grpc.pb.h"  // NOLINT
@@ -43,6 +48,11 @@ THE SOFTWARE.
 #include "rdc/rdc_api_service.h"
 #include "rdc/rdc_server_utils.h"
 #include "common/rdc_utils.h"
+#include "rdc_lib/rdc_common.h"
+#include "rdc_lib/impl/RdcTelemetryCapture.h"
+#include "rdc_lib/RdcShmLayout.h"
+#include "rdc_lib/impl/RdcPrometheusExporter.h"
+#include "rdc_lib/impl/RdcExportPipeline.h"
 
 // TODO(cfreehil):
 // The following need to be made configurable (e.g., from YAML):
@@ -77,11 +87,32 @@ static const char * kDefaultRDCServerCertPemPkiPath =
 static const char * kDefaultRDCClientCACertPemPkiPath =
                                        "/etc/rdc/client/certs/rdc_cacert.pem";
 
+// Client credentials of an aggregator, the same as rdci uses
+static const char * kDefaultRDCClientCertPemPkiPath =
+                                "/etc/rdc/client/certs/rdc_client_cert.pem";
+static const char * kDefaultRDCClientKeyPkiPath =
+                               "/etc/rdc/client/private/rdc_client_cert.key";
+
 static const char *kDefaultListenPort = "50051";
 static const uint32_t kRSMIUMask = 027;
 
+// Polling threads per completion queue of the asynchronous server
+static const uint32_t kDefaultAsyncCQThreads = 4;
+
+// What an aggregator collects from each GPU unless told otherwise
+static const rdc_field_t kDefaultAggregateFields[] = {RDC_FI_GPU_TEMP,
+  RDC_FI_POWER_USAGE, RDC_FI_GPU_UTIL, RDC_FI_GPU_MEMORY_USAGE};
+static const uint32_t kDefaultAggregateIntervalMs = 1000;
+
+// What rdcd serves to Prometheus unless told otherwise, as the Python plugin
+static const rdc_field_t kDefaultPrometheusFields[] = {
+  RDC_FI_GPU_MEMORY_USAGE, RDC_FI_GPU_MEMORY_TOTAL, RDC_FI_POWER_USAGE,
+  RDC_FI_GPU_CLOCK, RDC_FI_GPU_UTIL, RDC_FI_GPU_TEMP};
+static const uint64_t kPrometheusUpdateFreqUs = 1000000;
+
 RDCServer::RDCServer() : server_address_("0.0.0.0:"),
-    secure_creds_(false), rsmi_service_(nullptr), rdc_admin_service_(nullptr) {
+    secure_creds_(false), rsmi_service_(nullptr), rdc_admin_service_(nullptr),
+    api_service_(nullptr), aggregator_service_(nullptr) {
 }
 
 RDCServer::~RDCServer() {
@@ -97,6 +128,32 @@ RDCServer::Initialize(RdcdCmdLineOpts *cl) {
   secure_creds_ = !cmd_line_->no_authentication;
   use_pinned_certs_ = cmd_line_->use_pinned_certs;
   log_debug_ = cmd_line_->log_dbg;
+
+  // The telemetry module of librdc reads these when it is loaded
+  if (!cmd_line_->capture_file.empty()) {
+    setenv(RDC_CAPTURE_FILE_ENV, cmd_line_->capture_file.c_str(), 1);
+  }
+  if (!cmd_line_->replay_file.empty()) {
+    setenv(RDC_REPLAY_FILE_ENV, cmd_line_->replay_file.c_str(), 1);
+  }
+  if (!cmd_line_->replay_speed.empty()) {
+    setenv(RDC_REPLAY_SPEED_ENV, cmd_line_->replay_speed.c_str(), 1);
+  }
+  // Keep a name given in the environment
+  if (cmd_line_->publish_shm) {
+    setenv(RDC_SHM_NAME_ENV,
+           amd::rdc::rdc_shm_default_name(cmd_line_->listen_port).c_str(), 0);
+  }
+  if (!cmd_line_->prometheus_listen.empty()) {
+    setenv(RDC_PROMETHEUS_LISTEN_ENV, cmd_line_->prometheus_listen.c_str(), 1);
+  }
+  if (!cmd_line_->export_sinks.empty()) {
+    std::string sinks;
+    for (auto& sink : cmd_line_->export_sinks) {
+      sinks += (sinks.empty() ? "" : ",") + sink;
+    }
+    setenv(RDC_EXPORT_ENV, sinks.c_str(), 1);
+  }
 }
 
 static int ConstructSSLOptsPin(grpc::SslServerCredentialsOptions *ssl_opts) {
@@ -175,6 +232,68 @@ static int ConstructSSLOptsPKI(grpc::SslServerCredentialsOptions *ssl_opts) {
   return 0;
 }
 
+// Bound the threads, streams and polling of the grpc server, so that a
+// burst of clients queues instead of spawning threads without limit.
+static void ConfigureServerResources(::grpc::ServerBuilder *builder,
+                                                const RdcdCmdLineOpts &opts) {
+  if (opts.max_threads) {
+    ::grpc::ResourceQuota quota("rdcd");
+    quota.SetMaxThreads(opts.max_threads);
+    builder->SetResourceQuota(quota);
+  }
+  if (opts.max_streams) {
+    builder->AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS,
+                                                            opts.max_streams);
+  }
+
+  // The asynchronous server creates its own queues and threads
+  if (opts.async_server) {
+    return;
+  }
+  if (opts.num_cqs) {
+    builder->SetSyncServerOption(
+             ::grpc::ServerBuilder::SyncServerOption::NUM_CQS, opts.num_cqs);
+  }
+  if (opts.cq_threads) {
+    builder->SetSyncServerOption(
+                  ::grpc::ServerBuilder::SyncServerOption::MIN_POLLERS, 1);
+    builder->SetSyncServerOption(
+       ::grpc::ServerBuilder::SyncServerOption::MAX_POLLERS, opts.cq_threads);
+  }
+}
+
+// An aggregator authenticates to the downstream rdcd like rdci does
+static int ReadAggregatorCredentials(
+                            amd::rdc::RdcAggregatorCredentials *credentials) {
+  assert(credentials != nullptr);
+  if (!amd::rdc::FileExists(kDefaultRDCClientCACertPemPkiPath) ||
+      !amd::rdc::FileExists(kDefaultRDCClientCertPemPkiPath) ||
+      !amd::rdc::FileExists(kDefaultRDCClientKeyPkiPath)) {
+    return -ENOENT;
+  }
+
+  int ret = amd::rdc::ReadFile(kDefaultRDCClientCACertPemPkiPath,
+                                                    &credentials->root_ca);
+  if (ret) {
+    return ret;
+  }
+  ret = amd::rdc::ReadFile(kDefaultRDCClientCertPemPkiPath,
+                                                &credentials->client_cert);
+  if (ret) {
+    return ret;
+  }
+  return amd::rdc::ReadFile(kDefaultRDCClientKeyPkiPath,
+                                                 &credentials->client_key);
+}
+
+// The systemd service provides a runtime directory for the socket
+static std::string DefaultUnixSocketPath(const std::string &port) {
+  if (access(RDC_UNIX_SOCKET_RUN_DIR, W_OK) == 0) {
+    return rdc_unix_socket_path(RDC_UNIX_SOCKET_RUN_DIR, port);
+  }
+  return rdc_unix_socket_path(RDC_UNIX_SOCKET_TMP_DIR, port);
+}
+
 void
 RDCServer::Run() {
   ::grpc::ServerBuilder builder;
@@ -200,16 +319,12 @@ RDCServer::Run() {
                                            grpc::InsecureServerCredentials());
   }
 
-  // Register services as the instances through which we'll communicate with
-  // clients. These are synchronous services.
-  if (start_rdc_admin_service()) {
-    rdc_admin_service_ = new amd::rdc::RDCAdminServiceImpl();
-    builder.RegisterService(rdc_admin_service_);
-  }
+  ConfigureServerResources(&builder, *cmd_line_);
 
+  // Create the service instances through which we'll communicate with
+  // clients.
   if (start_rsmi_service()) {
     rsmi_service_ = new amd::rdc::RsmiServiceImpl();
-    builder.RegisterService(rsmi_service_);
 
     rsmi_status_t ret = rsmi_service_->Initialize(0);
 
@@ -221,7 +336,6 @@ RDCServer::Run() {
 
   if (start_api_service()) {
     api_service_ = new amd::rdc::RdcAPIServiceImpl();
-    builder.RegisterService(api_service_);
 
     // TODO(bill_liu): pass flags from cnfg file
     rdc_status_t ret = api_service_->Initialize(0);
@@ -230,11 +344,109 @@ RDCServer::Run() {
       std::cerr << "Failed to start API service" << std::endl;
       return;
     }
+
+    if (!cmd_line_->prometheus_listen.empty()) {
+      ret = api_service_->WatchAllGpus("rdcd-prometheus",
+          cmd_line_->prometheus_fields, kPrometheusUpdateFreqUs);
+      if (ret != RDC_ST_OK) {
+        std::cerr << "Failed to watch the Prometheus fields: " <<
+                                         rdc_status_string(ret) << std::endl;
+      }
+    }
+  }
+
+  // The admin service reports the self-telemetry of the API service
+  if (start_rdc_admin_service()) {
+    rdc_admin_service_ = new amd::rdc::RDCAdminServiceImpl(api_service_,
+                                                           &rpc_metrics_);
+  }
+
+  if (!cmd_line_->aggregate_hosts.empty()) {
+    amd::rdc::RdcAggregatorCredentials credentials;
+    if (secure_creds_) {
+      ret = ReadAggregatorCredentials(&credentials);
+      if (ret) {
+        std::cerr << "Failed to read the client certificates to connect to "
+                        "the downstream rdcd. Errno: " << -ret << std::endl;
+        return;
+      }
+    }
+
+    aggregator_service_ = new amd::rdc::RdcAggregatorServiceImpl();
+    rdc_status_t status = aggregator_service_->Initialize(
+        cmd_line_->aggregate_hosts, cmd_line_->aggregate_fields,
+        cmd_line_->aggregate_interval_ms, credentials);
+    if (status != RDC_ST_OK) {
+      std::cerr << "Failed to start aggregator service" << std::endl;
+      return;
+    }
+    // The queries are served from memory, so it stays synchronous
+    builder.RegisterService(aggregator_service_);
+  }
+
+  // Register them either as synchronous services, or through the
+  // completion queues of the asynchronous server.
+  if (cmd_line_->async_server) {
+    async_server_.reset(new amd::rdc::RdcAsyncServer(rsmi_service_,
+                                        rdc_admin_service_, api_service_));
+    if (!async_server_->RegisterServices(&builder, cmd_line_->num_cqs)) {
+      std::cerr << "Failed to register the asynchronous services"
+                << std::endl;
+      return;
+    }
+  } else {
+    if (rdc_admin_service_) {
+      builder.RegisterService(rdc_admin_service_);
+    }
+    if (rsmi_service_) {
+      builder.RegisterService(rsmi_service_);
+    }
+    if (api_service_) {
+      builder.RegisterService(api_service_);
+    }
   }
 
+  // Every call is timed for the self-telemetry of RdcAdmin.
+  std::vector<std::unique_ptr<
+      ::grpc::experimental::ServerInterceptorFactoryInterface>> creators;
+  creators.emplace_back(
+      new amd::rdc::RdcRpcMetricsInterceptorFactory(&rpc_metrics_));
+  // Every API response tells the client the configuration generation, so
+  // clients can cache group and device metadata until it changes.
+  if (api_service_) {
+    creators.emplace_back(
+        new amd::rdc::RdcGenerationInterceptorFactory(api_service_));
+  }
+  builder.experimental().SetInterceptorCreators(std::move(creators));
+
   // Finally assemble the server.
   // std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
   server_ = builder.BuildAndStart();
+  if (!server_) {
+    std::cerr << "Failed to start the server on " << server_address_ <<
+                                                                    std::endl;
+    return;
+  }
+
+  if (async_server_) {
+    uint32_t threads = cmd_line_->cq_threads ? cmd_line_->cq_threads :
+                                                       kDefaultAsyncCQThreads;
+    async_server_->Start(threads);
+  }
+
+  // Node-local clients skip TLS through the Unix socket
+  if (cmd_line_->unix_socket != "none") {
+    std::string path = cmd_line_->unix_socket.empty() ?
+       DefaultUnixSocketPath(cmd_line_->listen_port) : cmd_line_->unix_socket;
+    int err = unix_listener_.Start(path, server_.get());
+    if (err) {
+      std::cerr << "Failed to listen on unix:" << path << ": " <<
+                                                   strerror(err) << std::endl;
+    } else {
+      std::cout << "Local clients are accepted on unix:" << path <<
+                                                                    std::endl;
+    }
+  }
 
   std::cout << "Server listening on " << server_address_.c_str() << std::endl;
   std::cout << "Accepting " <<
@@ -301,8 +513,15 @@ FileOwner(const char *fn, std::string *owner) {
 
 void
 RDCServer::ShutDown(void) {
+  unix_listener_.Stop();
   server_->Shutdown();
 
+  // Join the polling threads before the services they call are deleted
+  if (async_server_) {
+    async_server_->Shutdown();
+    async_server_.reset();
+  }
+
   if (rsmi_service_) {
     delete rsmi_service_;
     rsmi_service_ = nullptr;
@@ -318,6 +537,11 @@ RDCServer::ShutDown(void) {
     api_service_ = nullptr;
   }
 
+  if (aggregator_service_) {
+    delete aggregator_service_;
+    aggregator_service_ = nullptr;
+  }
+
 }
 
 static void * ProcessSignalLoop(void *server_ptr) {
@@ -327,9 +551,8 @@ static void * ProcessSignalLoop(void *server_ptr) {
   while (1) {
     if (sShutDownServer) {
       std::cout <<  "Shutting down RDC Server." << std::endl;
+      // This also drains the completion queues of the async server
       server->ShutDown();
-      // We will need to add shutdown of any completion queues
-      // here, when/if we add them
       break;
     } else if (sRestartServer) {
       std::cout <<  "Re-starting RDC Server." << std::endl;
@@ -382,11 +605,22 @@ static bool FileIsLocked(std::string fn) {
   return true;
 }
 
-static void ExitIfAlreadyRunning(bool is_root) {
+// There is one daemon per port, so that several rdcd can run side by side
+// on a node. The default port keeps the historical lock file names.
+static std::string LockFileName(const char *lock_file,
+                                                   const std::string &port) {
+  std::string name(lock_file);
+  if (port == kDefaultListenPort) {
+    return name;
+  }
+  return name.substr(0, name.rfind(".lock")) + "-" + port + ".lock";
+}
+
+static void ExitIfAlreadyRunning(bool is_root, const std::string &port) {
   const char *lock_fn;
   int lock_fh;
-  std::string lf_user(kDaemonLockFile);
-  std::string lf_root(kDaemonLockFileRoot);
+  std::string lf_user = LockFileName(kDaemonLockFile, port);
+  std::string lf_root = LockFileName(kDaemonLockFileRoot, port);
   ssize_t fsz;
 
   auto chk_if_locked = [&](std::string lock_file) {
@@ -403,9 +637,9 @@ static void ExitIfAlreadyRunning(bool is_root) {
   chk_if_locked(lf_user);
 
   if (is_root) {
-    lock_fn = kDaemonLockFileRoot;
+    lock_fn = lf_root.c_str();
   } else {
-    lock_fn = kDaemonLockFile;
+    lock_fn = lf_user.c_str();
   }
   // Temporarily adjust file-mask to create file with right permissions
   umask(023);
@@ -438,7 +672,7 @@ static void ExitIfAlreadyRunning(bool is_root) {
 }
 
 static void
-MakeDaemon(bool is_root) {
+MakeDaemon(bool is_root, const std::string &port) {
   int fd0;
   struct rlimit max_files;
 
@@ -497,7 +731,7 @@ MakeDaemon(bool is_root) {
       exit(1);
   }
 
-  ExitIfAlreadyRunning(is_root);
+  ExitIfAlreadyRunning(is_root, port);
 
   InitializeSignalHandling();
 }
@@ -508,16 +742,32 @@ MakeDaemon(bool is_root) {
 //  * no_argument
 static const struct option long_options[] = {
   {"port", required_argument, nullptr, 'p'},
+  {"capture", required_argument, nullptr, 'c'},
+  {"replay", required_argument, nullptr, 'r'},
+  {"replay_speed", required_argument, nullptr, 's'},
+  {"num_cqs", required_argument, nullptr, 'q'},
+  {"cq_threads", required_argument, nullptr, 't'},
+  {"max_threads", required_argument, nullptr, 'm'},
+  {"max_streams", required_argument, nullptr, 'x'},
+  {"unix_socket", required_argument, nullptr, 'U'},
+  {"aggregate", required_argument, nullptr, 'A'},
+  {"aggregate_fields", required_argument, nullptr, 'F'},
+  {"aggregate_interval", required_argument, nullptr, 'I'},
+  {"prometheus", required_argument, nullptr, 'P'},
+  {"prometheus_fields", required_argument, nullptr, 'E'},
+  {"export", required_argument, nullptr, 'X'},
   // Any options with optionals args would go here; e.g.,
   // {"start_rdcd", optional_argument, nullptr, 'd'},
   {"unauth_comm", no_argument, nullptr, 'u'},
   {"pinned_cert", no_argument, nullptr, 'i'},
+  {"async", no_argument, nullptr, 'a'},
+  {"shm", no_argument, nullptr, 'S'},
   {"debug", no_argument, nullptr, 'd'},
   {"help", no_argument, nullptr, 'h'},
 
   {nullptr, 0, nullptr, 0}
 };
-static const char* short_options = "p:uidh";
+static const char* short_options = "p:c:r:s:q:t:m:x:U:A:F:I:P:E:X:uiaSdh";
 
 static void PrintHelp(void) {
   std::cout <<
@@ -529,10 +779,98 @@ static void PrintHelp(void) {
                                                 "PKI authentication is used\n"
      "--pinned_cert, -i used \"pinned\" certificates instead of PKI "
                                 "authentication. This is for test purposes.\n"
+     "--capture, -c <file> record the fetched telemetry of every sweep "
+                                                         "into the file\n"
+     "--replay, -r <file> play back a capture file instead of reading "
+                                            "the captured fields from GPUs\n"
+     "--replay_speed, -s <speed> replay speed multiplier; default is 1\n"
+     "--unix_socket, -U <path> Unix socket for node-local clients, which "
+            "are authorized by their uid/gid instead of TLS; \"none\" to "
+            "disable. default is " RDC_UNIX_SOCKET_RUN_DIR "/rdcd-<port>.sock, "
+            "or " RDC_UNIX_SOCKET_TMP_DIR "/rdcd-<port>.sock if that "
+                                                 "directory is not writable\n"
+     "--shm, -S publish the latest value of every watched field to the "
+            "shared memory /dev/shm/rdcd-<port>, which local clients read "
+                                               "without calling rdcd\n"
+     "--prometheus, -P <[address:]port> serve the latest value of every "
+            "watched field at http://address:port/metrics in the Prometheus "
+                                    "text format; default is not to serve\n"
+     "--prometheus_fields, -E <field,...> the field names or ids served "
+            "to Prometheus; default is GPU_MEMORY_USAGE,GPU_MEMORY_TOTAL,"
+                              "POWER_USAGE,GPU_CLOCK,GPU_UTIL,GPU_TEMP\n"
+     "--export, -X <sink> push the value of every watched field, as it is "
+            "fetched, to influx-udp://host:port, influx-tcp://host:port, "
+            "statsd://host:port or textfile:///path; may be repeated\n"
+     "--async, -a serve the requests from completion queues on a fixed "
+                              "pool of threads instead of synchronously\n"
+     "--num_cqs, -q <n> number of completion queues; default is the gRPC "
+                                 "default, or 1 with --async\n"
+     "--cq_threads, -t <n> maximum polling threads per completion queue; "
+                       "default is the gRPC default, or 4 with --async\n"
+     "--max_threads, -m <n> resource quota on the threads gRPC may "
+                                            "create; default is no limit\n"
+     "--max_streams, -x <n> maximum concurrent streams per client "
+                                          "connection; default is no limit\n"
+     "--aggregate, -A <host:port,...> run as an aggregator of these rdcd "
+            "instead of reading local GPUs, and serve cluster queries from "
+                                      "their latest values; may be repeated\n"
+     "--aggregate_fields, -F <field,...> the field names or ids the "
+            "aggregator collects; default is GPU_TEMP,POWER_USAGE,GPU_UTIL,"
+                                                      "GPU_MEMORY_USAGE\n"
+     "--aggregate_interval, -I <ms> how often the aggregator polls the "
+                                              "rdcd; default is 1000 ms\n"
      "--debug, -d output debug messages\n"
      "--help, -h print this message\n";
 }
 
+// rdcd changes its working directory to / when daemonized
+static std::string AbsolutePath(const char *path) {
+  if (path[0] == '/') {
+    return path;
+  }
+  char cwd[PATH_MAX];
+  if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+    return path;
+  }
+  return std::string(cwd) + "/" + path;
+}
+
+// Split a comma separated option, skipping empty items
+static std::vector<std::string> SplitList(const char *list) {
+  std::vector<std::string> items;
+  std::string item;
+  for (const char *c = list; ; c++) {
+    if (*c == ',' || *c == '\0') {
+      if (!item.empty()) {
+        items.push_back(item);
+      }
+      item.clear();
+      if (*c == '\0') {
+        break;
+      }
+    } else {
+      item += *c;
+    }
+  }
+  return items;
+}
+
+// Parse a comma separated list of field names or ids
+static int ParseFieldList(const char *list, std::vector<rdc_field_t> *fields) {
+  fields->clear();
+  for (const std::string &name : SplitList(list)) {
+    rdc_field_t field = amd::rdc::IsNumber(name) ?
+      static_cast<rdc_field_t>(atoi(name.c_str())) :
+                                 get_field_id_from_name(name.c_str());
+    if (field == RDC_FI_INVALID) {
+      std::cerr << "\"" << name << "\" is not a valid field." << std::endl;
+      return -1;
+    }
+    fields->push_back(field);
+  }
+  return 0;
+}
+
 uint32_t ProcessCmdline(RdcdCmdLineOpts* cmdl_opts,
                                                int arg_cnt, char** arg_list) {
   int a;
@@ -557,6 +895,99 @@ uint32_t ProcessCmdline(RdcdCmdLineOpts* cmdl_opts,
         cmdl_opts->listen_port = optarg;
         break;
 
+      case 'c':
+        cmdl_opts->capture_file = AbsolutePath(optarg);
+        break;
+
+      case 'r':
+        cmdl_opts->replay_file = AbsolutePath(optarg);
+        break;
+
+      case 's':
+        if (atof(optarg) <= 0) {
+          std::cerr << "\"" << optarg <<
+                                "\" is not a valid replay speed." << std::endl;
+          return -1;
+        }
+        cmdl_opts->replay_speed = optarg;
+        break;
+
+      case 'q':
+      case 't':
+      case 'm':
+      case 'x': {
+        if (!amd::rdc::IsNumber(optarg) || atoi(optarg) <= 0) {
+          std::cerr << "\"" << optarg <<
+                        "\" is not a valid count for option -" <<
+                                      static_cast<char>(a) << "." << std::endl;
+          return -1;
+        }
+        uint32_t n = static_cast<uint32_t>(atoi(optarg));
+        if (a == 'q') {
+          cmdl_opts->num_cqs = n;
+        } else if (a == 't') {
+          cmdl_opts->cq_threads = n;
+        } else if (a == 'm') {
+          cmdl_opts->max_threads = n;
+        } else {
+          cmdl_opts->max_streams = n;
+        }
+        break;
+      }
+
+      case 'U':
+        cmdl_opts->unix_socket = optarg == std::string("none") ? optarg :
+                                                          AbsolutePath(optarg);
+        break;
+
+      case 'A':
+        for (const std::string &host : SplitList(optarg)) {
+          cmdl_opts->aggregate_hosts.push_back(host);
+        }
+        break;
+
+      case 'F':
+        if (ParseFieldList(optarg, &cmdl_opts->aggregate_fields)) {
+          return -1;
+        }
+        break;
+
+      case 'E':
+        if (ParseFieldList(optarg, &cmdl_opts->prometheus_fields)) {
+          return -1;
+        }
+        break;
+
+      case 'I':
+        if (!amd::rdc::IsNumber(optarg) || atoi(optarg) <= 0) {
+          std::cerr << "\"" << optarg <<
+                          "\" is not a valid polling interval." << std::endl;
+          return -1;
+        }
+        cmdl_opts->aggregate_interval_ms = static_cast<uint32_t>(atoi(optarg));
+        break;
+
+      case 'a':
+        cmdl_opts->async_server = true;
+        break;
+
+      case 'S':
+        cmdl_opts->publish_shm = true;
+        break;
+
+      case 'P':
+        cmdl_opts->prometheus_listen = optarg;
+        break;
+
+      case 'X':
+        if (strstr(optarg, "://") == nullptr) {
+          std::cerr << "\"" << optarg << "\" is not a valid export sink."
+                                                                << std::endl;
+          return -1;
+        }
+        cmdl_opts->export_sinks.push_back(optarg);
+        break;
+
       case 'u':
         cmdl_opts->no_authentication = true;
         break;
@@ -596,6 +1027,19 @@ static void init_cmd_line_opts(RdcdCmdLineOpts *opts) {
   opts->no_authentication = false;
   opts->use_pinned_certs = false;
   opts->log_dbg = false;
+  opts->async_server = false;
+  opts->publish_shm = false;
+  opts->num_cqs = 0;
+  opts->cq_threads = 0;
+  opts->max_threads = 0;
+  opts->max_streams = 0;
+  opts->aggregate_fields.assign(kDefaultAggregateFields,
+      kDefaultAggregateFields + sizeof(kDefaultAggregateFields) /
+                                          sizeof(kDefaultAggregateFields[0]));
+  opts->aggregate_interval_ms = kDefaultAggregateIntervalMs;
+  opts->prometheus_fields.assign(kDefaultPrometheusFields,
+      kDefaultPrometheusFields + sizeof(kDefaultPrometheusFields) /
+                                          sizeof(kDefaultPrometheusFields[0]));
 }
 
 int main(int argc, char** argv) {
@@ -630,7 +1074,7 @@ int main(int argc, char** argv) {
     }
   }
 
-  MakeDaemon(is_root);
+  MakeDaemon(is_root, cmd_line_opts.listen_port);
 
   rdc_server.Initialize(&cmd_line_opts);
 
@@ -691,9 +1135,11 @@ int main(int argc, char** argv) {
   }
 
   // TODO(cfreehil): Eventually, set these by reading a config file
-  rdc_server.set_start_rsmi_service(true);
+  // An aggregator does not need local GPUs
+  bool aggregator = !cmd_line_opts.aggregate_hosts.empty();
+  rdc_server.set_start_rsmi_service(!aggregator);
   rdc_server.set_start_rdc_admin_service(true);
-  rdc_server.set_start_api_service(true);
+  rdc_server.set_start_api_service(!aggregator);
 
   rdc_server.Run();
 
@@ -0,0 +1,184 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <errno.h>
+#include <grp.h>
+#include <pwd.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <grpcpp/server_posix.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "rdc/rdc_unix_listener.h"
+#include "rdc_lib/RdcThreads.h"
+
+namespace amd {
+namespace rdc {
+
+static const mode_t kUnixSocketMode = 0660;
+
+RdcUnixListener::RdcUnixListener() : listen_fd_(-1), server_(nullptr),
+    stopping_(false) {
+}
+
+RdcUnixListener::~RdcUnixListener() {
+  Stop();
+}
+
+int
+RdcUnixListener::Start(const std::string& path, ::grpc::Server* server) {
+  struct sockaddr_un addr;
+
+  if (server == nullptr || path.size() >= sizeof(addr.sun_path)) {
+    return EINVAL;
+  }
+
+  // A socket left behind by an rdcd that did not exit cleanly. The lock
+  // file ensures no other rdcd is running.
+  struct stat st;
+  if (lstat(path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      return EEXIST;
+    }
+    if (unlink(path.c_str()) != 0) {
+      return errno;
+    }
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return errno;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0
+      || chmod(path.c_str(), kUnixSocketMode) != 0
+      || listen(fd, SOMAXCONN) != 0) {
+    int err = errno;
+    close(fd);
+    unlink(path.c_str());
+    return err;
+  }
+
+  path_ = path;
+  listen_fd_ = fd;
+  server_ = server;
+  stopping_ = false;
+  accept_thread_ = std::thread(&RdcUnixListener::AcceptLoop, this);
+  return 0;
+}
+
+void
+RdcUnixListener::Stop() {
+  if (listen_fd_ < 0) {
+    return;
+  }
+
+  // shutdown() wakes up the blocked accept()
+  stopping_ = true;
+  shutdown(listen_fd_, SHUT_RDWR);
+  if (accept_thread_.joinable()) {
+    accept_thread_.join();
+  }
+  close(listen_fd_);
+  listen_fd_ = -1;
+  unlink(path_.c_str());
+}
+
+void
+RdcUnixListener::AcceptLoop() {
+  RdcThreads::get().setup(RDC_THREAD_RPC, "rdc-unix");
+  while (!stopping_) {
+    int fd = accept4(listen_fd_, nullptr, nullptr,
+                                             SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0) {
+      if (stopping_) {
+        break;
+      }
+      if (errno == EMFILE || errno == ENFILE) {
+        // Give the existing connections a chance to close
+        usleep(100000);
+      }
+      continue;
+    }
+
+    if (!PeerAllowed(fd)) {
+      close(fd);
+      continue;
+    }
+
+    // The server owns the connection from now on
+    ::grpc::AddInsecureChannelFromFd(server_, fd);
+  }
+}
+
+bool
+RdcUnixListener::PeerAllowed(int fd) const {
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+    std::cerr << "Failed to get the credentials of a local client: " <<
+                                                   strerror(errno) << std::endl;
+    return false;
+  }
+
+  if (cred.uid == 0 || cred.uid == geteuid() || cred.gid == getegid()) {
+    return true;
+  }
+
+  // Supplementary members of the rdcd group may connect as well
+  struct passwd pw;
+  struct passwd *result = nullptr;
+  std::vector<char> buf(16384);
+  if (getpwuid_r(cred.uid, &pw, buf.data(), buf.size(), &result) == 0 &&
+                                                          result != nullptr) {
+    int ngroups = 64;
+    std::vector<gid_t> groups(ngroups);
+    if (getgrouplist(pw.pw_name, pw.pw_gid, groups.data(), &ngroups) < 0) {
+      groups.resize(ngroups);
+      getgrouplist(pw.pw_name, pw.pw_gid, groups.data(), &ngroups);
+    }
+    for (int i = 0; i < ngroups && i < static_cast<int>(groups.size());
+                                                                        i++) {
+      if (groups[i] == getegid()) {
+        return true;
+      }
+    }
+  }
+
+  std::cerr << "Rejected local client pid " << cred.pid << " uid " <<
+                                                         cred.uid << std::endl;
+  return false;
+}
+
+}  // namespace rdc
+}  // namespace amd
@@ -0,0 +1,536 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Checks the sinks of the export pipeline against local listeners. Batches
+// of values, as the watch table hands them to the pipeline from
+// handle_fields(), are pushed to an InfluxDB sink over UDP and over TCP, a
+// StatsD sink and a textfile sink:
+//   - the listeners must receive the exact lines of the values exported,
+//     and none of the failed or string values
+//   - a reader of the textfile must only ever see complete files, each
+//     batch replacing the file by a rename
+// Then an InfluxDB TCP listener stops reading: the pushes must not wait
+// for it, and the values the full queue had no room for must be counted
+// as dropped.
+//
+// Usage: rdc_export_sink_test [-t seconds]
+//   -t  time the values are pushed to the stalled listener, 4 seconds by
+//       default so that the buffers of the connection fill up
+// Exits with 1 if any check fails.
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcTelemetry.h"
+#include "rdc_lib/impl/RdcExportPipeline.h"
+
+namespace {
+
+using amd::rdc::RdcExportPipeline;
+using amd::rdc::rdc_export_sink_create;
+using amd::rdc::rdc_gpu_field_value_t;
+
+// Enough GPUs for a batch to take several datagrams
+const uint32_t kNumGpus = 16;
+const uint32_t kNumBatches = 3;
+const uint32_t kIntervalMs = 50;
+// Lines of the exported values: one per GPU for GPU_TEMP and GPU_UTIL
+const size_t kNumLines = kNumBatches * kNumGpus * 2;
+// The sinks send a batch within a second of the flush, so a listener
+// waits longer than that for its lines
+const uint64_t kReceiveTimeoutMs = 3000;
+// A push only adds to the queue. Far below the send timeout of the sinks,
+// but above what the scheduler may delay a single CPU machine by.
+const uint64_t kMaxPushMs = 100;
+// The datagrams stay under the usual MTU
+const size_t kMaxDatagramSize = 1400;
+
+uint64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string host_name() {
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "localhost";
+    }
+    return name;
+}
+
+// A socket bound to an ephemeral port of the loopback
+int listen_local(int type, int rcvbuf, uint16_t* port) {
+    int fd = socket(AF_INET, type | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    struct timeval tv = {0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), len) != 0 ||
+            (type == SOCK_STREAM && listen(fd, 4) != 0) ||
+            getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                        &len) != 0) {
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+void split_lines(const std::string& text, std::vector<std::string>* lines) {
+    size_t start = 0;
+    size_t end;
+    while ((end = text.find('\n', start)) != std::string::npos) {
+        lines->push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+// The lines of the datagrams received until there are num_lines of them,
+// and the size of the largest datagram
+std::vector<std::string> receive_datagrams(int fd, size_t num_lines,
+                                           size_t* max_datagram) {
+    std::vector<std::string> lines;
+    std::vector<char> datagram(65536);
+    uint64_t deadline = now_ms() + kReceiveTimeoutMs;
+    while (lines.size() < num_lines && now_ms() < deadline) {
+        ssize_t n = recv(fd, datagram.data(), datagram.size(), 0);
+        if (n <= 0) {
+            continue;
+        }
+        *max_datagram = std::max(*max_datagram, static_cast<size_t>(n));
+        split_lines(std::string(datagram.data(), n), &lines);
+    }
+    return lines;
+}
+
+// The lines received on the first connection until there are num_lines
+std::vector<std::string> receive_stream(int listen_fd, size_t num_lines) {
+    std::vector<std::string> lines;
+    uint64_t deadline = now_ms() + kReceiveTimeoutMs;
+    int fd = -1;
+    while (fd < 0 && now_ms() < deadline) {
+        fd = accept(listen_fd, nullptr, nullptr);
+    }
+    if (fd < 0) {
+        return lines;
+    }
+    struct timeval tv = {0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::string text;
+    char buffer[4096];
+    while (std::count(text.begin(), text.end(), '\n') <
+            static_cast<ssize_t>(num_lines) && now_ms() < deadline) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            text.append(buffer, n);
+        }
+    }
+    close(fd);
+    split_lines(text, &lines);
+    return lines;
+}
+
+// What the watch table does with the values of a sweep
+void handle_fields(RdcExportPipeline* pipeline,
+                   const std::vector<rdc_gpu_field_value_t>& values) {
+    for (auto& v : values) {
+        pipeline->push(v.gpu_index, v.field_value);
+    }
+}
+
+rdc_gpu_field_value_t make_value(uint32_t gpu_index, rdc_field_t field_id,
+                                 rdc_field_type_t type, uint64_t ts) {
+    rdc_gpu_field_value_t v;
+    memset(&v, 0, sizeof(v));
+    v.gpu_index = gpu_index;
+    v.field_value.field_id = field_id;
+    v.field_value.status = RDC_ST_OK;
+    v.field_value.type = type;
+    v.field_value.ts = ts;
+    return v;
+}
+
+int64_t temp_of(uint32_t batch, uint32_t gpu) {
+    return 40000 + batch * 1000 + gpu;
+}
+
+double util_of(uint32_t batch, uint32_t gpu) {
+    return gpu + batch + 0.25;
+}
+
+// A sweep of the GPUs: their temperature and busy percentage, plus a
+// failed fetch and a string, which are not exported
+std::vector<rdc_gpu_field_value_t> make_batch(uint32_t batch, uint64_t ts) {
+    std::vector<rdc_gpu_field_value_t> values;
+    for (uint32_t g = 0; g < kNumGpus; g++) {
+        rdc_gpu_field_value_t temp = make_value(g, RDC_FI_GPU_TEMP, INTEGER,
+                                                ts);
+        temp.field_value.value.l_int = temp_of(batch, g);
+        values.push_back(temp);
+        rdc_gpu_field_value_t util = make_value(g, RDC_FI_GPU_UTIL, DOUBLE,
+                                                ts);
+        util.field_value.value.dbl = util_of(batch, g);
+        values.push_back(util);
+        rdc_gpu_field_value_t failed = make_value(g, RDC_FI_POWER_USAGE,
+                                                  INTEGER, ts);
+        failed.field_value.status = RDC_ST_TIMEOUT;
+        values.push_back(failed);
+        rdc_gpu_field_value_t name = make_value(g, RDC_FI_DEV_NAME, STRING,
+                                                ts);
+        snprintf(name.field_value.value.str, RDC_MAX_STR_LENGTH, "gpu%u", g);
+        values.push_back(name);
+    }
+    return values;
+}
+
+std::string format_double(double value) {
+    char number[32];
+    snprintf(number, sizeof(number), "%.17g", value);
+    return number;
+}
+
+std::vector<std::string> expected_influx(const std::string& host,
+                                         uint64_t base_ts) {
+    std::vector<std::string> lines;
+    for (uint32_t b = 0; b < kNumBatches; b++) {
+        std::string ns = std::to_string((base_ts + b * 1000) * 1000000);
+        for (uint32_t g = 0; g < kNumGpus; g++) {
+            std::string tags = ",host=" + host + ",gpu_index=" +
+                    std::to_string(g);
+            lines.push_back("gpu_temp" + tags + " value=" +
+                    std::to_string(temp_of(b, g)) + "i " + ns);
+            lines.push_back("gpu_util" + tags + " value=" +
+                    format_double(util_of(b, g)) + " " + ns);
+        }
+    }
+    return lines;
+}
+
+std::vector<std::string> expected_statsd(std::string host) {
+    std::replace(host.begin(), host.end(), '.', '_');
+    std::vector<std::string> lines;
+    for (uint32_t b = 0; b < kNumBatches; b++) {
+        for (uint32_t g = 0; g < kNumGpus; g++) {
+            std::string prefix = "rdc." + host + ".gpu" + std::to_string(g);
+            lines.push_back(prefix + ".gpu_temp:" +
+                    std::to_string(temp_of(b, g)) + "|g");
+            lines.push_back(prefix + ".gpu_util:" +
+                    format_double(util_of(b, g)) + "|g");
+        }
+    }
+    return lines;
+}
+
+// The file of the last batch, the families in field id order
+std::string expected_textfile() {
+    std::string temp = "# HELP gpu_temp GPU temperature in millidegrees "
+            "Celsius\n# TYPE gpu_temp gauge\n";
+    std::string util = "# HELP gpu_util GPU busy percentage\n"
+            "# TYPE gpu_util gauge\n";
+    for (uint32_t g = 0; g < kNumGpus; g++) {
+        std::string label = "{gpu_index=\"" + std::to_string(g) + "\"} ";
+        temp += "gpu_temp" + label +
+                std::to_string(temp_of(kNumBatches - 1, g)) + "\n";
+        util += "gpu_util" + label +
+                format_double(util_of(kNumBatches - 1, g)) + "\n";
+    }
+    return (RDC_FI_GPU_TEMP < RDC_FI_GPU_UTIL ? temp + util : util + temp) +
+            "# EOF\n";
+}
+
+bool same_lines(const char* sink, std::vector<std::string> received,
+                std::vector<std::string> expected) {
+    std::sort(received.begin(), received.end());
+    std::sort(expected.begin(), expected.end());
+    if (received == expected) {
+        return true;
+    }
+    fprintf(stderr, "FAIL: %s received %zu lines, expected %zu\n", sink,
+            received.size(), expected.size());
+    for (auto& line : received) {
+        if (!std::binary_search(expected.begin(), expected.end(), line)) {
+            fprintf(stderr, "  unexpected: %s\n", line.c_str());
+        }
+    }
+    for (auto& line : expected) {
+        if (!std::binary_search(received.begin(), received.end(), line)) {
+            fprintf(stderr, "  missing: %s\n", line.c_str());
+        }
+    }
+    return false;
+}
+
+bool read_file(const std::string& path, std::string* text) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        return false;
+    }
+    text->clear();
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text->append(buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+// Pushes the batches to the four sinks and checks what they wrote
+bool sinks_write_the_values(const std::string& dir) {
+    uint16_t udp_port, tcp_port, statsd_port;
+    int udp_fd = listen_local(SOCK_DGRAM, 0, &udp_port);
+    int tcp_fd = listen_local(SOCK_STREAM, 0, &tcp_port);
+    int statsd_fd = listen_local(SOCK_DGRAM, 0, &statsd_port);
+    if (udp_fd < 0 || tcp_fd < 0 || statsd_fd < 0) {
+        fprintf(stderr, "FAIL: cannot listen on the loopback\n");
+        return false;
+    }
+    std::string textfile = dir + "/rdc.prom";
+
+    RdcExportPipeline pipeline(1024, kIntervalMs);
+    pipeline.add_sink(rdc_export_sink_create(
+            "influx-udp://127.0.0.1:" + std::to_string(udp_port)));
+    pipeline.add_sink(rdc_export_sink_create(
+            "influx-tcp://127.0.0.1:" + std::to_string(tcp_port)));
+    pipeline.add_sink(rdc_export_sink_create(
+            "statsd://127.0.0.1:" + std::to_string(statsd_port)));
+    pipeline.add_sink(rdc_export_sink_create("textfile://" + textfile));
+    pipeline.start();
+
+    // Reads the textfile while the batches replace it
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> num_reads(0);
+    std::atomic<uint64_t> num_partial(0);
+    std::atomic<uint64_t> num_versions(0);
+    std::thread reader([&]() {
+        std::string text;
+        std::string last;
+        while (!stop) {
+            if (read_file(textfile, &text)) {
+                num_reads++;
+                if (text != last) {
+                    num_versions++;
+                    last = text;
+                }
+                if (text.compare(0, 7, "# HELP ") != 0 || text.size() < 6 ||
+                        text.compare(text.size() - 6, 6, "# EOF\n") != 0) {
+                    num_partial++;
+                }
+            }
+        }
+    });
+
+    std::vector<std::string> tcp_lines;
+    std::thread tcp_receiver([&]() {
+        tcp_lines = receive_stream(tcp_fd, kNumLines);
+    });
+
+    // Each batch in its own flush
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    uint64_t base_ts = static_cast<uint64_t>(tv.tv_sec) * 1000 +
+            tv.tv_usec / 1000;
+    for (uint32_t b = 0; b < kNumBatches; b++) {
+        handle_fields(&pipeline, make_batch(b, base_ts + b * 1000));
+        usleep(3 * kIntervalMs * 1000);
+    }
+
+    size_t max_datagram = 0;
+    std::vector<std::string> udp_lines = receive_datagrams(udp_fd, kNumLines,
+                                                           &max_datagram);
+    std::vector<std::string> statsd_lines = receive_datagrams(statsd_fd,
+            kNumLines, &max_datagram);
+    tcp_receiver.join();
+    usleep(3 * kIntervalMs * 1000);
+    stop = true;
+    reader.join();
+
+    std::string host = host_name();
+    bool passed = same_lines("influx-udp", udp_lines,
+                             expected_influx(host, base_ts));
+    passed = same_lines("influx-tcp", tcp_lines,
+                        expected_influx(host, base_ts)) && passed;
+    passed = same_lines("statsd", statsd_lines, expected_statsd(host)) &&
+            passed;
+
+    std::string text;
+    read_file(textfile, &text);
+    if (text != expected_textfile()) {
+        fprintf(stderr, "FAIL: the textfile holds\n%s", text.c_str());
+        passed = false;
+    }
+    if (access((textfile + ".tmp").c_str(), F_OK) == 0) {
+        fprintf(stderr, "FAIL: the temporary textfile was left\n");
+        passed = false;
+    }
+    if (num_partial != 0 || num_versions < kNumBatches) {
+        fprintf(stderr, "FAIL: %lu of %lu reads saw a partial textfile, "
+                "and %lu versions of it\n",
+                static_cast<unsigned long>(num_partial),  // NOLINT
+                static_cast<unsigned long>(num_reads),  // NOLINT
+                static_cast<unsigned long>(num_versions));  // NOLINT
+        passed = false;
+    }
+    if (max_datagram > kMaxDatagramSize) {
+        fprintf(stderr, "FAIL: a datagram of %zu bytes was sent\n",
+                max_datagram);
+        passed = false;
+    }
+
+    printf("sinks exported=%lu failed=%lu dropped=%lu max_datagram=%zu "
+           "textfile_reads=%lu textfile_versions=%lu\n",
+           static_cast<unsigned long>(pipeline.num_exported()),  // NOLINT
+           static_cast<unsigned long>(pipeline.num_failed()),  // NOLINT
+           static_cast<unsigned long>(pipeline.num_dropped()),  // NOLINT
+           max_datagram, static_cast<unsigned long>(num_reads),  // NOLINT
+           static_cast<unsigned long>(num_versions));  // NOLINT
+    // Every sink gets every value once
+    if (pipeline.num_exported() != 4 * kNumLines ||
+            pipeline.num_failed() != 0 || pipeline.num_dropped() != 0) {
+        fprintf(stderr, "FAIL: the pipeline counters are wrong\n");
+        passed = false;
+    }
+    unlink(textfile.c_str());
+    close(udp_fd);
+    close(tcp_fd);
+    close(statsd_fd);
+    return passed;
+}
+
+// Pushes sweeps to a TCP listener which never reads, and checks that the
+// pushes do not wait for it and that the full queue drops values
+bool stalled_sink_drops(uint64_t duration_ms) {
+    uint16_t port;
+    int fd = listen_local(SOCK_STREAM, 4096, &port);
+    if (fd < 0) {
+        fprintf(stderr, "FAIL: cannot listen on the loopback\n");
+        return false;
+    }
+
+    // The connection is queued but never accepted, so its buffers fill up
+    // and the sink blocks in send() until its timeout
+    RdcExportPipeline pipeline(4096, 10);
+    pipeline.add_sink(rdc_export_sink_create(
+            "influx-tcp://127.0.0.1:" + std::to_string(port)));
+    pipeline.start();
+
+    // 32 GPUs every millisecond
+    std::vector<rdc_gpu_field_value_t> sweep;
+    for (uint32_t g = 0; g < 32; g++) {
+        for (uint32_t b = 0; b < 2; b++) {
+            sweep.push_back(make_value(g, RDC_FI_GPU_TEMP, INTEGER, 0));
+            sweep.back().field_value.value.l_int = temp_of(b, g);
+        }
+    }
+    uint64_t pushed = 0;
+    uint64_t max_push_ms = 0;
+    uint64_t deadline = now_ms() + duration_ms;
+    while (now_ms() < deadline) {
+        uint64_t start = now_ms();
+        handle_fields(&pipeline, sweep);
+        max_push_ms = std::max(max_push_ms, now_ms() - start);
+        pushed += sweep.size();
+        usleep(1000);
+    }
+
+    uint64_t queued = pipeline.num_queued();
+    uint64_t dropped = pipeline.num_dropped();
+    printf("stalled pushed=%lu queued=%lu dropped=%lu failed=%lu "
+           "max_push_ms=%lu\n",
+           static_cast<unsigned long>(pushed),  // NOLINT
+           static_cast<unsigned long>(queued),  // NOLINT
+           static_cast<unsigned long>(dropped),  // NOLINT
+           static_cast<unsigned long>(pipeline.num_failed()),  // NOLINT
+           static_cast<unsigned long>(max_push_ms));  // NOLINT
+    close(fd);
+
+    bool passed = true;
+    if (dropped == 0 || queued + dropped != pushed) {
+        fprintf(stderr, "FAIL: the stalled sink did not make the queue "
+                "drop values\n");
+        passed = false;
+    }
+    if (max_push_ms > kMaxPushMs) {
+        fprintf(stderr, "FAIL: a sweep waited %lu ms for the stalled sink\n",
+                static_cast<unsigned long>(max_push_ms));  // NOLINT
+        passed = false;
+    }
+    return passed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double seconds = 4;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:h")) != -1) {
+        switch (opt) {
+            case 't':
+                seconds = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-t seconds]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (seconds <= 0) {
+        fprintf(stderr, "Invalid duration\n");
+        return 1;
+    }
+
+    char dir[] = "/tmp/rdc_export_sink_test.XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    bool passed = sinks_write_the_values(dir);
+    rmdir(dir);
+    passed = stalled_sink_drops(static_cast<uint64_t>(seconds * 1000)) &&
+            passed;
+    if (!passed) {
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
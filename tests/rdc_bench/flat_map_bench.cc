@@ -0,0 +1,124 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Measures the per-sweep lookup cost of the RdcFieldKey indexed tables.
+// Every collection sweep of the watch table looks up each watched
+// (gpu, field) pair in fields_to_watch_ and then in the cache samples,
+// this replays that access pattern against std::map and RdcFlatMap.
+//
+// Usage: rdc_flat_map_bench [iterations]
+// Output is one "key=value" line per configuration.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>  // NOLINT
+#include <map>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcFlatMap.h"
+
+namespace {
+
+typedef std::pair<uint32_t, rdc_field_t> FieldKey;
+
+// Typical field group of a monitoring agent, plus some XGMI events
+const uint32_t kFieldsPerGpu = 20;
+const rdc_field_t kFields[kFieldsPerGpu] = {
+    RDC_FI_GPU_COUNT, RDC_FI_DEV_NAME, RDC_FI_GPU_CLOCK, RDC_FI_MEM_CLOCK,
+    RDC_FI_MEMORY_TEMP, RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE,
+    RDC_FI_PCIE_TX, RDC_FI_PCIE_RX, RDC_FI_GPU_UTIL,
+    RDC_FI_GPU_MEMORY_USAGE, RDC_FI_GPU_MEMORY_TOTAL,
+    RDC_FI_ECC_CORRECT_TOTAL, RDC_FI_ECC_UNCORRECT_TOTAL,
+    RDC_EVNT_XGMI_0_NOP_TX, RDC_EVNT_XGMI_0_REQ_TX, RDC_EVNT_XGMI_0_RESP_TX,
+    RDC_EVNT_XGMI_0_BEATS_TX, RDC_EVNT_XGMI_1_NOP_TX,
+    RDC_EVNT_XGMI_1_BEATS_TX};
+
+template <typename WatchMap, typename CacheMap>
+double run_sweeps(uint32_t num_gpus, uint32_t iterations) {
+    WatchMap watch;
+    CacheMap cache;
+    std::vector<FieldKey> keys;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        for (uint32_t f = 0; f < kFieldsPerGpu; f++) {
+            FieldKey key(g, kFields[f]);
+            keys.push_back(key);
+            watch[key] = 1000000;
+            cache[key] = 0;
+        }
+    }
+
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (const auto& key : keys) {
+            auto w = watch.find(key);
+            if (w == watch.end()) continue;
+            auto c = cache.find(key);
+            if (c == cache.end()) continue;
+            c->second += w->second;
+            sink += c->second;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Keep the loop from being optimized away
+    if (sink == 1) printf("\n");
+
+    double total_ns = std::chrono::duration<double, std::nano>(
+        end - start).count();
+    return total_ns / iterations;
+}
+
+void report(const char* map_name, uint32_t num_gpus, double ns_per_sweep) {
+    uint32_t lookups = num_gpus * kFieldsPerGpu * 2;
+    printf("map=%s gpus=%u lookups_per_sweep=%u ns_per_sweep=%.0f "
+           "ns_per_lookup=%.2f\n", map_name, num_gpus, lookups,
+           ns_per_sweep, ns_per_sweep / lookups);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 20000;
+    if (argc > 1) {
+        iterations = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+        if (iterations == 0) {
+            fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const uint32_t gpu_counts[] = {16, 256};
+    for (uint32_t num_gpus : gpu_counts) {
+        double ns = run_sweeps<std::map<FieldKey, uint64_t>,
+                std::map<FieldKey, uint64_t>>(num_gpus, iterations);
+        report("std_map", num_gpus, ns);
+
+        ns = run_sweeps<amd::rdc::RdcFlatMap<FieldKey, uint64_t>,
+                amd::rdc::RdcFlatMap<FieldKey, uint64_t>>(num_gpus,
+                iterations);
+        report("flat_map", num_gpus, ns);
+    }
+
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Checks the GPU watchdog of rdcd against a GPU which hangs. rdcd is
+// started with the fake rocm_smi library of -DBUILD_RSMI_FAKE=ON and a
+// "latency all:<gpu>" rule making every call to the hung GPU take 3
+// seconds, and with RDC_GPU_TIMEOUT_MS set so the watchdog is on. The
+// power of all the GPUs is watched; the test fails unless the other GPUs
+// keep the update period and the latest value of the hung GPU reports
+// RDC_ST_TIMEOUT.
+//
+// Usage: rdc_gpu_timeout_test -e rdcd [-L rsmi_fake_dir] [-p port]
+//                             [-g hung_gpu] [-t timeout_ms] [-d seconds]
+// Output is one "key=value" line per GPU, and one line with the result.
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace {
+
+const uint32_t kNumGpus = 4;
+const uint32_t kHangUs = 3000000;
+const uint64_t kUpdateUs = 100000;
+
+// A GPU keeps its period if half its samples are at most this late, and
+// none waited for a call to the hung GPU
+const uint64_t kMaxMedianGapMs = 150;
+const uint64_t kMaxGapMs = kHangUs / 1000 / 2;
+
+pid_t start_rdcd(const char* rdcd, const std::string& port,
+                 const char* rsmi_fake_dir, const std::string& config,
+                 uint32_t timeout_ms) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (rsmi_fake_dir != nullptr && rsmi_fake_dir[0] != '\0') {
+            std::string path = rsmi_fake_dir;
+            const char* old_path = getenv("LD_LIBRARY_PATH");
+            if (old_path != nullptr && old_path[0] != '\0') {
+                path = path + ":" + old_path;
+            }
+            setenv("LD_LIBRARY_PATH", path.c_str(), 1);
+        }
+        setenv("RSMI_FAKE_NUM_DEVICES", std::to_string(kNumGpus).c_str(), 1);
+        setenv("RSMI_FAKE_CONFIG", config.c_str(), 1);
+        setenv("RDC_GPU_TIMEOUT_MS", std::to_string(timeout_ms).c_str(), 1);
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        execl(rdcd, rdcd, "-u", "-p", port.c_str(), "-U", "none",
+              static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+// rdcd may be stuck in a call to the hung GPU for a while
+void stop_rdcd(pid_t pid) {
+    kill(pid, SIGTERM);
+    for (int retry = 0; retry < 100; retry++) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            return;
+        }
+        usleep(100000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+// The gaps in milliseconds between the samples kept for the GPU
+std::vector<uint64_t> sample_gaps(rdc_handle_t handle, uint32_t gpu) {
+    std::vector<uint64_t> timestamps;
+    uint64_t since = 0;
+    uint64_t next = 0;
+    rdc_field_value value;
+    while (rdc_field_get_value_since(handle, gpu, RDC_FI_POWER_USAGE, since,
+                                     &next, &value) == RDC_ST_OK) {
+        timestamps.push_back(value.ts);
+        if (next <= since) {
+            break;
+        }
+        since = next;
+    }
+    std::vector<uint64_t> gaps;
+    for (size_t i = 1; i < timestamps.size(); i++) {
+        gaps.push_back(timestamps[i] - timestamps[i - 1]);
+    }
+    std::sort(gaps.begin(), gaps.end());
+    return gaps;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* rdcd = nullptr;
+#ifdef RDC_BENCH_RSMI_FAKE_DIR
+    const char* rsmi_fake_dir = RDC_BENCH_RSMI_FAKE_DIR;
+#else
+    const char* rsmi_fake_dir = nullptr;
+#endif
+    std::string port = "50071";
+    uint32_t hung_gpu = 2;
+    uint32_t timeout_ms = 500;
+    uint32_t seconds = 6;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:L:p:g:t:d:h")) != -1) {
+        switch (opt) {
+            case 'e':
+                rdcd = optarg;
+                break;
+            case 'L':
+                rsmi_fake_dir = optarg;
+                break;
+            case 'p':
+                port = optarg;
+                break;
+            case 'g':
+                hung_gpu = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 't':
+                timeout_ms = static_cast<uint32_t>(
+                    strtoul(optarg, nullptr, 10));
+                break;
+            case 'd':
+                seconds = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            default:
+                fprintf(stderr, "Usage: %s -e rdcd [-L rsmi_fake_dir] "
+                        "[-p port] [-g hung_gpu] [-t timeout_ms] "
+                        "[-d seconds]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (rdcd == nullptr || hung_gpu >= kNumGpus || timeout_ms == 0 ||
+        seconds == 0) {
+        fprintf(stderr, "Missing rdcd, or invalid GPU, timeout or "
+                "duration\n");
+        return 1;
+    }
+
+    char config[] = "/tmp/rdc_gpu_timeout_XXXXXX";
+    int fd = mkstemp(config);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    std::string rule = "latency all:" + std::to_string(hung_gpu) + " " +
+                       std::to_string(kHangUs) + "\n";
+    bool written = write(fd, rule.c_str(), rule.size()) ==
+                   static_cast<ssize_t>(rule.size());
+    close(fd);
+    if (!written) {
+        unlink(config);
+        return 1;
+    }
+
+    setenv("RDC_UNIX_SOCKET", "none", 1);
+    setenv("RDC_SHM_NAME", "none", 1);
+    pid_t pid = start_rdcd(rdcd, port, rsmi_fake_dir, config, timeout_ms);
+    std::string server = "localhost:" + port;
+
+    rdc_init(0);
+    rdc_handle_t handle = nullptr;
+    rdc_gpu_group_t group_id = 0;
+    rdc_field_grp_t field_group_id = 0;
+    rdc_status_t result = rdc_connect(server.c_str(), &handle, nullptr,
+                                      nullptr, nullptr);
+    for (int retry = 0; result == RDC_ST_OK && retry < 100; retry++) {
+        result = rdc_group_gpu_create(handle, RDC_GROUP_DEFAULT,
+                                      "rdc_gpu_timeout_test", &group_id);
+        if (result != RDC_ST_CLIENT_ERROR) {
+            break;
+        }
+        result = RDC_ST_OK;
+        usleep(100000);
+    }
+    rdc_field_t fields[] = {RDC_FI_POWER_USAGE};
+    if (result == RDC_ST_OK) {
+        result = rdc_group_field_create(handle, 1, fields,
+                                        "rdc_gpu_timeout_test",
+                                        &field_group_id);
+    }
+    if (result == RDC_ST_OK) {
+        result = rdc_field_watch(handle, group_id, field_group_id,
+                                 kUpdateUs, seconds + 10, 1000);
+    }
+
+    int ret = 0;
+    if (result != RDC_ST_OK) {
+        fprintf(stderr, "Failed to watch rdcd at %s: %s\n", server.c_str(),
+                rdc_status_string(result));
+        ret = 1;
+    } else {
+        sleep(seconds);
+        for (uint32_t gpu = 0; gpu < kNumGpus; gpu++) {
+            std::vector<uint64_t> gaps = sample_gaps(handle, gpu);
+            rdc_field_value latest;
+            rdc_status_t status = rdc_field_get_latest_value(
+                handle, gpu, RDC_FI_POWER_USAGE, &latest);
+            rdc_status_t value_status = status;
+            if (status == RDC_ST_OK) {
+                value_status = static_cast<rdc_status_t>(latest.status);
+            }
+            uint64_t median = gaps.empty() ? 0 : gaps[gaps.size() / 2];
+            uint64_t max = gaps.empty() ? 0 : gaps.back();
+            printf("gpu=%u hung=%d samples=%zu gap_p50_ms=%lu "
+                   "gap_max_ms=%lu latest_status=%s\n", gpu,
+                   gpu == hung_gpu, gaps.empty() ? 0 : gaps.size() + 1,
+                   static_cast<unsigned long>(median),
+                   static_cast<unsigned long>(max),
+                   rdc_status_string(value_status));
+            if (gpu == hung_gpu) {
+                if (value_status != RDC_ST_TIMEOUT) {
+                    ret = 1;
+                }
+            } else if (gaps.empty() || median > kMaxMedianGapMs ||
+                       max > kMaxGapMs || value_status != RDC_ST_OK) {
+                ret = 1;
+            }
+        }
+        rdc_field_unwatch(handle, group_id, field_group_id);
+    }
+    if (handle != nullptr) {
+        rdc_disconnect(handle);
+    }
+    rdc_shutdown();
+
+    stop_rdcd(pid);
+    unlink(config);
+    printf("result=%s\n", ret == 0 ? "pass" : "fail");
+    return ret;
+}
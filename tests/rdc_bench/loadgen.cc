@@ -0,0 +1,536 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// End-to-end load on rdcd from many concurrent clients. Each client has
+// its own connection and runs a weighted mix of operations:
+//   latest   poll the latest value of a watched field
+//   history  read the samples of a watched field since its last read
+//   watch    watch then unwatch a field group on its own GPU group
+//   job      start, get, stop and remove a job on its own GPU group
+// With -e, the load generator starts rdcd itself, with the fake rocm_smi
+// library of -DBUILD_RSMI_FAKE=ON as its telemetry source so no GPU is
+// needed. Connections go through TCP and latest values are read from
+// rdcd rather than from its shared memory.
+//
+// Usage: rdc_loadgen [-s host:port] [-e rdcd [-L rsmi_fake_dir]]
+//                    [-d seconds] [-c clients,...] [-m op=weight,...]
+// Output is one "key=value" line per RPC and concurrency level, and one
+// line with rpc=all for the level.
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace {
+
+const rdc_field_t kFields[] = {RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE,
+                               RDC_FI_GPU_UTIL, RDC_FI_GPU_MEMORY_USAGE};
+const uint32_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+
+enum Op { OP_LATEST, OP_HISTORY, OP_WATCH, OP_JOB, OP_COUNT };
+const char* kOpNames[OP_COUNT] = {"latest", "history", "watch", "job"};
+
+enum Rpc {
+    RPC_GET_LATEST, RPC_GET_SINCE, RPC_WATCH, RPC_UNWATCH,
+    RPC_JOB_START, RPC_JOB_GET, RPC_JOB_STOP, RPC_JOB_REMOVE, RPC_COUNT
+};
+const char* kRpcNames[RPC_COUNT] = {
+    "GetLatestFieldValue", "GetFieldSince", "WatchFields", "UnWatchFields",
+    "StartJobStats", "GetJobStats", "StopJobStats", "RemoveJob"};
+
+struct RpcResult {
+    std::vector<uint32_t> latencies_us;
+    uint64_t errors = 0;
+};
+
+struct ClientResult {
+    RpcResult rpcs[RPC_COUNT];
+    bool setup_failed = false;
+};
+
+// Shared by the clients of one concurrency level
+struct Level {
+    std::string server;
+    std::vector<uint32_t> gpus;
+    std::vector<uint32_t> weights;
+    std::atomic<uint32_t> ready;
+    std::atomic<bool> go;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// The groups a client owns for the watch churn and its jobs
+struct Client {
+    uint32_t id;
+    rdc_handle_t handle;
+    rdc_gpu_group_t group_id;
+    rdc_field_grp_t field_group_id;
+    bool has_group;
+    bool has_field_group;
+    uint64_t since;
+    uint32_t jobs;
+};
+
+// Calls the RPC and records its latency, or its error
+template <typename Call>
+rdc_status_t timed(ClientResult* result, Rpc rpc, Call call) {
+    auto start = std::chrono::steady_clock::now();
+    rdc_status_t status = call();
+    auto end = std::chrono::steady_clock::now();
+    RpcResult& r = result->rpcs[rpc];
+    if (status != RDC_ST_OK && status != RDC_ST_NOT_FOUND) {
+        r.errors++;
+    } else {
+        r.latencies_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                end - start).count()));
+    }
+    return status;
+}
+
+rdc_status_t setup_client(Level* level, Client* client) {
+    client->has_group = false;
+    client->has_field_group = false;
+    client->since = 0;
+    client->jobs = 0;
+    rdc_status_t result = rdc_connect(level->server.c_str(),
+                                      &client->handle, nullptr, nullptr,
+                                      nullptr);
+    if (result != RDC_ST_OK) {
+        client->handle = nullptr;
+        return result;
+    }
+
+    std::string name = "rdc_loadgen_" + std::to_string(getpid()) + "_" +
+                       std::to_string(client->id);
+    result = rdc_group_gpu_create(client->handle, RDC_GROUP_EMPTY,
+                                  name.c_str(), &client->group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    client->has_group = true;
+    result = rdc_group_gpu_add(client->handle, client->group_id,
+                level->gpus[client->id % level->gpus.size()]);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    rdc_field_t fields[] = {RDC_FI_GPU_CLOCK, RDC_FI_MEM_CLOCK};
+    result = rdc_group_field_create(client->handle, 2, fields, name.c_str(),
+                                    &client->field_group_id);
+    client->has_field_group = (result == RDC_ST_OK);
+    return result;
+}
+
+void teardown_client(Client* client) {
+    if (client->handle == nullptr) {
+        return;
+    }
+    if (client->has_field_group) {
+        rdc_group_field_destroy(client->handle, client->field_group_id);
+    }
+    if (client->has_group) {
+        rdc_group_gpu_destroy(client->handle, client->group_id);
+    }
+    rdc_disconnect(client->handle);
+}
+
+void run_op(Level* level, Client* client, Op op, std::mt19937* rng,
+            ClientResult* result) {
+    rdc_handle_t handle = client->handle;
+    uint32_t gpu = level->gpus[(*rng)() % level->gpus.size()];
+    rdc_field_t field = kFields[(*rng)() % kNumFields];
+    switch (op) {
+        case OP_LATEST: {
+            rdc_field_value value;
+            timed(result, RPC_GET_LATEST, [&]() {
+                return rdc_field_get_latest_value(handle, gpu, field, &value);
+            });
+            break;
+        }
+        case OP_HISTORY: {
+            // Follow the samples of the first GPU, as a history reader does
+            rdc_field_value value;
+            uint64_t next_since = 0;
+            rdc_status_t status = timed(result, RPC_GET_SINCE, [&]() {
+                return rdc_field_get_value_since(handle, level->gpus[0],
+                        RDC_FI_GPU_TEMP, client->since, &next_since, &value);
+            });
+            client->since = (status == RDC_ST_OK) ? next_since : 0;
+            break;
+        }
+        case OP_WATCH:
+            if (timed(result, RPC_WATCH, [&]() {
+                    return rdc_field_watch(handle, client->group_id,
+                            client->field_group_id, 1000000, 10, 0);
+                }) == RDC_ST_OK) {
+                timed(result, RPC_UNWATCH, [&]() {
+                    return rdc_field_unwatch(handle, client->group_id,
+                                             client->field_group_id);
+                });
+            }
+            break;
+        case OP_JOB: {
+            char job_id[64];
+            snprintf(job_id, sizeof(job_id), "rdc_loadgen_%d_%u_%u",
+                     static_cast<int>(getpid()), client->id, client->jobs++);
+            if (timed(result, RPC_JOB_START, [&]() {
+                    return rdc_job_start_stats(handle, client->group_id,
+                                               job_id, 1000000);
+                }) != RDC_ST_OK) {
+                break;
+            }
+            rdc_job_info_t job_info;
+            timed(result, RPC_JOB_GET, [&]() {
+                return rdc_job_get_stats(handle, job_id, &job_info);
+            });
+            timed(result, RPC_JOB_STOP, [&]() {
+                return rdc_job_stop_stats(handle, job_id);
+            });
+            timed(result, RPC_JOB_REMOVE, [&]() {
+                return rdc_job_remove(handle, job_id);
+            });
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void run_client(Level* level, uint32_t id, ClientResult* result) {
+    Client client;
+    client.id = id;
+    if (setup_client(level, &client) != RDC_ST_OK) {
+        result->setup_failed = true;
+    }
+    level->ready++;
+    while (!level->go) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::mt19937 rng(id);
+    std::discrete_distribution<int> mix(level->weights.begin(),
+                                        level->weights.end());
+    while (!result->setup_failed &&
+           std::chrono::steady_clock::now() < level->deadline) {
+        run_op(level, &client, static_cast<Op>(mix(rng)), &rng, result);
+    }
+    teardown_client(&client);
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+void report(uint32_t clients, const char* rpc, std::vector<uint32_t>* all,
+            uint64_t errors, uint32_t seconds) {
+    std::sort(all->begin(), all->end());
+    printf("clients=%u rpc=%s calls=%zu calls_per_sec=%.0f errors=%lu "
+           "p50_us=%u p99_us=%u p999_us=%u max_us=%u\n", clients, rpc,
+           all->size(), static_cast<double>(all->size()) / seconds,
+           static_cast<unsigned long>(errors),  // NOLINT
+           percentile(*all, 0.5), percentile(*all, 0.99),
+           percentile(*all, 0.999), all->empty() ? 0 : all->back());
+}
+
+bool run_level(Level* level, uint32_t clients, uint32_t seconds) {
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    level->ready = 0;
+    level->go = false;
+    for (uint32_t c = 0; c < clients; c++) {
+        threads.push_back(std::thread(run_client, level, c, &results[c]));
+    }
+    // Connections and groups are set up before the clock starts
+    while (level->ready < clients) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    level->deadline = std::chrono::steady_clock::now() +
+                      std::chrono::seconds(seconds);
+    level->go = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    uint32_t failed = 0;
+    for (auto& r : results) {
+        if (r.setup_failed) {
+            failed++;
+        }
+    }
+    if (failed > 0) {
+        fprintf(stderr, "%u of %u clients failed to set up\n", failed,
+                clients);
+    }
+
+    std::vector<uint32_t> total;
+    uint64_t total_errors = 0;
+    for (uint32_t rpc = 0; rpc < RPC_COUNT; rpc++) {
+        std::vector<uint32_t> all;
+        uint64_t errors = 0;
+        for (auto& r : results) {
+            const RpcResult& rr = r.rpcs[rpc];
+            all.insert(all.end(), rr.latencies_us.begin(),
+                       rr.latencies_us.end());
+            errors += rr.errors;
+        }
+        if (all.empty() && errors == 0) {
+            continue;
+        }
+        total.insert(total.end(), all.begin(), all.end());
+        total_errors += errors;
+        report(clients, kRpcNames[rpc], &all, errors, seconds);
+    }
+    report(clients, "all", &total, total_errors, seconds);
+    fflush(stdout);
+    return failed == 0;
+}
+
+std::vector<uint32_t> parse_levels(const char* arg) {
+    std::vector<uint32_t> levels;
+    std::string s(arg);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = s.size();
+        }
+        uint32_t n = static_cast<uint32_t>(
+            strtoul(s.substr(pos, comma - pos).c_str(), nullptr, 10));
+        if (n > 0) {
+            levels.push_back(n);
+        }
+        pos = comma + 1;
+    }
+    return levels;
+}
+
+// Parses "latest=70,history=10,..."; the operations not listed get 0
+bool parse_mix(const char* arg, std::vector<uint32_t>* weights) {
+    weights->assign(OP_COUNT, 0);
+    std::string s(arg);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = s.size();
+        }
+        std::string item = s.substr(pos, comma - pos);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        std::string name = item.substr(0, eq);
+        uint32_t op = 0;
+        while (op < OP_COUNT && name != kOpNames[op]) {
+            op++;
+        }
+        if (op == OP_COUNT) {
+            return false;
+        }
+        (*weights)[op] = static_cast<uint32_t>(
+            strtoul(item.c_str() + eq + 1, nullptr, 10));
+        pos = comma + 1;
+    }
+    for (uint32_t w : *weights) {
+        if (w > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+pid_t start_rdcd(const char* rdcd, const std::string& port,
+                 const char* rsmi_fake_dir) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (rsmi_fake_dir != nullptr && rsmi_fake_dir[0] != '\0') {
+            std::string path = rsmi_fake_dir;
+            const char* old_path = getenv("LD_LIBRARY_PATH");
+            if (old_path != nullptr && old_path[0] != '\0') {
+                path = path + ":" + old_path;
+            }
+            setenv("LD_LIBRARY_PATH", path.c_str(), 1);
+        }
+        setenv("RSMI_FAKE_NUM_DEVICES", "8", 0);
+        // Keep the output of the load generator machine readable
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        execl(rdcd, rdcd, "-u", "-p", port.c_str(), "-U", "none",
+              static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string server = "localhost:50051";
+    const char* rdcd = nullptr;
+#ifdef RDC_LOADGEN_RSMI_FAKE_DIR
+    const char* rsmi_fake_dir = RDC_LOADGEN_RSMI_FAKE_DIR;
+#else
+    const char* rsmi_fake_dir = nullptr;
+#endif
+    uint32_t seconds = 5;
+    std::vector<uint32_t> levels = {1, 4, 16, 64};
+    std::vector<uint32_t> weights = {70, 10, 10, 10};
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:e:L:d:c:m:h")) != -1) {
+        switch (opt) {
+            case 's':
+                server = optarg;
+                break;
+            case 'e':
+                rdcd = optarg;
+                break;
+            case 'L':
+                rsmi_fake_dir = optarg;
+                break;
+            case 'd':
+                seconds = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 'c':
+                levels = parse_levels(optarg);
+                break;
+            case 'm':
+                if (!parse_mix(optarg, &weights)) {
+                    fprintf(stderr, "Invalid mix %s, expected "
+                            "op=weight,... with op latest, history, watch "
+                            "or job\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s host:port] "
+                        "[-e rdcd [-L rsmi_fake_dir]] [-d seconds] "
+                        "[-c clients,...] [-m op=weight,...]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (seconds == 0 || levels.empty()) {
+        fprintf(stderr, "Invalid duration or client counts\n");
+        return 1;
+    }
+
+    // Measure the RPCs, not the local shortcuts of rdc_connect()
+    setenv("RDC_UNIX_SOCKET", "none", 1);
+    setenv("RDC_SHM_NAME", "none", 1);
+
+    pid_t pid = -1;
+    if (rdcd != nullptr) {
+        size_t colon = server.rfind(':');
+        std::string port = (colon == std::string::npos) ? "50051" :
+                           server.substr(colon + 1);
+        pid = start_rdcd(rdcd, port, rsmi_fake_dir);
+    }
+
+    rdc_init(0);
+    Level level;
+    level.server = server;
+    level.weights = weights;
+
+    // Watch the polled fields on all GPUs so they come from the cache,
+    // retrying while a freshly started rdcd comes up
+    rdc_handle_t handle = nullptr;
+    rdc_gpu_group_t group_id = 0;
+    rdc_field_grp_t field_group_id = 0;
+    std::vector<uint32_t> gpus(RDC_MAX_NUM_DEVICES_EXT);
+    uint32_t count = 0;
+    rdc_status_t result = rdc_connect(server.c_str(), &handle, nullptr,
+                                      nullptr, nullptr);
+    for (int retry = 0; result == RDC_ST_OK && retry < 100; retry++) {
+        count = static_cast<uint32_t>(gpus.size());
+        result = rdc_device_get_all_ext(handle, gpus.data(), &count);
+        if (result != RDC_ST_CLIENT_ERROR || rdcd == nullptr) {
+            break;
+        }
+        result = RDC_ST_OK;
+        usleep(100000);
+    }
+    if (result == RDC_ST_OK && count == 0) {
+        result = RDC_ST_NOT_FOUND;
+    }
+    if (result == RDC_ST_OK) {
+        level.gpus.assign(gpus.begin(), gpus.begin() + count);
+        result = rdc_group_gpu_create(handle, RDC_GROUP_DEFAULT,
+                                      "rdc_loadgen", &group_id);
+    }
+    if (result == RDC_ST_OK) {
+        rdc_field_t fields[kNumFields];
+        std::copy(kFields, kFields + kNumFields, fields);
+        result = rdc_group_field_create(handle, kNumFields, fields,
+                                        "rdc_loadgen", &field_group_id);
+    }
+    if (result == RDC_ST_OK) {
+        result = rdc_field_watch(handle, group_id, field_group_id,
+                                 1000000, 60, 0);
+    }
+
+    int ret = 0;
+    if (result != RDC_ST_OK) {
+        fprintf(stderr, "Cannot watch the fields of %s: %s\n",
+                server.c_str(), rdc_status_string(result));
+        ret = 1;
+    } else {
+        // Let the first sweeps fill the cache
+        sleep(2);
+        for (uint32_t clients : levels) {
+            if (!run_level(&level, clients, seconds)) {
+                ret = 1;
+            }
+        }
+        rdc_field_unwatch(handle, group_id, field_group_id);
+        rdc_group_field_destroy(handle, field_group_id);
+        rdc_group_gpu_destroy(handle, group_id);
+    }
+    if (handle != nullptr) {
+        rdc_disconnect(handle);
+    }
+    rdc_shutdown();
+
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    return ret;
+}
@@ -0,0 +1,306 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Wall-clock time to sweep the latest values of many rdcd hosts, with the
+// synchronous API one request after the other, and with the asynchronous
+// API all requests in flight at once on the shared completion queue.
+// With -e, the bench starts the stand-in rdcd instances itself on
+// consecutive ports, e.g. an rdcd built with -DBUILD_RSMI_FAKE=ON and
+// RSMI_FAKE_NUM_DEVICES set. Connections go through TCP as they would to
+// remote nodes.
+//
+// Usage: rdc_multi_host_bench [-e rdcd] [-n hosts] [-p base_port]
+//                             [-r sweeps] [-t timeout_ms]
+// Output is one "key=value" line per mode.
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace {
+
+const rdc_field_t kFields[] = {RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE,
+                               RDC_FI_GPU_UTIL, RDC_FI_GPU_MEMORY_USAGE};
+const uint32_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+
+struct Host {
+    std::string address;
+    rdc_handle_t handle;
+    std::vector<uint32_t> gpus;
+    rdc_gpu_group_t group_id;
+    rdc_field_grp_t field_group_id;
+    bool watching;
+};
+
+// Counts down the requests of one asynchronous sweep
+struct Sweep {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t remaining;
+    uint32_t errors;
+};
+
+void on_value(rdc_status_t status, const rdc_field_value*, void* user_data) {
+    Sweep* sweep = static_cast<Sweep*>(user_data);
+    std::lock_guard<std::mutex> guard(sweep->mutex);
+    if (status != RDC_ST_OK) {
+        sweep->errors++;
+    }
+    if (--sweep->remaining == 0) {
+        sweep->cv.notify_one();
+    }
+}
+
+pid_t start_rdcd(const char* rdcd, uint32_t port) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Keep the output of the bench machine readable
+        int null_fd = open("/dev/null", O_WRONLY);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        std::string p = std::to_string(port);
+        execl(rdcd, rdcd, "-u", "-p", p.c_str(), "-U", "none",
+              static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    return pid;
+}
+
+// Connect and watch the fields on all GPUs of the host, retrying while a
+// freshly started rdcd comes up.
+rdc_status_t setup_host(Host* host) {
+    rdc_status_t result = rdc_connect(host->address.c_str(), &host->handle,
+                                      nullptr, nullptr, nullptr);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+
+    std::vector<uint32_t> gpus(RDC_MAX_NUM_DEVICES_EXT);
+    uint32_t count = 0;
+    for (int retry = 0; retry < 100; retry++) {
+        count = static_cast<uint32_t>(gpus.size());
+        result = rdc_device_get_all_ext(host->handle, gpus.data(), &count);
+        if (result != RDC_ST_CLIENT_ERROR) {
+            break;
+        }
+        usleep(100000);
+    }
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    host->gpus.assign(gpus.begin(), gpus.begin() + count);
+
+    result = rdc_group_gpu_create(host->handle, RDC_GROUP_DEFAULT,
+                                  "rdc_multi_host_bench", &host->group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    rdc_field_t fields[kNumFields];
+    std::copy(kFields, kFields + kNumFields, fields);
+    result = rdc_group_field_create(host->handle, kNumFields, fields,
+                    "rdc_multi_host_bench", &host->field_group_id);
+    if (result != RDC_ST_OK) {
+        return result;
+    }
+    result = rdc_field_watch(host->handle, host->group_id,
+                             host->field_group_id, 1000000, 10, 0);
+    host->watching = (result == RDC_ST_OK);
+    return result;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t sweep_serial(const std::vector<Host>& hosts) {
+    uint32_t errors = 0;
+    for (const Host& host : hosts) {
+        for (uint32_t gpu : host.gpus) {
+            for (uint32_t f = 0; f < kNumFields; f++) {
+                rdc_field_value value;
+                if (rdc_field_get_latest_value(host.handle, gpu, kFields[f],
+                                               &value) != RDC_ST_OK) {
+                    errors++;
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+uint32_t sweep_async(const std::vector<Host>& hosts, uint32_t requests,
+                     uint32_t timeout_ms) {
+    Sweep sweep;
+    sweep.remaining = requests;
+    sweep.errors = 0;
+    for (const Host& host : hosts) {
+        for (uint32_t gpu : host.gpus) {
+            for (uint32_t f = 0; f < kNumFields; f++) {
+                if (rdc_field_get_latest_value_async(host.handle, gpu,
+                        kFields[f], timeout_ms, on_value, &sweep)
+                                                            != RDC_ST_OK) {
+                    on_value(RDC_ST_CLIENT_ERROR, nullptr, &sweep);
+                }
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(sweep.mutex);
+    sweep.cv.wait(lock, [&sweep] { return sweep.remaining == 0; });
+    return sweep.errors;
+}
+
+void report(const char* mode, uint32_t hosts, uint32_t requests,
+            std::vector<double>* times, uint32_t errors) {
+    std::sort(times->begin(), times->end());
+    printf("mode=%s hosts=%u requests_per_sweep=%u sweeps=%zu errors=%u "
+           "sweep_ms_p50=%.2f sweep_ms_max=%.2f\n", mode, hosts, requests,
+           times->size(), errors, (*times)[times->size() / 2],
+           times->back());
+    fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* rdcd = nullptr;
+    uint32_t num_hosts = 8;
+    uint32_t base_port = 51000;
+    uint32_t sweeps = 20;
+    uint32_t timeout_ms = 5000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:n:p:r:t:h")) != -1) {
+        switch (opt) {
+            case 'e':
+                rdcd = optarg;
+                break;
+            case 'n':
+                num_hosts = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 'p':
+                base_port = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 'r':
+                sweeps = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 't':
+                timeout_ms = static_cast<uint32_t>(
+                    strtoul(optarg, nullptr, 10));
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-e rdcd] [-n hosts] "
+                        "[-p base_port] [-r sweeps] [-t timeout_ms]\n",
+                        argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (num_hosts == 0 || sweeps == 0) {
+        fprintf(stderr, "Invalid host or sweep count\n");
+        return 1;
+    }
+
+    // Measure the RPCs, not the local shortcuts of rdc_connect()
+    setenv("RDC_UNIX_SOCKET", "none", 1);
+    setenv("RDC_SHM_NAME", "none", 1);
+
+    std::vector<pid_t> pids;
+    if (rdcd != nullptr) {
+        for (uint32_t i = 0; i < num_hosts; i++) {
+            pids.push_back(start_rdcd(rdcd, base_port + i));
+        }
+    }
+
+    int ret = 0;
+    rdc_init(0);
+    std::vector<Host> hosts(num_hosts);
+    uint32_t requests = 0;
+    for (uint32_t i = 0; i < num_hosts; i++) {
+        hosts[i].address = "localhost:" + std::to_string(base_port + i);
+        hosts[i].handle = nullptr;
+        hosts[i].watching = false;
+        rdc_status_t result = setup_host(&hosts[i]);
+        if (result != RDC_ST_OK) {
+            fprintf(stderr, "Cannot watch the fields of %s: %s\n",
+                    hosts[i].address.c_str(), rdc_status_string(result));
+            ret = 1;
+            break;
+        }
+        requests += hosts[i].gpus.size() * kNumFields;
+    }
+
+    if (ret == 0) {
+        // Let the first collection sweep fill the caches
+        sleep(2);
+
+        std::vector<double> times;
+        uint32_t errors = 0;
+        for (uint32_t s = 0; s < sweeps; s++) {
+            auto start = std::chrono::steady_clock::now();
+            errors += sweep_serial(hosts);
+            times.push_back(elapsed_ms(start));
+        }
+        report("serial", num_hosts, requests, &times, errors);
+
+        times.clear();
+        errors = 0;
+        for (uint32_t s = 0; s < sweeps; s++) {
+            auto start = std::chrono::steady_clock::now();
+            errors += sweep_async(hosts, requests, timeout_ms);
+            times.push_back(elapsed_ms(start));
+        }
+        report("async", num_hosts, requests, &times, errors);
+    }
+
+    for (Host& host : hosts) {
+        if (host.watching) {
+            rdc_field_unwatch(host.handle, host.group_id,
+                              host.field_group_id);
+            rdc_group_field_destroy(host.handle, host.field_group_id);
+            rdc_group_gpu_destroy(host.handle, host.group_id);
+        }
+        if (host.handle != nullptr) {
+            rdc_disconnect(host.handle);
+        }
+    }
+    rdc_shutdown();
+
+    for (pid_t pid : pids) {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+    return ret;
+}
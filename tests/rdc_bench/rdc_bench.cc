@@ -0,0 +1,403 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Microbenchmarks of the collection and cache hot paths of librdc: the
+// cache manager, the watch table sweep, the telemetry dispatch and the
+// group settings lookups. The telemetry comes from a stub module built in
+// here, so it runs without GPUs and measures RDC rather than rocm_smi_lib.
+//
+// Usage: rdc_bench [-f filter] [-t seconds]
+//   -f  only run the benchmarks whose name contains filter
+//   -t  minimum time per benchmark, 0.5 seconds by default
+// Output is one "bench=<name> key=value ..." line per configuration, with
+// the time of one operation in ns_per_op.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>  // NOLINT
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcTelemetry.h"
+#include "rdc_lib/impl/RdcCacheManagerImpl.h"
+#include "rdc_lib/impl/RdcGroupSettingsImpl.h"
+#include "rdc_lib/impl/RdcTelemetryModule.h"
+#include "rdc_lib/impl/RdcWatchTableImpl.h"
+#include "tests/rdc_bench/rdc_bench_stubs.h"
+
+namespace {
+
+using amd::rdc::RdcCacheManagerImpl;
+using amd::rdc::RdcGroupSettingsImpl;
+using amd::rdc::RdcTelemetryModule;
+using amd::rdc::RdcTelemetryPtr;
+using amd::rdc::RdcWatchTableImpl;
+using amd::rdc::bench::StubMetricFetcher;
+using amd::rdc::bench::StubModuleMgr;
+using amd::rdc::bench::StubTelemetry;
+using amd::rdc::bench::now_ms;
+using amd::rdc::rdc_gpu_field_t;
+using amd::rdc::rdc_gpu_field_value_t;
+
+// Typical field group of a monitoring agent, plus some XGMI events
+const uint32_t kFieldsPerGpu = 20;
+const rdc_field_t kFields[kFieldsPerGpu] = {
+    RDC_FI_GPU_COUNT, RDC_FI_DEV_NAME, RDC_FI_GPU_CLOCK, RDC_FI_MEM_CLOCK,
+    RDC_FI_MEMORY_TEMP, RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE,
+    RDC_FI_PCIE_TX, RDC_FI_PCIE_RX, RDC_FI_GPU_UTIL,
+    RDC_FI_GPU_MEMORY_USAGE, RDC_FI_GPU_MEMORY_TOTAL,
+    RDC_FI_ECC_CORRECT_TOTAL, RDC_FI_ECC_UNCORRECT_TOTAL,
+    RDC_EVNT_XGMI_0_NOP_TX, RDC_EVNT_XGMI_0_REQ_TX, RDC_EVNT_XGMI_0_RESP_TX,
+    RDC_EVNT_XGMI_0_BEATS_TX, RDC_EVNT_XGMI_1_NOP_TX,
+    RDC_EVNT_XGMI_1_BEATS_TX};
+
+// The fields read from sysfs when RDC_SYSFS_ROOT is set
+const uint32_t kNumHotFields = 4;
+const rdc_field_t kHotFields[kNumHotFields] = {
+    RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE, RDC_FI_GPU_UTIL,
+    RDC_FI_GPU_MEMORY_USAGE};
+
+const char* g_filter = "";
+double g_min_seconds = 0.5;
+
+// Runs op, which does ops_per_call operations, until g_min_seconds
+// passed, and prints the line of the benchmark
+template <typename Op>
+void run(const char* name, const std::string& params, uint64_t ops_per_call,
+         Op op) {
+    uint64_t calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    uint64_t batch = 1;
+    while (elapsed < g_min_seconds) {
+        for (uint64_t i = 0; i < batch; i++) {
+            op();
+        }
+        calls += batch;
+        elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+        if (batch < (1u << 20)) batch *= 2;
+    }
+
+    uint64_t ops = calls * ops_per_call;
+    printf("bench=%s %s ops=%lu ns_per_op=%.1f\n", name, params.c_str(),
+           static_cast<unsigned long>(ops), elapsed * 1e9 / ops);  // NOLINT
+    fflush(stdout);
+}
+
+bool selected(const char* name) {
+    return strstr(name, g_filter) != nullptr;
+}
+
+std::string format(const char* fmt, uint32_t a, uint32_t b = 0,
+                   uint32_t c = 0) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), fmt, a, b, c);
+    return buf;
+}
+
+rdc_field_value make_value(rdc_field_t field_id, uint64_t ts, int64_t v) {
+    rdc_field_value value;
+    value.field_id = field_id;
+    value.status = RDC_ST_OK;
+    value.ts = ts;
+    value.type = INTEGER;
+    value.value.l_int = v;
+    return value;
+}
+
+void fill_cache(RdcCacheManagerImpl* cache, uint32_t num_gpus,
+                uint32_t history, uint64_t first_ts) {
+    for (uint32_t h = 0; h < history; h++) {
+        for (uint32_t g = 0; g < num_gpus; g++) {
+            for (uint32_t f = 0; f < kFieldsPerGpu; f++) {
+                cache->rdc_update_cache(g,
+                        make_value(kFields[f], first_ts + h, h));
+            }
+        }
+    }
+}
+
+// A sweep adding one sample per field, then evicting down to the history
+void bench_cache_update(uint32_t num_gpus, uint32_t history) {
+    if (!selected("cache_update")) return;
+    RdcCacheManagerImpl cache;
+    uint64_t ts = now_ms();
+    fill_cache(&cache, num_gpus, history, ts);
+    int64_t v = 0;
+    run("cache_update", format("gpus=%u history=%u", num_gpus, history),
+        num_gpus * kFieldsPerGpu, [&]() {
+        for (uint32_t g = 0; g < num_gpus; g++) {
+            for (uint32_t f = 0; f < kFieldsPerGpu; f++) {
+                cache.rdc_update_cache(g, make_value(kFields[f], ts, v++));
+                cache.evict_cache(g, kFields[f], history, 3600);
+            }
+        }
+    });
+}
+
+void bench_cache_latest(uint32_t num_gpus, uint32_t history) {
+    if (!selected("cache_latest")) return;
+    RdcCacheManagerImpl cache;
+    fill_cache(&cache, num_gpus, history, now_ms());
+    rdc_field_value value;
+    run("cache_latest", format("gpus=%u history=%u", num_gpus, history),
+        num_gpus * kFieldsPerGpu, [&]() {
+        for (uint32_t g = 0; g < num_gpus; g++) {
+            for (uint32_t f = 0; f < kFieldsPerGpu; f++) {
+                cache.rdc_field_get_latest_value(g, kFields[f], &value);
+            }
+        }
+    });
+}
+
+// Reads the newer half of the history, one sample per call
+void bench_cache_since(uint32_t history) {
+    if (!selected("cache_since")) return;
+    RdcCacheManagerImpl cache;
+    uint64_t first_ts = now_ms();
+    fill_cache(&cache, 1, history, first_ts);
+    rdc_field_value value;
+    uint64_t since = first_ts + history / 2;
+    run("cache_since", format("history=%u", history), 1, [&]() {
+        uint64_t next = 0;
+        if (cache.rdc_field_get_value_since(0, RDC_FI_GPU_TEMP, since,
+                &next, &value) != RDC_ST_OK || next >= first_ts + history) {
+            since = first_ts + history / 2;
+        } else {
+            since = next;
+        }
+    });
+}
+
+// Evicting the oldest sample of one field
+void bench_cache_evict(uint32_t history) {
+    if (!selected("cache_evict")) return;
+    RdcCacheManagerImpl cache;
+    uint64_t ts = now_ms();
+    fill_cache(&cache, 1, history, ts);
+    int64_t v = 0;
+    run("cache_evict", format("history=%u", history), 1, [&]() {
+        cache.rdc_update_cache(0, make_value(RDC_FI_GPU_TEMP, ts, v++));
+        cache.evict_cache(0, RDC_FI_GPU_TEMP, history, 3600);
+    });
+}
+
+// Updating the job stats of every job field of every GPU in the job
+void bench_job_update(uint32_t num_gpus, uint32_t num_jobs) {
+    if (!selected("job_update")) return;
+    RdcCacheManagerImpl cache;
+    RdcGroupSettingsImpl settings;
+    amd::rdc::RdcFieldGroupSnapshot job_fields;
+    settings.rdc_group_field_get_snapshot(amd::rdc::JOB_FIELD_ID,
+                                          &job_fields);
+    amd::rdc::RdcGpuGroup group;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        group.entity_ids.push_back(g);
+    }
+    rdc_gpu_gauges_t gauges;
+    std::vector<std::string> job_ids;
+    for (uint32_t j = 0; j < num_jobs; j++) {
+        job_ids.push_back("bench_job_" + std::to_string(j));
+        cache.rdc_job_start_stats(job_ids.back().c_str(), group, *job_fields,
+                                  gauges);
+    }
+
+    uint64_t ts = now_ms();
+    int64_t v = 0;
+    const std::string& job_id = job_ids.back();
+    run("job_update", format("gpus=%u jobs=%u", num_gpus, num_jobs),
+        num_gpus * job_fields->field_ids.size(), [&]() {
+        ts++;
+        for (uint32_t g = 0; g < num_gpus; g++) {
+            for (auto field_id : job_fields->field_ids) {
+                cache.rdc_update_job_stats(g, job_id,
+                        make_value(field_id, ts, v++));
+            }
+        }
+    });
+}
+
+// A collection sweep of the watch table: every GPU is watched through its
+// own group with the field group, and each job watches its own GPU.
+void bench_watch_sweep(uint32_t num_gpus, uint32_t num_jobs,
+                       uint32_t history) {
+    if (!selected("watch_sweep")) return;
+    auto settings = std::make_shared<RdcGroupSettingsImpl>();
+    auto cache = std::make_shared<RdcCacheManagerImpl>();
+    RdcTelemetryPtr stub(new StubTelemetry(kFields, kFieldsPerGpu));
+    auto telemetry = std::make_shared<RdcTelemetryModule>(
+            std::list<RdcTelemetryPtr>{stub});
+    RdcWatchTableImpl watch_table(settings, cache,
+            std::make_shared<StubMetricFetcher>(),
+            std::make_shared<StubModuleMgr>(telemetry));
+
+    rdc_field_grp_t field_group;
+    std::vector<rdc_field_t> fields(kFields, kFields + kFieldsPerGpu);
+    settings->rdc_group_field_create(kFieldsPerGpu, fields.data(),
+                                     "bench_fields", &field_group);
+    rdc_gpu_gauges_t gauges;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        rdc_gpu_group_t group;
+        std::string name = "bench_gpu_" + std::to_string(g);
+        settings->rdc_group_gpu_create(name.c_str(), &group);
+        settings->rdc_group_gpu_add(group, g);
+        // Every sweep fetches every field
+        watch_table.rdc_field_watch(group, field_group, 1, 3600, history);
+        if (g < num_jobs) {
+            std::string job_id = "bench_job_" + std::to_string(g);
+            watch_table.rdc_job_start_stats(group, job_id.c_str(), 1,
+                                            gauges);
+        }
+    }
+
+    run("watch_sweep", format("gpus=%u jobs=%u history=%u", num_gpus,
+        num_jobs, history), 1, [&]() {
+        watch_table.rdc_field_update_all();
+    });
+}
+
+// Dispatching a sweep to the modules, as with the sysfs and the SMI
+// modules, without the cost of the values
+void bench_telemetry_dispatch(uint32_t num_gpus) {
+    if (!selected("telemetry_dispatch")) return;
+    RdcTelemetryPtr hot(new StubTelemetry(kHotFields, kNumHotFields));
+    RdcTelemetryPtr rest(new StubTelemetry(kFields, kFieldsPerGpu));
+    RdcTelemetryModule telemetry(std::list<RdcTelemetryPtr>{hot, rest});
+
+    std::vector<rdc_gpu_field_t> fields;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        for (uint32_t f = 0; f < kFieldsPerGpu; f++) {
+            fields.push_back({g, kFields[f]});
+        }
+    }
+    uint64_t num_values = 0;
+    auto count_values = [](rdc_gpu_field_value_t*, uint32_t num_values,
+            void* user_data) -> rdc_status_t {
+        *static_cast<uint64_t*>(user_data) += num_values;
+        return RDC_ST_OK;
+    };
+    run("telemetry_dispatch", format("gpus=%u fields=%u", num_gpus,
+        fields.size()), fields.size(), [&]() {
+        telemetry.rdc_telemetry_fields_value_get(fields.data(), fields.size(),
+                count_values, &num_values);
+    });
+}
+
+// Resolving groups as every watch and job call does
+void bench_group_lookup(uint32_t num_groups) {
+    if (!selected("group_")) return;
+    RdcGroupSettingsImpl settings;
+    std::vector<rdc_gpu_group_t> gpu_groups;
+    std::vector<rdc_field_grp_t> field_groups;
+    std::vector<rdc_field_t> fields(kFields, kFields + kFieldsPerGpu);
+    for (uint32_t i = 0; i < num_groups; i++) {
+        std::string name = "bench_" + std::to_string(i);
+        rdc_gpu_group_t group;
+        settings.rdc_group_gpu_create(name.c_str(), &group);
+        for (uint32_t g = 0; g < 8; g++) {
+            settings.rdc_group_gpu_add(group, g);
+        }
+        gpu_groups.push_back(group);
+        rdc_field_grp_t field_group;
+        if (settings.rdc_group_field_create(kFieldsPerGpu, fields.data(),
+                name.c_str(), &field_group) == RDC_ST_OK) {
+            field_groups.push_back(field_group);
+        }
+    }
+
+    std::string params = format("groups=%u", num_groups);
+    uint32_t i = 0;
+    if (selected("group_gpu_snapshot")) {
+        amd::rdc::RdcGpuGroupSnapshot snapshot;
+        run("group_gpu_snapshot", params, 1, [&]() {
+            settings.rdc_group_gpu_get_snapshot(
+                    gpu_groups[i++ % gpu_groups.size()], &snapshot);
+        });
+    }
+    if (selected("group_gpu_info")) {
+        rdc_group_info_t info;
+        run("group_gpu_info", params, 1, [&]() {
+            settings.rdc_group_gpu_get_info(
+                    gpu_groups[i++ % gpu_groups.size()], &info);
+        });
+    }
+    if (selected("group_field_snapshot") && !field_groups.empty()) {
+        amd::rdc::RdcFieldGroupSnapshot snapshot;
+        run("group_field_snapshot", format("groups=%u",
+            field_groups.size()), 1, [&]() {
+            settings.rdc_group_field_get_snapshot(
+                    field_groups[i++ % field_groups.size()], &snapshot);
+        });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                g_filter = optarg;
+                break;
+            case 't':
+                g_min_seconds = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-f filter] [-t seconds]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (g_min_seconds <= 0) {
+        fprintf(stderr, "Invalid duration\n");
+        return 1;
+    }
+
+    const uint32_t histories[] = {1, 100, 10000};
+    for (uint32_t history : histories) {
+        bench_cache_update(8, history);
+        bench_cache_latest(8, history);
+        bench_cache_since(history);
+        bench_cache_evict(history);
+    }
+    bench_job_update(8, 1);
+    bench_job_update(8, 64);
+
+    bench_watch_sweep(8, 0, 100);
+    bench_watch_sweep(8, 8, 100);
+    bench_watch_sweep(64, 0, 100);
+    bench_watch_sweep(64, 64, 100);
+
+    bench_telemetry_dispatch(8);
+    bench_telemetry_dispatch(64);
+
+    bench_group_lookup(16);
+    bench_group_lookup(1024);
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Stand-ins for the telemetry and the rocm_smi_lib side of librdc, so that
+// the watch table, the cache and the telemetry dispatch run without GPUs.
+// Shared by rdc_bench and rdc_sweep_alloc_test.
+
+#ifndef TESTS_RDC_BENCH_RDC_BENCH_STUBS_H_
+#define TESTS_RDC_BENCH_RDC_BENCH_STUBS_H_
+
+#include <sys/time.h>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/RdcMetricFetcher.h"
+#include "rdc_lib/RdcModuleMgr.h"
+#include "rdc_lib/RdcTelemetry.h"
+
+namespace amd {
+namespace rdc {
+namespace bench {
+
+inline uint64_t now_ms() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000 + tv.tv_usec / 1000;
+}
+
+// Returns a changing integer for any field, batched to the callback like
+// RdcSmiLib does
+class StubTelemetry : public RdcTelemetry {
+ public:
+    StubTelemetry(const rdc_field_t* fields, uint32_t num_fields)
+        : fields_(fields, fields + num_fields), counter_(0) {}
+
+    rdc_status_t rdc_telemetry_fields_query(
+            uint32_t field_ids[MAX_NUM_FIELDS],
+            uint32_t* field_count) override {
+        for (uint32_t i = 0; i < fields_.size(); i++) {
+            field_ids[i] = fields_[i];
+        }
+        *field_count = fields_.size();
+        return RDC_ST_OK;
+    }
+
+    rdc_status_t rdc_telemetry_fields_value_get(rdc_gpu_field_t* fields,
+            uint32_t fields_count, rdc_field_value_f callback,
+            void* user_data) override {
+        const uint32_t kBulkMax = 16;
+        rdc_gpu_field_value_t values[kBulkMax];
+        uint64_t ts = now_ms();
+        uint32_t bulk_count = 0;
+        for (uint32_t i = 0; i < fields_count; i++) {
+            if (bulk_count >= kBulkMax) {
+                callback(values, bulk_count, user_data);
+                bulk_count = 0;
+            }
+            rdc_gpu_field_value_t& v = values[bulk_count++];
+            v.gpu_index = fields[i].gpu_index;
+            v.field_value.field_id = fields[i].field_id;
+            v.field_value.status = RDC_ST_OK;
+            v.field_value.ts = ts;
+            v.field_value.type = INTEGER;
+            v.field_value.value.l_int = counter_++;
+        }
+        if (bulk_count != 0) {
+            callback(values, bulk_count, user_data);
+        }
+        return RDC_ST_OK;
+    }
+
+    rdc_status_t rdc_telemetry_fields_watch(rdc_gpu_field_t*,
+            uint32_t) override {
+        return RDC_ST_OK;
+    }
+    rdc_status_t rdc_telemetry_fields_unwatch(rdc_gpu_field_t*,
+            uint32_t) override {
+        return RDC_ST_OK;
+    }
+
+ private:
+    std::vector<rdc_field_t> fields_;
+    int64_t counter_;
+};
+
+class StubMetricFetcher : public RdcMetricFetcher {
+ public:
+    rdc_status_t acquire_rsmi_handle(RdcFieldKey) override {
+        return RDC_ST_OK;
+    }
+    rdc_status_t delete_rsmi_handle(RdcFieldKey) override {
+        return RDC_ST_OK;
+    }
+    rdc_status_t fetch_smi_field(uint32_t, rdc_field_t,
+            rdc_field_value*) override {
+        return RDC_ST_NOT_SUPPORTED;
+    }
+};
+
+class StubModuleMgr : public RdcModuleMgr {
+ public:
+    explicit StubModuleMgr(const RdcTelemetryPtr& telemetry)
+        : telemetry_(telemetry) {}
+    RdcTelemetryPtr get_telemetry_module() override { return telemetry_; }
+
+ private:
+    RdcTelemetryPtr telemetry_;
+};
+
+}  // namespace bench
+}  // namespace rdc
+}  // namespace amd
+
+#endif  // TESTS_RDC_BENCH_RDC_BENCH_STUBS_H_
@@ -0,0 +1,229 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Latency of rdcd under concurrent clients. Every client has its own
+// connection and polls the latest value of a watched field in a loop,
+// the way a fleet of exporters scrapes rdcd. Run it once against rdcd
+// started normally and once against "rdcd --async" to compare the
+// synchronous and the completion queue servers.
+//
+// Usage: rdc_rpc_bench [-s host:port] [-d seconds] [-c clients,...]
+// Output is one "key=value" line per concurrency level.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "rdc/rdc.h"
+
+namespace {
+
+struct ClientResult {
+    std::vector<uint32_t> latencies_us;
+    uint64_t errors;
+};
+
+void run_client(const std::string& server, const std::vector<uint32_t>& gpus,
+                std::chrono::steady_clock::time_point deadline,
+                ClientResult* result) {
+    rdc_handle_t handle;
+    result->errors = 0;
+    if (rdc_connect(server.c_str(), &handle, nullptr, nullptr, nullptr)
+                                                            != RDC_ST_OK) {
+        result->errors++;
+        return;
+    }
+
+    size_t i = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        rdc_field_value value;
+        auto start = std::chrono::steady_clock::now();
+        rdc_status_t status = rdc_field_get_latest_value(handle,
+                gpus[i++ % gpus.size()], RDC_FI_GPU_TEMP, &value);
+        auto end = std::chrono::steady_clock::now();
+        if (status != RDC_ST_OK) {
+            result->errors++;
+            continue;
+        }
+        result->latencies_us.push_back(static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                end - start).count()));
+    }
+
+    rdc_disconnect(handle);
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+void run_level(const std::string& server, const std::vector<uint32_t>& gpus,
+               uint32_t clients, uint32_t seconds) {
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::seconds(seconds);
+    for (uint32_t c = 0; c < clients; c++) {
+        threads.push_back(std::thread(run_client, std::cref(server),
+                                      std::cref(gpus), deadline, &results[c]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::vector<uint32_t> all;
+    uint64_t errors = 0;
+    for (auto& r : results) {
+        all.insert(all.end(), r.latencies_us.begin(), r.latencies_us.end());
+        errors += r.errors;
+    }
+    std::sort(all.begin(), all.end());
+
+    printf("server=%s clients=%u calls=%zu calls_per_sec=%.0f errors=%lu "
+           "p50_us=%u p99_us=%u p999_us=%u max_us=%u\n", server.c_str(),
+           clients, all.size(), static_cast<double>(all.size()) / seconds,
+           errors, percentile(all, 0.5), percentile(all, 0.99),
+           percentile(all, 0.999), all.empty() ? 0 : all.back());
+    fflush(stdout);
+}
+
+std::vector<uint32_t> parse_levels(const char* arg) {
+    std::vector<uint32_t> levels;
+    std::string s(arg);
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = s.size();
+        }
+        uint32_t n = static_cast<uint32_t>(
+            strtoul(s.substr(pos, comma - pos).c_str(), nullptr, 10));
+        if (n > 0) {
+            levels.push_back(n);
+        }
+        pos = comma + 1;
+    }
+    return levels;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string server = "localhost:50051";
+    uint32_t seconds = 5;
+    std::vector<uint32_t> levels = {1, 4, 16, 64, 256};
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:d:c:h")) != -1) {
+        switch (opt) {
+            case 's':
+                server = optarg;
+                break;
+            case 'd':
+                seconds = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+                break;
+            case 'c':
+                levels = parse_levels(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s host:port] [-d seconds] "
+                        "[-c clients,...]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (seconds == 0 || levels.empty()) {
+        fprintf(stderr, "Invalid duration or client counts\n");
+        return 1;
+    }
+
+    rdc_status_t result = rdc_init(0);
+    if (result != RDC_ST_OK) {
+        fprintf(stderr, "rdc_init failed: %s\n", rdc_status_string(result));
+        return 1;
+    }
+
+    rdc_handle_t handle;
+    result = rdc_connect(server.c_str(), &handle, nullptr, nullptr, nullptr);
+    if (result != RDC_ST_OK) {
+        fprintf(stderr, "Cannot connect to %s. Start rdcd with -u.\n",
+                server.c_str());
+        rdc_shutdown();
+        return 1;
+    }
+
+    // Watch a field on all GPUs so the polled values come from the cache
+    std::vector<uint32_t> gpus(RDC_MAX_NUM_DEVICES_EXT);
+    uint32_t count = static_cast<uint32_t>(gpus.size());
+    rdc_gpu_group_t group_id = 0;
+    rdc_field_grp_t field_group_id = 0;
+    rdc_field_t fields[] = {RDC_FI_GPU_TEMP};
+    result = rdc_device_get_all_ext(handle, gpus.data(), &count);
+    if (result == RDC_ST_OK && count == 0) {
+        result = RDC_ST_NOT_FOUND;
+    }
+    if (result == RDC_ST_OK) {
+        gpus.resize(count);
+        result = rdc_group_gpu_create(handle, RDC_GROUP_DEFAULT,
+                                      "rdc_rpc_bench", &group_id);
+    }
+    if (result == RDC_ST_OK) {
+        result = rdc_group_field_create(handle, 1, fields,
+                                        "rdc_rpc_bench", &field_group_id);
+    }
+    if (result == RDC_ST_OK) {
+        result = rdc_field_watch(handle, group_id, field_group_id,
+                                 1000000, 10, 0);
+    }
+    if (result != RDC_ST_OK) {
+        fprintf(stderr, "Failed to set up the watch: %s\n",
+                rdc_status_string(result));
+        rdc_disconnect(handle);
+        rdc_shutdown();
+        return 1;
+    }
+
+    // Let the first sweep fill the cache
+    sleep(2);
+
+    for (uint32_t clients : levels) {
+        run_level(server, gpus, clients, seconds);
+    }
+
+    rdc_field_unwatch(handle, group_id, field_group_id);
+    rdc_group_field_destroy(handle, field_group_id);
+    rdc_group_gpu_destroy(handle, group_id);
+    rdc_disconnect(handle);
+    rdc_shutdown();
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Checks that the collection sweeps of the watch table do not allocate
+// once the watches are stable: the operator new of the program counts the
+// allocations of all the threads while the sweeps run against the stub
+// telemetry of rdc_bench. The sweeps are counted with the lanes fetching
+// their GPUs, then with the GPU workers of RDC_GPU_TIMEOUT_MS.
+//
+// Usage: rdc_sweep_alloc_test [-g gpus] [-t seconds]
+//   -g  number of GPUs watched, 8 by default
+//   -t  time the sweeps are counted for in each mode, after as long a warm
+//       up, 3 seconds by default so that the once a second clean up is
+//       included
+// Exits with 1 if any sweep allocated, in either mode.
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/impl/RdcCacheManagerImpl.h"
+#include "rdc_lib/impl/RdcGpuCollector.h"
+#include "rdc_lib/impl/RdcGroupSettingsImpl.h"
+#include "rdc_lib/impl/RdcTelemetryModule.h"
+#include "rdc_lib/impl/RdcWatchTableImpl.h"
+#include "tests/rdc_bench/rdc_bench_stubs.h"
+
+namespace {
+
+std::atomic<bool> g_counting(false);
+std::atomic<uint64_t> g_allocations(0);
+
+void* counted_alloc(size_t size) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return malloc(size == 0 ? 1 : size);
+}
+
+// Not inlined, or the compiler sees the frees of what new returned
+__attribute__((noinline)) void counted_free(void* p) {
+    free(p);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* p = counted_alloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size);
+}
+
+void operator delete(void* p) noexcept {
+    counted_free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    counted_free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    counted_free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    counted_free(p);
+}
+
+namespace {
+
+using amd::rdc::RdcCacheManagerImpl;
+using amd::rdc::RdcGroupSettingsImpl;
+using amd::rdc::RdcTelemetryModule;
+using amd::rdc::RdcTelemetryPtr;
+using amd::rdc::RdcWatchTableImpl;
+using amd::rdc::bench::StubMetricFetcher;
+using amd::rdc::bench::StubModuleMgr;
+using amd::rdc::bench::StubTelemetry;
+using amd::rdc::bench::now_ms;
+
+const uint32_t kNumFields = 8;
+const rdc_field_t kFields[kNumFields] = {
+    RDC_FI_GPU_CLOCK, RDC_FI_MEM_CLOCK, RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE,
+    RDC_FI_GPU_UTIL, RDC_FI_GPU_MEMORY_USAGE, RDC_FI_ECC_CORRECT_TOTAL,
+    RDC_EVNT_XGMI_0_NOP_TX};
+
+// Sweeps as the lanes of rdcd would until the deadline, returns the number
+// of sweeps
+uint64_t sweep_until(RdcWatchTableImpl* watch_table, uint64_t deadline_ms) {
+    uint64_t sweeps = 0;
+    while (now_ms() < deadline_ms) {
+        watch_table->rdc_field_update_all();
+        sweeps++;
+        usleep(1000);
+    }
+    return sweeps;
+}
+
+// Watches the GPUs with RDC_GPU_TIMEOUT_MS set to gpu_timeout_ms, then
+// counts the allocations of the steady state sweeps
+bool sweeps_do_not_allocate(uint32_t num_gpus, uint64_t duration_ms,
+                            const char* gpu_timeout_ms) {
+    setenv(RDC_GPU_TIMEOUT_MS_ENV, gpu_timeout_ms, 1);
+    auto settings = std::make_shared<RdcGroupSettingsImpl>();
+    auto cache = std::make_shared<RdcCacheManagerImpl>();
+    RdcTelemetryPtr stub(new StubTelemetry(kFields, kNumFields));
+    auto telemetry = std::make_shared<RdcTelemetryModule>(
+            std::list<RdcTelemetryPtr>{stub});
+    RdcWatchTableImpl watch_table(settings, cache,
+            std::make_shared<StubMetricFetcher>(),
+            std::make_shared<StubModuleMgr>(telemetry));
+
+    // Each GPU in its own group, watched every 10ms with some history, and
+    // every other GPU in a job whose id does not fit a short string
+    rdc_field_grp_t field_group;
+    std::vector<rdc_field_t> fields(kFields, kFields + kNumFields);
+    settings->rdc_group_field_create(kNumFields, fields.data(),
+                                     "alloc_test_fields", &field_group);
+    rdc_gpu_gauges_t gauges;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        rdc_gpu_group_t group;
+        std::string name = "alloc_test_gpu_" + std::to_string(g);
+        settings->rdc_group_gpu_create(name.c_str(), &group);
+        settings->rdc_group_gpu_add(group, g);
+        watch_table.rdc_field_watch(group, field_group, 10000, 3600, 100);
+        if (g % 2 == 0) {
+            std::string job_id = "rdc_sweep_alloc_test_job_" +
+                    std::to_string(g);
+            watch_table.rdc_job_start_stats(group, job_id.c_str(), 10000,
+                                            gauges);
+        }
+    }
+
+    sweep_until(&watch_table, now_ms() + duration_ms);
+
+    rdc_field_value before;
+    cache->rdc_field_get_latest_value(0, RDC_FI_POWER_USAGE, &before);
+    g_counting = true;
+    uint64_t sweeps = sweep_until(&watch_table, now_ms() + duration_ms);
+    g_counting = false;
+    rdc_field_value after;
+    cache->rdc_field_get_latest_value(0, RDC_FI_POWER_USAGE, &after);
+
+    uint64_t allocations = g_allocations.exchange(0);
+    printf("watchdog=%s gpus=%u sweeps=%lu allocations=%lu\n",
+           gpu_timeout_ms[0] == '0' ? "off" : "on", num_gpus,
+           static_cast<unsigned long>(sweeps),  // NOLINT
+           static_cast<unsigned long>(allocations));  // NOLINT
+    if (after.ts == before.ts) {
+        fprintf(stderr, "FAIL: the sweeps did not fetch any value\n");
+        return false;
+    }
+    if (allocations != 0) {
+        fprintf(stderr, "FAIL: the steady state sweeps allocated %lu times\n",
+                static_cast<unsigned long>(allocations));  // NOLINT
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t num_gpus = 8;
+    double seconds = 3;
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:h")) != -1) {
+        switch (opt) {
+            case 'g':
+                num_gpus = static_cast<uint32_t>(atoi(optarg));
+                break;
+            case 't':
+                seconds = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-g gpus] [-t seconds]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (num_gpus == 0 || num_gpus > RDC_MAX_NUM_DEVICES_EXT || seconds <= 0) {
+        fprintf(stderr, "Invalid number of GPUs or duration\n");
+        return 1;
+    }
+
+    uint64_t duration_ms = static_cast<uint64_t>(seconds * 1000);
+    bool passed = sweeps_do_not_allocate(num_gpus, duration_ms, "0");
+    passed = sweeps_do_not_allocate(num_gpus, duration_ms, "1000") && passed;
+    if (!passed) {
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,471 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// Checks and benchmarks the sysfs telemetry module of RDC_SYSFS_ROOT
+// against a fake drm class tree built in a temporary directory, so it runs
+// without GPUs. The check reads the hot fields of a tree with a connector,
+// a GPU of another vendor, hwmon temperatures found by their label, a
+// power1_input without power1_average, a value which does not parse and a
+// missing gpu_busy_percent which must fall back to the metric fetcher.
+// The benchmark then times a sweep of the hot fields over the GPUs with:
+//   sysfs_pread      RdcSysfsLib, one pread() per field on the kept files
+//   sysfs_open_read  an open(), read() and close() per field, the way
+//                    rocm_smi_lib reads sysfs
+//   rocm_smi         RdcSmiLib over the rocm_smi library librdc links,
+//                    which is only comparable against a real tree
+//
+// Usage: rdc_sysfs_bench [-g gpus] [-t seconds] [-r drm_root]
+//   -g  number of GPUs of the fake tree of the benchmark, 8 by default
+//   -t  minimum time per benchmark, 0.5 seconds by default
+//   -r  benchmark the given tree, i.e. /sys/class/drm, instead of a fake
+//       one; the check still runs on its own fake tree
+// Exits with 1 if the check fails.
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "rdc/rdc.h"
+#include "rdc_lib/impl/RdcMetricFetcherImpl.h"
+#include "rdc_lib/impl/RdcSmiLib.h"
+#include "rdc_lib/impl/RdcSysfsLib.h"
+
+namespace {
+
+using amd::rdc::RdcMetricFetcher;
+using amd::rdc::RdcMetricFetcherImpl;
+using amd::rdc::RdcMetricFetcherPtr;
+using amd::rdc::RdcSmiLib;
+using amd::rdc::RdcSysfsLib;
+using amd::rdc::RdcTelemetry;
+using amd::rdc::rdc_gpu_field_t;
+using amd::rdc::rdc_gpu_field_value_t;
+
+const char kAmdVendorId[] = "0x1002";
+const int64_t kFallbackValue = 7;
+
+// The fields read from sysfs when RDC_SYSFS_ROOT is set
+const uint32_t kNumHotFields = 4;
+const rdc_field_t kHotFields[kNumHotFields] = {
+    RDC_FI_GPU_TEMP, RDC_FI_POWER_USAGE, RDC_FI_GPU_UTIL,
+    RDC_FI_GPU_MEMORY_USAGE};
+
+typedef std::vector<std::pair<std::string, std::string>> Files;
+
+bool write_file(const std::string& path, const std::string& content) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = write(fd, content.c_str(), content.size()) ==
+                   static_cast<ssize_t>(content.size());
+    close(fd);
+    return written;
+}
+
+// Creates root/name and the files under it, along with their directories
+bool add_entry(const std::string& root, const std::string& name,
+               const Files& files) {
+    std::string dir = root + "/" + name;
+    if (mkdir(dir.c_str(), 0755) != 0) {
+        return false;
+    }
+    for (const auto& file : files) {
+        std::string path = dir + "/" + file.first;
+        for (size_t slash = path.find('/', dir.size() + 1);
+             slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+        if (!write_file(path, file.second + "\n")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int remove_entry(const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+}
+
+void remove_tree(const std::string& root) {
+    nftw(root.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+Files amd_card(uint32_t n) {
+    return Files{
+        {"device/vendor", kAmdVendorId},
+        {"device/gpu_busy_percent", std::to_string(n % 100)},
+        {"device/mem_info_vram_used", std::to_string(n << 20)},
+        {"device/hwmon/hwmon" + std::to_string(n) + "/temp1_label", "edge"},
+        {"device/hwmon/hwmon" + std::to_string(n) + "/temp1_input", "45000"},
+        {"device/hwmon/hwmon" + std::to_string(n) + "/power1_average",
+         "120000000"}};
+}
+
+// Stands in for rocm_smi_lib for the fields the tree does not expose
+class FallbackFetcher : public RdcMetricFetcher {
+ public:
+    FallbackFetcher() : calls_(0) {}
+    rdc_status_t acquire_rsmi_handle(RdcFieldKey) override {
+        return RDC_ST_OK;
+    }
+    rdc_status_t delete_rsmi_handle(RdcFieldKey) override {
+        return RDC_ST_OK;
+    }
+    rdc_status_t fetch_smi_field(uint32_t, rdc_field_t field_id,
+            rdc_field_value* value) override {
+        calls_++;
+        value->field_id = field_id;
+        value->status = RDC_ST_OK;
+        value->type = INTEGER;
+        value->value.l_int = kFallbackValue;
+        return RDC_ST_OK;
+    }
+    uint32_t calls() const { return calls_; }
+
+ private:
+    uint32_t calls_;
+};
+
+struct Expected {
+    uint32_t gpu_index;
+    rdc_field_t field_id;
+    int status;
+    int64_t value;
+};
+
+rdc_status_t collect(rdc_gpu_field_value_t* values, uint32_t num_values,
+                     void* user_data) {
+    auto collected = static_cast<std::vector<rdc_gpu_field_value_t>*>(
+            user_data);
+    collected->insert(collected->end(), values, values + num_values);
+    return RDC_ST_OK;
+}
+
+bool check(const std::string& root) {
+    bool ok = add_entry(root, "card0", Files{
+            {"device/vendor", kAmdVendorId},
+            {"device/gpu_busy_percent", "37"},
+            {"device/mem_info_vram_used", "1073741824"},
+            {"device/hwmon/hwmon3/temp1_label", "edge"},
+            {"device/hwmon/hwmon3/temp1_input", "45000"},
+            {"device/hwmon/hwmon3/temp2_label", "junction"},
+            {"device/hwmon/hwmon3/temp2_input", "50000"},
+            {"device/hwmon/hwmon3/temp3_label", "mem"},
+            {"device/hwmon/hwmon3/temp3_input", "60000"},
+            {"device/hwmon/hwmon3/power1_average", "120000000"}}) &&
+        add_entry(root, "card0-DP-1", Files{{"status", "connected"}}) &&
+        add_entry(root, "card1", Files{
+            {"device/vendor", "0x10de"},
+            {"device/gpu_busy_percent", "99"}}) &&
+        add_entry(root, "card2", Files{
+            {"device/vendor", kAmdVendorId},
+            {"device/mem_info_vram_used", "n/a"},
+            {"device/hwmon/hwmon5/temp1_label", "mem"},
+            {"device/hwmon/hwmon5/temp1_input", "55000"},
+            {"device/hwmon/hwmon5/temp2_label", "edge"},
+            {"device/hwmon/hwmon5/temp2_input", "-5000"},
+            {"device/hwmon/hwmon5/power1_input", "90000000"}}) &&
+        add_entry(root, "renderD128", Files{});
+    if (!ok) {
+        fprintf(stderr, "FAIL: cannot build the sysfs tree in %s\n",
+                root.c_str());
+        return false;
+    }
+
+    // card1 is not an AMD GPU, so card2 is GPU 1
+    const Expected expected[] = {
+        {0, RDC_FI_GPU_TEMP, RDC_ST_OK, 45000},
+        {0, RDC_FI_MEMORY_TEMP, RDC_ST_OK, 60000},
+        {0, RDC_FI_POWER_USAGE, RDC_ST_OK, 120000000},
+        {0, RDC_FI_GPU_UTIL, RDC_ST_OK, 37},
+        {0, RDC_FI_GPU_MEMORY_USAGE, RDC_ST_OK, 1073741824},
+        {1, RDC_FI_GPU_TEMP, RDC_ST_OK, -5000},
+        {1, RDC_FI_MEMORY_TEMP, RDC_ST_OK, 55000},
+        {1, RDC_FI_POWER_USAGE, RDC_ST_OK, 90000000},
+        {1, RDC_FI_GPU_UTIL, RDC_ST_OK, kFallbackValue},
+        {1, RDC_FI_GPU_MEMORY_USAGE, RDC_ST_NO_DATA, 0}};
+    const uint32_t num_expected = sizeof(expected) / sizeof(expected[0]);
+
+    auto fetcher = std::make_shared<FallbackFetcher>();
+    RdcSysfsLib sysfs(root, fetcher);
+    if (sysfs.get_num_devices() != 2) {
+        fprintf(stderr, "FAIL: %u GPUs found in the sysfs tree instead of 2\n",
+                sysfs.get_num_devices());
+        return false;
+    }
+
+    std::vector<rdc_gpu_field_t> fields;
+    for (uint32_t i = 0; i < num_expected; i++) {
+        fields.push_back({expected[i].gpu_index, expected[i].field_id});
+    }
+    std::vector<rdc_gpu_field_value_t> values;
+    sysfs.rdc_telemetry_fields_value_get(fields.data(), fields.size(),
+                                         collect, &values);
+    if (values.size() != num_expected) {
+        fprintf(stderr, "FAIL: %zu values read instead of %u\n",
+                values.size(), num_expected);
+        return false;
+    }
+    for (uint32_t i = 0; i < num_expected; i++) {
+        const rdc_field_value& value = values[i].field_value;
+        bool matches = values[i].gpu_index == expected[i].gpu_index &&
+                       value.field_id == expected[i].field_id &&
+                       value.status == expected[i].status &&
+                       (value.status != RDC_ST_OK ||
+                        value.value.l_int == expected[i].value);
+        printf("check gpu=%u field=%u status=%d value=%ld %s\n",
+               values[i].gpu_index, value.field_id, value.status,
+               static_cast<long>(value.value.l_int),  // NOLINT
+               matches ? "ok" : "FAIL");
+        ok = ok && matches;
+    }
+    if (fetcher->calls() != 1) {
+        fprintf(stderr, "FAIL: %u fetches fell back instead of 1\n",
+                fetcher->calls());
+        ok = false;
+    }
+    return ok;
+}
+
+// The cardN/device directories of the AMD GPUs in the order of N, as
+// RdcSysfsLib and rocm_smi_lib enumerate them
+std::vector<std::string> amd_devices(const std::string& root) {
+    std::vector<std::pair<int, std::string>> cards;
+    DIR* dir = opendir(root.c_str());
+    if (dir == nullptr) {
+        return {};
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        int card = -1;
+        char extra;
+        if (sscanf(entry->d_name, "card%d%c", &card, &extra) != 1) {
+            continue;
+        }
+        std::string device = root + "/" + entry->d_name + "/device";
+        char vendor[16] = {0};
+        int fd = open((device + "/vendor").c_str(), O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        ssize_t len = read(fd, vendor, sizeof(vendor) - 1);
+        close(fd);
+        if (len > 0 && strncmp(vendor, kAmdVendorId,
+                               sizeof(kAmdVendorId) - 1) == 0) {
+            cards.push_back({card, device});
+        }
+    }
+    closedir(dir);
+    std::sort(cards.begin(), cards.end());
+    std::vector<std::string> devices;
+    for (const auto& card : cards) {
+        devices.push_back(card.second);
+    }
+    return devices;
+}
+
+// The files of the hot fields of a device, in the order of kHotFields
+std::vector<std::string> hot_files(const std::string& device) {
+    std::string hwmon;
+    DIR* dir = opendir((device + "/hwmon").c_str());
+    if (dir != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strncmp(entry->d_name, "hwmon", 5) == 0) {
+                hwmon = device + "/hwmon/" + entry->d_name;
+                break;
+            }
+        }
+        closedir(dir);
+    }
+    return {hwmon + "/temp1_input", hwmon + "/power1_average",
+            device + "/gpu_busy_percent", device + "/mem_info_vram_used"};
+}
+
+double g_min_seconds = 0.5;
+
+// Runs a sweep until g_min_seconds passed, and prints the line of the
+// benchmark
+template <typename Sweep>
+void run(const char* name, uint32_t num_gpus, uint32_t num_fields,
+         Sweep sweep) {
+    uint64_t sweeps = 0;
+    uint64_t errors = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < g_min_seconds) {
+        for (uint32_t i = 0; i < 64; i++) {
+            errors += sweep();
+        }
+        sweeps += 64;
+        elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+    printf("bench=%s gpus=%u fields=%u sweeps=%lu us_per_sweep=%.2f "
+           "errors=%lu\n", name, num_gpus, num_fields,
+           static_cast<unsigned long>(sweeps),  // NOLINT
+           elapsed * 1e6 / sweeps,
+           static_cast<unsigned long>(errors));  // NOLINT
+    fflush(stdout);
+}
+
+rdc_status_t count_errors(rdc_gpu_field_value_t* values, uint32_t num_values,
+                          void* user_data) {
+    for (uint32_t i = 0; i < num_values; i++) {
+        if (values[i].field_value.status != RDC_ST_OK) {
+            (*static_cast<uint64_t*>(user_data))++;
+        }
+    }
+    return RDC_ST_OK;
+}
+
+// Errors of a sweep of the module over the fields
+uint64_t module_sweep(RdcTelemetry* module,
+                      std::vector<rdc_gpu_field_t>* fields) {
+    uint64_t errors = 0;
+    module->rdc_telemetry_fields_value_get(fields->data(), fields->size(),
+                                           count_errors, &errors);
+    return errors;
+}
+
+void bench(const std::string& root) {
+    std::vector<std::string> devices = amd_devices(root);
+    if (devices.empty()) {
+        fprintf(stderr, "No AMD GPU in %s\n", root.c_str());
+        return;
+    }
+    uint32_t num_gpus = devices.size();
+    std::vector<rdc_gpu_field_t> fields;
+    std::vector<std::string> files;
+    for (uint32_t g = 0; g < num_gpus; g++) {
+        std::vector<std::string> device_files = hot_files(devices[g]);
+        for (uint32_t f = 0; f < kNumHotFields; f++) {
+            fields.push_back({g, kHotFields[f]});
+            files.push_back(device_files[f]);
+        }
+    }
+    uint32_t num_fields = fields.size();
+
+    RdcMetricFetcherPtr fetcher = std::make_shared<RdcMetricFetcherImpl>();
+    RdcSysfsLib sysfs(root, fetcher);
+    run("sysfs_pread", num_gpus, num_fields, [&]() {
+        return module_sweep(&sysfs, &fields);
+    });
+
+    run("sysfs_open_read", num_gpus, num_fields, [&]() {
+        uint64_t errors = 0;
+        char buf[32];
+        for (const auto& file : files) {
+            int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0 || read(fd, buf, sizeof(buf) - 1) <= 0) {
+                errors++;
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        return errors;
+    });
+
+    RdcSmiLib smi(fetcher);
+    run("rocm_smi", num_gpus, num_fields, [&]() {
+        return module_sweep(&smi, &fields);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t num_gpus = 8;
+    std::string drm_root;
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:r:h")) != -1) {
+        switch (opt) {
+            case 'g':
+                num_gpus = static_cast<uint32_t>(atoi(optarg));
+                break;
+            case 't':
+                g_min_seconds = atof(optarg);
+                break;
+            case 'r':
+                drm_root = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-g gpus] [-t seconds] "
+                        "[-r drm_root]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (num_gpus == 0 || num_gpus > RDC_MAX_NUM_DEVICES_EXT ||
+        g_min_seconds <= 0) {
+        fprintf(stderr, "Invalid number of GPUs or duration\n");
+        return 1;
+    }
+
+    char check_root[] = "/tmp/rdc_sysfs_check_XXXXXX";
+    if (mkdtemp(check_root) == nullptr) {
+        perror("mkdtemp");
+        return 1;
+    }
+    bool passed = check(check_root);
+    remove_tree(check_root);
+
+    if (!drm_root.empty()) {
+        bench(drm_root);
+    } else {
+        char bench_root[] = "/tmp/rdc_sysfs_bench_XXXXXX";
+        if (mkdtemp(bench_root) == nullptr) {
+            perror("mkdtemp");
+            return 1;
+        }
+        bool built = true;
+        for (uint32_t g = 0; g < num_gpus && built; g++) {
+            built = add_entry(bench_root, "card" + std::to_string(g),
+                              amd_card(g));
+        }
+        if (built) {
+            bench(bench_root);
+        } else {
+            fprintf(stderr, "Cannot build the sysfs tree in %s\n",
+                    bench_root);
+        }
+        remove_tree(bench_root);
+    }
+
+    if (!passed) {
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -24,6 +24,7 @@ THE SOFTWARE.
 #include <stddef.h>
 
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "rdc_tests/functional/rdci_discovery.h"
@@ -112,6 +113,23 @@ void TestRdciDiscovery::Run(void) {
 
   ASSERT_GT(count, 0);
 
+  IF_VERB(STANDARD) {
+    std::cout << "\t**Getting the devices with the _ext API\n" << std::endl;
+  }
+  uint32_t ext_count = 0;
+  result = rdc_device_get_all_ext(rdc_handle, nullptr, &ext_count);
+  ASSERT_EQ(result, RDC_ST_INSUFF_RESOURCES);
+  ASSERT_EQ(ext_count, count);
+
+  std::vector<uint32_t> ext_index_list(ext_count);
+  result = rdc_device_get_all_ext(rdc_handle, ext_index_list.data(),
+                                                                &ext_count);
+  ASSERT_EQ(result, RDC_ST_OK);
+  ASSERT_EQ(ext_count, count);
+  for (uint32_t i = 0; i < count; i++) {
+    ASSERT_EQ(ext_index_list[i], gpu_index_list[i]);
+  }
+
   IF_VERB(STANDARD) {
     std::cout << "\t**Fetching attributes of every device\n" << std::endl;
   }
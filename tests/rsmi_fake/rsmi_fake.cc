@@ -0,0 +1,700 @@
+/*
+Copyright (c) 2020 - present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+// A drop-in fake of librocm_smi64.so which implements the rocm_smi_lib
+// functions used by RDC, so that librdc.so, rdcd and the tests can run
+// on machines without AMD GPUs.
+//
+// It is configured with the environment variables:
+//   RSMI_FAKE_NUM_DEVICES  Number of virtual devices, 8 by default.
+//   RSMI_FAKE_LATENCY_US   Latency added to every call, 0 by default.
+//   RSMI_FAKE_JITTER_US    Random jitter added on top of the latency.
+//   RSMI_FAKE_NUMA_NODES   NUMA nodes the devices are spread over, 1 by
+//                          default.
+//   RSMI_FAKE_CONFIG       Optional script file, one rule per line:
+//
+//     # <metric>[:<gpu>] <generator> <args...>
+//     temp_edge      sine   40000 80000 60   # min max period_sec
+//     power          ramp   50000000 250000000 30
+//     busy:1         random 0 100
+//     memory_total   const  34359738368
+//     pcie_tx:3      error  2                # return RSMI_STATUS_NOT_SUPPORTED
+//     # latency <metric|all>[:<gpu>] <usec> [<jitter_usec>]
+//     latency all:2  500000                  # GPU 2 hangs for 0.5 second
+//
+// Without a gpu suffix the rule applies to all devices.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <map>
+#include <mutex>  // NOLINT
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "rocm_smi/rocm_smi.h"
+
+namespace {
+
+enum FakeMetric {
+    METRIC_MEMORY_USAGE = 0,
+    METRIC_MEMORY_TOTAL,
+    METRIC_POWER,
+    METRIC_GPU_CLOCK,
+    METRIC_MEM_CLOCK,
+    METRIC_BUSY,
+    METRIC_TEMP_EDGE,
+    METRIC_TEMP_JUNCTION,
+    METRIC_TEMP_MEMORY,
+    METRIC_ECC_CORRECT,
+    METRIC_ECC_UNCORRECT,
+    METRIC_PCIE_TX,
+    METRIC_PCIE_RX,
+    METRIC_FAN_RPMS,
+    METRIC_FAN_SPEED,
+    METRIC_XGMI,
+    METRIC_COUNT
+};
+
+const char* kMetricNames[METRIC_COUNT] = {
+    "memory_usage", "memory_total", "power", "gpu_clock", "mem_clock",
+    "busy", "temp_edge", "temp_junction", "temp_mem", "ecc_correct",
+    "ecc_uncorrect", "pcie_tx", "pcie_rx", "fan_rpms", "fan_speed", "xgmi"
+};
+
+enum GeneratorType {
+    GEN_CONST = 0,
+    GEN_RAMP,
+    GEN_SINE,
+    GEN_RANDOM,
+    GEN_ERROR
+};
+
+struct Generator {
+    GeneratorType type;
+    double min;
+    double max;
+    double period;  //!< in seconds
+    rsmi_status_t error;
+};
+
+struct Latency {
+    uint64_t usec;
+    uint64_t jitter_usec;
+};
+
+struct FakeCounter {
+    uint32_t dv_ind;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+const uint32_t kDefaultNumDevices = 8;
+const double kPi = 3.14159265358979323846;
+
+class FakeSmi {
+ public:
+    static FakeSmi& getInstance() {
+        static FakeSmi instance;
+        return instance;
+    }
+
+    rsmi_status_t init() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (ref_count_ == 0) {
+            load_config();
+        }
+        ref_count_++;
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    rsmi_status_t shut_down() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (ref_count_ > 0) {
+            ref_count_--;
+        }
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    uint32_t num_devices() const { return num_devices_; }
+
+    uint32_t numa_node(uint32_t dv_ind) const {
+        return dv_ind * num_numa_nodes_ / num_devices_;
+    }
+
+    bool is_initialized() const { return ref_count_ > 0; }
+
+    // Sleep for the injected latency and generate the value
+    rsmi_status_t get(FakeMetric metric, uint32_t dv_ind, int64_t* val) {
+        if (!is_initialized()) {
+            return RSMI_STATUS_INIT_ERROR;
+        }
+        if (val == nullptr) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        if (dv_ind >= num_devices_) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        inject_latency(latencies_[index(dv_ind, metric)]);
+
+        const Generator& gen = generators_[index(dv_ind, metric)];
+        if (gen.type == GEN_ERROR) {
+            return gen.error;
+        }
+        *val = static_cast<int64_t>(generate(gen, dv_ind));
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    rsmi_status_t counter_create(uint32_t dv_ind, rsmi_event_handle_t* h) {
+        if (dv_ind >= num_devices_ || h == nullptr) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        std::lock_guard<std::mutex> guard(mutex_);
+        FakeCounter* counter = new FakeCounter();
+        counter->dv_ind = dv_ind;
+        counter->running = false;
+        counters_.insert({reinterpret_cast<rsmi_event_handle_t>(counter),
+                counter});
+        *h = reinterpret_cast<rsmi_event_handle_t>(counter);
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    rsmi_status_t counter_destroy(rsmi_event_handle_t h) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto ite = counters_.find(h);
+        if (ite == counters_.end()) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        delete ite->second;
+        counters_.erase(ite);
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    rsmi_status_t counter_control(rsmi_event_handle_t h,
+            rsmi_counter_command_t cmd) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        auto ite = counters_.find(h);
+        if (ite == counters_.end()) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        ite->second->running = (cmd == RSMI_CNTR_CMD_START);
+        ite->second->start = std::chrono::steady_clock::now();
+        return RSMI_STATUS_SUCCESS;
+    }
+
+    // The xgmi generator gives the rate in events per second
+    rsmi_status_t counter_read(rsmi_event_handle_t h,
+            rsmi_counter_value_t* value) {
+        if (value == nullptr) {
+            return RSMI_STATUS_INVALID_ARGS;
+        }
+        uint32_t dv_ind;
+        std::chrono::steady_clock::time_point start;
+        do {
+            std::lock_guard<std::mutex> guard(mutex_);
+            auto ite = counters_.find(h);
+            if (ite == counters_.end()) {
+                return RSMI_STATUS_INVALID_ARGS;
+            }
+            if (!ite->second->running) {
+                value->value = 0;
+                value->time_enabled = 0;
+                value->time_running = 0;
+                return RSMI_STATUS_SUCCESS;
+            }
+            dv_ind = ite->second->dv_ind;
+            start = ite->second->start;
+        } while (0);
+
+        int64_t rate = 0;
+        rsmi_status_t ret = get(METRIC_XGMI, dv_ind, &rate);
+        if (ret != RSMI_STATUS_SUCCESS) {
+            return ret;
+        }
+        uint64_t elapsed_ns = std::chrono::duration_cast<
+                std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        value->value = static_cast<uint64_t>(rate * (elapsed_ns / 1e9));
+        value->time_enabled = elapsed_ns;
+        value->time_running = elapsed_ns;
+        return RSMI_STATUS_SUCCESS;
+    }
+
+ private:
+    FakeSmi(): ref_count_(0), num_devices_(kDefaultNumDevices)
+        , num_numa_nodes_(1)
+        , start_(std::chrono::steady_clock::now()) {
+    }
+
+    size_t index(uint32_t dv_ind, FakeMetric metric) const {
+        return dv_ind * METRIC_COUNT + metric;
+    }
+
+    static uint64_t env_to_uint(const char* name, uint64_t default_value) {
+        const char* env = getenv(name);
+        if (env == nullptr || env[0] == '\0') {
+            return default_value;
+        }
+        return strtoull(env, nullptr, 10);
+    }
+
+    void set_default_generators() {
+        const Generator defaults[METRIC_COUNT] = {
+            {GEN_SINE, 1e9, 16e9, 120, RSMI_STATUS_SUCCESS},  // memory_usage
+            {GEN_CONST, 32e9, 32e9, 0, RSMI_STATUS_SUCCESS},  // memory_total
+            {GEN_SINE, 50e6, 250e6, 30, RSMI_STATUS_SUCCESS},  // power
+            {GEN_SINE, 800e6, 1700e6, 20, RSMI_STATUS_SUCCESS},  // gpu_clock
+            {GEN_CONST, 1200e6, 1200e6, 0, RSMI_STATUS_SUCCESS},  // mem_clock
+            {GEN_RAMP, 0, 100, 60, RSMI_STATUS_SUCCESS},  // busy
+            {GEN_SINE, 35000, 75000, 60, RSMI_STATUS_SUCCESS},  // temp_edge
+            {GEN_SINE, 40000, 90000, 60, RSMI_STATUS_SUCCESS},  // temp_junction
+            {GEN_SINE, 40000, 85000, 60, RSMI_STATUS_SUCCESS},  // temp_mem
+            {GEN_CONST, 0, 0, 0, RSMI_STATUS_SUCCESS},  // ecc_correct
+            {GEN_CONST, 0, 0, 0, RSMI_STATUS_SUCCESS},  // ecc_uncorrect
+            {GEN_RANDOM, 0, 1e9, 0, RSMI_STATUS_SUCCESS},  // pcie_tx
+            {GEN_RANDOM, 0, 1e9, 0, RSMI_STATUS_SUCCESS},  // pcie_rx
+            {GEN_SINE, 1000, 3000, 60, RSMI_STATUS_SUCCESS},  // fan_rpms
+            {GEN_SINE, 50, 200, 60, RSMI_STATUS_SUCCESS},  // fan_speed
+            {GEN_CONST, 1e6, 1e6, 0, RSMI_STATUS_SUCCESS}  // xgmi
+        };
+        generators_.clear();
+        latencies_.clear();
+        const Latency latency = {env_to_uint("RSMI_FAKE_LATENCY_US", 0),
+                env_to_uint("RSMI_FAKE_JITTER_US", 0)};
+        for (uint32_t i = 0; i < num_devices_; i++) {
+            for (uint32_t m = 0; m < METRIC_COUNT; m++) {
+                generators_.push_back(defaults[m]);
+                latencies_.push_back(latency);
+            }
+        }
+    }
+
+    bool parse_target(const std::string& target, int* metric,
+            int* dv_ind) const {
+        std::string name = target;
+        *dv_ind = -1;
+        size_t pos = target.find(':');
+        if (pos != std::string::npos) {
+            name = target.substr(0, pos);
+            *dv_ind = atoi(target.substr(pos + 1).c_str());
+            if (*dv_ind < 0 || static_cast<uint32_t>(*dv_ind) >=
+                    num_devices_) {
+                return false;
+            }
+        }
+        if (name == "all") {
+            *metric = -1;
+            return true;
+        }
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            if (name == kMetricNames[m]) {
+                *metric = m;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    void apply_rule(int metric, int dv_ind, const T& rule,
+            std::vector<T>* rules) {
+        for (uint32_t i = 0; i < num_devices_; i++) {
+            if (dv_ind >= 0 && static_cast<uint32_t>(dv_ind) != i) {
+                continue;
+            }
+            for (int m = 0; m < METRIC_COUNT; m++) {
+                if (metric >= 0 && metric != m) {
+                    continue;
+                }
+                (*rules)[index(i, static_cast<FakeMetric>(m))] = rule;
+            }
+        }
+    }
+
+    void load_config() {
+        num_devices_ = env_to_uint("RSMI_FAKE_NUM_DEVICES",
+                kDefaultNumDevices);
+        num_numa_nodes_ = env_to_uint("RSMI_FAKE_NUMA_NODES", 1);
+        if (num_numa_nodes_ == 0) {
+            num_numa_nodes_ = 1;
+        }
+        set_default_generators();
+
+        const char* config_file = getenv("RSMI_FAKE_CONFIG");
+        if (config_file == nullptr || config_file[0] == '\0') {
+            return;
+        }
+        std::ifstream config(config_file);
+        if (!config.is_open()) {
+            fprintf(stderr, "rsmi_fake: fail to open %s\n", config_file);
+            return;
+        }
+
+        std::string line;
+        uint32_t line_number = 0;
+        while (std::getline(config, line)) {
+            line_number++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream tokens(line);
+            std::string first;
+            std::string target;
+            if (!(tokens >> first)) {
+                continue;
+            }
+            int metric;
+            int dv_ind;
+            if (first == "latency") {
+                Latency latency = {0, 0};
+                if (!(tokens >> target >> latency.usec) ||
+                        !parse_target(target, &metric, &dv_ind)) {
+                    fprintf(stderr, "rsmi_fake: %s:%u: bad latency rule\n",
+                            config_file, line_number);
+                    continue;
+                }
+                tokens >> latency.jitter_usec;
+                apply_rule(metric, dv_ind, latency, &latencies_);
+                continue;
+            }
+
+            std::string type;
+            Generator gen = {GEN_CONST, 0, 0, 0, RSMI_STATUS_SUCCESS};
+            if (!parse_target(first, &metric, &dv_ind) || !(tokens >> type)) {
+                fprintf(stderr, "rsmi_fake: %s:%u: bad rule\n",
+                            config_file, line_number);
+                continue;
+            }
+            if (type == "const") {
+                tokens >> gen.min;
+                gen.max = gen.min;
+            } else if (type == "ramp" || type == "sine") {
+                gen.type = (type == "ramp") ? GEN_RAMP : GEN_SINE;
+                tokens >> gen.min >> gen.max >> gen.period;
+            } else if (type == "random") {
+                gen.type = GEN_RANDOM;
+                tokens >> gen.min >> gen.max;
+            } else if (type == "error") {
+                uint32_t error = RSMI_STATUS_NOT_SUPPORTED;
+                tokens >> error;
+                gen.type = GEN_ERROR;
+                gen.error = static_cast<rsmi_status_t>(error);
+            } else {
+                fprintf(stderr, "rsmi_fake: %s:%u: unknown generator %s\n",
+                            config_file, line_number, type.c_str());
+                continue;
+            }
+            apply_rule(metric, dv_ind, gen, &generators_);
+        }
+    }
+
+    static std::minstd_rand& rng() {
+        static thread_local std::minstd_rand engine(std::random_device{}());
+        return engine;
+    }
+
+    void inject_latency(const Latency& latency) const {
+        uint64_t usec = latency.usec;
+        if (latency.jitter_usec > 0) {
+            usec += rng()() % (latency.jitter_usec + 1);
+        }
+        if (usec == 0) {
+            return;
+        }
+        struct timespec ts;
+        ts.tv_sec = usec / 1000000;
+        ts.tv_nsec = (usec % 1000000) * 1000;
+        while (nanosleep(&ts, &ts) != 0) {}
+    }
+
+    // Each device is shifted in phase so the devices report different values
+    double generate(const Generator& gen, uint32_t dv_ind) const {
+        double elapsed = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start_).count();
+        double phase = 0;
+        if (gen.period > 0) {
+            phase = fmod(elapsed / gen.period +
+                    static_cast<double>(dv_ind) / num_devices_, 1.0);
+        }
+        switch (gen.type) {
+            case GEN_RAMP:
+                return gen.min + (gen.max - gen.min) * phase;
+            case GEN_SINE:
+                return gen.min + (gen.max - gen.min) *
+                        (1 + sin(2 * kPi * phase)) / 2;
+            case GEN_RANDOM:
+                return gen.min + (gen.max - gen.min) *
+                        (rng()() / static_cast<double>(rng().max()));
+            default:
+                return gen.min;
+        }
+    }
+
+    std::mutex mutex_;
+    std::atomic<uint32_t> ref_count_;
+    uint32_t num_devices_;
+    uint32_t num_numa_nodes_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<Generator> generators_;
+    std::vector<Latency> latencies_;
+    std::map<rsmi_event_handle_t, FakeCounter*> counters_;
+};
+
+rsmi_status_t get_metric(FakeMetric metric, uint32_t dv_ind, int64_t* val) {
+    return FakeSmi::getInstance().get(metric, dv_ind, val);
+}
+
+template <typename T>
+rsmi_status_t get_metric(FakeMetric metric, uint32_t dv_ind, T* val) {
+    if (val == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    int64_t i64 = 0;
+    rsmi_status_t ret = get_metric(metric, dv_ind, &i64);
+    if (ret == RSMI_STATUS_SUCCESS) {
+        *val = static_cast<T>(i64);
+    }
+    return ret;
+}
+
+}  // namespace
+
+rsmi_status_t rsmi_init(uint64_t init_flags) {
+    (void)init_flags;
+    return FakeSmi::getInstance().init();
+}
+
+rsmi_status_t rsmi_shut_down(void) {
+    return FakeSmi::getInstance().shut_down();
+}
+
+rsmi_status_t rsmi_num_monitor_devices(uint32_t* num_devices) {
+    if (num_devices == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    *num_devices = FakeSmi::getInstance().num_devices();
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_dev_memory_usage_get(uint32_t dv_ind,
+        rsmi_memory_type_t mem_type, uint64_t* used) {
+    (void)mem_type;
+    return get_metric(METRIC_MEMORY_USAGE, dv_ind, used);
+}
+
+rsmi_status_t rsmi_dev_memory_total_get(uint32_t dv_ind,
+        rsmi_memory_type_t mem_type, uint64_t* total) {
+    (void)mem_type;
+    return get_metric(METRIC_MEMORY_TOTAL, dv_ind, total);
+}
+
+rsmi_status_t rsmi_dev_power_ave_get(uint32_t dv_ind, uint32_t sensor_ind,
+        uint64_t* power) {
+    (void)sensor_ind;
+    return get_metric(METRIC_POWER, dv_ind, power);
+}
+
+rsmi_status_t rsmi_dev_gpu_clk_freq_get(uint32_t dv_ind,
+        rsmi_clk_type_t clk_type, rsmi_frequencies_t* f) {
+    if (f == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    FakeMetric metric = (clk_type == RSMI_CLK_TYPE_MEM) ?
+            METRIC_MEM_CLOCK : METRIC_GPU_CLOCK;
+    int64_t freq = 0;
+    rsmi_status_t ret = get_metric(metric, dv_ind, &freq);
+    if (ret == RSMI_STATUS_SUCCESS) {
+        f->num_supported = 1;
+        f->current = 0;
+        f->frequency[0] = static_cast<uint64_t>(freq);
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_busy_percent_get(uint32_t dv_ind,
+        uint32_t* busy_percent) {
+    return get_metric(METRIC_BUSY, dv_ind, busy_percent);
+}
+
+rsmi_status_t rsmi_dev_name_get(uint32_t dv_ind, char* name, size_t len) {
+    if (name == nullptr || len == 0) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= FakeSmi::getInstance().num_devices()) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    snprintf(name, len, "Fake GPU %u", dv_ind);
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_dev_temp_metric_get(uint32_t dv_ind, uint32_t sensor_type,
+        rsmi_temperature_metric_t metric, int64_t* temperature) {
+    (void)metric;
+    FakeMetric fake_metric = METRIC_TEMP_EDGE;
+    if (sensor_type == RSMI_TEMP_TYPE_JUNCTION) {
+        fake_metric = METRIC_TEMP_JUNCTION;
+    } else if (sensor_type == RSMI_TEMP_TYPE_MEMORY) {
+        fake_metric = METRIC_TEMP_MEMORY;
+    }
+    return get_metric(fake_metric, dv_ind, temperature);
+}
+
+rsmi_status_t rsmi_dev_ecc_status_get(uint32_t dv_ind,
+        rsmi_gpu_block_t block, rsmi_ras_err_state_t* state) {
+    (void)block;
+    if (state == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= FakeSmi::getInstance().num_devices()) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    *state = RSMI_RAS_ERR_STATE_ENABLED;
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_dev_ecc_count_get(uint32_t dv_ind,
+        rsmi_gpu_block_t block, rsmi_error_count_t* ec) {
+    (void)block;
+    if (ec == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    rsmi_status_t ret = get_metric(METRIC_ECC_CORRECT, dv_ind,
+            &ec->correctable_err);
+    if (ret != RSMI_STATUS_SUCCESS) {
+        return ret;
+    }
+    return get_metric(METRIC_ECC_UNCORRECT, dv_ind, &ec->uncorrectable_err);
+}
+
+rsmi_status_t rsmi_dev_pci_throughput_get(uint32_t dv_ind, uint64_t* sent,
+        uint64_t* received, uint64_t* max_pkt_sz) {
+    if (sent == nullptr || received == nullptr || max_pkt_sz == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    rsmi_status_t ret = get_metric(METRIC_PCIE_TX, dv_ind, sent);
+    if (ret != RSMI_STATUS_SUCCESS) {
+        return ret;
+    }
+    *max_pkt_sz = 256;
+    return get_metric(METRIC_PCIE_RX, dv_ind, received);
+}
+
+rsmi_status_t rsmi_dev_fan_rpms_get(uint32_t dv_ind, uint32_t sensor_ind,
+        int64_t* speed) {
+    (void)sensor_ind;
+    return get_metric(METRIC_FAN_RPMS, dv_ind, speed);
+}
+
+rsmi_status_t rsmi_dev_fan_speed_get(uint32_t dv_ind, uint32_t sensor_ind,
+        int64_t* speed) {
+    (void)sensor_ind;
+    return get_metric(METRIC_FAN_SPEED, dv_ind, speed);
+}
+
+rsmi_status_t rsmi_dev_fan_speed_max_get(uint32_t dv_ind, uint32_t sensor_ind,
+        uint64_t* max_speed) {
+    (void)sensor_ind;
+    if (max_speed == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= FakeSmi::getInstance().num_devices()) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    *max_speed = 255;
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_topo_get_numa_node_number(uint32_t dv_ind,
+        uint32_t* numa_node) {
+    if (numa_node == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= FakeSmi::getInstance().num_devices()) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    *numa_node = FakeSmi::getInstance().numa_node(dv_ind);
+    return RSMI_STATUS_SUCCESS;
+}
+
+rsmi_status_t rsmi_dev_counter_group_supported(uint32_t dv_ind,
+        rsmi_event_group_t group) {
+    if (!FakeSmi::getInstance().is_initialized()) {
+        return RSMI_STATUS_INIT_ERROR;
+    }
+    if (dv_ind >= FakeSmi::getInstance().num_devices()) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    return group == RSMI_EVNT_GRP_XGMI ?
+            RSMI_STATUS_SUCCESS : RSMI_STATUS_NOT_SUPPORTED;
+}
+
+rsmi_status_t rsmi_counter_available_counters_get(uint32_t dv_ind,
+        rsmi_event_group_t grp, uint32_t* available) {
+    if (available == nullptr) {
+        return RSMI_STATUS_INVALID_ARGS;
+    }
+    rsmi_status_t ret = rsmi_dev_counter_group_supported(dv_ind, grp);
+    if (ret == RSMI_STATUS_SUCCESS) {
+        *available = 4;
+    }
+    return ret;
+}
+
+rsmi_status_t rsmi_dev_counter_create(uint32_t dv_ind,
+        rsmi_event_type_t type, rsmi_event_handle_t* evnt_handle) {
+    (void)type;
+    return FakeSmi::getInstance().counter_create(dv_ind, evnt_handle);
+}
+
+rsmi_status_t rsmi_dev_counter_destroy(rsmi_event_handle_t evnt_handle) {
+    return FakeSmi::getInstance().counter_destroy(evnt_handle);
+}
+
+rsmi_status_t rsmi_counter_control(rsmi_event_handle_t evt_handle,
+        rsmi_counter_command_t cmd, void* cmd_args) {
+    (void)cmd_args;
+    return FakeSmi::getInstance().counter_control(evt_handle, cmd);
+}
+
+rsmi_status_t rsmi_counter_read(rsmi_event_handle_t evt_handle,
+        rsmi_counter_value_t* value) {
+    return FakeSmi::getInstance().counter_read(evt_handle, value);
+}